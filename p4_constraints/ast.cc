@@ -25,6 +25,7 @@
 #include "absl/strings/ascii.h"
 #include "absl/strings/str_cat.h"
 #include "absl/types/optional.h"
+#include "google/protobuf/arena.h"
 #include "google/protobuf/descriptor.h"
 #include "google/protobuf/util/message_differencer.h"
 #include "gutil/proto.h"
@@ -294,5 +295,20 @@ absl::StatusOr<int> Size(const ast::Expression& ast, SizeCache* size_cache) {
   return result;
 }
 
+void ExpressionDeleter::operator()(Expression* expr) const {
+  if (expr->GetArena() == nullptr) delete expr;
+}
+
+ExpressionPtr NewExpression(google::protobuf::Arena* arena) {
+  return ExpressionPtr(google::protobuf::Arena::Create<Expression>(arena));
+}
+
+ExpressionPtr TakeExpression(Expression* expr) {
+  ExpressionPtr result = NewExpression(expr->GetArena());
+  // Swapping expressions on the same arena (or on the heap) is O(1).
+  result->Swap(expr);
+  return result;
+}
+
 }  // namespace ast
 }  // namespace p4_constraints
@@ -21,12 +21,14 @@
 #define P4_CONSTRAINTS_AST_H_
 
 #include <iosfwd>
+#include <memory>
 #include <string>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
 #include "absl/types/optional.h"
+#include "google/protobuf/arena.h"
 #include "p4_constraints/ast.pb.h"
 
 namespace p4_constraints {
@@ -91,6 +93,29 @@ using SizeCache = absl::flat_hash_map<const Expression*, int>;
 // Status when passed an invalid ast.
 absl::StatusOr<int> Size(const Expression& ast, SizeCache* size_cache);
 
+// -- Arena allocation ---------------------------------------------------------
+
+// Deletes expressions that are not owned by an arena.
+struct ExpressionDeleter {
+  void operator()(Expression* expr) const;
+};
+
+// Owns an expression, unless the expression lives on an arena, which then owns
+// it. To make the expression a subexpression of another expression on the same
+// arena (or of a heap-allocated expression, if it is heap-allocated itself),
+// pass `release()` to a `set_allocated_*` method; this does not copy it.
+using ExpressionPtr = std::unique_ptr<Expression, ExpressionDeleter>;
+
+// Returns an empty expression on `arena`, or on the heap if `arena` is null.
+ExpressionPtr NewExpression(google::protobuf::Arena* arena);
+
+// Moves `*expr` into a new expression on the same arena as `expr` (or on the
+// heap), leaving `*expr` empty. Takes O(1) time, whereas moving `*expr` into an
+// expression on the stack copies it if `expr` lives on an arena. Use this to
+// restructure ASTs, e.g. to replace an expression with one of its
+// subexpressions.
+ExpressionPtr TakeExpression(Expression* expr);
+
 }  // namespace ast
 }  // namespace p4_constraints
 
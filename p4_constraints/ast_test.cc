@@ -22,6 +22,7 @@
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/substitute.h"
+#include "google/protobuf/arena.h"
 #include "gutil/status_matchers.h"
 #include "gutil/testing.h"
 
@@ -308,5 +309,37 @@ TEST(AddVariables, ReturnsEmptyForActionParameter) {
   EXPECT_EQ(GetVariables(expr), expected);
 }
 
+TEST(NewExpressionTest, AllocatesOnArenaIfGiven) {
+  google::protobuf::Arena arena;
+  EXPECT_EQ(NewExpression(&arena)->GetArena(), &arena);
+  EXPECT_EQ(NewExpression(nullptr)->GetArena(), nullptr);
+}
+
+// Takes the operand out of a negation allocated on `arena` (or on the heap, if
+// `arena` is null) and puts it back.
+void TakeAndRestoreOperand(google::protobuf::Arena* arena) {
+  ExpressionPtr expr = NewExpression(arena);
+  *expr = ParseRawAst(R"pb(
+    boolean_negation { key: "k" type { exact { bitwidth: 8 } } }
+  )pb");
+  ExpressionPtr operand = TakeExpression(expr->mutable_boolean_negation());
+  EXPECT_EQ(operand->GetArena(), arena);
+  EXPECT_EQ(operand->key(), "k");
+  EXPECT_EQ(operand->type().exact().bitwidth(), 8);
+  EXPECT_EQ(expr->boolean_negation().key(), "");
+
+  expr->set_allocated_boolean_negation(operand.release());
+  EXPECT_EQ(expr->boolean_negation().key(), "k");
+}
+
+TEST(TakeExpressionTest, MovesExpressionOutOnArena) {
+  google::protobuf::Arena arena;
+  TakeAndRestoreOperand(&arena);
+}
+
+TEST(TakeExpressionTest, MovesExpressionOutOnHeap) {
+  TakeAndRestoreOperand(nullptr);
+}
+
 }  // namespace ast
 }  // namespace p4_constraints
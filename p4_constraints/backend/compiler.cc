@@ -0,0 +1,459 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "p4_constraints/backend/compiler.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/numeric/int128.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "gutil/status.h"
+#include "p4_constraints/ast.h"
+#include "p4_constraints/ast.pb.h"
+#include "p4_constraints/backend/program.h"
+#include "p4_constraints/big_int.h"
+
+namespace p4_constraints {
+
+namespace {
+
+using ::p4_constraints::ast::Expression;
+using ::p4_constraints::ast::Type;
+
+// Returns true iff values of the given type are represented by BigInt in the
+// reference interpreter.
+bool IsIntegral(const Type& type) {
+  return type.type_case() == Type::kArbitraryInt ||
+         type.type_case() == Type::kFixedUnsigned;
+}
+
+// Returns the components of a key of the given type, in stack order.
+absl::StatusOr<std::vector<KeyField>> KeyFields(const Type& type) {
+  switch (type.type_case()) {
+    case Type::kExact:
+      return std::vector<KeyField>{KeyField::kValue};
+    case Type::kTernary:
+    case Type::kOptionalMatch:
+      return std::vector<KeyField>{KeyField::kValue, KeyField::kMask};
+    case Type::kLpm:
+      return std::vector<KeyField>{KeyField::kValue, KeyField::kPrefixLength};
+    case Type::kRange:
+      return std::vector<KeyField>{KeyField::kLow, KeyField::kHigh};
+    default:
+      return gutil::UnimplementedErrorBuilder()
+             << "keys of type " << type << " are not supported";
+  }
+}
+
+// Returns the number of stack slots occupied by a value of the given type.
+absl::StatusOr<int> ComponentCount(const Type& type) {
+  switch (type.type_case()) {
+    case Type::kBoolean:
+    case Type::kArbitraryInt:
+    case Type::kFixedUnsigned:
+      return 1;
+    default: {
+      ASSIGN_OR_RETURN(std::vector<KeyField> fields, KeyFields(type));
+      return fields.size();
+    }
+  }
+}
+
+absl::StatusOr<KeyField> ParseKeyField(const Type& type,
+                                       absl::string_view field) {
+  ASSIGN_OR_RETURN(std::vector<KeyField> fields, KeyFields(type));
+  for (KeyField key_field : fields) {
+    if (KeyFieldName(key_field) == field) return key_field;
+  }
+  return gutil::UnimplementedErrorBuilder()
+         << "value of type " << type << " has no field " << field;
+}
+
+// Sets the representation of `program` to the narrowest one that can hold all
+// of its constants and the values of its variables at their static types.
+void ChooseRepresentation(Program& program) {
+  program.representation = ValueRepresentation::kBigInt;
+  program.fixed_width_constants.clear();
+  for (const Instruction& instruction : program.instructions) {
+    // Negation is the only source of negative values besides constants.
+    if (instruction.opcode == Opcode::kNegate) return;
+    if (instruction.opcode == Opcode::kPushInteger && instruction.operand < 0) {
+      return;
+    }
+  }
+  int bitwidth = 0;
+  for (const Variable& variable : program.variables) {
+    std::optional<int> variable_bitwidth = ast::TypeBitwidth(variable.type);
+    if (!variable_bitwidth.has_value()) return;
+    bitwidth = std::max(bitwidth, *variable_bitwidth);
+  }
+  std::vector<absl::uint128> fixed_width_constants;
+  fixed_width_constants.reserve(program.constants.size());
+  for (const BigInt& constant : program.constants) {
+    std::optional<absl::uint128> fixed_width_constant =
+        BigIntToUint128(constant);
+    if (!fixed_width_constant.has_value()) return;
+    if (absl::Uint128High64(*fixed_width_constant) != 0) bitwidth = 128;
+    fixed_width_constants.push_back(*fixed_width_constant);
+  }
+  if (bitwidth > 128) return;
+  program.representation = bitwidth <= 64 ? ValueRepresentation::kUint64
+                                          : ValueRepresentation::kUint128;
+  program.fixed_width_constants = std::move(fixed_width_constants);
+}
+
+class Compiler {
+ public:
+  absl::StatusOr<Program> Run(const Expression& constraint) {
+    if (constraint.type().type_case() != Type::kBoolean) {
+      return gutil::InvalidArgumentErrorBuilder()
+             << "expected constraint of type bool, but got type "
+             << constraint.type();
+    }
+    RETURN_IF_ERROR(Compile(constraint));
+    ChooseRepresentation(program_);
+    return std::move(program_);
+  }
+
+ private:
+  absl::Status Compile(const Expression& expr) {
+    switch (expr.type().type_case()) {
+      case Type::kUnknown:
+      case Type::kUnsupported:
+      case Type::TYPE_NOT_SET:
+        return gutil::InvalidArgumentErrorBuilder()
+               << "expected type-checked expression, but found expression of "
+                  "type "
+               << expr.type() << ": " << expr.ShortDebugString();
+      default:
+        break;
+    }
+
+    if (IsIntegral(expr.type())) {
+      ASSIGN_OR_RETURN(std::optional<BigInt> constant, FoldIntegral(expr));
+      if (constant.has_value()) {
+        Emit(Opcode::kPushConstant, ConstantIndex(*constant));
+        return absl::OkStatus();
+      }
+    }
+
+    switch (expr.expression_case()) {
+      case Expression::kBooleanConstant:
+        Emit(Opcode::kPushInteger, expr.boolean_constant() ? 1 : 0);
+        return absl::OkStatus();
+
+      case Expression::kIntegerConstant: {
+        ASSIGN_OR_RETURN(BigInt value, ParseLiteral(expr.integer_constant()));
+        Emit(Opcode::kPushConstant, ConstantIndex(value));
+        return absl::OkStatus();
+      }
+
+      case Expression::kKey: {
+        ASSIGN_OR_RETURN(std::vector<KeyField> fields, KeyFields(expr.type()));
+        const int index = VariableIndex(expr.key(), expr.type());
+        for (KeyField field : fields) Emit(Opcode::kLoadKey, index, field);
+        return absl::OkStatus();
+      }
+
+      case Expression::kActionParameter:
+        if (!IsIntegral(expr.type())) {
+          return gutil::UnimplementedErrorBuilder()
+                 << "action parameters of type " << expr.type()
+                 << " are not supported";
+        }
+        Emit(Opcode::kLoadParam,
+             VariableIndex(expr.action_parameter(), expr.type()));
+        return absl::OkStatus();
+
+      case Expression::kAttributeAccess:
+        if (expr.attribute_access().attribute_name() == "priority") {
+          Emit(Opcode::kLoadPriority);
+          return absl::OkStatus();
+        }
+        return gutil::UnimplementedErrorBuilder()
+               << "unknown attribute '"
+               << expr.attribute_access().attribute_name() << "'";
+
+      case Expression::kBooleanNegation:
+        RETURN_IF_ERROR(CompileBoolean(expr.boolean_negation()));
+        Emit(Opcode::kNot);
+        return absl::OkStatus();
+
+      case Expression::kArithmeticNegation:
+        RETURN_IF_ERROR(CompileIntegral(expr.arithmetic_negation()));
+        Emit(Opcode::kNegate);
+        return absl::OkStatus();
+
+      case Expression::kTypeCast:
+        return CompileTypeCast(expr.type(), expr.type_cast());
+
+      case Expression::kBinaryExpression:
+        return CompileBinaryExpression(expr.binary_expression());
+
+      case Expression::kFieldAccess: {
+        const Expression& composite_expr = expr.field_access().expr();
+        if (composite_expr.expression_case() != Expression::kKey) {
+          return gutil::UnimplementedErrorBuilder()
+                 << "field access is only supported on keys";
+        }
+        ASSIGN_OR_RETURN(KeyField field,
+                         ParseKeyField(composite_expr.type(),
+                                       expr.field_access().field()));
+        Emit(Opcode::kLoadKey,
+             VariableIndex(composite_expr.key(), composite_expr.type()), field);
+        return absl::OkStatus();
+      }
+
+      case Expression::EXPRESSION_NOT_SET:
+        break;
+    }
+    return gutil::InvalidArgumentErrorBuilder()
+           << "invalid expression: " << expr.DebugString();
+  }
+
+  absl::Status CompileBoolean(const Expression& expr) {
+    if (expr.type().type_case() != Type::kBoolean) {
+      return gutil::UnimplementedErrorBuilder()
+             << "expected expression of type bool, but got type "
+             << expr.type();
+    }
+    return Compile(expr);
+  }
+
+  absl::Status CompileIntegral(const Expression& expr) {
+    if (!IsIntegral(expr.type())) {
+      return gutil::UnimplementedErrorBuilder()
+             << "expected expression of integral type, but got type "
+             << expr.type();
+    }
+    return Compile(expr);
+  }
+
+  absl::Status CompileTypeCast(const Type& type, const Expression& expr) {
+    RETURN_IF_ERROR(CompileIntegral(expr));
+    const int bitwidth = ast::TypeBitwidth(type).value_or(-1);
+    switch (type.type_case()) {
+      // int ~~> bit<W>
+      //   n |~> n mod 2^W
+      case Type::kFixedUnsigned:
+        Emit(Opcode::kMod, ConstantIndex(BigInt(1) << bitwidth));
+        return absl::OkStatus();
+
+      // bit<W> ~~> Exact<W>
+      //      n |~> Exact { value = n }
+      case Type::kExact:
+        return absl::OkStatus();
+
+      // bit<W> ~~> Ternary<W>/Optional<W>
+      //      n |~> Ternary { value = n; mask = 2^W-1 }
+      case Type::kTernary:
+      case Type::kOptionalMatch:
+        Emit(Opcode::kPushConstant,
+             ConstantIndex((BigInt(1) << bitwidth) - 1));
+        return absl::OkStatus();
+
+      // bit<W> ~~> LPM<W>
+      //      n |~> LPM { value = n; prefix_length = W }
+      case Type::kLpm:
+        Emit(Opcode::kPushInteger, bitwidth);
+        return absl::OkStatus();
+
+      // bit<W> ~~> Range<W>
+      //      n |~> Range { low = n; high = n }
+      case Type::kRange:
+        Emit(Opcode::kDup);
+        return absl::OkStatus();
+
+      default:
+        return gutil::UnimplementedErrorBuilder()
+               << "cannot cast expression of type " << expr.type()
+               << " to type " << type;
+    }
+  }
+
+  absl::Status CompileBinaryExpression(const ast::BinaryExpression& binexpr) {
+    const Expression& left = binexpr.left();
+    const Expression& right = binexpr.right();
+    switch (binexpr.binop()) {
+      case ast::EQ:
+      case ast::NE: {
+        // The reference interpreter considers values of distinct runtime
+        // representations unequal; we only deal with the well-typed case.
+        if (!(left.type() == right.type())) {
+          return gutil::UnimplementedErrorBuilder()
+                 << "comparison of values of distinct types " << left.type()
+                 << " and " << right.type();
+        }
+        ASSIGN_OR_RETURN(int components, ComponentCount(left.type()));
+        RETURN_IF_ERROR(Compile(left));
+        RETURN_IF_ERROR(Compile(right));
+        Emit(binexpr.binop() == ast::EQ ? Opcode::kEq : Opcode::kNe,
+             components);
+        return absl::OkStatus();
+      }
+
+      case ast::GT:
+      case ast::GE:
+      case ast::LT:
+      case ast::LE: {
+        RETURN_IF_ERROR(CompileIntegral(left));
+        RETURN_IF_ERROR(CompileIntegral(right));
+        switch (binexpr.binop()) {
+          case ast::GT:
+            Emit(Opcode::kGt);
+            break;
+          case ast::GE:
+            Emit(Opcode::kGe);
+            break;
+          case ast::LT:
+            Emit(Opcode::kLt);
+            break;
+          default:
+            Emit(Opcode::kLe);
+            break;
+        }
+        return absl::OkStatus();
+      }
+
+      // Short circuit boolean operations:
+      //   l && r  ~~>  l; jump_if_false_else_pop end; r; end:
+      //   l || r  ~~>  l; jump_if_true_else_pop end; r; end:
+      //   l -> r  ~~>  l; not; jump_if_true_else_pop end; r; end:
+      case ast::AND:
+      case ast::OR:
+      case ast::IMPLIES: {
+        RETURN_IF_ERROR(CompileBoolean(left));
+        if (binexpr.binop() == ast::IMPLIES) Emit(Opcode::kNot);
+        const int jump = program_.instructions.size();
+        Emit(binexpr.binop() == ast::AND ? Opcode::kJumpIfFalseElsePop
+                                         : Opcode::kJumpIfTrueElsePop);
+        RETURN_IF_ERROR(CompileBoolean(right));
+        program_.instructions[jump].operand = program_.instructions.size();
+        return absl::OkStatus();
+      }
+
+      default:
+        return gutil::InvalidArgumentErrorBuilder()
+               << "unknown binary operator "
+               << ast::BinaryOperator_Name(binexpr.binop());
+    }
+  }
+
+  // Appends the given instruction, keeping track of the stack size.
+  void Emit(Opcode opcode, int32_t operand = 0,
+            KeyField field = KeyField::kValue) {
+    program_.instructions.push_back(
+        Instruction{.opcode = opcode, .field = field, .operand = operand});
+    switch (opcode) {
+      case Opcode::kPushInteger:
+      case Opcode::kPushConstant:
+      case Opcode::kLoadKey:
+      case Opcode::kLoadParam:
+      case Opcode::kLoadPriority:
+      case Opcode::kDup:
+        ++stack_size_;
+        break;
+      case Opcode::kNot:
+      case Opcode::kNegate:
+      case Opcode::kMod:
+        break;
+      case Opcode::kEq:
+      case Opcode::kNe:
+        stack_size_ -= 2 * operand - 1;
+        break;
+      case Opcode::kLt:
+      case Opcode::kLe:
+      case Opcode::kGt:
+      case Opcode::kGe:
+        --stack_size_;
+        break;
+      // The stack size where the jump lands is the same as after the
+      // fall-through path has pushed the right operand, so we only track the
+      // latter.
+      case Opcode::kJumpIfFalseElsePop:
+      case Opcode::kJumpIfTrueElsePop:
+        --stack_size_;
+        break;
+    }
+    program_.max_stack_size = std::max(program_.max_stack_size, stack_size_);
+  }
+
+  // Evaluates integral expressions that do not depend on the entry, i.e.
+  // literals and negations and casts thereof. Returns nullopt for all other
+  // expressions.
+  absl::StatusOr<std::optional<BigInt>> FoldIntegral(const Expression& expr) {
+    switch (expr.expression_case()) {
+      case Expression::kIntegerConstant:
+        return ParseLiteral(expr.integer_constant());
+      case Expression::kArithmeticNegation: {
+        ASSIGN_OR_RETURN(std::optional<BigInt> value,
+                         FoldIntegral(expr.arithmetic_negation()));
+        if (value.has_value()) return -*value;
+        return std::nullopt;
+      }
+      case Expression::kTypeCast: {
+        if (expr.type().type_case() != Type::kFixedUnsigned) break;
+        ASSIGN_OR_RETURN(std::optional<BigInt> value,
+                         FoldIntegral(expr.type_cast()));
+        if (!value.has_value()) return std::nullopt;
+        const BigInt domain_size =
+            BigInt(1) << ast::TypeBitwidth(expr.type()).value_or(0);
+        BigInt fixed_value = *value % domain_size;
+        // operator% may return negative values.
+        if (fixed_value < 0) fixed_value += domain_size;
+        return fixed_value;
+      }
+      default:
+        break;
+    }
+    return std::nullopt;
+  }
+
+  absl::StatusOr<BigInt> ParseLiteral(const std::string& decimal) {
+    ASSIGN_OR_RETURN(BigInt value, ParseBigInt(decimal, 10),
+                     _ << "AST invariant violated; invalid decimal string: "
+                       << decimal);
+    return value;
+  }
+
+  // Returns the index of `value` in the program's constants, adding it if
+  // necessary.
+  int ConstantIndex(const BigInt& value) {
+    auto [it, inserted] = constant_index_.insert(
+        {BigIntToString(value), program_.constants.size()});
+    if (inserted) program_.constants.push_back(value);
+    return it->second;
+  }
+
+  int VariableIndex(const std::string& name, const Type& type) {
+    auto [it, inserted] =
+        variable_index_.insert({name, program_.variables.size()});
+    if (inserted) {
+      program_.variables.push_back(Variable{.name = name, .type = type});
+    }
+    return it->second;
+  }
+
+  Program program_;
+  int stack_size_ = 0;
+  // Maps the decimal strings of constants to their indices.
+  absl::flat_hash_map<std::string, int> constant_index_;
+  absl::flat_hash_map<std::string, int> variable_index_;
+};
+
+}  // namespace
+
+absl::StatusOr<Program> CompileConstraint(const Expression& constraint) {
+  return Compiler().Run(constraint);
+}
+
+}  // namespace p4_constraints
@@ -0,0 +1,25 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+// The compiler lowers type-checked constraints into programs for the VM.
+
+#ifndef P4_CONSTRAINTS_BACKEND_COMPILER_H_
+#define P4_CONSTRAINTS_BACKEND_COMPILER_H_
+
+#include "absl/status/statusor.h"
+#include "p4_constraints/ast.pb.h"
+#include "p4_constraints/backend/program.h"
+
+namespace p4_constraints {
+
+// Compiles the given type-checked constraint into a `Program` whose execution
+// (see vm.h) agrees with the reference interpreter (see interpreter.h).
+//
+// Returns an `Unimplemented` error for constraints that are well-typed but not
+// supported by the VM; these must be evaluated by the reference interpreter.
+// Returns an `InvalidArgument` error if `constraint` is not type-checked.
+absl::StatusOr<Program> CompileConstraint(const ast::Expression& constraint);
+
+}  // namespace p4_constraints
+
+#endif  // P4_CONSTRAINTS_BACKEND_COMPILER_H_
@@ -0,0 +1,164 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "p4_constraints/backend/compiler.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <stdint.h>
+
+#include <string>
+
+#include "absl/numeric/int128.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "gutil/status_matchers.h"
+#include "gutil/testing.h"
+#include "p4_constraints/ast.pb.h"
+#include "p4_constraints/backend/constraint_info.h"
+#include "p4_constraints/backend/program.h"
+#include "p4_constraints/backend/type_checker.h"
+#include "p4_constraints/big_int.h"
+#include "p4_constraints/constraint_source.h"
+#include "p4_constraints/frontend/constraint_kind.h"
+#include "p4_constraints/frontend/parser.h"
+
+namespace p4_constraints {
+namespace {
+
+using ::gutil::ParseProtoOrDie;
+using ::gutil::StatusIs;
+using ::p4_constraints::ast::Expression;
+using ::p4_constraints::ast::Type;
+using ::testing::ElementsAre;
+using ::testing::Field;
+using ::testing::IsEmpty;
+
+class CompileConstraintTest : public ::testing::Test {
+ public:
+  const Type kExact32 = ParseProtoOrDie<Type>("exact { bitwidth: 32 }");
+  const Type kTernary32 = ParseProtoOrDie<Type>("ternary { bitwidth: 32 }");
+
+  const TableInfo kTableInfo = {
+      .id = 1,
+      .name = "table",
+      .keys_by_id = {{1, {1, "exact32", kExact32}},
+                     {2, {2, "ternary32", kTernary32}}},
+      .keys_by_name = {{"exact32", {1, "exact32", kExact32}},
+                       {"ternary32", {2, "ternary32", kTernary32}}},
+  };
+
+  absl::StatusOr<Program> ParseAndCompile(const std::string& constraint) {
+    ConstraintSource source{
+        .constraint_string = constraint,
+        .constraint_location = ast::SourceLocation(),
+    };
+    ASSIGN_OR_RETURN(Expression expr,
+                     ParseConstraint(ConstraintKind::kTableConstraint, source));
+    RETURN_IF_ERROR(InferAndCheckTypes(&expr, kTableInfo));
+    return CompileConstraint(expr);
+  }
+};
+
+TEST_F(CompileConstraintTest, ScalarizesCompositeComparison) {
+  ASSERT_OK_AND_ASSIGN(Program program, ParseAndCompile("ternary32 == 5"));
+  EXPECT_THAT(program.instructions,
+              ElementsAre(Field(&Instruction::opcode, Opcode::kLoadKey),
+                          Field(&Instruction::opcode, Opcode::kLoadKey),
+                          Field(&Instruction::opcode, Opcode::kPushConstant),
+                          Field(&Instruction::opcode, Opcode::kPushConstant),
+                          Field(&Instruction::opcode, Opcode::kEq)));
+  EXPECT_EQ(program.instructions.back().operand, 2);
+  EXPECT_EQ(program.max_stack_size, 4);
+}
+
+TEST_F(CompileConstraintTest, ShortCircuitJumpsPastRightOperand) {
+  ASSERT_OK_AND_ASSIGN(Program program,
+                       ParseAndCompile("exact32 == 1 && exact32 == 2"));
+  ASSERT_EQ(program.instructions[3].opcode, Opcode::kJumpIfFalseElsePop);
+  EXPECT_EQ(program.instructions[3].operand, program.instructions.size());
+}
+
+TEST_F(CompileConstraintTest, DeduplicatesConstantsAndVariables) {
+  ASSERT_OK_AND_ASSIGN(
+      Program program,
+      ParseAndCompile("exact32 == 7 || exact32::value == 7 || ternary32 == 7"));
+  // 7 and the mask 2^32-1 of ternary32.
+  EXPECT_EQ(program.constants.size(), 2);
+  EXPECT_THAT(program.variables,
+              ElementsAre(Field(&Variable::name, "exact32"),
+                          Field(&Variable::name, "ternary32")));
+}
+
+TEST_F(CompileConstraintTest, FoldsCastsOfLiterals) {
+  ASSERT_OK_AND_ASSIGN(Program program,
+                       ParseAndCompile("ternary32::mask == -1"));
+  EXPECT_THAT(program.instructions,
+              ElementsAre(Field(&Instruction::opcode, Opcode::kLoadKey),
+                          Field(&Instruction::opcode, Opcode::kPushConstant),
+                          Field(&Instruction::opcode, Opcode::kEq)));
+  EXPECT_THAT(program.constants, ElementsAre((BigInt(1) << 32) - 1));
+}
+
+TEST_F(CompileConstraintTest, PrecomputesDomainSizeOfCasts) {
+  ASSERT_OK_AND_ASSIGN(Program program,
+                       ParseAndCompile("::priority == exact32::value"));
+  EXPECT_THAT(program.instructions,
+              ElementsAre(Field(&Instruction::opcode, Opcode::kLoadPriority),
+                          Field(&Instruction::opcode, Opcode::kMod),
+                          Field(&Instruction::opcode, Opcode::kLoadKey),
+                          Field(&Instruction::opcode, Opcode::kEq)));
+  EXPECT_THAT(program.constants, ElementsAre(BigInt(1) << 32));
+}
+
+TEST_F(CompileConstraintTest, ChoosesNarrowestRepresentation) {
+  ASSERT_OK_AND_ASSIGN(Program program,
+                       ParseAndCompile("ternary32::mask == -1"));
+  EXPECT_EQ(program.representation, ValueRepresentation::kUint64);
+  EXPECT_THAT(program.fixed_width_constants,
+              ElementsAre(absl::uint128(0xffffffff)));
+
+  ASSERT_OK_AND_ASSIGN(program,
+                       ParseAndCompile("::priority != 0x10000000000000000"));
+  EXPECT_EQ(program.representation, ValueRepresentation::kUint128);
+
+  ASSERT_OK_AND_ASSIGN(program, ParseAndCompile("::priority > -1"));
+  EXPECT_EQ(program.representation, ValueRepresentation::kBigInt);
+  EXPECT_THAT(program.fixed_width_constants, IsEmpty());
+
+  ASSERT_OK_AND_ASSIGN(program, ParseAndCompile("-::priority < 0"));
+  EXPECT_EQ(program.representation, ValueRepresentation::kBigInt);
+}
+
+// The reference interpreter rejects ordered comparisons of exact keys at
+// runtime, so the compiler leaves them to the interpreter.
+TEST_F(CompileConstraintTest, OrderedComparisonOfExactKeysIsUnimplemented) {
+  EXPECT_THAT(ParseAndCompile("exact32 > 5"),
+              StatusIs(absl::StatusCode::kUnimplemented));
+}
+
+TEST_F(CompileConstraintTest, UntypedConstraintIsRejected) {
+  EXPECT_THAT(CompileConstraint(ParseProtoOrDie<Expression>(
+                  R"pb(boolean_constant: true)pb")),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(ValidateProgramTest, RejectsEqualityOfHugeNumberOfComponents) {
+  for (Opcode opcode : {Opcode::kEq, Opcode::kNe}) {
+    for (int32_t components : {0x40000000, 0x7fffffff}) {
+      const Program program{
+          .instructions = {{.opcode = Opcode::kPushInteger},
+                           {.opcode = Opcode::kJumpIfTrueElsePop, .operand = 4},
+                           {.opcode = opcode, .operand = components},
+                           {.opcode = Opcode::kNot}},
+          .max_stack_size = 2,
+      };
+      EXPECT_THAT(ValidateProgram(program),
+                  StatusIs(absl::StatusCode::kInvalidArgument))
+          << OpcodeName(opcode) << " " << components;
+    }
+  }
+}
+
+}  // namespace
+}  // namespace p4_constraints
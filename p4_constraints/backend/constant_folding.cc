@@ -0,0 +1,239 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "p4_constraints/backend/constant_folding.h"
+
+#include <optional>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "gutil/status.h"
+#include "p4_constraints/ast.h"
+#include "p4_constraints/ast.pb.h"
+#include "p4_constraints/big_int.h"
+
+namespace p4_constraints {
+
+namespace {
+
+using ::p4_constraints::ast::Expression;
+using ::p4_constraints::ast::Type;
+
+// Returns the value of `expr` if it is an integral expression that does not
+// depend on the entry, i.e. a literal or a negation thereof, and nullopt
+// otherwise. Expects casts of constants to be folded already.
+absl::StatusOr<std::optional<BigInt>> IntegralValue(const Expression& expr) {
+  switch (expr.expression_case()) {
+    case Expression::kIntegerConstant: {
+      ASSIGN_OR_RETURN(BigInt value, ParseBigInt(expr.integer_constant(), 10),
+                       _ << "AST invariant violated; invalid decimal string: "
+                         << expr.integer_constant());
+      return value;
+    }
+    case Expression::kArithmeticNegation: {
+      ASSIGN_OR_RETURN(std::optional<BigInt> value,
+                       IntegralValue(expr.arithmetic_negation()));
+      if (!value.has_value()) return std::nullopt;
+      return -*value;
+    }
+    default:
+      return std::nullopt;
+  }
+}
+
+std::optional<bool> BooleanValue(const Expression& expr) {
+  if (expr.expression_case() != Expression::kBooleanConstant) {
+    return std::nullopt;
+  }
+  return expr.boolean_constant();
+}
+
+// Replaces `expr` by the integer constant `value`, which must be
+// non-negative, keeping the type and source location of `expr`.
+void SetIntegerConstant(const BigInt& value, Expression* expr) {
+  expr->set_integer_constant(BigIntToString(value));
+}
+
+// Replaces `expr` by its subexpression `subexpr`, which keeps its own type and
+// source location.
+void ReplaceWith(Expression* subexpr, Expression* expr) {
+  ast::ExpressionPtr replacement = ast::TakeExpression(subexpr);
+  expr->Swap(replacement.get());
+}
+
+// Replaces `expr` by its Boolean subexpression `constant`, which decides the
+// value of `expr`, with value `value`. Keeps the source location of `constant`,
+// so that explanations quote the operand that decided `expr` rather than all of
+// it.
+void ReplaceWithConstant(bool value, Expression* constant, Expression* expr) {
+  constant->set_boolean_constant(value);
+  ReplaceWith(constant, expr);
+}
+
+// Replaces `expr` by the negation of its subexpression `subexpr`, keeping the
+// type and source location of `expr`.
+void ReplaceWithNegationOf(Expression* subexpr, Expression* expr) {
+  ast::ExpressionPtr negated = ast::TakeExpression(subexpr);
+  expr->set_allocated_boolean_negation(negated.release());
+}
+
+bool Compare(ast::BinaryOperator binop, const BigInt& left,
+             const BigInt& right) {
+  switch (binop) {
+    case ast::EQ:
+      return left == right;
+    case ast::NE:
+      return left != right;
+    case ast::GT:
+      return left > right;
+    case ast::GE:
+      return left >= right;
+    case ast::LT:
+      return left < right;
+    default:
+      return left <= right;
+  }
+}
+
+absl::Status FoldBinaryExpression(Expression* expr) {
+  ast::BinaryExpression& binexpr = *expr->mutable_binary_expression();
+  RETURN_IF_ERROR(FoldConstants(binexpr.mutable_left()));
+  RETURN_IF_ERROR(FoldConstants(binexpr.mutable_right()));
+  const std::optional<bool> left = BooleanValue(binexpr.left());
+  const std::optional<bool> right = BooleanValue(binexpr.right());
+
+  switch (binexpr.binop()) {
+    case ast::EQ:
+    case ast::NE:
+    case ast::GT:
+    case ast::GE:
+    case ast::LT:
+    case ast::LE: {
+      // Booleans only support (in)equality.
+      if (left.has_value() && right.has_value()) {
+        if (binexpr.binop() == ast::EQ || binexpr.binop() == ast::NE) {
+          expr->set_boolean_constant((binexpr.binop() == ast::EQ) ==
+                                     (*left == *right));
+        }
+        return absl::OkStatus();
+      }
+      ASSIGN_OR_RETURN(std::optional<BigInt> left_value,
+                       IntegralValue(binexpr.left()));
+      if (!left_value.has_value()) return absl::OkStatus();
+      ASSIGN_OR_RETURN(std::optional<BigInt> right_value,
+                       IntegralValue(binexpr.right()));
+      if (!right_value.has_value()) return absl::OkStatus();
+      expr->set_boolean_constant(
+          Compare(binexpr.binop(), *left_value, *right_value));
+      return absl::OkStatus();
+    }
+
+    // true && x ~~> x      x && true ~~> x
+    // false && x ~~> false  x && false ~~> false
+    case ast::AND:
+      if (left == false) {
+        ReplaceWithConstant(false, binexpr.mutable_left(), expr);
+      } else if (right == false) {
+        ReplaceWithConstant(false, binexpr.mutable_right(), expr);
+      } else if (left == true) {
+        ReplaceWith(binexpr.mutable_right(), expr);
+      } else if (right == true) {
+        ReplaceWith(binexpr.mutable_left(), expr);
+      }
+      return absl::OkStatus();
+
+    // true || x ~~> true    x || true ~~> true
+    // false || x ~~> x      x || false ~~> x
+    case ast::OR:
+      if (left == true) {
+        ReplaceWithConstant(true, binexpr.mutable_left(), expr);
+      } else if (right == true) {
+        ReplaceWithConstant(true, binexpr.mutable_right(), expr);
+      } else if (left == false) {
+        ReplaceWith(binexpr.mutable_right(), expr);
+      } else if (right == false) {
+        ReplaceWith(binexpr.mutable_left(), expr);
+      }
+      return absl::OkStatus();
+
+    // false -> x ~~> true   x -> true ~~> true
+    // true -> x ~~> x       x -> false ~~> !x
+    case ast::IMPLIES:
+      if (left == false) {
+        ReplaceWithConstant(true, binexpr.mutable_left(), expr);
+      } else if (right == true) {
+        ReplaceWithConstant(true, binexpr.mutable_right(), expr);
+      } else if (left == true) {
+        ReplaceWith(binexpr.mutable_right(), expr);
+      } else if (right == false) {
+        ReplaceWithNegationOf(binexpr.mutable_left(), expr);
+      }
+      return absl::OkStatus();
+
+    default:
+      return gutil::InvalidArgumentErrorBuilder()
+             << "unknown binary operator "
+             << ast::BinaryOperator_Name(binexpr.binop());
+  }
+}
+
+}  // namespace
+
+absl::Status FoldConstants(Expression* expr) {
+  switch (expr->expression_case()) {
+    case Expression::kBooleanNegation: {
+      Expression* operand = expr->mutable_boolean_negation();
+      RETURN_IF_ERROR(FoldConstants(operand));
+      if (std::optional<bool> value = BooleanValue(*operand)) {
+        expr->set_boolean_constant(!*value);
+      } else if (operand->has_boolean_negation()) {
+        ReplaceWith(operand->mutable_boolean_negation(), expr);
+      }
+      return absl::OkStatus();
+    }
+
+    case Expression::kArithmeticNegation: {
+      RETURN_IF_ERROR(FoldConstants(expr->mutable_arithmetic_negation()));
+      // Negative values have no literal representation.
+      ASSIGN_OR_RETURN(std::optional<BigInt> value, IntegralValue(*expr));
+      if (value.has_value() && *value >= 0) SetIntegerConstant(*value, expr);
+      return absl::OkStatus();
+    }
+
+    // int ~~> bit<W>
+    //   n |~> n mod 2^W
+    case Expression::kTypeCast: {
+      RETURN_IF_ERROR(FoldConstants(expr->mutable_type_cast()));
+      if (expr->type().type_case() != Type::kFixedUnsigned) {
+        return absl::OkStatus();
+      }
+      ASSIGN_OR_RETURN(std::optional<BigInt> value,
+                       IntegralValue(expr->type_cast()));
+      if (!value.has_value()) return absl::OkStatus();
+      const BigInt domain_size = BigInt(1)
+                                 << ast::TypeBitwidth(expr->type()).value_or(0);
+      BigInt fixed_value = *value % domain_size;
+      // operator% may return negative values.
+      if (fixed_value < 0) fixed_value += domain_size;
+      SetIntegerConstant(fixed_value, expr);
+      return absl::OkStatus();
+    }
+
+    case Expression::kBinaryExpression:
+      return FoldBinaryExpression(expr);
+
+    case Expression::kFieldAccess:
+      return FoldConstants(expr->mutable_field_access()->mutable_expr());
+
+    case Expression::kBooleanConstant:
+    case Expression::kIntegerConstant:
+    case Expression::kKey:
+    case Expression::kActionParameter:
+    case Expression::kAttributeAccess:
+    case Expression::EXPRESSION_NOT_SET:
+      return absl::OkStatus();
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace p4_constraints
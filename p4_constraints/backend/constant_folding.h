@@ -0,0 +1,43 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+// Simplifies type-checked constraints before they are evaluated.
+//
+// The type checker wraps literals in casts (e.g. int ~~> bit<W>), and
+// constraints, especially machine-generated ones, often contain subterms that
+// do not depend on the entry (e.g. `true && x`, `!!x`, `1 < 2`, `x -> true`).
+// Folding these once when a constraint is loaded spares the interpreter from
+// re-evaluating them for every entry.
+
+#ifndef P4_CONSTRAINTS_BACKEND_CONSTANT_FOLDING_H_
+#define P4_CONSTRAINTS_BACKEND_CONSTANT_FOLDING_H_
+
+#include "absl/status/status.h"
+#include "p4_constraints/ast.pb.h"
+
+namespace p4_constraints {
+
+// Simplifies the given type-checked expression in place, preserving its
+// semantics on well-formed entries:
+// - Casts int ~~> bit<W> of constants become integer constants of type bit<W>,
+//   and negations of constants with non-negative values become constants.
+// - Comparisons of two constants, and negations of Boolean constants, become
+//   Boolean constants; `!!x` becomes `x`.
+// - Boolean operators with a constant operand are simplified, e.g. `true && x`
+//   becomes `x` and `x -> true` becomes `true`. Since they are decided by the
+//   constant operand, some subterms may no longer be evaluated.
+//
+// Subterms decided by a constant operand (e.g. `x && false`) take the source
+// location of that operand. Other folded subterms, including `!x` folded from
+// `x -> false`, keep the locations of the terms they replace, and subterms that
+// are kept keep their own. This way, explanations of constraint violations
+// still quote the user's constraint, and only the parts that decided it; e.g.
+// violations of `x -> false` are explained by `x`.
+//
+// Returns an InvalidArgument error if the expression contains a malformed
+// literal.
+absl::Status FoldConstants(ast::Expression* expr);
+
+}  // namespace p4_constraints
+
+#endif  // P4_CONSTRAINTS_BACKEND_CONSTANT_FOLDING_H_
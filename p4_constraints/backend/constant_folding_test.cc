@@ -0,0 +1,296 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "p4_constraints/backend/constant_folding.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "gutil/proto_matchers.h"
+#include "gutil/status_matchers.h"
+#include "gutil/testing.h"
+#include "p4/config/v1/p4info.pb.h"
+#include "p4/v1/p4runtime.pb.h"
+#include "p4_constraints/ast.pb.h"
+#include "p4_constraints/backend/constraint_info.h"
+#include "p4_constraints/backend/interpreter.h"
+#include "p4_constraints/backend/test_util.h"
+
+namespace p4_constraints {
+namespace {
+
+using ::gutil::EqualsProto;
+using ::gutil::ParseProtoOrDie;
+using ::gutil::StatusIs;
+using ::p4_constraints::ast::Expression;
+using ::p4_constraints::ast::Type;
+using ::testing::HasSubstr;
+using ::testing::IsEmpty;
+using ::testing::Not;
+
+// The table that constraints are type checked against.
+TableInfo TestTable() {
+  return MakeTableInfo({
+      KeyInfo{.id = 1,
+              .name = "exact16",
+              .type = ParseProtoOrDie<Type>("exact { bitwidth: 16 }")},
+      KeyInfo{.id = 2,
+              .name = "ternary32",
+              .type = ParseProtoOrDie<Type>("ternary { bitwidth: 32 }")},
+  });
+}
+
+Expression TypeChecked(const std::string& constraint) {
+  return TypeCheckedConstraint(constraint, TestTable());
+}
+
+// Clears the source locations of `expr` and its subexpressions, to compare
+// expressions parsed from different strings.
+void ClearLocations(Expression& expr) {
+  expr.clear_start_location();
+  expr.clear_end_location();
+  switch (expr.expression_case()) {
+    case Expression::kBooleanNegation:
+      ClearLocations(*expr.mutable_boolean_negation());
+      break;
+    case Expression::kArithmeticNegation:
+      ClearLocations(*expr.mutable_arithmetic_negation());
+      break;
+    case Expression::kTypeCast:
+      ClearLocations(*expr.mutable_type_cast());
+      break;
+    case Expression::kBinaryExpression:
+      ClearLocations(*expr.mutable_binary_expression()->mutable_left());
+      ClearLocations(*expr.mutable_binary_expression()->mutable_right());
+      break;
+    case Expression::kFieldAccess:
+      ClearLocations(*expr.mutable_field_access()->mutable_expr());
+      break;
+    default:
+      break;
+  }
+}
+
+struct FoldingTestCase {
+  std::string constraint;
+  // Type checks to the same expression as the folded `constraint`, up to
+  // source locations.
+  std::string folded_constraint;
+};
+
+class ConstantFoldingTest : public ::testing::TestWithParam<FoldingTestCase> {
+};
+
+TEST_P(ConstantFoldingTest, FoldsConstraint) {
+  Expression expr = TypeChecked(GetParam().constraint);
+  ASSERT_OK(FoldConstants(&expr));
+  ClearLocations(expr);
+
+  Expression expected = TypeChecked(GetParam().folded_constraint);
+  // The expected constraint may be foldable itself, e.g. if it contains casts.
+  ASSERT_OK(FoldConstants(&expected));
+  ClearLocations(expected);
+  EXPECT_THAT(expr, EqualsProto(expected));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    BooleanOperators, ConstantFoldingTest,
+    ::testing::Values(
+        FoldingTestCase{"true && exact16 == 1", "exact16 == 1"},
+        FoldingTestCase{"exact16 == 1 && true", "exact16 == 1"},
+        FoldingTestCase{"false && exact16 == 1", "false"},
+        FoldingTestCase{"exact16 == 1 && false", "false"},
+        FoldingTestCase{"true || exact16 == 1", "true"},
+        FoldingTestCase{"exact16 == 1 || true", "true"},
+        FoldingTestCase{"false || exact16 == 1", "exact16 == 1"},
+        FoldingTestCase{"exact16 == 1 || false", "exact16 == 1"},
+        FoldingTestCase{"false -> exact16 == 1", "true"},
+        FoldingTestCase{"exact16 == 1 -> true", "true"},
+        FoldingTestCase{"true -> exact16 == 1", "exact16 == 1"},
+        FoldingTestCase{"exact16 == 1 -> false", "!(exact16 == 1)"},
+        FoldingTestCase{"!!(exact16 == 1)", "exact16 == 1"},
+        FoldingTestCase{"!!!(exact16 == 1)", "!(exact16 == 1)"},
+        FoldingTestCase{"!true", "false"},
+        FoldingTestCase{"true && (false || (true -> exact16 == 1))",
+                        "exact16 == 1"}));
+
+INSTANTIATE_TEST_SUITE_P(
+    Comparisons, ConstantFoldingTest,
+    ::testing::Values(FoldingTestCase{"1 < 2", "true"},
+                      FoldingTestCase{"-1 >= 0", "false"},
+                      FoldingTestCase{"--3 == 3", "true"},
+                      FoldingTestCase{"true == false", "false"},
+                      FoldingTestCase{"true != false", "true"},
+                      FoldingTestCase{"(1 == 1) == (2 > 3)", "false"},
+                      FoldingTestCase{"exact16 == 1 && 2 <= 1", "false"}));
+
+INSTANTIATE_TEST_SUITE_P(
+    Casts, ConstantFoldingTest,
+    ::testing::Values(
+        // Casts to bit<16> wrap around.
+        FoldingTestCase{"exact16::value == -1", "exact16::value == 65535"},
+        FoldingTestCase{"exact16::value == 65537", "exact16::value == 1"},
+        FoldingTestCase{"ternary32::mask == -1 || ternary32::mask == 0",
+                        "ternary32::mask == 4294967295 || "
+                        "ternary32::mask == 0"},
+        // Negative integers have no literal representation.
+        FoldingTestCase{"::priority > -3", "::priority > -3"}));
+
+TEST(FoldConstantsTest, FoldsCastsToIntegerConstantsOfFixedWidthType) {
+  Expression expr = TypeChecked("exact16::value == -1");
+  ASSERT_OK(FoldConstants(&expr));
+  const Expression& constant = expr.binary_expression().right();
+  EXPECT_EQ(constant.integer_constant(), "65535");
+  EXPECT_THAT(constant.type(), EqualsProto("fixed_unsigned { bitwidth: 16 }"));
+}
+
+TEST(FoldConstantsTest, KeepsSourceLocationOfKeptSubexpressions) {
+  const Expression original = TypeChecked("exact16 == 1 && true");
+  Expression expr = original;
+  ASSERT_OK(FoldConstants(&expr));
+  const Expression& kept = original.binary_expression().left();
+  EXPECT_THAT(expr.start_location(), EqualsProto(kept.start_location()));
+  EXPECT_THAT(expr.end_location(), EqualsProto(kept.end_location()));
+}
+
+TEST(FoldConstantsTest, KeepsSourceLocationOfFoldedSubexpressions) {
+  for (const std::string constraint : {"exact16 == 1 -> false", "1 < 2"}) {
+    SCOPED_TRACE(constraint);
+    const Expression original = TypeChecked(constraint);
+    Expression expr = original;
+    ASSERT_OK(FoldConstants(&expr));
+    EXPECT_THAT(expr.start_location(),
+                EqualsProto(original.start_location()));
+    EXPECT_THAT(expr.end_location(), EqualsProto(original.end_location()));
+  }
+}
+
+TEST(FoldConstantsTest, KeepsSourceLocationOfDecidingConstants) {
+  for (const auto& [constraint, constant_is_left] :
+       std::vector<std::pair<std::string, bool>>{
+           {"false && exact16 == 1", true},
+           {"exact16 == 1 && false", false},
+           {"true || exact16 == 1", true},
+           {"exact16 == 1 || true", false},
+           {"false -> exact16 == 1", true},
+           {"exact16 == 1 -> true", false},
+       }) {
+    SCOPED_TRACE(constraint);
+    const Expression original = TypeChecked(constraint);
+    Expression expr = original;
+    ASSERT_OK(FoldConstants(&expr));
+    ASSERT_EQ(expr.expression_case(), Expression::kBooleanConstant);
+    const Expression& constant = constant_is_left
+                                     ? original.binary_expression().left()
+                                     : original.binary_expression().right();
+    EXPECT_THAT(expr.start_location(),
+                EqualsProto(constant.start_location()));
+    EXPECT_THAT(expr.end_location(), EqualsProto(constant.end_location()));
+  }
+}
+
+TEST(FoldConstantsTest, RejectsMalformedLiterals) {
+  Expression expr = TypeChecked("exact16::value == 1");
+  expr.mutable_binary_expression()
+      ->mutable_right()
+      ->mutable_type_cast()
+      ->set_integer_constant("0x1");
+  EXPECT_THAT(FoldConstants(&expr),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(FoldConstantsTest, ExplanationsQuoteTheUserConstraint) {
+  ASSERT_OK_AND_ASSIGN(
+      const ConstraintInfo constraint_info,
+      P4ToConstraintInfo(ParseProtoOrDie<p4::config::v1::P4Info>(R"pb(
+        tables {
+          preamble {
+            id: 1
+            name: "table"
+            annotations: "@entry_restriction(\"true && exact16 != 1\")"
+          }
+          match_fields { id: 1 name: "exact16" bitwidth: 16 match_type: EXACT }
+        }
+      )pb")));
+
+  EXPECT_THAT(ReasonEntryViolatesConstraint(
+                  ParseProtoOrDie<p4::v1::TableEntry>(R"pb(
+                    table_id: 1
+                    match { field_id: 1 exact { value: "\x02" } }
+                  )pb"),
+                  constraint_info),
+              gutil::IsOkAndHolds(IsEmpty()));
+
+  ASSERT_OK_AND_ASSIGN(std::string reason,
+                       ReasonEntryViolatesConstraint(
+                           ParseProtoOrDie<p4::v1::TableEntry>(R"pb(
+                             table_id: 1
+                             match { field_id: 1 exact { value: "\x01" } }
+                           )pb"),
+                           constraint_info));
+  EXPECT_THAT(reason, HasSubstr("true && exact16 != 1"));
+  EXPECT_THAT(reason, HasSubstr("        ^^^^^^^^^^^^"));
+  EXPECT_THAT(reason, Not(HasSubstr("^^^^^^^^^^^^^^^^^^^^")));
+}
+
+TEST(FoldConstantsTest, ExplanationsQuoteTheDecidingConstant) {
+  ASSERT_OK_AND_ASSIGN(
+      const ConstraintInfo constraint_info,
+      P4ToConstraintInfo(ParseProtoOrDie<p4::config::v1::P4Info>(R"pb(
+        tables {
+          preamble {
+            id: 1
+            name: "table"
+            annotations: "@entry_restriction(\"exact16 != 1 && false\")"
+          }
+          match_fields { id: 1 name: "exact16" bitwidth: 16 match_type: EXACT }
+        }
+      )pb")));
+
+  ASSERT_OK_AND_ASSIGN(std::string reason,
+                       ReasonEntryViolatesConstraint(
+                           ParseProtoOrDie<p4::v1::TableEntry>(R"pb(
+                             table_id: 1
+                             match { field_id: 1 exact { value: "\x02" } }
+                           )pb"),
+                           constraint_info));
+  EXPECT_THAT(reason, HasSubstr("exact16 != 1 && false"));
+  EXPECT_THAT(reason, HasSubstr("                ^^^^^"));
+  EXPECT_THAT(reason, Not(HasSubstr("^^^^^^")));
+}
+
+// `x -> false` is folded to `!x`, so its violations are explained by `x`
+// rather than by the whole implication.
+TEST(FoldConstantsTest, ExplanationsOfImplicationsOfFalseQuoteTheAntecedent) {
+  ASSERT_OK_AND_ASSIGN(
+      const ConstraintInfo constraint_info,
+      P4ToConstraintInfo(ParseProtoOrDie<p4::config::v1::P4Info>(R"pb(
+        tables {
+          preamble {
+            id: 1
+            name: "table"
+            annotations: "@entry_restriction(\"exact16 == 1 -> false\")"
+          }
+          match_fields { id: 1 name: "exact16" bitwidth: 16 match_type: EXACT }
+        }
+      )pb")));
+
+  ASSERT_OK_AND_ASSIGN(std::string reason,
+                       ReasonEntryViolatesConstraint(
+                           ParseProtoOrDie<p4::v1::TableEntry>(R"pb(
+                             table_id: 1
+                             match { field_id: 1 exact { value: "\x01" } }
+                           )pb"),
+                           constraint_info));
+  EXPECT_THAT(reason, HasSubstr("exact16 == 1 -> false"));
+  EXPECT_THAT(reason, HasSubstr("| ^^^^^^^^^^^^"));
+  EXPECT_THAT(reason, Not(HasSubstr("^^^^^^^^^^^^^")));
+}
+
+}  // namespace
+}  // namespace p4_constraints
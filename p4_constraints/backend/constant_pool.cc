@@ -0,0 +1,104 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "p4_constraints/backend/constant_pool.h"
+
+#include <string>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "gutil/status.h"
+#include "p4_constraints/ast.h"
+#include "p4_constraints/ast.pb.h"
+#include "p4_constraints/big_int.h"
+
+namespace p4_constraints {
+
+namespace {
+
+using ::p4_constraints::ast::Expression;
+using ::p4_constraints::ast::Type;
+
+absl::Status AddConstants(const Expression& expr, ConstantPool& pool) {
+  switch (expr.expression_case()) {
+    case Expression::kIntegerConstant: {
+      if (pool.literals.contains(expr.integer_constant())) {
+        return absl::OkStatus();
+      }
+      ASSIGN_OR_RETURN(BigInt value, ParseBigInt(expr.integer_constant(), 10),
+                       _ << "AST invariant violated; invalid decimal string: "
+                         << expr.integer_constant());
+      pool.literals.insert({expr.integer_constant(), std::move(value)});
+      return absl::OkStatus();
+    }
+    case Expression::kTypeCast: {
+      const int bitwidth = ast::TypeBitwidth(expr.type()).value_or(-1);
+      switch (expr.type().type_case()) {
+        case Type::kFixedUnsigned:
+          if (!pool.domain_sizes.contains(bitwidth)) {
+            pool.domain_sizes.insert({bitwidth, BigInt(1) << bitwidth});
+          }
+          break;
+        case Type::kTernary:
+        case Type::kOptionalMatch:
+          if (!pool.masks.contains(bitwidth)) {
+            pool.masks.insert({bitwidth, (BigInt(1) << bitwidth) - 1});
+          }
+          break;
+        default:
+          break;
+      }
+      return AddConstants(expr.type_cast(), pool);
+    }
+    case Expression::kBooleanNegation:
+      return AddConstants(expr.boolean_negation(), pool);
+    case Expression::kArithmeticNegation:
+      return AddConstants(expr.arithmetic_negation(), pool);
+    case Expression::kBinaryExpression:
+      RETURN_IF_ERROR(AddConstants(expr.binary_expression().left(), pool));
+      return AddConstants(expr.binary_expression().right(), pool);
+    case Expression::kFieldAccess:
+      return AddConstants(expr.field_access().expr(), pool);
+    case Expression::kBooleanConstant:
+    case Expression::kKey:
+    case Expression::kActionParameter:
+    case Expression::kAttributeAccess:
+    case Expression::EXPRESSION_NOT_SET:
+      return absl::OkStatus();
+  }
+  return absl::OkStatus();
+}
+
+const BigInt* FindOrNull(const absl::flat_hash_map<int, BigInt>& map,
+                         int bitwidth) {
+  auto it = map.find(bitwidth);
+  if (it == map.end()) return nullptr;
+  return &it->second;
+}
+
+}  // namespace
+
+absl::StatusOr<ConstantPool> BuildConstantPool(
+    const ast::Expression& constraint) {
+  ConstantPool pool;
+  RETURN_IF_ERROR(AddConstants(constraint, pool));
+  return pool;
+}
+
+const BigInt* FindLiteral(const ConstantPool& pool, absl::string_view decimal) {
+  auto it = pool.literals.find(decimal);
+  if (it == pool.literals.end()) return nullptr;
+  return &it->second;
+}
+
+const BigInt* FindDomainSize(const ConstantPool& pool, int bitwidth) {
+  return FindOrNull(pool.domain_sizes, bitwidth);
+}
+
+const BigInt* FindMask(const ConstantPool& pool, int bitwidth) {
+  return FindOrNull(pool.masks, bitwidth);
+}
+
+}  // namespace p4_constraints
@@ -0,0 +1,49 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+// The constant pool of a constraint holds the integer constants needed to
+// evaluate it, computed once when the constraint is loaded: parsed integer
+// literals, and the domain sizes and masks of the casts inserted by the type
+// checker. The interpreter looks these up instead of recomputing them for
+// every entry.
+
+#ifndef P4_CONSTRAINTS_BACKEND_CONSTANT_POOL_H_
+#define P4_CONSTRAINTS_BACKEND_CONSTANT_POOL_H_
+
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "p4_constraints/ast.pb.h"
+#include "p4_constraints/big_int.h"
+
+namespace p4_constraints {
+
+struct ConstantPool {
+  // Maps the decimal strings of integer literals to their values.
+  absl::flat_hash_map<std::string, BigInt> literals;
+  // Maps bitwidths W of casts int ~~> bit<W> to the domain size 2^W.
+  absl::flat_hash_map<int, BigInt> domain_sizes;
+  // Maps bitwidths W of casts bit<W> ~~> Ternary<W>/Optional<W> to the mask
+  // 2^W - 1.
+  absl::flat_hash_map<int, BigInt> masks;
+};
+
+// Builds the constant pool of the given type-checked constraint. Returns an
+// InvalidArgument error if the constraint contains a malformed literal.
+absl::StatusOr<ConstantPool> BuildConstantPool(
+    const ast::Expression& constraint);
+
+// Returns a pointer to the value of the given literal, or nullptr if the
+// literal is not in the pool.
+const BigInt* FindLiteral(const ConstantPool& pool, absl::string_view decimal);
+
+// Returns a pointer to 2^bitwidth (resp. 2^bitwidth - 1), or nullptr if it is
+// not in the pool.
+const BigInt* FindDomainSize(const ConstantPool& pool, int bitwidth);
+const BigInt* FindMask(const ConstantPool& pool, int bitwidth);
+
+}  // namespace p4_constraints
+
+#endif  // P4_CONSTRAINTS_BACKEND_CONSTANT_POOL_H_
@@ -0,0 +1,110 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "p4_constraints/backend/constant_pool.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "absl/status/status.h"
+#include "gutil/status_matchers.h"
+#include "gutil/testing.h"
+#include "p4_constraints/ast.pb.h"
+#include "p4_constraints/big_int.h"
+
+namespace p4_constraints {
+namespace {
+
+using ::gutil::ParseProtoOrDie;
+using ::gutil::StatusIs;
+using ::p4_constraints::ast::Expression;
+using ::testing::IsEmpty;
+using ::testing::Pair;
+using ::testing::Pointee;
+using ::testing::UnorderedElementsAre;
+
+// `ternary16 == 10 || -3 == 7` after type checking, i.e. with casts inserted.
+constexpr char kTypeCheckedConstraint[] = R"pb(
+  type { boolean {} }
+  binary_expression {
+    binop: OR
+    left {
+      type { boolean {} }
+      binary_expression {
+        binop: EQ
+        left {
+          type { ternary { bitwidth: 16 } }
+          key: "ternary16"
+        }
+        right {
+          type { ternary { bitwidth: 16 } }
+          type_cast {
+            type { fixed_unsigned { bitwidth: 16 } }
+            type_cast {
+              type { arbitrary_int {} }
+              integer_constant: "10"
+            }
+          }
+        }
+      }
+    }
+    right {
+      type { boolean {} }
+      binary_expression {
+        binop: EQ
+        left {
+          type { arbitrary_int {} }
+          arithmetic_negation {
+            type { arbitrary_int {} }
+            integer_constant: "3"
+          }
+        }
+        right {
+          type { arbitrary_int {} }
+          integer_constant: "7"
+        }
+      }
+    }
+  }
+)pb";
+
+TEST(BuildConstantPoolTest, CollectsLiteralsMasksAndDomainSizes) {
+  ASSERT_OK_AND_ASSIGN(
+      ConstantPool pool,
+      BuildConstantPool(ParseProtoOrDie<Expression>(kTypeCheckedConstraint)));
+  EXPECT_THAT(pool.literals,
+              UnorderedElementsAre(Pair("10", BigInt(10)), Pair("3", BigInt(3)),
+                                   Pair("7", BigInt(7))));
+  EXPECT_THAT(pool.domain_sizes, UnorderedElementsAre(Pair(16, BigInt(65536))));
+  EXPECT_THAT(pool.masks, UnorderedElementsAre(Pair(16, BigInt(65535))));
+}
+
+TEST(BuildConstantPoolTest, ConstraintWithoutConstantsYieldsEmptyPool) {
+  ASSERT_OK_AND_ASSIGN(ConstantPool pool,
+                       BuildConstantPool(ParseProtoOrDie<Expression>(
+                           R"pb(type { boolean {} } boolean_constant: true)pb")));
+  EXPECT_THAT(pool.literals, IsEmpty());
+  EXPECT_THAT(pool.domain_sizes, IsEmpty());
+  EXPECT_THAT(pool.masks, IsEmpty());
+}
+
+TEST(BuildConstantPoolTest, MalformedLiteralIsRejected) {
+  EXPECT_THAT(BuildConstantPool(ParseProtoOrDie<Expression>(
+                  R"pb(type { arbitrary_int {} } integer_constant: "0x1")pb")),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(FindConstantTest, FindsPooledConstantsOnly) {
+  ASSERT_OK_AND_ASSIGN(
+      ConstantPool pool,
+      BuildConstantPool(ParseProtoOrDie<Expression>(kTypeCheckedConstraint)));
+  EXPECT_THAT(FindLiteral(pool, "10"), Pointee(BigInt(10)));
+  EXPECT_EQ(FindLiteral(pool, "11"), nullptr);
+  EXPECT_THAT(FindDomainSize(pool, 16), Pointee(BigInt(65536)));
+  EXPECT_EQ(FindDomainSize(pool, 32), nullptr);
+  EXPECT_THAT(FindMask(pool, 16), Pointee(BigInt(65535)));
+  EXPECT_EQ(FindMask(pool, 8), nullptr);
+}
+
+}  // namespace
+}  // namespace p4_constraints
@@ -17,11 +17,16 @@
 
 #include <stdint.h>
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -31,14 +36,29 @@
 #include "absl/strings/string_view.h"
 #include "absl/strings/strip.h"
 #include "absl/types/optional.h"
+#include "google/protobuf/arena.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/io/zero_copy_stream_impl_lite.h"
+#include "google/protobuf/message.h"
 #include "gutil/status.h"
 #include "p4/config/v1/p4info.pb.h"
 #include "p4/config/v1/p4types.pb.h"
+#include "p4_constraints/ast.h"
 #include "p4_constraints/ast.pb.h"
+#include "p4_constraints/backend/compiler.h"
+#include "p4_constraints/backend/constant_folding.h"
+#include "p4_constraints/backend/constant_pool.h"
+#include "p4_constraints/backend/eval_result.h"
+#include "p4_constraints/backend/flat_constraint.h"
+#include "p4_constraints/backend/operand_ordering.h"
+#include "p4_constraints/backend/program.h"
+#include "p4_constraints/backend/thread_pool.h"
 #include "p4_constraints/backend/type_checker.h"
+#include "p4_constraints/big_int.h"
 #include "p4_constraints/constraint_source.h"
 #include "p4_constraints/frontend/constraint_kind.h"
 #include "p4_constraints/frontend/parser.h"
+#include "p4_constraints/quote.h"
 #include "re2/re2.h"
 
 namespace p4_constraints {
@@ -180,6 +200,129 @@ absl::StatusOr<absl::optional<ConstraintSource>> ExtractConstraint(
   };
 }
 
+// Returns the deterministic serialization of `message`.
+std::string SerializeDeterministically(
+    const google::protobuf::Message& message) {
+  std::string bytes;
+  {
+    google::protobuf::io::StringOutputStream stream(&bytes);
+    google::protobuf::io::CodedOutputStream output(&stream);
+    output.SetSerializationDeterministic(true);
+    message.SerializeToCodedStream(&output);
+  }
+  return bytes;
+}
+
+// Returns the 64-bit FNV-1a hash of `bytes`.
+uint64_t Fingerprint(absl::string_view bytes) {
+  uint64_t fingerprint = 0xcbf29ce484222325ull;
+  for (unsigned char byte : bytes) {
+    fingerprint ^= byte;
+    fingerprint *= 0x100000001b3ull;
+  }
+  return fingerprint;
+}
+
+// Returns the deterministic serialization of the parts of `table` (resp.
+// `action`) that its TableInfo (resp. ActionInfo) is derived from, as hashed by
+// `TableFingerprint` (resp. `ActionFingerprint`).
+std::string FingerprintedBytes(const Table& table) {
+  Table relevant;
+  relevant.mutable_preamble()->set_id(table.preamble().id());
+  relevant.mutable_preamble()->set_name(table.preamble().name());
+  *relevant.mutable_preamble()->mutable_annotations() =
+      table.preamble().annotations();
+  *relevant.mutable_match_fields() = table.match_fields();
+  return SerializeDeterministically(relevant);
+}
+std::string FingerprintedBytes(const Action& action) {
+  Action relevant;
+  relevant.mutable_preamble()->set_id(action.preamble().id());
+  relevant.mutable_preamble()->set_name(action.preamble().name());
+  *relevant.mutable_preamble()->mutable_annotations() =
+      action.preamble().annotations();
+  *relevant.mutable_params() = action.params();
+  return SerializeDeterministically(relevant);
+}
+
+// Returns true iff `info`, a TableInfo or ActionInfo, was derived from parts
+// serialized to `bytes`, whose fingerprint is `fingerprint`. Compares the
+// bytes only if the fingerprints match.
+template <class Info>
+bool IsDerivedFrom(const Info& info, uint64_t fingerprint,
+                   absl::string_view bytes) {
+  return !info.fingerprinted_bytes.empty() &&
+         info.fingerprint == fingerprint &&
+         info.fingerprinted_bytes == bytes;
+}
+
+// Returns the value of an omitted key of the given type, or nullopt if keys of
+// this type must not be omitted.
+std::optional<internal_interpreter::EvalResult> DefaultKeyValue(
+    const ast::Type& type) {
+  switch (type.type_case()) {
+    case ast::Type::kTernary:
+    case ast::Type::kOptionalMatch:
+      return internal_interpreter::Ternary{};
+    case ast::Type::kLpm:
+      return internal_interpreter::Lpm{};
+    case ast::Type::kRange:
+      return internal_interpreter::Range{
+          .low = BigInt(0),
+          .high = (BigInt(1) << type.range().bitwidth()) - 1,
+      };
+    default:
+      return std::nullopt;
+  }
+}
+
+// Assigns slots to the given names in order, and maps the given IDs to them.
+template <typename Info>
+EntryLayout MakeLayout(
+    const absl::flat_hash_map<uint32_t, Info>& infos_by_id,
+    const absl::flat_hash_map<std::string, Info>& infos_by_name) {
+  EntryLayout layout;
+  layout.names.reserve(infos_by_name.size());
+  for (const auto& [name, info] : infos_by_name) layout.names.push_back(name);
+  std::sort(layout.names.begin(), layout.names.end());
+  for (int slot = 0; slot < layout.names.size(); ++slot) {
+    layout.slot_by_name[layout.names[slot]] = slot;
+  }
+  for (const auto& [id, info] : infos_by_id) {
+    auto it = layout.slot_by_name.find(info.name);
+    if (it != layout.slot_by_name.end()) layout.slot_by_id[id] = it->second;
+  }
+  return layout;
+}
+
+// Marks the slots of the variables of `constraint` as referenced in `layout`.
+// Leaves all slots referenced if there is no constraint.
+void MarkReferenced(const ast::Expression* constraint, EntryLayout& layout) {
+  if (constraint == nullptr) return;
+  layout.referenced.assign(layout.names.size(), false);
+  for (const std::string& variable : ast::GetVariables(*constraint)) {
+    auto it = layout.slot_by_name.find(variable);
+    if (it != layout.slot_by_name.end()) layout.referenced[it->second] = true;
+  }
+}
+
+// Returns `constraint`, which must be allocated on `arena`, as a pointer that
+// keeps `arena` alive in place of owning `constraint`.
+std::shared_ptr<const ast::Expression> ShareArena(
+    std::shared_ptr<google::protobuf::Arena> arena,
+    ast::ExpressionPtr constraint) {
+  DCHECK_EQ(constraint->GetArena(), arena.get());
+  return std::shared_ptr<const ast::Expression>(std::move(arena),
+                                                constraint.release());
+}
+
+// Builds the constant pool of `constraint`, to be shared by all evaluations.
+absl::StatusOr<std::shared_ptr<const ConstantPool>> MakeConstantPool(
+    const ast::Expression& constraint) {
+  ASSIGN_OR_RETURN(ConstantPool pool, BuildConstantPool(constraint));
+  return std::make_shared<const ConstantPool>(std::move(pool));
+}
+
 absl::StatusOr<ast::Type> ParseKeyType(const MatchField& key) {
   ast::Type type;
   switch (key.match_case()) {
@@ -227,7 +370,9 @@ absl::StatusOr<ast::Type> ParseParamType(const Action_Param& param) {
   return type;
 }
 
-absl::StatusOr<TableInfo> ParseTableInfo(const Table& table) {
+// Parses `table`, allocating its constraint on `arena`.
+absl::StatusOr<TableInfo> ParseTableInfo(
+    const Table& table, const std::shared_ptr<google::protobuf::Arena>& arena) {
   absl::flat_hash_map<uint32_t, KeyInfo> keys_by_id;
   absl::flat_hash_map<std::string, KeyInfo> keys_by_name;
 
@@ -250,31 +395,54 @@ absl::StatusOr<TableInfo> ParseTableInfo(const Table& table) {
       absl::optional<ConstraintSource> constraint_source,
       ExtractConstraint(ConstraintKind::kTableConstraint, table.preamble()));
 
-  absl::optional<ast::Expression> constraint = absl::nullopt;
+  ast::ExpressionPtr constraint;
   if (constraint_source.has_value()) {
-    ASSIGN_OR_RETURN(
-        constraint,
-        ParseConstraint(ConstraintKind::kTableConstraint, *constraint_source));
+    ASSIGN_OR_RETURN(constraint,
+                     ParseConstraint(ConstraintKind::kTableConstraint,
+                                     *constraint_source, arena.get()));
   }
 
   TableInfo table_info{
       .id = table.preamble().id(),
       .name = table.preamble().name(),
-      .constraint = constraint,
       .constraint_source = constraint_source.value_or(ConstraintSource()),
       .keys_by_id = keys_by_id,
       .keys_by_name = keys_by_name,
   };
 
-  // Type check constraint.
-  if (table_info.constraint.has_value()) {
-    RETURN_IF_ERROR(InferAndCheckTypes(&*table_info.constraint, table_info));
+  // Type check, simplify, and reorder constraint.
+  if (constraint != nullptr) {
+    RETURN_IF_ERROR(InferAndCheckTypes(constraint.get(), table_info));
+    RETURN_IF_ERROR(FoldConstants(constraint.get()));
+    RETURN_IF_ERROR(ReorderOperandsByCost(constraint.get()));
+    table_info.constraint = ShareArena(arena, std::move(constraint));
+    IndexConstraintSource(table_info.constraint_source, *table_info.constraint);
+  }
+
+  // Keys that only occurred in folded subterms are left unreferenced.
+  table_info.key_layout =
+      std::make_shared<const EntryLayout>(MakeKeyLayout(table_info));
+
+  if (table_info.constraint != nullptr) {
+    ASSIGN_OR_RETURN(table_info.constant_pool,
+                     MakeConstantPool(*table_info.constraint));
+    ASSIGN_OR_RETURN(table_info.program,
+                     CompileForVm(*table_info.constraint,
+                                  *table_info.key_layout));
+    table_info.flat_constraint =
+        MakeFlatConstraint(table_info.constraint, table_info.key_layout,
+                           table_info.constant_pool);
   }
 
+  table_info.fingerprinted_bytes = FingerprintedBytes(table);
+  table_info.fingerprint = Fingerprint(table_info.fingerprinted_bytes);
   return table_info;
 }
 
-absl::StatusOr<ActionInfo> ParseActionInfo(const Action& action) {
+// Parses `action`, allocating its constraint on `arena`.
+absl::StatusOr<ActionInfo> ParseActionInfo(
+    const Action& action,
+    const std::shared_ptr<google::protobuf::Arena>& arena) {
   absl::flat_hash_map<uint32_t, ParamInfo> params_by_id;
   absl::flat_hash_map<std::string, ParamInfo> params_by_name;
 
@@ -299,27 +467,105 @@ absl::StatusOr<ActionInfo> ParseActionInfo(const Action& action) {
   ASSIGN_OR_RETURN(
       absl::optional<ConstraintSource> constraint_source,
       ExtractConstraint(ConstraintKind::kActionConstraint, action.preamble()));
-  absl::optional<ast::Expression> constraint;
+  ast::ExpressionPtr constraint;
   if (constraint_source.has_value()) {
-    ASSIGN_OR_RETURN(
-        constraint,
-        ParseConstraint(ConstraintKind::kActionConstraint, *constraint_source));
+    ASSIGN_OR_RETURN(constraint,
+                     ParseConstraint(ConstraintKind::kActionConstraint,
+                                     *constraint_source, arena.get()));
   }
   ActionInfo action_info{
       .id = action.preamble().id(),
       .name = action.preamble().name(),
-      .constraint = constraint,
       .constraint_source = constraint_source.value_or(ConstraintSource()),
       .params_by_id = params_by_id,
       .params_by_name = params_by_name,
   };
-  // Type check constraint.
-  if (action_info.constraint.has_value()) {
-    RETURN_IF_ERROR(InferAndCheckTypes(&*action_info.constraint, action_info));
+  // Type check, simplify, and reorder constraint.
+  if (constraint != nullptr) {
+    RETURN_IF_ERROR(InferAndCheckTypes(constraint.get(), action_info));
+    RETURN_IF_ERROR(FoldConstants(constraint.get()));
+    RETURN_IF_ERROR(ReorderOperandsByCost(constraint.get()));
+    action_info.constraint = ShareArena(arena, std::move(constraint));
+    IndexConstraintSource(action_info.constraint_source,
+                          *action_info.constraint);
   }
+
+  // Params that only occurred in folded subterms are left unreferenced.
+  action_info.param_layout =
+      std::make_shared<const EntryLayout>(MakeParamLayout(action_info));
+
+  if (action_info.constraint != nullptr) {
+    ASSIGN_OR_RETURN(action_info.constant_pool,
+                     MakeConstantPool(*action_info.constraint));
+    ASSIGN_OR_RETURN(action_info.program,
+                     CompileForVm(*action_info.constraint,
+                                  *action_info.param_layout));
+    action_info.flat_constraint =
+        MakeFlatConstraint(action_info.constraint, action_info.param_layout,
+                           action_info.constant_pool);
+  }
+  action_info.fingerprinted_bytes = FingerprintedBytes(action);
+  action_info.fingerprint = Fingerprint(action_info.fingerprinted_bytes);
   return action_info;
 }
 
+// Assembles the `ConstraintInfo` of `p4info` from the results of
+// `ParseTableInfo` (resp. `ParseActionInfo`) on its tables (resp. actions), in
+// order. Errors are reported in the order of `p4info`, independently of the
+// order in which the results were computed.
+absl::StatusOr<ConstraintInfo> MergeConstraintInfo(
+    const p4::config::v1::P4Info& p4info,
+    std::vector<absl::StatusOr<TableInfo>> table_infos,
+    std::vector<absl::StatusOr<ActionInfo>> action_infos) {
+  // Allocate output.
+  absl::flat_hash_map<uint32_t, ActionInfo> action_info_by_id;
+  absl::flat_hash_map<uint32_t, TableInfo> table_info_by_id;
+
+  std::vector<absl::Status> errors;
+
+  for (int i = 0; i < p4info.tables_size(); ++i) {
+    const Table& table = p4info.tables(i);
+    absl::StatusOr<TableInfo>& table_info = table_infos[i];
+    if (!table_info.ok()) {
+      errors.push_back(table_info.status());
+    } else if (!table_info_by_id
+                    .insert({table.preamble().id(), *std::move(table_info)})
+                    .second) {
+      errors.push_back(gutil::InvalidArgumentErrorBuilder()
+                       << "duplicate table: " << table.DebugString());
+    }
+  }
+
+  for (int i = 0; i < p4info.actions_size(); ++i) {
+    const Action& action = p4info.actions(i);
+    absl::StatusOr<ActionInfo>& action_info = action_infos[i];
+    if (!action_info.ok()) {
+      errors.push_back(action_info.status());
+    } else if (!action_info_by_id
+                    .insert({action.preamble().id(), *std::move(action_info)})
+                    .second) {
+      errors.push_back(gutil::InvalidArgumentErrorBuilder()
+                       << "duplicate action: " << action.DebugString());
+    }
+  }
+
+  if (errors.empty()) {
+    ConstraintInfo info{
+        .action_info_by_id = std::move(action_info_by_id),
+        .table_info_by_id = std::move(table_info_by_id),
+        .generation = NewConstraintInfoGeneration(),
+    };
+    return info;
+  }
+  return gutil::InvalidArgumentErrorBuilder()
+         << "P4Info to constraint info translation failed with the following "
+            "errors:\n- "
+         << absl::StrJoin(errors, "\n- ",
+                          [](std::string* out, const absl::Status& status) {
+                            absl::StrAppend(out, status.message(), "\n");
+                          });
+}
+
 }  // namespace
 
 std::optional<AttributeInfo> GetAttributeInfo(
@@ -336,6 +582,63 @@ std::optional<AttributeInfo> GetAttributeInfo(
   return absl::nullopt;
 }
 
+EntryLayout MakeKeyLayout(const TableInfo& table_info) {
+  EntryLayout layout =
+      MakeLayout(table_info.keys_by_id, table_info.keys_by_name);
+  layout.default_values.reserve(layout.names.size());
+  for (const std::string& name : layout.names) {
+    layout.default_values.push_back(
+        DefaultKeyValue(table_info.keys_by_name.at(name).type));
+  }
+  MarkReferenced(table_info.constraint.get(), layout);
+  return layout;
+}
+
+EntryLayout MakeParamLayout(const ActionInfo& action_info) {
+  EntryLayout layout =
+      MakeLayout(action_info.params_by_id, action_info.params_by_name);
+  MarkReferenced(action_info.constraint.get(), layout);
+  return layout;
+}
+
+std::shared_ptr<const FlatConstraint> MakeFlatConstraint(
+    std::shared_ptr<const ast::Expression> constraint,
+    std::shared_ptr<const EntryLayout> layout,
+    std::shared_ptr<const ConstantPool> constant_pool) {
+  struct Owner {
+    std::shared_ptr<const ast::Expression> constraint;
+    std::shared_ptr<const EntryLayout> layout;
+    std::shared_ptr<const ConstantPool> constant_pool;
+    FlatConstraint flat_constraint;
+  };
+  auto owner = std::make_shared<Owner>();
+  owner->flat_constraint = FlattenConstraint(
+      *constraint, &layout->slot_by_name, constant_pool.get());
+  owner->constraint = std::move(constraint);
+  owner->layout = std::move(layout);
+  owner->constant_pool = std::move(constant_pool);
+  const FlatConstraint* flat_constraint = &owner->flat_constraint;
+  return std::shared_ptr<const FlatConstraint>(std::move(owner),
+                                               flat_constraint);
+}
+
+absl::StatusOr<std::shared_ptr<const Program>> CompileForVm(
+    const ast::Expression& constraint, const EntryLayout& layout) {
+  absl::StatusOr<Program> program = CompileConstraint(constraint);
+  if (absl::IsUnimplemented(program.status())) return nullptr;
+  RETURN_IF_ERROR(program.status());
+  for (Variable& variable : program->variables) {
+    auto it = layout.slot_by_name.find(variable.name);
+    if (it != layout.slot_by_name.end()) variable.slot = it->second;
+  }
+  return std::make_shared<const Program>(*std::move(program));
+}
+
+uint64_t NewConstraintInfoGeneration() {
+  static std::atomic<uint64_t> last_generation{0};
+  return ++last_generation;
+}
+
 const TableInfo* GetTableInfoOrNull(const ConstraintInfo& constraint_info,
                                     uint32_t table_id) {
   auto it = constraint_info.table_info_by_id.find(table_id);
@@ -352,48 +655,96 @@ const ActionInfo* GetActionInfoOrNull(const ConstraintInfo& constraint_info,
 
 absl::StatusOr<ConstraintInfo> P4ToConstraintInfo(
     const p4::config::v1::P4Info& p4info) {
-  // Allocate output.
-  absl::flat_hash_map<uint32_t, ActionInfo> action_info_by_id;
-  absl::flat_hash_map<uint32_t, TableInfo> table_info_by_id;
+  auto arena = std::make_shared<google::protobuf::Arena>();
+  std::vector<absl::StatusOr<TableInfo>> table_infos;
+  table_infos.reserve(p4info.tables_size());
+  for (const Table& table : p4info.tables()) {
+    table_infos.push_back(ParseTableInfo(table, arena));
+  }
+  std::vector<absl::StatusOr<ActionInfo>> action_infos;
+  action_infos.reserve(p4info.actions_size());
+  for (const Action& action : p4info.actions()) {
+    action_infos.push_back(ParseActionInfo(action, arena));
+  }
+  return MergeConstraintInfo(p4info, std::move(table_infos),
+                             std::move(action_infos));
+}
 
-  std::vector<absl::Status> errors;
+absl::StatusOr<ConstraintInfo> P4ToConstraintInfo(
+    const p4::config::v1::P4Info& p4info, ThreadPool& thread_pool) {
+  const int num_tables = p4info.tables_size();
+  std::vector<absl::StatusOr<TableInfo>> table_infos(num_tables);
+  std::vector<absl::StatusOr<ActionInfo>> action_infos(p4info.actions_size());
+  // Arenas are thread-safe, so all tasks allocate on the same one.
+  auto arena = std::make_shared<google::protobuf::Arena>();
+  // Tables and actions are parsed independently; each task writes only its own
+  // result.
+  thread_pool.ParallelFor(
+      num_tables + p4info.actions_size(), [&](int task, int /*worker*/) {
+        if (task < num_tables) {
+          table_infos[task] = ParseTableInfo(p4info.tables(task), arena);
+        } else {
+          action_infos[task - num_tables] =
+              ParseActionInfo(p4info.actions(task - num_tables), arena);
+        }
+      });
+  return MergeConstraintInfo(p4info, std::move(table_infos),
+                             std::move(action_infos));
+}
+
+absl::StatusOr<ConstraintInfo> P4ToConstraintInfo(
+    const p4::config::v1::P4Info& p4info, int num_threads) {
+  if (num_threads == 1) return P4ToConstraintInfo(p4info);
+  ThreadPool thread_pool(num_threads);
+  return P4ToConstraintInfo(p4info, thread_pool);
+}
 
+absl::StatusOr<ConstraintInfo> UpdateConstraintInfo(
+    ConstraintInfo constraint_info, const p4::config::v1::P4Info& p4info) {
+  // Reused entries keep their own arenas alive.
+  auto arena = std::make_shared<google::protobuf::Arena>();
+  std::vector<absl::StatusOr<TableInfo>> table_infos;
+  table_infos.reserve(p4info.tables_size());
   for (const Table& table : p4info.tables()) {
-    absl::StatusOr<TableInfo> table_info = ParseTableInfo(table);
-    if (!table_info.ok()) {
-      errors.push_back(table_info.status());
-    } else if (!table_info_by_id.insert({table.preamble().id(), *table_info})
-                    .second) {
-      errors.push_back(gutil::InvalidArgumentErrorBuilder()
-                       << "duplicate table: " << table.DebugString());
+    // Entries are erased once reused, so duplicate IDs are parsed and then
+    // reported like in `P4ToConstraintInfo`.
+    auto it = constraint_info.table_info_by_id.find(table.preamble().id());
+    const std::string bytes = FingerprintedBytes(table);
+    if (it != constraint_info.table_info_by_id.end() &&
+        IsDerivedFrom(it->second, Fingerprint(bytes), bytes)) {
+      table_infos.push_back(std::move(it->second));
+      constraint_info.table_info_by_id.erase(it);
+    } else {
+      table_infos.push_back(ParseTableInfo(table, arena));
     }
   }
-
+  std::vector<absl::StatusOr<ActionInfo>> action_infos;
+  action_infos.reserve(p4info.actions_size());
   for (const Action& action : p4info.actions()) {
-    absl::StatusOr<ActionInfo> action_info = ParseActionInfo(action);
-    if (!action_info.ok()) {
-      errors.push_back(action_info.status());
-    } else if (!action_info_by_id.insert({action.preamble().id(), *action_info})
-                    .second) {
-      errors.push_back(gutil::InvalidArgumentErrorBuilder()
-                       << "duplicate action: " << action.DebugString());
+    auto it = constraint_info.action_info_by_id.find(action.preamble().id());
+    const std::string bytes = FingerprintedBytes(action);
+    if (it != constraint_info.action_info_by_id.end() &&
+        IsDerivedFrom(it->second, Fingerprint(bytes), bytes)) {
+      action_infos.push_back(std::move(it->second));
+      constraint_info.action_info_by_id.erase(it);
+    } else {
+      action_infos.push_back(ParseActionInfo(action, arena));
     }
   }
+  return MergeConstraintInfo(p4info, std::move(table_infos),
+                             std::move(action_infos));
+}
 
-  if (errors.empty()) {
-    ConstraintInfo info{
-        .action_info_by_id = std::move(action_info_by_id),
-        .table_info_by_id = std::move(table_info_by_id),
-    };
-    return info;
-  }
-  return gutil::InvalidArgumentErrorBuilder()
-         << "P4Info to constraint info translation failed with the following "
-            "errors:\n- "
-         << absl::StrJoin(errors, "\n- ",
-                          [](std::string* out, const absl::Status& status) {
-                            absl::StrAppend(out, status.message(), "\n");
-                          });
+uint64_t P4InfoFingerprint(const p4::config::v1::P4Info& p4info) {
+  return Fingerprint(SerializeDeterministically(p4info));
+}
+
+uint64_t TableFingerprint(const Table& table) {
+  return Fingerprint(FingerprintedBytes(table));
+}
+
+uint64_t ActionFingerprint(const Action& action) {
+  return Fingerprint(FingerprintedBytes(action));
 }
 
 }  // namespace p4_constraints
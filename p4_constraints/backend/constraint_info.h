@@ -26,8 +26,11 @@
 
 #include <stdint.h>
 
+#include <memory>
+#include <optional>
 #include <ostream>
 #include <string>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
@@ -37,6 +40,11 @@
 #include "absl/types/optional.h"
 #include "p4/config/v1/p4info.pb.h"
 #include "p4_constraints/ast.pb.h"
+#include "p4_constraints/backend/constant_pool.h"
+#include "p4_constraints/backend/eval_result.h"
+#include "p4_constraints/backend/flat_constraint.h"
+#include "p4_constraints/backend/program.h"
+#include "p4_constraints/backend/thread_pool.h"
 #include "p4_constraints/constraint_source.h"
 
 namespace p4_constraints {
@@ -65,12 +73,39 @@ void AbslStringify(Sink& sink, const KeyInfo& info) {
                info.name, info.type.ShortDebugString());
 }
 
+// Assigns dense slot indices to the keys of a table (resp. the parameters of
+// an action), so that parsed entries can store them in a vector indexed by
+// slot instead of a map keyed by name. Slots are assigned in order of names.
+struct EntryLayout {
+  // Key/param names, by slot.
+  std::vector<std::string> names;
+  absl::flat_hash_map<uint32_t, int> slot_by_id;
+  absl::flat_hash_map<std::string, int> slot_by_name;
+  // Only used for tables: the value of each key if it is omitted from an entry
+  // (see Section 9.1.1. of the P4Runtime specification), by slot. Keys that
+  // must not be omitted, e.g. exact keys, have no default value.
+  std::vector<std::optional<internal_interpreter::EvalResult>> default_values;
+  // Whether the constraint references the key/param, by slot. Values that are
+  // not referenced are never observed during evaluation, so entry parsing only
+  // validates them instead of converting them. Empty if all slots count as
+  // referenced, e.g. if there is no constraint.
+  std::vector<bool> referenced;
+};
+
+// Returns true iff the value in the given slot must be converted when parsing
+// entries laid out by `layout`.
+inline bool IsReferenced(const EntryLayout& layout, int slot) {
+  return layout.referenced.empty() || layout.referenced[slot];
+}
+
 struct TableInfo {
   uint32_t id;       // Same as Table.preamble.id in p4info.proto.
   std::string name;  // Same as Table.preamble.name in p4info.proto.
 
-  // An optional constraint (aka entry_restriction) on table entries.
-  absl::optional<ast::Expression> constraint;
+  // An optional constraint (aka entry_restriction) on table entries. Null if
+  // there is none. Typically allocated on a protobuf arena that it shares with
+  // other constraints and keeps alive, see `P4ToConstraintInfo`.
+  std::shared_ptr<const ast::Expression> constraint;
   // If member `constraint` is present, this captures its source. Arbitrary
   // otherwise.
   ConstraintSource constraint_source;
@@ -79,14 +114,39 @@ struct TableInfo {
   // Derives from Table.match_fields in p4info.proto.
   absl::flat_hash_map<uint32_t, KeyInfo> keys_by_id;
   absl::flat_hash_map<std::string, KeyInfo> keys_by_name;
+  // Slots of the keys, derived from the maps above. May be null if the
+  // TableInfo was constructed by hand, in which case it is derived on the fly.
+  std::shared_ptr<const EntryLayout> key_layout;
+
+  // Constants used when evaluating `constraint`. Null if there is no
+  // constraint, or if the constraint was attached without building its pool.
+  std::shared_ptr<const ConstantPool> constant_pool;
+  // Compiled form of `constraint`, executed by the VM (see vm.h). Null if
+  // there is no constraint or if it is not supported by the compiler, in which
+  // case the reference interpreter is used instead.
+  std::shared_ptr<const Program> program;
+  // Flat form of `constraint`, evaluated by the reference interpreter (see
+  // flat_constraint.h). Null if there is no constraint, or if the constraint
+  // was attached by hand, in which case it is flattened on the fly.
+  std::shared_ptr<const FlatConstraint> flat_constraint;
+
+  // `TableFingerprint` of the table in p4info.proto this was parsed from, used
+  // by `UpdateConstraintInfo` to detect unchanged tables. 0 if unknown.
+  uint64_t fingerprint = 0;
+  // The bytes hashed into `fingerprint`, which `UpdateConstraintInfo` compares
+  // to rule out collisions. Empty if unknown, in which case the table is never
+  // reused.
+  std::string fingerprinted_bytes;
 };
 
 struct ActionInfo {
   uint32_t id;       // Same as Action.preamble.id in p4info.proto.
   std::string name;  // Same as Action.preamble.name in p4info.proto.
 
-  // An optional constraint (aka action_restriction) on actions.
-  absl::optional<ast::Expression> constraint;
+  // An optional constraint (aka action_restriction) on actions. Null if there
+  // is none. Typically allocated on a protobuf arena that it shares with other
+  // constraints and keeps alive, see `P4ToConstraintInfo`.
+  std::shared_ptr<const ast::Expression> constraint;
   // If member `constraint` is present, this captures its source. Arbitrary
   // otherwise.
   ConstraintSource constraint_source;
@@ -95,6 +155,29 @@ struct ActionInfo {
   absl::flat_hash_map<uint32_t, ParamInfo> params_by_id;
   // Maps from param names to ParamInfo.
   absl::flat_hash_map<std::string, ParamInfo> params_by_name;
+  // Slots of the params, derived from the maps above. May be null if the
+  // ActionInfo was constructed by hand, in which case it is derived on the fly.
+  std::shared_ptr<const EntryLayout> param_layout;
+
+  // Constants used when evaluating `constraint`. Null if there is no
+  // constraint, or if the constraint was attached without building its pool.
+  std::shared_ptr<const ConstantPool> constant_pool;
+  // Compiled form of `constraint`, executed by the VM (see vm.h). Null if
+  // there is no constraint or if it is not supported by the compiler, in which
+  // case the reference interpreter is used instead.
+  std::shared_ptr<const Program> program;
+  // Flat form of `constraint`, evaluated by the reference interpreter (see
+  // flat_constraint.h). Null if there is no constraint, or if the constraint
+  // was attached by hand, in which case it is flattened on the fly.
+  std::shared_ptr<const FlatConstraint> flat_constraint;
+
+  // `ActionFingerprint` of the action in p4info.proto this was parsed from,
+  // used by `UpdateConstraintInfo` to detect unchanged actions. 0 if unknown.
+  uint64_t fingerprint = 0;
+  // The bytes hashed into `fingerprint`, which `UpdateConstraintInfo` compares
+  // to rule out collisions. Empty if unknown, in which case the action is never
+  // reused.
+  std::string fingerprinted_bytes;
 };
 
 // Contains all information required for constraint checking.
@@ -103,16 +186,82 @@ struct ConstraintInfo {
   absl::flat_hash_map<uint32_t, ActionInfo> action_info_by_id;
   // Maps from table IDs to TableInfo.
   absl::flat_hash_map<uint32_t, TableInfo> table_info_by_id;
+  // Identifies the constraints above for caches of checking results (see
+  // verdict_cache.h). Distinct for every result of `P4ToConstraintInfo`; must
+  // be changed whenever the maps above are modified. 0 if constructed by hand,
+  // in which case `Validator`s do not cache verdicts.
+  uint64_t generation = 0;
 };
 
+// Returns a `ConstraintInfo::generation` distinct from all generations returned
+// before in this process, and from 0.
+uint64_t NewConstraintInfoGeneration();
+
+// Derives the layout of the keys of the given table (resp. the parameters of
+// the given action) from its `keys_by_name` and `keys_by_id` (resp.
+// `params_by_name` and `params_by_id`), marking the variables of its
+// `constraint` as referenced.
+EntryLayout MakeKeyLayout(const TableInfo& table_info);
+EntryLayout MakeParamLayout(const ActionInfo& action_info);
+
+// Compiles the type-checked `constraint` for the VM, assigning the slots of
+// `layout` to its variables. Returns null if `constraint` is not supported by
+// the compiler, leaving it to the reference interpreter.
+absl::StatusOr<std::shared_ptr<const Program>> CompileForVm(
+    const ast::Expression& constraint, const EntryLayout& layout);
+
+// Flattens `constraint`, resolving the slots of its variables in `layout` and
+// the values of its literals in `constant_pool`. The result keeps `constraint`,
+// `layout`, and `constant_pool` alive.
+std::shared_ptr<const FlatConstraint> MakeFlatConstraint(
+    std::shared_ptr<const ast::Expression> constraint,
+    std::shared_ptr<const EntryLayout> layout,
+    std::shared_ptr<const ConstantPool> constant_pool);
+
 // Translates `P4Info` to `ConstraintInfo`.
 //
 // Parses all tables and actions and their p4-constraints annotations into an
 // in-memory representation suitable for constraint checking. Returns parsed
 // representation, or an error status if parsing fails.
+//
+// The ASTs of all constraints are built, type checked, and simplified in place
+// on a single `google::protobuf::Arena`, which is freed together with the last
+// `constraint` referring to it.
 absl::StatusOr<ConstraintInfo> P4ToConstraintInfo(
     const p4::config::v1::P4Info& p4info);
 
+// Same as above, but parses the tables and actions in parallel on the workers
+// of `thread_pool`. Returns the same result, including the order of errors, as
+// the sequential version. The second overload uses a thread pool with
+// `num_threads` threads (see `ThreadPool`) for the duration of the call, and is
+// the sequential version for `num_threads` == 1. Since that pool starts its
+// threads on every call, callers that translate P4Infos repeatedly should reuse
+// a `ThreadPool`.
+absl::StatusOr<ConstraintInfo> P4ToConstraintInfo(
+    const p4::config::v1::P4Info& p4info, ThreadPool& thread_pool);
+absl::StatusOr<ConstraintInfo> P4ToConstraintInfo(
+    const p4::config::v1::P4Info& p4info, int num_threads);
+
+// Translates `p4info` like `P4ToConstraintInfo`, but reuses the TableInfos
+// (resp. ActionInfos) of `constraint_info` whose tables (resp. actions) are
+// unchanged in `p4info`: their fingerprints pick the candidates, and their
+// fingerprinted bytes must match too. Only tables and actions that are new or
+// changed are parsed, type checked, and compiled.
+//
+// Returns the same result as `P4ToConstraintInfo(p4info)`, with a fresh
+// `generation`. Reused entries are moved out of `constraint_info`, so passing
+// it by `std::move` avoids copying them; a copy shares their layouts, constant
+// pools, and programs with the original.
+absl::StatusOr<ConstraintInfo> UpdateConstraintInfo(
+    ConstraintInfo constraint_info, const p4::config::v1::P4Info& p4info);
+
+// Returns a fingerprint of `p4info`, resp. of the parts of `table` (`action`)
+// that its TableInfo (ActionInfo) is derived from, i.e. its ID, name,
+// annotations, and match fields (params). Stable across processes.
+uint64_t P4InfoFingerprint(const p4::config::v1::P4Info& p4info);
+uint64_t TableFingerprint(const p4::config::v1::Table& table);
+uint64_t ActionFingerprint(const p4::config::v1::Action& action);
+
 // Returns a pointer to the TableInfo associated with a given table_id
 // or std::nullptr if the table_id cannot be found.
 const TableInfo* GetTableInfoOrNull(const ConstraintInfo& constraint_info,
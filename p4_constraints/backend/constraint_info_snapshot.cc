@@ -0,0 +1,417 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "p4_constraints/backend/constraint_info_snapshot.h"
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/numeric/int128.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "google/protobuf/arena.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/io/zero_copy_stream_impl_lite.h"
+#include "gutil/status.h"
+#include "p4/config/v1/p4info.pb.h"
+#include "p4_constraints/ast.pb.h"
+#include "p4_constraints/backend/constant_pool.h"
+#include "p4_constraints/backend/constraint_info.h"
+#include "p4_constraints/backend/constraint_info_snapshot.pb.h"
+#include "p4_constraints/backend/program.h"
+#include "p4_constraints/big_int.h"
+#include "p4_constraints/constraint_source.h"
+#include "p4_constraints/quote.h"
+
+namespace p4_constraints {
+
+namespace {
+
+// -- Serialization ------------------------------------------------------------
+
+// Returns the elements of `map` ordered by key, so that snapshots of equal
+// `ConstraintInfo`s are equal.
+template <typename Value>
+std::vector<const Value*> SortedById(
+    const absl::flat_hash_map<uint32_t, Value>& map) {
+  std::vector<std::pair<uint32_t, const Value*>> entries;
+  entries.reserve(map.size());
+  for (const auto& [id, value] : map) entries.push_back({id, &value});
+  std::sort(entries.begin(), entries.end());
+  std::vector<const Value*> values;
+  values.reserve(entries.size());
+  for (const auto& [id, value] : entries) values.push_back(value);
+  return values;
+}
+
+template <typename Info>
+void SerializeVariables(
+    const absl::flat_hash_map<uint32_t, Info>& infos_by_id,
+    google::protobuf::RepeatedPtrField<VariableSnapshot>& snapshots) {
+  for (const Info* info : SortedById(infos_by_id)) {
+    VariableSnapshot& snapshot = *snapshots.Add();
+    snapshot.set_id(info->id);
+    snapshot.set_name(info->name);
+    *snapshot.mutable_type() = info->type;
+  }
+}
+
+void SerializeProgram(const Program& program, ProgramSnapshot& snapshot) {
+  snapshot.mutable_instructions()->Reserve(program.instructions.size());
+  for (const Instruction& instruction : program.instructions) {
+    snapshot.add_instructions(
+        static_cast<uint64_t>(instruction.opcode) |
+        static_cast<uint64_t>(instruction.field) << 8 |
+        static_cast<uint64_t>(static_cast<uint32_t>(instruction.operand))
+            << 32);
+  }
+  for (const BigInt& constant : program.constants) {
+    snapshot.add_constants(BigIntToString(constant));
+  }
+  for (const Variable& variable : program.variables) {
+    ProgramVariableSnapshot& variable_snapshot = *snapshot.add_variables();
+    variable_snapshot.set_name(variable.name);
+    *variable_snapshot.mutable_type() = variable.type;
+    variable_snapshot.set_slot(variable.slot);
+  }
+  snapshot.set_max_stack_size(program.max_stack_size);
+  snapshot.set_representation(static_cast<uint32_t>(program.representation));
+}
+
+void SerializeConstraint(const ast::Expression& constraint,
+                         const ConstraintSource& source, const Program* program,
+                         ConstraintSnapshot& snapshot) {
+  *snapshot.mutable_constraint() = constraint;
+  snapshot.set_source(source.constraint_string.str());
+  *snapshot.mutable_source_location() = source.constraint_location;
+  if (program != nullptr) {
+    SerializeProgram(*program, *snapshot.mutable_program());
+  }
+}
+
+// -- Deserialization ----------------------------------------------------------
+
+// Adds the variables in `snapshots` to `infos_by_id` and `infos_by_name`.
+template <typename Info>
+absl::Status DeserializeVariables(
+    const google::protobuf::RepeatedPtrField<VariableSnapshot>& snapshots,
+    absl::flat_hash_map<uint32_t, Info>& infos_by_id,
+    absl::flat_hash_map<std::string, Info>& infos_by_name) {
+  for (const VariableSnapshot& snapshot : snapshots) {
+    Info info{.id = snapshot.id(), .name = snapshot.name(),
+              .type = snapshot.type()};
+    if (!infos_by_id.insert({info.id, info}).second ||
+        !infos_by_name.insert({info.name, info}).second) {
+      return gutil::InvalidArgumentErrorBuilder()
+             << "duplicate key or parameter '" << info.name << "'";
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Decodes `snapshot` into a program reading the variables of `layout`.
+// Validates the program, since the VM executes it without bounds checks.
+absl::StatusOr<std::shared_ptr<const Program>> DeserializeProgram(
+    const ProgramSnapshot& snapshot, const EntryLayout& layout) {
+  Program program;
+  program.instructions.reserve(snapshot.instructions_size());
+  for (uint64_t word : snapshot.instructions()) {
+    program.instructions.push_back(Instruction{
+        .opcode = static_cast<Opcode>(word & 0xff),
+        .field = static_cast<KeyField>((word >> 8) & 0xff),
+        .operand = static_cast<int32_t>(static_cast<uint32_t>(word >> 32)),
+    });
+  }
+  program.constants.reserve(snapshot.constants_size());
+  for (const std::string& constant : snapshot.constants()) {
+    ASSIGN_OR_RETURN(program.constants.emplace_back(), ParseBigInt(constant));
+  }
+  for (const ProgramVariableSnapshot& variable : snapshot.variables()) {
+    const int slot = variable.slot();
+    if (slot != -1 &&
+        (slot < 0 || slot >= layout.names.size() ||
+         layout.names[slot] != variable.name())) {
+      return gutil::InvalidArgumentErrorBuilder()
+             << "invalid slot " << slot << " of variable '" << variable.name()
+             << "'";
+    }
+    program.variables.push_back(Variable{
+        .name = variable.name(), .type = variable.type(), .slot = slot});
+  }
+  program.max_stack_size = snapshot.max_stack_size();
+  if (snapshot.representation() >
+      static_cast<uint32_t>(ValueRepresentation::kBigInt)) {
+    return gutil::InvalidArgumentErrorBuilder()
+           << "invalid value representation " << snapshot.representation();
+  }
+  program.representation =
+      static_cast<ValueRepresentation>(snapshot.representation());
+  if (program.representation != ValueRepresentation::kBigInt) {
+    program.fixed_width_constants.reserve(program.constants.size());
+    for (const BigInt& constant : program.constants) {
+      std::optional<absl::uint128> fixed_width_constant =
+          BigIntToUint128(constant);
+      if (!fixed_width_constant.has_value()) {
+        return gutil::InvalidArgumentErrorBuilder()
+               << "constant " << constant << " exceeds 128 bits";
+      }
+      program.fixed_width_constants.push_back(*fixed_width_constant);
+    }
+  }
+  RETURN_IF_ERROR(ValidateProgram(program).status());
+  return std::make_shared<const Program>(std::move(program));
+}
+
+// Attaches the source, constant pool, program, and flat form of the constraint
+// in `snapshot` to `info`, which must be a TableInfo or ActionInfo with layout
+// `layout` whose `constraint` is the one in `snapshot`.
+template <typename Info>
+absl::Status DeserializeConstraint(
+    const ConstraintSnapshot& snapshot,
+    const std::shared_ptr<const EntryLayout>& layout, Info& info) {
+  if (snapshot.constraint().type().type_case() != ast::Type::kBoolean) {
+    return gutil::InvalidArgumentErrorBuilder()
+           << "constraint of '" << info.name << "' is not of type bool";
+  }
+  info.constraint_source = ConstraintSource{
+      .constraint_string = snapshot.source(),
+      .constraint_location = snapshot.source_location(),
+  };
+  IndexConstraintSource(info.constraint_source, *info.constraint);
+  ASSIGN_OR_RETURN(ConstantPool pool, BuildConstantPool(*info.constraint));
+  info.constant_pool = std::make_shared<const ConstantPool>(std::move(pool));
+  if (snapshot.has_program()) {
+    ASSIGN_OR_RETURN(info.program,
+                     DeserializeProgram(snapshot.program(), *layout));
+  }
+  info.flat_constraint =
+      MakeFlatConstraint(info.constraint, layout, info.constant_pool);
+  return absl::OkStatus();
+}
+
+// Deserializes `snapshot`, which must be allocated on `arena`. Its constraint
+// is used in place, keeping `arena` alive.
+absl::StatusOr<TableInfo> DeserializeTable(
+    const TableSnapshot& snapshot,
+    const std::shared_ptr<google::protobuf::Arena>& arena) {
+  TableInfo table_info{.id = snapshot.id(), .name = snapshot.name()};
+  table_info.fingerprint = snapshot.fingerprint();
+  table_info.fingerprinted_bytes = snapshot.fingerprinted_bytes();
+  RETURN_IF_ERROR(DeserializeVariables(snapshot.keys(), table_info.keys_by_id,
+                                       table_info.keys_by_name));
+  if (snapshot.has_constraint()) {
+    table_info.constraint = std::shared_ptr<const ast::Expression>(
+        arena, &snapshot.constraint().constraint());
+  }
+  auto layout = std::make_shared<const EntryLayout>(MakeKeyLayout(table_info));
+  table_info.key_layout = layout;
+  if (snapshot.has_constraint()) {
+    RETURN_IF_ERROR(
+        DeserializeConstraint(snapshot.constraint(), layout, table_info));
+  }
+  return table_info;
+}
+
+// Like `DeserializeTable`, but for actions.
+absl::StatusOr<ActionInfo> DeserializeAction(
+    const ActionSnapshot& snapshot,
+    const std::shared_ptr<google::protobuf::Arena>& arena) {
+  ActionInfo action_info{.id = snapshot.id(), .name = snapshot.name()};
+  action_info.fingerprint = snapshot.fingerprint();
+  action_info.fingerprinted_bytes = snapshot.fingerprinted_bytes();
+  RETURN_IF_ERROR(DeserializeVariables(snapshot.params(),
+                                       action_info.params_by_id,
+                                       action_info.params_by_name));
+  if (snapshot.has_constraint()) {
+    action_info.constraint = std::shared_ptr<const ast::Expression>(
+        arena, &snapshot.constraint().constraint());
+  }
+  auto layout =
+      std::make_shared<const EntryLayout>(MakeParamLayout(action_info));
+  action_info.param_layout = layout;
+  if (snapshot.has_constraint()) {
+    RETURN_IF_ERROR(
+        DeserializeConstraint(snapshot.constraint(), layout, action_info));
+  }
+  return action_info;
+}
+
+}  // namespace
+
+absl::StatusOr<std::string> SerializeConstraintInfo(
+    const ConstraintInfo& constraint_info,
+    const p4::config::v1::P4Info& p4info) {
+  ConstraintInfoSnapshot snapshot;
+  snapshot.set_format_version(kConstraintInfoSnapshotVersion);
+  snapshot.set_p4info_fingerprint(P4InfoFingerprint(p4info));
+  for (const TableInfo* table_info :
+       SortedById(constraint_info.table_info_by_id)) {
+    TableSnapshot& table = *snapshot.add_tables();
+    table.set_id(table_info->id);
+    table.set_name(table_info->name);
+    table.set_fingerprint(table_info->fingerprint);
+    table.set_fingerprinted_bytes(table_info->fingerprinted_bytes);
+    SerializeVariables(table_info->keys_by_id, *table.mutable_keys());
+    if (table_info->constraint != nullptr) {
+      SerializeConstraint(*table_info->constraint,
+                          table_info->constraint_source,
+                          table_info->program.get(),
+                          *table.mutable_constraint());
+    }
+  }
+  for (const ActionInfo* action_info :
+       SortedById(constraint_info.action_info_by_id)) {
+    ActionSnapshot& action = *snapshot.add_actions();
+    action.set_id(action_info->id);
+    action.set_name(action_info->name);
+    action.set_fingerprint(action_info->fingerprint);
+    action.set_fingerprinted_bytes(action_info->fingerprinted_bytes);
+    SerializeVariables(action_info->params_by_id, *action.mutable_params());
+    if (action_info->constraint != nullptr) {
+      SerializeConstraint(
+          *action_info->constraint, action_info->constraint_source,
+          action_info->program.get(), *action.mutable_constraint());
+    }
+  }
+
+  std::string bytes;
+  {
+    google::protobuf::io::StringOutputStream stream(&bytes);
+    google::protobuf::io::CodedOutputStream output(&stream);
+    output.SetSerializationDeterministic(true);
+    if (!snapshot.SerializeToCodedStream(&output)) {
+      return gutil::InternalErrorBuilder()
+             << "failed to serialize constraint info snapshot";
+    }
+  }
+  return bytes;
+}
+
+absl::StatusOr<ConstraintInfo> DeserializeConstraintInfo(
+    absl::string_view snapshot,
+    std::optional<uint64_t> expected_p4info_fingerprint) {
+  // The snapshot is decoded onto an arena that the constraints of the result
+  // point into, so that they are not copied out of it.
+  auto arena = std::make_shared<google::protobuf::Arena>();
+  ConstraintInfoSnapshot& decoded =
+      *google::protobuf::Arena::Create<ConstraintInfoSnapshot>(arena.get());
+  if (snapshot.size() > std::numeric_limits<int>::max() ||
+      !decoded.ParseFromArray(snapshot.data(), snapshot.size())) {
+    return gutil::InvalidArgumentErrorBuilder()
+           << "malformed constraint info snapshot";
+  }
+  if (decoded.format_version() != kConstraintInfoSnapshotVersion) {
+    return gutil::InvalidArgumentErrorBuilder()
+           << "constraint info snapshot has format version "
+           << decoded.format_version() << ", but expected version "
+           << kConstraintInfoSnapshotVersion;
+  }
+  if (expected_p4info_fingerprint.has_value() &&
+      decoded.p4info_fingerprint() != *expected_p4info_fingerprint) {
+    return gutil::FailedPreconditionErrorBuilder()
+           << "constraint info snapshot was taken from a different P4Info";
+  }
+
+  ConstraintInfo constraint_info;
+  constraint_info.table_info_by_id.reserve(decoded.tables_size());
+  for (const TableSnapshot& table : decoded.tables()) {
+    absl::StatusOr<TableInfo> table_info = DeserializeTable(table, arena);
+    if (!table_info.ok()) {
+      return gutil::InvalidArgumentErrorBuilder()
+             << "malformed constraint info snapshot: table '" << table.name()
+             << "': " << table_info.status().message();
+    }
+    if (!constraint_info.table_info_by_id
+             .insert({table.id(), *std::move(table_info)})
+             .second) {
+      return gutil::InvalidArgumentErrorBuilder()
+             << "malformed constraint info snapshot: duplicate table "
+             << table.id();
+    }
+  }
+  constraint_info.action_info_by_id.reserve(decoded.actions_size());
+  for (const ActionSnapshot& action : decoded.actions()) {
+    absl::StatusOr<ActionInfo> action_info = DeserializeAction(action, arena);
+    if (!action_info.ok()) {
+      return gutil::InvalidArgumentErrorBuilder()
+             << "malformed constraint info snapshot: action '" << action.name()
+             << "': " << action_info.status().message();
+    }
+    if (!constraint_info.action_info_by_id
+             .insert({action.id(), *std::move(action_info)})
+             .second) {
+      return gutil::InvalidArgumentErrorBuilder()
+             << "malformed constraint info snapshot: duplicate action "
+             << action.id();
+    }
+  }
+  constraint_info.generation = NewConstraintInfoGeneration();
+  return constraint_info;
+}
+
+absl::Status WriteConstraintInfoSnapshot(
+    const ConstraintInfo& constraint_info, const p4::config::v1::P4Info& p4info,
+    const std::string& path) {
+  ASSIGN_OR_RETURN(std::string snapshot,
+                   SerializeConstraintInfo(constraint_info, p4info));
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file << snapshot;
+  file.close();
+  if (!file) {
+    return gutil::UnavailableErrorBuilder() << "unable to write file " << path;
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<ConstraintInfo> ReadConstraintInfoSnapshot(
+    const std::string& path,
+    std::optional<uint64_t> expected_p4info_fingerprint) {
+  // Decode the snapshot in place if the file can be mapped.
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd >= 0) {
+    struct stat stats;
+    void* data = MAP_FAILED;
+    if (fstat(fd, &stats) == 0 && stats.st_size > 0) {
+      data = mmap(nullptr, stats.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (data != MAP_FAILED) {
+      absl::StatusOr<ConstraintInfo> constraint_info =
+          DeserializeConstraintInfo(
+              absl::string_view(static_cast<const char*>(data),
+                                stats.st_size),
+              expected_p4info_fingerprint);
+      munmap(data, stats.st_size);
+      return constraint_info;
+    }
+  }
+
+  // Otherwise, e.g. for pipes, read it.
+  std::ifstream file(path, std::ios::binary);
+  if (!file.is_open()) {
+    return gutil::NotFoundErrorBuilder() << "unable to open file " << path;
+  }
+  std::string snapshot((std::istreambuf_iterator<char>(file)),
+                       std::istreambuf_iterator<char>());
+  if (file.bad()) {
+    return gutil::UnavailableErrorBuilder() << "unable to read file " << path;
+  }
+  return DeserializeConstraintInfo(snapshot, expected_p4info_fingerprint);
+}
+
+}  // namespace p4_constraints
@@ -0,0 +1,72 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+// Binary snapshots of `ConstraintInfo` for fast controller startup.
+//
+// `P4ToConstraintInfo` parses, type checks, simplifies, and compiles every
+// constraint of a P4 program, which dominates startup time for programs with
+// many constraints. A snapshot records the result, so that later runs can load
+// it instead. Loading a snapshot only decodes it and rebuilds the derived
+// lookup structures (entry layouts and constant pools); in particular, it does
+// not run the constraint parser, type checker, or compiler.
+//
+// Snapshots are versioned and carry a fingerprint of the P4Info they were
+// taken from, so that stale snapshots are detected rather than silently used.
+
+#ifndef P4_CONSTRAINTS_BACKEND_CONSTRAINT_INFO_SNAPSHOT_H_
+#define P4_CONSTRAINTS_BACKEND_CONSTRAINT_INFO_SNAPSHOT_H_
+
+#include <stdint.h>
+
+#include <optional>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "p4/config/v1/p4info.pb.h"
+#include "p4_constraints/backend/constraint_info.h"
+
+namespace p4_constraints {
+
+// Version of the snapshot format. Must be incremented whenever the encoding of
+// snapshots or the meaning of their contents (e.g. the instruction set of the
+// VM, see program.h) changes.
+inline constexpr uint32_t kConstraintInfoSnapshotVersion = 1;
+
+// Returns a snapshot of `constraint_info`, which must be the result of
+// `P4ToConstraintInfo(p4info)`. The snapshot records the `P4InfoFingerprint`
+// (see constraint_info.h) of `p4info` to identify the P4 program it was taken
+// from.
+absl::StatusOr<std::string> SerializeConstraintInfo(
+    const ConstraintInfo& constraint_info,
+    const p4::config::v1::P4Info& p4info);
+
+// Loads a snapshot returned by `SerializeConstraintInfo`. The result behaves
+// like the `ConstraintInfo` the snapshot was taken from, but has a fresh
+// `generation`.
+//
+// Returns an InvalidArgument error if `snapshot` is malformed or was written
+// by a different version of the snapshot format, and a FailedPrecondition
+// error if `expected_p4info_fingerprint` is given and does not match the
+// fingerprint recorded in the snapshot.
+absl::StatusOr<ConstraintInfo> DeserializeConstraintInfo(
+    absl::string_view snapshot,
+    std::optional<uint64_t> expected_p4info_fingerprint = std::nullopt);
+
+// Writes the snapshot `SerializeConstraintInfo(constraint_info, p4info)` to
+// the file at `path`.
+absl::Status WriteConstraintInfoSnapshot(
+    const ConstraintInfo& constraint_info, const p4::config::v1::P4Info& p4info,
+    const std::string& path);
+
+// Loads the snapshot in the file at `path`, see `DeserializeConstraintInfo`.
+// The file is memory-mapped if possible, so it is decoded in place without
+// being copied first.
+absl::StatusOr<ConstraintInfo> ReadConstraintInfoSnapshot(
+    const std::string& path,
+    std::optional<uint64_t> expected_p4info_fingerprint = std::nullopt);
+
+}  // namespace p4_constraints
+
+#endif  // P4_CONSTRAINTS_BACKEND_CONSTRAINT_INFO_SNAPSHOT_H_
@@ -0,0 +1,283 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "p4_constraints/backend/constraint_info_snapshot.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "gutil/status_matchers.h"
+#include "gutil/testing.h"
+#include "p4/config/v1/p4info.pb.h"
+#include "p4/v1/p4runtime.pb.h"
+#include "p4_constraints/backend/constraint_info.h"
+#include "p4_constraints/backend/constraint_info_snapshot.pb.h"
+#include "p4_constraints/backend/interpreter.h"
+#include "p4_constraints/backend/program.h"
+
+namespace p4_constraints {
+namespace {
+
+using ::gutil::ParseProtoOrDie;
+using ::gutil::StatusIs;
+using ::testing::HasSubstr;
+
+// A table whose keys and constants do not fit into 64 bits, a table without a
+// constraint, and an action restriction.
+constexpr char kP4Info[] = R"pb(
+  tables {
+    preamble {
+      id: 1
+      name: "wide_table"
+      annotations: "@entry_restriction(\"wide != 1 && wide != 340282366920938463463374607431768211455\")"
+    }
+    match_fields { id: 1 name: "wide" bitwidth: 256 match_type: EXACT }
+  }
+  tables {
+    preamble { id: 2 name: "unconstrained_table" }
+    match_fields { id: 1 name: "key" bitwidth: 8 match_type: EXACT }
+  }
+  actions {
+    preamble {
+      id: 3
+      name: "set_vlan"
+      annotations: "@action_restriction(\"vlan_id != 0\")"
+    }
+    params { id: 1 name: "vlan_id" bitwidth: 12 }
+  }
+)pb";
+
+p4::config::v1::P4Info P4Info() {
+  return ParseProtoOrDie<p4::config::v1::P4Info>(kP4Info);
+}
+
+std::vector<p4::v1::TableEntry> Entries() {
+  return {
+      ParseProtoOrDie<p4::v1::TableEntry>(R"pb(
+        table_id: 1
+        match {
+          field_id: 1
+          exact { value: "\x01" }
+        }
+      )pb"),
+      ParseProtoOrDie<p4::v1::TableEntry>(R"pb(
+        table_id: 1
+        match {
+          field_id: 1
+          exact { value: "\x02" }
+        }
+      )pb"),
+      ParseProtoOrDie<p4::v1::TableEntry>(R"pb(
+        table_id: 1
+        match {
+          field_id: 1
+          exact { value: "\x02" }
+        }
+        action {
+          action {
+            action_id: 3
+            params { param_id: 1 value: "\x00" }
+          }
+        }
+      )pb"),
+      ParseProtoOrDie<p4::v1::TableEntry>(R"pb(
+        table_id: 2
+        match {
+          field_id: 1
+          exact { value: "\x02" }
+        }
+        action {
+          action {
+            action_id: 3
+            params { param_id: 1 value: "\x07" }
+          }
+        }
+      )pb"),
+      ParseProtoOrDie<p4::v1::TableEntry>(R"pb(
+        table_id: 2
+        match {
+          field_id: 1
+          exact { value: "\x02" }
+        }
+        action {
+          action {
+            action_id: 3
+            params { param_id: 1 value: "\x00" }
+          }
+        }
+      )pb"),
+      ParseProtoOrDie<p4::v1::TableEntry>(R"pb(table_id: 99)pb"),
+  };
+}
+
+TEST(ConstraintInfoSnapshotTest, RoundTripPreservesVerdicts) {
+  const p4::config::v1::P4Info p4info = P4Info();
+  ASSERT_OK_AND_ASSIGN(ConstraintInfo original, P4ToConstraintInfo(p4info));
+  ASSERT_OK_AND_ASSIGN(std::string snapshot,
+                       SerializeConstraintInfo(original, p4info));
+  ASSERT_OK_AND_ASSIGN(
+      ConstraintInfo loaded,
+      DeserializeConstraintInfo(snapshot, P4InfoFingerprint(p4info)));
+  EXPECT_NE(loaded.generation, original.generation);
+  EXPECT_NE(loaded.generation, 0);
+
+  for (const p4::v1::TableEntry& entry : Entries()) {
+    SCOPED_TRACE(entry.DebugString());
+    absl::StatusOr<std::string> expected =
+        ReasonEntryViolatesConstraint(entry, original);
+    absl::StatusOr<std::string> actual =
+        ReasonEntryViolatesConstraint(entry, loaded);
+    EXPECT_EQ(actual.status(), expected.status());
+    if (expected.ok() && actual.ok()) EXPECT_EQ(*actual, *expected);
+  }
+}
+
+TEST(ConstraintInfoSnapshotTest, PreservesCompiledPrograms) {
+  const p4::config::v1::P4Info p4info = P4Info();
+  ASSERT_OK_AND_ASSIGN(ConstraintInfo original, P4ToConstraintInfo(p4info));
+  ASSERT_OK_AND_ASSIGN(
+      ConstraintInfo loaded,
+      DeserializeConstraintInfo(*SerializeConstraintInfo(original, p4info)));
+  const TableInfo* table_info = GetTableInfoOrNull(loaded, 1);
+  ASSERT_NE(table_info, nullptr);
+  ASSERT_NE(table_info->program, nullptr);
+  EXPECT_EQ(ProgramToString(*table_info->program),
+            ProgramToString(*GetTableInfoOrNull(original, 1)->program));
+  EXPECT_EQ(table_info->fingerprint,
+            GetTableInfoOrNull(original, 1)->fingerprint);
+  EXPECT_EQ(table_info->fingerprinted_bytes,
+            GetTableInfoOrNull(original, 1)->fingerprinted_bytes);
+  EXPECT_EQ(GetTableInfoOrNull(loaded, 2)->program, nullptr);
+}
+
+TEST(ConstraintInfoSnapshotTest, IsDeterministic) {
+  const p4::config::v1::P4Info p4info = P4Info();
+  ASSERT_OK_AND_ASSIGN(ConstraintInfo first, P4ToConstraintInfo(p4info));
+  ASSERT_OK_AND_ASSIGN(ConstraintInfo second, P4ToConstraintInfo(p4info));
+  EXPECT_EQ(*SerializeConstraintInfo(first, p4info),
+            *SerializeConstraintInfo(second, p4info));
+}
+
+TEST(ConstraintInfoSnapshotTest, RejectsOtherP4Info) {
+  const p4::config::v1::P4Info p4info = P4Info();
+  ASSERT_OK_AND_ASSIGN(ConstraintInfo constraint_info,
+                       P4ToConstraintInfo(p4info));
+  ASSERT_OK_AND_ASSIGN(std::string snapshot,
+                       SerializeConstraintInfo(constraint_info, p4info));
+  p4::config::v1::P4Info other = p4info;
+  other.mutable_tables(0)->mutable_match_fields(0)->set_bitwidth(9);
+  EXPECT_NE(P4InfoFingerprint(other), P4InfoFingerprint(p4info));
+  EXPECT_THAT(DeserializeConstraintInfo(snapshot, P4InfoFingerprint(other)),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+}
+
+TEST(ConstraintInfoSnapshotTest, RejectsOtherFormatVersions) {
+  const p4::config::v1::P4Info p4info = P4Info();
+  ASSERT_OK_AND_ASSIGN(ConstraintInfo constraint_info,
+                       P4ToConstraintInfo(p4info));
+  ConstraintInfoSnapshot snapshot;
+  ASSERT_TRUE(snapshot.ParseFromString(
+      *SerializeConstraintInfo(constraint_info, p4info)));
+  snapshot.set_format_version(kConstraintInfoSnapshotVersion + 1);
+  EXPECT_THAT(DeserializeConstraintInfo(snapshot.SerializeAsString()),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("format version")));
+}
+
+TEST(ConstraintInfoSnapshotTest, RejectsMalformedSnapshots) {
+  EXPECT_THAT(DeserializeConstraintInfo("not a snapshot"),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+
+  const p4::config::v1::P4Info p4info = P4Info();
+  ASSERT_OK_AND_ASSIGN(ConstraintInfo constraint_info,
+                       P4ToConstraintInfo(p4info));
+  ConstraintInfoSnapshot snapshot;
+  ASSERT_TRUE(snapshot.ParseFromString(
+      *SerializeConstraintInfo(constraint_info, p4info)));
+  ProgramSnapshot& program =
+      *snapshot.mutable_tables(0)->mutable_constraint()->mutable_program();
+  ASSERT_GT(program.instructions_size(), 0);
+
+  // Out-of-bounds variable.
+  ConstraintInfoSnapshot corrupted = snapshot;
+  corrupted.mutable_tables(0)
+      ->mutable_constraint()
+      ->mutable_program()
+      ->mutable_variables(0)
+      ->set_slot(100);
+  EXPECT_THAT(DeserializeConstraintInfo(corrupted.SerializeAsString()),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("wide_table")));
+
+  // Stack underflow.
+  corrupted = snapshot;
+  corrupted.mutable_tables(0)
+      ->mutable_constraint()
+      ->mutable_program()
+      ->set_instructions(0, static_cast<uint64_t>(Opcode::kNot));
+  EXPECT_THAT(DeserializeConstraintInfo(corrupted.SerializeAsString()),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+
+  // Stack underflow, hidden by an overflowing number of components.
+  corrupted = snapshot;
+  ProgramSnapshot& underflow =
+      *corrupted.mutable_tables(0)->mutable_constraint()->mutable_program();
+  underflow.clear_instructions();
+  for (const Instruction& instruction :
+       std::vector<Instruction>{
+           {.opcode = Opcode::kPushInteger},
+           {.opcode = Opcode::kJumpIfTrueElsePop, .operand = 4},
+           {.opcode = Opcode::kEq, .operand = 0x40000000},
+           {.opcode = Opcode::kNot},
+       }) {
+    underflow.add_instructions(
+        static_cast<uint64_t>(instruction.opcode) |
+        static_cast<uint64_t>(static_cast<uint32_t>(instruction.operand))
+            << 32);
+  }
+  underflow.set_max_stack_size(2);
+  EXPECT_THAT(DeserializeConstraintInfo(corrupted.SerializeAsString()),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("stack underflow")));
+
+  // Unknown opcode.
+  corrupted = snapshot;
+  corrupted.mutable_tables(0)
+      ->mutable_constraint()
+      ->mutable_program()
+      ->set_instructions(0, 0xff);
+  EXPECT_THAT(DeserializeConstraintInfo(corrupted.SerializeAsString()),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(ConstraintInfoSnapshotTest, ReadsSnapshotsWrittenToFiles) {
+  const p4::config::v1::P4Info p4info = P4Info();
+  ASSERT_OK_AND_ASSIGN(ConstraintInfo original, P4ToConstraintInfo(p4info));
+  const std::string path =
+      absl::StrCat(::testing::TempDir(), "/constraint_info.snapshot");
+  ASSERT_OK(WriteConstraintInfoSnapshot(original, p4info, path));
+  ASSERT_OK_AND_ASSIGN(
+      ConstraintInfo loaded,
+      ReadConstraintInfoSnapshot(path, P4InfoFingerprint(p4info)));
+  EXPECT_EQ(loaded.table_info_by_id.size(), original.table_info_by_id.size());
+  EXPECT_EQ(loaded.action_info_by_id.size(),
+            original.action_info_by_id.size());
+  for (const p4::v1::TableEntry& entry : Entries()) {
+    SCOPED_TRACE(entry.DebugString());
+    EXPECT_EQ(ReasonEntryViolatesConstraint(entry, loaded).status(),
+              ReasonEntryViolatesConstraint(entry, original).status());
+  }
+
+  EXPECT_THAT(ReadConstraintInfoSnapshot(path + ".missing"),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
+}  // namespace
+}  // namespace p4_constraints
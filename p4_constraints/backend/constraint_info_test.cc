@@ -20,14 +20,18 @@
 
 #include <cstdint>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "gutil/proto.h"
 #include "gutil/status.h"           // IWYU pragma: keep
 #include "gutil/status_matchers.h"  // IWYU pragma: keep
 #include "p4/config/v1/p4info.pb.h"
+#include "p4_constraints/backend/program.h"
 
 using p4::config::v1::P4Info;
 
@@ -67,6 +71,12 @@ TEST(P4ToConstraintInfoTest, ValidActionRestrictionSucceeds) {
 
   EXPECT_EQ(action_info_by_id[123].constraint_source.constraint_string,
             "multicast_group_id != 0");
+  EXPECT_NE(action_info_by_id[123].program, nullptr);
+  ASSERT_NE(action_info_by_id[123].param_layout, nullptr);
+  EXPECT_EQ(action_info_by_id[123].param_layout->slot_by_id.at(1), 0);
+  EXPECT_EQ(action_info_by_id[123].program->variables[0].slot, 0);
+  EXPECT_EQ(action_info_by_id[123].param_layout->referenced,
+            std::vector<bool>{true});
 }
 
 TEST(P4ToConstraintInfoTest, ActionWithP4NamedTypeConstraintFails) {
@@ -127,6 +137,196 @@ Syntax error: @action_restriction must be enclosed in '("' and '")'
   ASSERT_TRUE(!constraints.status().ok());
 }
 
+// Returns a P4Info with many tables and actions, including invalid and
+// duplicate ones.
+P4Info ManyTablesAndActions() {
+  P4Info p4_info;
+  for (int i = 0; i < 100; ++i) {
+    p4::config::v1::Table& table = *p4_info.add_tables();
+    // Every 10th table reuses the ID of its predecessor.
+    table.mutable_preamble()->set_id(i % 10 == 9 ? i - 1 : i);
+    table.mutable_preamble()->set_name(absl::StrCat("table_", i));
+    table.mutable_preamble()->add_annotations(
+        i % 7 == 3
+            ? absl::StrCat("@entry_restriction(\"unknown_", i, " != 0\")")
+            : "@entry_restriction(\"key::mask != 0 -> key == 1\")");
+    p4::config::v1::MatchField& key = *table.add_match_fields();
+    key.set_id(1);
+    key.set_name("key");
+    key.set_bitwidth(16);
+    key.set_match_type(p4::config::v1::MatchField::TERNARY);
+
+    p4::config::v1::Action& action = *p4_info.add_actions();
+    action.mutable_preamble()->set_id(i % 10 == 9 ? 1000 + i - 1 : 1000 + i);
+    action.mutable_preamble()->set_name(absl::StrCat("action_", i));
+    action.mutable_preamble()->add_annotations(
+        i % 5 == 2 ? "@action_restriction(\"param == \")"
+                   : "@action_restriction(\"param != 0\")");
+    p4::config::v1::Action::Param& param = *action.add_params();
+    param.set_id(1);
+    param.set_name("param");
+    param.set_bitwidth(8);
+  }
+  return p4_info;
+}
+
+TEST(P4ToConstraintInfoTest, ParallelTranslationReportsErrorsInOrder) {
+  const P4Info p4_info = ManyTablesAndActions();
+  absl::StatusOr<ConstraintInfo> sequential = P4ToConstraintInfo(p4_info);
+  ASSERT_FALSE(sequential.ok());
+  for (int num_threads : {1, 2, 8}) {
+    absl::StatusOr<ConstraintInfo> parallel =
+        P4ToConstraintInfo(p4_info, num_threads);
+    EXPECT_EQ(parallel.status(), sequential.status())
+        << "num_threads: " << num_threads;
+  }
+}
+
+TEST(P4ToConstraintInfoTest, ParallelTranslationSucceeds) {
+  P4Info p4_info = ManyTablesAndActions();
+  p4_info.clear_tables();
+  p4_info.clear_actions();
+  const P4Info many = ManyTablesAndActions();
+  for (int i = 0; i < many.tables_size(); ++i) {
+    if (i % 10 == 9) continue;
+    if (i % 7 != 3) *p4_info.add_tables() = many.tables(i);
+    if (i % 5 != 2) *p4_info.add_actions() = many.actions(i);
+  }
+  ASSERT_OK_AND_ASSIGN(ConstraintInfo sequential, P4ToConstraintInfo(p4_info));
+  ASSERT_OK_AND_ASSIGN(ConstraintInfo parallel,
+                       P4ToConstraintInfo(p4_info, /*num_threads=*/4));
+  EXPECT_NE(parallel.generation, sequential.generation);
+  ASSERT_EQ(parallel.table_info_by_id.size(),
+            sequential.table_info_by_id.size());
+  ASSERT_EQ(parallel.action_info_by_id.size(),
+            sequential.action_info_by_id.size());
+  for (const auto& [id, table_info] : sequential.table_info_by_id) {
+    const TableInfo* parallel_table_info = GetTableInfoOrNull(parallel, id);
+    ASSERT_NE(parallel_table_info, nullptr);
+    EXPECT_EQ(parallel_table_info->name, table_info.name);
+    ASSERT_NE(parallel_table_info->program, nullptr);
+    EXPECT_EQ(ProgramToString(*parallel_table_info->program),
+              ProgramToString(*table_info.program));
+  }
+  for (const auto& [id, action_info] : sequential.action_info_by_id) {
+    const ActionInfo* parallel_action_info = GetActionInfoOrNull(parallel, id);
+    ASSERT_NE(parallel_action_info, nullptr);
+    EXPECT_EQ(parallel_action_info->name, action_info.name);
+  }
+}
+
+TEST(UpdateConstraintInfoTest, ReusesOnlyUnchangedTablesAndActions) {
+  P4Info p4_info;
+  ASSERT_OK(gutil::ReadProtoFromString(R"pb(
+    tables {
+      preamble {
+        id: 1
+        name: "unchanged_table"
+        annotations: "@entry_restriction(\"key != 0\")"
+      }
+      match_fields { id: 1 name: "key" bitwidth: 8 match_type: EXACT }
+      size: 100
+    }
+    tables {
+      preamble {
+        id: 2
+        name: "changed_table"
+        annotations: "@entry_restriction(\"key != 0\")"
+      }
+      match_fields { id: 1 name: "key" bitwidth: 8 match_type: EXACT }
+    }
+    tables {
+      preamble { id: 3 name: "removed_table" }
+    }
+    actions {
+      preamble {
+        id: 10
+        name: "unchanged_action"
+        annotations: "@action_restriction(\"param != 0\")"
+      }
+      params { id: 1 name: "param" bitwidth: 8 }
+    }
+  )pb",
+                                       &p4_info));
+  ASSERT_OK_AND_ASSIGN(ConstraintInfo old_info, P4ToConstraintInfo(p4_info));
+  const Program* unchanged_program = old_info.table_info_by_id[1].program.get();
+  const Program* changed_program = old_info.table_info_by_id[2].program.get();
+  const Program* action_program = old_info.action_info_by_id[10].program.get();
+
+  // Only the table size (which does not affect constraints) of the unchanged
+  // table changes.
+  p4_info.mutable_tables(0)->set_size(200);
+  p4_info.mutable_tables(1)->mutable_preamble()->set_annotations(
+      0, "@entry_restriction(\"key != 1\")");
+  p4_info.mutable_tables()->RemoveLast();
+  p4::config::v1::Table& added_table = *p4_info.add_tables();
+  added_table.mutable_preamble()->set_id(4);
+  added_table.mutable_preamble()->set_name("added_table");
+
+  ASSERT_OK_AND_ASSIGN(ConstraintInfo expected, P4ToConstraintInfo(p4_info));
+  const uint64_t old_generation = old_info.generation;
+  ASSERT_OK_AND_ASSIGN(ConstraintInfo updated,
+                       UpdateConstraintInfo(std::move(old_info), p4_info));
+  EXPECT_NE(updated.generation, old_generation);
+
+  EXPECT_EQ(updated.table_info_by_id[1].program.get(), unchanged_program);
+  EXPECT_EQ(updated.action_info_by_id[10].program.get(), action_program);
+  EXPECT_NE(updated.table_info_by_id[2].program.get(), changed_program);
+  EXPECT_EQ(updated.table_info_by_id[2].constraint_source.constraint_string,
+            "key != 1");
+  EXPECT_EQ(GetTableInfoOrNull(updated, 3), nullptr);
+  EXPECT_NE(GetTableInfoOrNull(updated, 4), nullptr);
+  EXPECT_EQ(updated.table_info_by_id.size(), expected.table_info_by_id.size());
+  EXPECT_EQ(updated.action_info_by_id.size(),
+            expected.action_info_by_id.size());
+  for (const auto& [id, table_info] : expected.table_info_by_id) {
+    EXPECT_EQ(updated.table_info_by_id[id].fingerprint, table_info.fingerprint);
+  }
+}
+
+TEST(UpdateConstraintInfoTest, DoesNotReuseTablesWhoseFingerprintsCollide) {
+  P4Info p4_info;
+  ASSERT_OK(gutil::ReadProtoFromString(R"pb(
+    tables {
+      preamble {
+        id: 1
+        name: "table"
+        annotations: "@entry_restriction(\"key != 0\")"
+      }
+      match_fields { id: 1 name: "key" bitwidth: 8 match_type: EXACT }
+    }
+  )pb",
+                                       &p4_info));
+  ASSERT_OK_AND_ASSIGN(ConstraintInfo old_info, P4ToConstraintInfo(p4_info));
+  const Program* old_program = old_info.table_info_by_id[1].program.get();
+
+  p4_info.mutable_tables(0)->mutable_preamble()->set_annotations(
+      0, "@entry_restriction(\"key != 1\")");
+  // Simulates a collision of the old and new fingerprints.
+  old_info.table_info_by_id[1].fingerprint =
+      TableFingerprint(p4_info.tables(0));
+  ASSERT_OK_AND_ASSIGN(ConstraintInfo updated,
+                       UpdateConstraintInfo(std::move(old_info), p4_info));
+  EXPECT_NE(updated.table_info_by_id[1].program.get(), old_program);
+  EXPECT_EQ(updated.table_info_by_id[1].constraint_source.constraint_string,
+            "key != 1");
+}
+
+TEST(UpdateConstraintInfoTest, ReportsErrorsLikeP4ToConstraintInfo) {
+  P4Info p4_info = ManyTablesAndActions();
+  p4_info.clear_tables();
+  p4_info.clear_actions();
+  const P4Info many = ManyTablesAndActions();
+  for (int i = 0; i < 50; ++i) {
+    if (i % 10 == 9) continue;
+    if (i % 7 != 3) *p4_info.add_tables() = many.tables(i);
+    if (i % 5 != 2) *p4_info.add_actions() = many.actions(i);
+  }
+  ASSERT_OK_AND_ASSIGN(ConstraintInfo old_info, P4ToConstraintInfo(p4_info));
+  EXPECT_EQ(UpdateConstraintInfo(old_info, many).status(),
+            P4ToConstraintInfo(many).status());
+}
+
 TEST(GetTableInfoOrNullTest, ShouldGetNonNullptrToTableInfo) {
   P4Info p4_info;
 
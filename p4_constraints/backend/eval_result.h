@@ -0,0 +1,95 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+// Runtime representations of the values that constraints are evaluated over.
+
+#ifndef P4_CONSTRAINTS_BACKEND_EVAL_RESULT_H_
+#define P4_CONSTRAINTS_BACKEND_EVAL_RESULT_H_
+
+#include <ostream>
+
+#include "absl/strings/str_format.h"
+#include "absl/types/variant.h"
+#include "p4_constraints/big_int.h"
+
+namespace p4_constraints {
+namespace internal_interpreter {
+
+// -- Runtime representations --------------------------------------------------
+
+// We use p4_constraints::BigInt to represent all integers, including
+// arbitrary-precision and fixed-width signed/unsigned integers.
+
+struct Exact {
+  BigInt value;
+};
+
+// Used to represent both ternary and optional keys at runtime, since an
+// optional key is just a ternary key whose mask is all zeros or all ones.
+struct Ternary {
+  BigInt value;
+  BigInt mask;
+};
+
+struct Lpm {
+  BigInt value;
+  BigInt prefix_length;
+};
+
+struct Range {
+  BigInt low;
+  BigInt high;
+};
+
+// Evaluation can result in a value of various types.
+// We use a tagged union to ease debugging (see DynamicTypeCheck); an untagged
+// union would work just fine assuming the type checker has no bugs.
+using EvalResult = absl::variant<bool, BigInt, Exact, Ternary, Lpm, Range>;
+
+inline bool operator==(const Exact& left, const Exact& right) {
+  return left.value == right.value;
+}
+
+inline bool operator==(const Ternary& left, const Ternary& right) {
+  return left.value == right.value && left.mask == right.mask;
+}
+
+inline bool operator==(const Lpm& left, const Lpm& right) {
+  return left.value == right.value && left.prefix_length == right.prefix_length;
+}
+
+inline bool operator==(const Range& left, const Range& right) {
+  return left.low == right.low && left.high == right.high;
+}
+
+inline std::ostream& operator<<(std::ostream& os, const BigInt& integer) {
+  return os << BigIntToString(integer);
+}
+
+inline std::ostream& operator<<(std::ostream& os, const Exact& exact) {
+  return os << absl::StrFormat("Exact{.value = %s}",
+                               BigIntToString(exact.value));
+}
+
+inline std::ostream& operator<<(std::ostream& os, const Ternary& ternary) {
+  return os << absl::StrFormat("Ternary{.value = %s, .mask = %s}",
+                               BigIntToString(ternary.value),
+                               BigIntToString(ternary.mask));
+}
+
+inline std::ostream& operator<<(std::ostream& os, const Lpm& lpm) {
+  return os << absl::StrFormat("Lpm{.value = %s, .prefix_length = %s}",
+                               BigIntToString(lpm.value),
+                               BigIntToString(lpm.prefix_length));
+}
+
+inline std::ostream& operator<<(std::ostream& os, const Range& range) {
+  return os << absl::StrFormat("Range{.low = %s, .high = %s}",
+                               BigIntToString(range.low),
+                               BigIntToString(range.high));
+}
+
+}  // namespace internal_interpreter
+}  // namespace p4_constraints
+
+#endif  // P4_CONSTRAINTS_BACKEND_EVAL_RESULT_H_
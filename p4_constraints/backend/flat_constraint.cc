@@ -0,0 +1,172 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "p4_constraints/backend/flat_constraint.h"
+
+#include <string>
+#include <tuple>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "p4_constraints/ast.h"
+#include "p4_constraints/ast.pb.h"
+#include "p4_constraints/backend/constant_pool.h"
+
+namespace p4_constraints {
+
+namespace {
+
+using ::p4_constraints::ast::Expression;
+using ::p4_constraints::ast::Type;
+
+// Identifies the value of a node, up to structural identity: its kind, type
+// (case, bitwidth, and name, see `UnsupportedTypeName`), payload (constant,
+// name, field, or attribute), binary operator, and the values of its operands.
+// The strings point into the constraint, so building a key does not allocate.
+using ValueKey = std::tuple<int, int, int, absl::string_view,
+                            absl::string_view, int, int, int>;
+using ValueByKey = absl::flat_hash_map<ValueKey, int>;
+
+// Returns the slot of `name` in `slot_by_name`, or -1 if there is none.
+int FindSlot(const absl::flat_hash_map<std::string, int>* slot_by_name,
+             absl::string_view name) {
+  if (slot_by_name == nullptr) return -1;
+  auto it = slot_by_name->find(name);
+  return it == slot_by_name->end() ? -1 : it->second;
+}
+
+// Returns the name of unsupported types, which are told apart by it. Other
+// types are identified by their case and bitwidth.
+absl::string_view UnsupportedTypeName(const Type& type) {
+  if (type.type_case() != Type::kUnsupported) return "";
+  return type.unsupported().name();
+}
+
+// Returns the payload of the node of `expr`: its constant, name, field, or
+// attribute, if any.
+absl::string_view Payload(const Expression& expr) {
+  switch (expr.expression_case()) {
+    case Expression::kBooleanConstant:
+      return expr.boolean_constant() ? "true" : "false";
+    case Expression::kIntegerConstant:
+      return expr.integer_constant();
+    case Expression::kKey:
+      return expr.key();
+    case Expression::kActionParameter:
+      return expr.action_parameter();
+    case Expression::kAttributeAccess:
+      return expr.attribute_access().attribute_name();
+    case Expression::kFieldAccess:
+      return expr.field_access().field();
+    default:
+      return "";
+  }
+}
+
+// Appends the nodes of `expr` to `flat` in post-order and returns the id of
+// the node of `expr`, resolving its integer constants in `constant_pool`, if
+// given. `value_by_key` holds the values of the nodes so far.
+int Flatten(const Expression& expr, const ConstantPool* constant_pool,
+            FlatConstraint& flat, ValueByKey& value_by_key) {
+  FlatNode node{
+      .expr = &expr,
+      .kind = expr.expression_case(),
+      .first = static_cast<int>(flat.nodes.size()),
+  };
+  switch (expr.expression_case()) {
+    case Expression::kKey:
+      node.slot = FindSlot(flat.slot_by_name, expr.key());
+      break;
+    case Expression::kActionParameter:
+      node.slot = FindSlot(flat.slot_by_name, expr.action_parameter());
+      break;
+    case Expression::kAttributeAccess:
+      node.attribute =
+          ParseAttributeId(expr.attribute_access().attribute_name());
+      break;
+    case Expression::kBooleanNegation:
+      node.operand = Flatten(expr.boolean_negation(), constant_pool, flat,
+                             value_by_key);
+      node.size = 1 + flat.nodes[node.operand].size;
+      break;
+    case Expression::kArithmeticNegation:
+      node.operand = Flatten(expr.arithmetic_negation(), constant_pool, flat,
+                             value_by_key);
+      break;
+    case Expression::kTypeCast:
+      node.operand =
+          Flatten(expr.type_cast(), constant_pool, flat, value_by_key);
+      break;
+    case Expression::kBinaryExpression:
+      node.binop = expr.binary_expression().binop();
+      node.operand = Flatten(expr.binary_expression().left(), constant_pool,
+                             flat, value_by_key);
+      node.right = Flatten(expr.binary_expression().right(), constant_pool,
+                           flat, value_by_key);
+      node.size =
+          1 + flat.nodes[node.operand].size + flat.nodes[node.right].size;
+      break;
+    case Expression::kFieldAccess:
+      node.field = ParseFieldSelector(expr.field_access().field());
+      node.operand = Flatten(expr.field_access().expr(), constant_pool, flat,
+                             value_by_key);
+      break;
+    case Expression::kIntegerConstant:
+      if (constant_pool != nullptr) {
+        node.literal = FindLiteral(*constant_pool, expr.integer_constant());
+      }
+      break;
+    case Expression::kBooleanConstant:
+    case Expression::EXPRESSION_NOT_SET:
+      break;
+  }
+  const int id = flat.nodes.size();
+  const ValueKey key = {
+      expr.expression_case(),
+      expr.type().type_case(),
+      ast::TypeBitwidth(expr.type()).value_or(-1),
+      UnsupportedTypeName(expr.type()),
+      Payload(expr),
+      node.binop,
+      node.operand < 0 ? -1 : flat.nodes[node.operand].value,
+      node.right < 0 ? -1 : flat.nodes[node.right].value,
+  };
+  auto [it, inserted] = value_by_key.try_emplace(key, id);
+  if (inserted) ++flat.num_values;
+  node.value = it->second;
+  flat.nodes.push_back(node);
+  return id;
+}
+
+}  // namespace
+
+FieldSelector ParseFieldSelector(absl::string_view field) {
+  if (field == "value") return FieldSelector::kValue;
+  if (field == "mask") return FieldSelector::kMask;
+  if (field == "prefix_length") return FieldSelector::kPrefixLength;
+  if (field == "low") return FieldSelector::kLow;
+  if (field == "high") return FieldSelector::kHigh;
+  return FieldSelector::kUnknown;
+}
+
+AttributeId ParseAttributeId(absl::string_view attribute_name) {
+  if (attribute_name == "priority") return AttributeId::kPriority;
+  return AttributeId::kUnknown;
+}
+
+FlatConstraint FlattenConstraint(
+    const ast::Expression& constraint,
+    const absl::flat_hash_map<std::string, int>* slot_by_name,
+    const ConstantPool* constant_pool) {
+  FlatConstraint flat{.slot_by_name = slot_by_name};
+  ValueByKey value_by_key;
+  Flatten(constraint, constant_pool, flat, value_by_key);
+  return flat;
+}
+
+double DedupRatio(const FlatConstraint& constraint) {
+  if (constraint.num_values == 0) return 1;
+  return static_cast<double>(constraint.nodes.size()) / constraint.num_values;
+}
+
+}  // namespace p4_constraints
@@ -0,0 +1,124 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+// The flat form of a constraint is the evaluation-oriented counterpart of its
+// AST, used by the interpreter (see interpreter.h). It holds the nodes of the
+// AST in a contiguous array in post-order, so that each node is identified by
+// a dense id (its index) and can be memoized in vectors indexed by id rather
+// than in maps keyed by pointers into the AST. Everything that the interpreter
+// would otherwise look up by name per entry is resolved when flattening: the
+// fields of field accesses, the attributes of attribute accesses, the slots of
+// keys and action parameters, and the sizes of subexpressions.
+//
+// Flattening also hash-conses the subexpressions of a constraint: nodes whose
+// subexpressions are structurally identical (e.g. the atom `is_ipv4 == 1`
+// occurring in several clauses) are assigned the same value, so that results
+// memoized for one are reused for all. The nodes themselves stay distinct, as
+// they differ in their source locations, which explanations quote.
+//
+// Since subtree sizes and ranges are precomputed, explaining a violation (see
+// `MinimalSubexpressionLeadingToEvalResult`) needs no per-call bookkeeping
+// beyond the evaluation cache.
+
+#ifndef P4_CONSTRAINTS_BACKEND_FLAT_CONSTRAINT_H_
+#define P4_CONSTRAINTS_BACKEND_FLAT_CONSTRAINT_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "p4_constraints/ast.pb.h"
+#include "p4_constraints/backend/constant_pool.h"
+#include "p4_constraints/big_int.h"
+
+namespace p4_constraints {
+
+// The field of a field access, e.g. `mask` in `k::mask`.
+enum class FieldSelector : uint8_t {
+  kUnknown,  // Not a field of any composite value.
+  kValue,
+  kMask,
+  kPrefixLength,
+  kLow,
+  kHigh,
+};
+
+// The attribute of an attribute access, e.g. `priority` in `::priority`.
+enum class AttributeId : uint8_t {
+  kUnknown,
+  kPriority,
+};
+
+// Returns the selector (resp. ID) of the given field (resp. attribute) name.
+FieldSelector ParseFieldSelector(absl::string_view field);
+AttributeId ParseAttributeId(absl::string_view attribute_name);
+
+struct FlatNode {
+  // The AST node, for its type, source location, and payload. Its children are
+  // the nodes `operand` and `right`.
+  const ast::Expression* expr = nullptr;
+  ast::Expression::ExpressionCase kind = ast::Expression::EXPRESSION_NOT_SET;
+  // The id of the only operand of negations, casts, and field accesses, resp.
+  // of the left operand of binary expressions; -1 for leaves.
+  int operand = -1;
+  // The id of the right operand of binary expressions, -1 otherwise.
+  int right = -1;
+  // Only meaningful for the respective kinds of nodes.
+  ast::BinaryOperator binop = ast::BinaryOperator::UNKNOWN_OPERATOR;
+  FieldSelector field = FieldSelector::kUnknown;
+  AttributeId attribute = AttributeId::kUnknown;
+  // The slot of the key or action parameter (see `EntryLayout` in
+  // constraint_info.h), or -1 if unknown.
+  int slot = -1;
+  // The value of the integer constant in the constant pool, or null if unknown.
+  const BigInt* literal = nullptr;
+  // The size of the subexpression rooted at the node: 1 plus the sizes of the
+  // operands for Boolean negations and binary expressions, and 1 for all other
+  // nodes, which evaluate to a single value (like `ast::Size`).
+  int size = 1;
+  // The id of the first node of the subtree rooted at this node. As nodes are
+  // in post-order, the subtree consists of the nodes `first` through this one,
+  // so e.g. its keys and action parameters are found by a scan of that range.
+  int first = -1;
+  // The id of the first node whose subexpression is structurally identical to
+  // the one rooted at this node, which may be the node itself. Nodes with the
+  // same value evaluate to the same result on every entry.
+  int value = -1;
+};
+
+struct FlatConstraint {
+  // The nodes, in post-order: the operands of a node precede it, and the root
+  // comes last.
+  std::vector<FlatNode> nodes;
+  // The `EntryLayout::slot_by_name` that the slots of the nodes refer to, or
+  // null if none was given. Entries laid out differently fall back to looking
+  // up keys and action parameters by name.
+  const absl::flat_hash_map<std::string, int>* slot_by_name = nullptr;
+  // The number of distinct values of the nodes.
+  int num_values = 0;
+};
+
+// Returns the id of the root of `constraint`.
+inline int RootNode(const FlatConstraint& constraint) {
+  return static_cast<int>(constraint.nodes.size()) - 1;
+}
+
+// Returns the number of nodes of `constraint` per distinct value, which is 1 if
+// no subexpression is repeated and grows with the share of repeated ones.
+double DedupRatio(const FlatConstraint& constraint);
+
+// Flattens the type-checked `constraint`, resolving the slots of its keys and
+// action parameters in `slot_by_name`, resp. the values of its integer
+// constants in `constant_pool`, if given. The result points into `constraint`
+// (resp. `slot_by_name` and `constant_pool`), which must outlive it.
+FlatConstraint FlattenConstraint(
+    const ast::Expression& constraint,
+    const absl::flat_hash_map<std::string, int>* slot_by_name = nullptr,
+    const ConstantPool* constant_pool = nullptr);
+
+}  // namespace p4_constraints
+
+#endif  // P4_CONSTRAINTS_BACKEND_FLAT_CONSTRAINT_H_
@@ -0,0 +1,264 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "p4_constraints/backend/flat_constraint.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "gutil/status_matchers.h"
+#include "gutil/testing.h"
+#include "p4_constraints/ast.pb.h"
+#include "p4_constraints/backend/constant_pool.h"
+#include "p4_constraints/big_int.h"
+
+namespace p4_constraints {
+namespace {
+
+using ::gutil::ParseProtoOrDie;
+using ::p4_constraints::ast::Expression;
+using ::testing::ElementsAre;
+using ::testing::Field;
+
+// !(k::mask == 0) && ::priority > 1
+constexpr char kConstraint[] = R"pb(
+  binary_expression {
+    binop: AND
+    left {
+      boolean_negation {
+        binary_expression {
+          binop: EQ
+          left {
+            field_access {
+              field: "mask"
+              expr { key: "k" }
+            }
+          }
+          right { integer_constant: "0" }
+        }
+      }
+    }
+    right {
+      binary_expression {
+        binop: GT
+        left { attribute_access { attribute_name: "priority" } }
+        right { integer_constant: "1" }
+      }
+    }
+  }
+)pb";
+
+TEST(FlattenConstraintTest, NodesAreInPostOrder) {
+  const Expression constraint = ParseProtoOrDie<Expression>(kConstraint);
+  const FlatConstraint flat = FlattenConstraint(constraint);
+  EXPECT_THAT(flat.nodes,
+              ElementsAre(Field(&FlatNode::kind, Expression::kKey),
+                          Field(&FlatNode::kind, Expression::kFieldAccess),
+                          Field(&FlatNode::kind, Expression::kIntegerConstant),
+                          Field(&FlatNode::kind, Expression::kBinaryExpression),
+                          Field(&FlatNode::kind, Expression::kBooleanNegation),
+                          Field(&FlatNode::kind, Expression::kAttributeAccess),
+                          Field(&FlatNode::kind, Expression::kIntegerConstant),
+                          Field(&FlatNode::kind, Expression::kBinaryExpression),
+                          Field(&FlatNode::kind,
+                                Expression::kBinaryExpression)));
+  ASSERT_EQ(RootNode(flat), 8);
+  EXPECT_EQ(flat.nodes[8].expr, &constraint);
+  EXPECT_EQ(flat.nodes[8].binop, ast::AND);
+  EXPECT_EQ(flat.nodes[8].operand, 4);
+  EXPECT_EQ(flat.nodes[8].right, 7);
+  EXPECT_EQ(flat.nodes[4].operand, 3);
+  EXPECT_EQ(flat.nodes[3].operand, 1);
+  EXPECT_EQ(flat.nodes[3].right, 2);
+  EXPECT_EQ(flat.nodes[1].operand, 0);
+  EXPECT_EQ(flat.nodes[0].expr,
+            &constraint.binary_expression()
+                 .left()
+                 .boolean_negation()
+                 .binary_expression()
+                 .left()
+                 .field_access()
+                 .expr());
+}
+
+TEST(FlattenConstraintTest, SizesCountBooleanStructure) {
+  const FlatConstraint flat =
+      FlattenConstraint(ParseProtoOrDie<Expression>(kConstraint));
+  EXPECT_THAT(flat.nodes, ElementsAre(Field(&FlatNode::size, 1),
+                                      Field(&FlatNode::size, 1),
+                                      Field(&FlatNode::size, 1),
+                                      Field(&FlatNode::size, 3),
+                                      Field(&FlatNode::size, 4),
+                                      Field(&FlatNode::size, 1),
+                                      Field(&FlatNode::size, 1),
+                                      Field(&FlatNode::size, 3),
+                                      Field(&FlatNode::size, 8)));
+}
+
+TEST(FlattenConstraintTest, SubtreesAreContiguousRanges) {
+  const FlatConstraint flat =
+      FlattenConstraint(ParseProtoOrDie<Expression>(kConstraint));
+  EXPECT_THAT(flat.nodes, ElementsAre(Field(&FlatNode::first, 0),
+                                      Field(&FlatNode::first, 0),
+                                      Field(&FlatNode::first, 2),
+                                      Field(&FlatNode::first, 0),
+                                      Field(&FlatNode::first, 0),
+                                      Field(&FlatNode::first, 5),
+                                      Field(&FlatNode::first, 6),
+                                      Field(&FlatNode::first, 5),
+                                      Field(&FlatNode::first, 0)));
+}
+
+TEST(FlattenConstraintTest, ResolvesFieldsAttributesAndSlots) {
+  const Expression constraint = ParseProtoOrDie<Expression>(kConstraint);
+  const absl::flat_hash_map<std::string, int> slot_by_name = {{"j", 0},
+                                                              {"k", 1}};
+  const FlatConstraint flat = FlattenConstraint(constraint, &slot_by_name);
+  EXPECT_EQ(flat.slot_by_name, &slot_by_name);
+  EXPECT_EQ(flat.nodes[0].slot, 1);
+  EXPECT_EQ(flat.nodes[1].field, FieldSelector::kMask);
+  EXPECT_EQ(flat.nodes[5].attribute, AttributeId::kPriority);
+
+  EXPECT_EQ(FlattenConstraint(constraint).nodes[0].slot, -1);
+  const absl::flat_hash_map<std::string, int> other_slots = {{"j", 0}};
+  EXPECT_EQ(FlattenConstraint(constraint, &other_slots).nodes[0].slot, -1);
+}
+
+TEST(FlattenConstraintTest, ResolvesLiteralsInConstantPool) {
+  const Expression constraint = ParseProtoOrDie<Expression>(kConstraint);
+  ASSERT_OK_AND_ASSIGN(const ConstantPool pool, BuildConstantPool(constraint));
+  const FlatConstraint flat =
+      FlattenConstraint(constraint, /*slot_by_name=*/nullptr, &pool);
+  EXPECT_EQ(flat.nodes[2].literal, FindLiteral(pool, "0"));
+  EXPECT_EQ(flat.nodes[6].literal, FindLiteral(pool, "1"));
+  ASSERT_NE(flat.nodes[6].literal, nullptr);
+  EXPECT_EQ(*flat.nodes[6].literal, BigInt(1));
+  EXPECT_EQ(flat.nodes[0].literal, nullptr);
+
+  EXPECT_EQ(FlattenConstraint(constraint).nodes[2].literal, nullptr);
+}
+
+TEST(FlattenConstraintTest, IdenticalSubexpressionsShareValues) {
+  // k::mask == 0 || (k::mask == 0 && 0 == k::mask), where the last 0 is typed.
+  const Expression constraint = ParseProtoOrDie<Expression>(R"pb(
+    binary_expression {
+      binop: OR
+      left {
+        binary_expression {
+          binop: EQ
+          left { field_access { field: "mask" expr { key: "k" } } }
+          right { integer_constant: "0" }
+        }
+      }
+      right {
+        binary_expression {
+          binop: AND
+          left {
+            binary_expression {
+              binop: EQ
+              left { field_access { field: "mask" expr { key: "k" } } }
+              right { integer_constant: "0" }
+            }
+          }
+          right {
+            binary_expression {
+              binop: EQ
+              left {
+                type { fixed_unsigned { bitwidth: 8 } }
+                integer_constant: "0"
+              }
+              right { field_access { field: "mask" expr { key: "k" } } }
+            }
+          }
+        }
+      }
+    }
+  )pb");
+  const FlatConstraint flat = FlattenConstraint(constraint);
+  ASSERT_EQ(flat.nodes.size(), 14);
+  // The first atom: k, k::mask, 0, and k::mask == 0.
+  for (int node = 0; node < 4; ++node) EXPECT_EQ(flat.nodes[node].value, node);
+  // The repetition of the first atom.
+  for (int node = 4; node < 8; ++node) {
+    EXPECT_EQ(flat.nodes[node].value, node - 4);
+  }
+  // The constant of the last atom differs in type, so the atom is distinct.
+  EXPECT_EQ(flat.nodes[8].value, 8);
+  EXPECT_EQ(flat.nodes[9].value, 0);
+  EXPECT_EQ(flat.nodes[10].value, 1);
+  EXPECT_EQ(flat.nodes[11].value, 11);
+  EXPECT_EQ(flat.nodes[12].value, 12);
+  EXPECT_EQ(flat.nodes[13].value, 13);
+  EXPECT_EQ(flat.num_values, 8);
+  EXPECT_DOUBLE_EQ(DedupRatio(flat), 14.0 / 8);
+}
+
+TEST(FlattenConstraintTest, TypesAreToldApartByKindAndBitwidth) {
+  // 1 == 1 || 1 == 1, where the constants are of type bit<8> and bit<16>
+  // (resp. bit<8> and Exact<8>).
+  const Expression constraint = ParseProtoOrDie<Expression>(R"pb(
+    binary_expression {
+      binop: OR
+      left {
+        binary_expression {
+          binop: EQ
+          left {
+            type { fixed_unsigned { bitwidth: 8 } }
+            integer_constant: "1"
+          }
+          right {
+            type { fixed_unsigned { bitwidth: 16 } }
+            integer_constant: "1"
+          }
+        }
+      }
+      right {
+        binary_expression {
+          binop: EQ
+          left {
+            type { fixed_unsigned { bitwidth: 8 } }
+            integer_constant: "1"
+          }
+          right {
+            type { exact { bitwidth: 8 } }
+            integer_constant: "1"
+          }
+        }
+      }
+    }
+  )pb");
+  const FlatConstraint flat = FlattenConstraint(constraint);
+  ASSERT_EQ(flat.nodes.size(), 7);
+  EXPECT_EQ(flat.nodes[0].value, 0);
+  EXPECT_EQ(flat.nodes[1].value, 1);
+  EXPECT_EQ(flat.nodes[3].value, 0);
+  EXPECT_EQ(flat.nodes[4].value, 4);
+  EXPECT_EQ(flat.num_values, 6);
+}
+
+TEST(FlattenConstraintTest, DistinctSubexpressionsHaveDistinctValues) {
+  const FlatConstraint flat =
+      FlattenConstraint(ParseProtoOrDie<Expression>(kConstraint));
+  for (int node = 0; node < flat.nodes.size(); ++node) {
+    EXPECT_EQ(flat.nodes[node].value, node);
+  }
+  EXPECT_EQ(flat.num_values, flat.nodes.size());
+  EXPECT_DOUBLE_EQ(DedupRatio(flat), 1);
+}
+
+TEST(ParseFieldSelectorTest, Works) {
+  EXPECT_EQ(ParseFieldSelector("value"), FieldSelector::kValue);
+  EXPECT_EQ(ParseFieldSelector("mask"), FieldSelector::kMask);
+  EXPECT_EQ(ParseFieldSelector("prefix_length"), FieldSelector::kPrefixLength);
+  EXPECT_EQ(ParseFieldSelector("low"), FieldSelector::kLow);
+  EXPECT_EQ(ParseFieldSelector("high"), FieldSelector::kHigh);
+  EXPECT_EQ(ParseFieldSelector("bogus"), FieldSelector::kUnknown);
+  EXPECT_EQ(ParseAttributeId("priority"), AttributeId::kPriority);
+  EXPECT_EQ(ParseAttributeId("bogus"), AttributeId::kUnknown);
+}
+
+}  // namespace
+}  // namespace p4_constraints
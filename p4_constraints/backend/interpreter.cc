@@ -18,13 +18,17 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <algorithm>
+#include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <variant>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
-#include "absl/container/flat_hash_set.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/functional/function_ref.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/meta/type_traits.h"
@@ -32,17 +36,20 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
-#include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/variant.h"
-#include "gutil/ordered_map.h"
 #include "gutil/overload.h"
 #include "gutil/status.h"
 #include "p4/v1/p4runtime.pb.h"
 #include "p4_constraints/ast.h"
 #include "p4_constraints/ast.pb.h"
+#include "p4_constraints/backend/constant_pool.h"
 #include "p4_constraints/backend/constraint_info.h"
 #include "p4_constraints/backend/errors.h"
+#include "p4_constraints/backend/eval_result.h"
+#include "p4_constraints/backend/flat_constraint.h"
+#include "p4_constraints/backend/program.h"
+#include "p4_constraints/backend/vm.h"
 #include "p4_constraints/big_int.h"
 #include "p4_constraints/constraint_source.h"
 #include "p4_constraints/quote.h"
@@ -102,9 +109,9 @@ std::string EvalResultToString(const EvalResult& result) {
 
 // -- Parsing P4RT table entries -----------------------------------------------
 
-BigInt ParseP4RTInteger(std::string int_str) {
-  // Remove leading zero-bits, allowing for non-canonical bytestrings.
-  int_str.erase(0, int_str.find_first_not_of('\0'));
+BigInt ParseP4RTInteger(absl::string_view int_str) {
+  // Leading zero-bytes do not contribute to the value, allowing for
+  // non-canonical bytestrings.
   return ParseBigEndianBytes(int_str);
 }
 
@@ -113,176 +120,349 @@ static BigInt MaxValueForBitwidth(int bitwidth) {
   return (BigInt(1) << bitwidth) - BigInt(1);
 }
 
-// Returns (table key name, table key value)-pair.
-absl::StatusOr<std::pair<std::string, EvalResult>> ParseKey(
-    const p4::v1::FieldMatch& p4field, const TableInfo& table_info) {
+// Returns the slot and info of the table key matched by `p4field`, after
+// checking that the match is consistent with the type of the key. Does not
+// convert the matched values, see `ParseKeyValue`.
+absl::StatusOr<std::pair<int, const KeyInfo*>> FindMatchedKey(
+    const p4::v1::FieldMatch& p4field, const TableInfo& table_info,
+    const EntryLayout& layout) {
   auto it = table_info.keys_by_id.find(p4field.field_id());
-  if (it == table_info.keys_by_id.end()) {
+  auto slot = layout.slot_by_id.find(p4field.field_id());
+  if (it == table_info.keys_by_id.end() || slot == layout.slot_by_id.end()) {
     return gutil::InvalidArgumentErrorBuilder()
            << "unknown table key with ID " << P4IDToString(p4field.field_id());
   }
   const KeyInfo& key = it->second;
 
   switch (p4field.field_match_type_case()) {
-    case p4::v1::FieldMatch::kExact: {
+    case p4::v1::FieldMatch::kExact:
       RET_CHECK_EQ(key.type.type_case(), Type::kExact)
           << "P4RT table entry inconsistent with P4 program";
-      BigInt value = ParseP4RTInteger(p4field.exact().value());
-      return {std::make_pair(key.name, Exact{.value = value})};
-    }
-
-    case p4::v1::FieldMatch::kTernary: {
+      break;
+    case p4::v1::FieldMatch::kTernary:
       RET_CHECK_EQ(key.type.type_case(), Type::kTernary)
           << "P4RT table entry inconsistent with P4 program";
-      BigInt value = ParseP4RTInteger(p4field.ternary().value());
-      BigInt mask = ParseP4RTInteger(p4field.ternary().mask());
-      return {std::make_pair(key.name, Ternary{.value = value, .mask = mask})};
-    }
-
-    case p4::v1::FieldMatch::kLpm: {
+      break;
+    case p4::v1::FieldMatch::kLpm:
       RET_CHECK_EQ(key.type.type_case(), Type::kLpm)
           << "P4RT table entry inconsistent with P4 program";
-      BigInt value = ParseP4RTInteger(p4field.lpm().value());
-      BigInt prefix_len = BigInt(p4field.lpm().prefix_len());
-      return {std::make_pair(key.name,
-                             Lpm{.value = value, .prefix_length = prefix_len})};
-    }
-
-    case p4::v1::FieldMatch::kRange: {
+      break;
+    case p4::v1::FieldMatch::kRange:
       RET_CHECK_EQ(key.type.type_case(), Type::kRange)
           << "P4RT table entry inconsistent with P4 program";
-
-      BigInt low = ParseP4RTInteger(p4field.range().low());
-      BigInt high = ParseP4RTInteger(p4field.range().high());
-      return {std::make_pair(key.name, Range{.low = low, .high = high})};
-    }
-
-    case p4::v1::FieldMatch::kOptional: {
+      break;
+    case p4::v1::FieldMatch::kOptional:
       RET_CHECK_EQ(key.type.type_case(), Type::kOptionalMatch)
           << "P4RT table entry inconsistent with P4 program";
-      BigInt value = ParseP4RTInteger(p4field.optional().value());
-      return {std::make_pair(
-          key.name, Ternary{.value = value,
-                            .mask = MaxValueForBitwidth(
-                                key.type.optional_match().bitwidth())})};
-    }
-
+      break;
     default:
       return gutil::InvalidArgumentErrorBuilder()
              << "unsupported P4RT field match type "
              << p4field.field_match_type_case();
   }
+  return std::make_pair(slot->second, &key);
 }
 
-absl::StatusOr<EvaluationContext> ParseTableEntry(
-    const p4::v1::TableEntry& entry, const TableInfo& table_info) {
-  absl::flat_hash_map<std::string, EvalResult> keys;
+// Converts the value(s) matched by `p4field` on `key`. The match must have
+// been checked by `FindMatchedKey`.
+EvalResult ParseKeyValue(const p4::v1::FieldMatch& p4field,
+                         const KeyInfo& key) {
+  switch (p4field.field_match_type_case()) {
+    case p4::v1::FieldMatch::kExact:
+      return Exact{.value = ParseP4RTInteger(p4field.exact().value())};
+    case p4::v1::FieldMatch::kTernary:
+      return Ternary{.value = ParseP4RTInteger(p4field.ternary().value()),
+                     .mask = ParseP4RTInteger(p4field.ternary().mask())};
+    case p4::v1::FieldMatch::kLpm:
+      return Lpm{.value = ParseP4RTInteger(p4field.lpm().value()),
+                 .prefix_length = BigInt(p4field.lpm().prefix_len())};
+    case p4::v1::FieldMatch::kRange:
+      return Range{.low = ParseP4RTInteger(p4field.range().low()),
+                   .high = ParseP4RTInteger(p4field.range().high())};
+    default:  // p4::v1::FieldMatch::kOptional
+      return Ternary{
+          .value = ParseP4RTInteger(p4field.optional().value()),
+          .mask = MaxValueForBitwidth(key.type.optional_match().bitwidth())};
+  }
+}
 
-  // Parse all keys that are explicitly present.
+absl::Status ParseTableEntryInto(const p4::v1::TableEntry& entry,
+                                const TableInfo& table_info,
+                                ParsedValues parsed_values,
+                                TableEntry& table_entry) {
+  table_entry.layout = table_info.key_layout;
+  if (table_entry.layout == nullptr) {
+    table_entry.layout =
+        std::make_shared<const EntryLayout>(MakeKeyLayout(table_info));
+  }
+  const EntryLayout& layout = *table_entry.layout;
+  const int num_keys = layout.names.size();
+  table_entry.table_name = table_info.name;
+  table_entry.priority = entry.priority();
+  table_entry.parsed_values = parsed_values;
+  auto is_parsed = [&](int slot) {
+    return parsed_values == ParsedValues::kAll || IsReferenced(layout, slot);
+  };
+  // Every slot is overwritten below, unless the key is not parsed.
+  std::vector<EvalResult>& keys = table_entry.keys;
+  keys.resize(num_keys);
+  absl::InlinedVector<bool, 64> present(num_keys, false);
+
+  // Parse all keys that are explicitly present. Keys that are not parsed are
+  // validated, but their values are not converted.
   for (const p4::v1::FieldMatch& field : entry.match()) {
-    ASSIGN_OR_RETURN(auto kv, ParseKey(field, table_info));
-    auto result = keys.insert(kv);
-    if (result.second == false) {
+    ASSIGN_OR_RETURN(auto slot_and_key,
+                     FindMatchedKey(field, table_info, layout));
+    auto [slot, key] = slot_and_key;
+    if (present[slot]) {
       return gutil::InvalidArgumentErrorBuilder()
-             << "duplicate match on key " << kv.first << " with ID "
+             << "duplicate match on key " << layout.names[slot] << " with ID "
              << P4IDToString(field.field_id());
     }
+    present[slot] = true;
+    if (is_parsed(slot)) keys[slot] = ParseKeyValue(field, *key);
   }
 
   // Use default value for omitted keys.
-  // See Section 9.1.1. of the P4Runtime specification.
-  for (const auto& [name, key_info] : table_info.keys_by_name) {
-    if (keys.contains(name)) continue;
-    switch (key_info.type.type_case()) {
-      case ast::Type::kExact:
-        return gutil::InvalidArgumentErrorBuilder()
-               << "missing exact match key '" << key_info.name << "'";
-      case ast::Type::kTernary:
-      case ast::Type::kOptionalMatch:
-        keys[name] = Ternary{};
-        continue;
-      case ast::Type::kLpm:
-        keys[name] = Lpm{};
-        continue;
-      case ast::Type::kRange:
-        keys[name] = Range{
-            .low = BigInt(0),
-            .high = MaxValueForBitwidth(key_info.type.range().bitwidth()),
-        };
-        continue;
-      case ast::Type::kBoolean:
-      case ast::Type::kArbitraryInt:
-      case ast::Type::kFixedUnsigned:
-      case ast::Type::kUnknown:
-      case ast::Type::kUnsupported:
-      case ast::Type::TYPE_NOT_SET:
-        break;
+  // See Section 9.1.1. of the P4Runtime specification.
+  for (int slot = 0; slot < num_keys; ++slot) {
+    if (present[slot]) continue;
+    if (layout.default_values[slot].has_value()) {
+      if (is_parsed(slot)) keys[slot] = *layout.default_values[slot];
+      continue;
+    }
+    const std::string& name = layout.names[slot];
+    const KeyInfo& key_info = table_info.keys_by_name.at(name);
+    if (key_info.type.type_case() == ast::Type::kExact) {
+      return gutil::InvalidArgumentErrorBuilder()
+             << "missing exact match key '" << name << "'";
     }
     return gutil::InternalErrorBuilder()
-           << "Key '" << key_info.name
+           << "Key '" << name
            << "' of invalid match type detected at runtime: "
            << key_info.type.DebugString();
   }
+  return absl::OkStatus();
+}
 
-  TableEntry table_entry{
-      .table_name = table_info.name,
-      .priority = entry.priority(),
-      .keys = std::move(keys),
-  };
-
+absl::StatusOr<EvaluationContext> ParseTableEntry(
+    const p4::v1::TableEntry& entry, const TableInfo& table_info) {
+  TableEntry table_entry;
+  RETURN_IF_ERROR(
+      ParseTableEntryInto(entry, table_info, ParsedValues::kAll, table_entry));
   return EvaluationContext{
       .constraint_context = std::move(table_entry),
       .constraint_source = table_info.constraint_source,
+      .constant_pool = table_info.constant_pool.get(),
   };
 }
 
-absl::StatusOr<EvaluationContext> ParseAction(const p4::v1::Action& action,
-                                              const ActionInfo& action_info) {
-  absl::flat_hash_map<std::string, BigInt> action_parameters;
-
-  // Parse action parameters.
+absl::Status ParseActionInto(const p4::v1::Action& action,
+                             const ActionInfo& action_info,
+                             ParsedValues parsed_values,
+                             ActionInvocation& action_invocation) {
+  action_invocation.layout = action_info.param_layout;
+  if (action_invocation.layout == nullptr) {
+    action_invocation.layout =
+        std::make_shared<const EntryLayout>(MakeParamLayout(action_info));
+  }
+  const EntryLayout& layout = *action_invocation.layout;
+  action_invocation.action_id = action.action_id();
+  action_invocation.action_name = action_info.name;
+  std::vector<std::optional<BigInt>>& action_parameters =
+      action_invocation.action_parameters;
+  action_parameters.assign(layout.names.size(), std::nullopt);
+  absl::InlinedVector<bool, 64> present(layout.names.size(), false);
+
+  // Parse action parameters. Parameters that are not parsed are validated, but
+  // their values are not converted.
   for (const p4::v1::Action_Param& param : action.params()) {
     int32_t param_id = param.param_id();
-    BigInt param_value = ParseP4RTInteger(param.value());
-    auto it = action_info.params_by_id.find(param_id);
-    if (it == action_info.params_by_id.end()) {
+    auto it = layout.slot_by_id.find(param_id);
+    if (it == layout.slot_by_id.end()) {
       return gutil::InvalidArgumentErrorBuilder()
              << "unknown action param with ID " << P4IDToString(param_id);
     }
-    if (action_parameters.contains(it->second.name)) {
+    const int slot = it->second;
+    if (present[slot]) {
       return gutil::InvalidArgumentErrorBuilder()
              << "duplicate action param with ID " << P4IDToString(param_id);
     }
-    action_parameters[it->second.name] = param_value;
+    present[slot] = true;
+    if (parsed_values == ParsedValues::kAll || IsReferenced(layout, slot)) {
+      action_parameters[slot] = ParseP4RTInteger(param.value());
+    }
   }
-  ActionInvocation action_invocation{
-      .action_id = action.action_id(),
-      .action_name = action_info.name,
-      .action_parameters = std::move(action_parameters),
-  };
+  return absl::OkStatus();
+}
+
+absl::StatusOr<EvaluationContext> ParseAction(const p4::v1::Action& action,
+                                              const ActionInfo& action_info) {
+  ActionInvocation action_invocation;
+  RETURN_IF_ERROR(ParseActionInto(action, action_info, ParsedValues::kAll,
+                                  action_invocation));
   return EvaluationContext{
       .constraint_context = std::move(action_invocation),
       .constraint_source = action_info.constraint_source,
+      .constant_pool = action_info.constant_pool.get(),
   };
 }
 
+namespace {
+
+// Returns the slot of the given name in `layout`, or -1 if there is none.
+int FindSlot(const EntryLayout* layout, absl::string_view name) {
+  if (layout == nullptr) return -1;
+  auto it = layout->slot_by_name.find(name);
+  if (it == layout->slot_by_name.end()) return -1;
+  return it->second;
+}
+
+// Returns the slot of the key or action parameter at `node` in entries laid
+// out by `layout`, or -1 if there is none. Uses the slot resolved when
+// flattening if `constraint` was flattened against `layout`.
+int SlotOf(const FlatConstraint& constraint, const FlatNode& node,
+           const EntryLayout* layout, absl::string_view name) {
+  if (layout != nullptr && constraint.slot_by_name == &layout->slot_by_name) {
+    return node.slot;
+  }
+  return FindSlot(layout, name);
+}
+
+// Returns the value of the key in the given slot, or nullptr if there is no
+// such slot or the key was not parsed.
+const EvalResult* KeyAt(const TableEntry& table_entry, int slot) {
+  if (slot < 0 || slot >= table_entry.keys.size()) return nullptr;
+  if (table_entry.parsed_values == ParsedValues::kReferenced &&
+      !IsReferenced(*table_entry.layout, slot)) {
+    return nullptr;
+  }
+  return &table_entry.keys[slot];
+}
+
+// Returns the value of the action parameter in the given slot, or nullptr if
+// there is no such slot or the parameter is missing.
+const BigInt* ActionParameterAt(const ActionInvocation& action_invocation,
+                                int slot) {
+  if (slot < 0 || slot >= action_invocation.action_parameters.size() ||
+      !action_invocation.action_parameters[slot].has_value()) {
+    return nullptr;
+  }
+  return &*action_invocation.action_parameters[slot];
+}
+
+// Assigns slots to the given names in order.
+std::shared_ptr<const EntryLayout> LayoutOfNames(
+    std::vector<std::string> names) {
+  EntryLayout layout;
+  layout.names = std::move(names);
+  std::sort(layout.names.begin(), layout.names.end());
+  for (int slot = 0; slot < layout.names.size(); ++slot) {
+    layout.slot_by_name[layout.names[slot]] = slot;
+  }
+  return std::make_shared<const EntryLayout>(std::move(layout));
+}
+
+}  // namespace
+
+const EvalResult* FindKey(const TableEntry& table_entry,
+                          absl::string_view name) {
+  return KeyAt(table_entry, FindSlot(table_entry.layout.get(), name));
+}
+
+const BigInt* FindActionParameter(const ActionInvocation& action_invocation,
+                                  absl::string_view name) {
+  return ActionParameterAt(action_invocation,
+                           FindSlot(action_invocation.layout.get(), name));
+}
+
+TableEntry MakeTableEntry(
+    std::string table_name, int32_t priority,
+    const absl::flat_hash_map<std::string, EvalResult>& keys) {
+  std::vector<std::string> names;
+  for (const auto& [name, value] : keys) names.push_back(name);
+  TableEntry table_entry{
+      .table_name = std::move(table_name),
+      .priority = priority,
+      .layout = LayoutOfNames(std::move(names)),
+  };
+  for (const std::string& name : table_entry.layout->names) {
+    table_entry.keys.push_back(keys.at(name));
+  }
+  return table_entry;
+}
+
+ActionInvocation MakeActionInvocation(
+    uint32_t action_id, std::string action_name,
+    const absl::flat_hash_map<std::string, BigInt>& action_parameters) {
+  std::vector<std::string> names;
+  for (const auto& [name, value] : action_parameters) names.push_back(name);
+  ActionInvocation action_invocation{
+      .action_id = action_id,
+      .action_name = std::move(action_name),
+      .layout = LayoutOfNames(std::move(names)),
+  };
+  for (const std::string& name : action_invocation.layout->names) {
+    action_invocation.action_parameters.push_back(action_parameters.at(name));
+  }
+  return action_invocation;
+}
+
 // -- Auxiliary evaluators -----------------------------------------------------
 
+namespace {
+
+// Mirrors the results in `eval_cache` for the nodes of `constraint` into
+// `flat_cache`.
+void SeedFlatCache(const FlatConstraint& constraint,
+                   const EvaluationCache& eval_cache,
+                   FlatEvaluationCache& flat_cache) {
+  flat_cache.Reset(constraint.nodes.size());
+  if (eval_cache.empty()) return;
+  for (int node = 0; node < constraint.nodes.size(); ++node) {
+    auto it = eval_cache.find(constraint.nodes[node].expr);
+    if (it != eval_cache.end()) {
+      flat_cache.Insert(constraint.nodes[node].value, it->second);
+    }
+  }
+}
+
+// Adds the results in `flat_cache` for the nodes of `constraint` to
+// `eval_cache`.
+void WriteBackFlatCache(const FlatConstraint& constraint,
+                        const FlatEvaluationCache& flat_cache,
+                        EvaluationCache& eval_cache) {
+  for (int node = 0; node < constraint.nodes.size(); ++node) {
+    std::optional<bool> result = flat_cache.Find(constraint.nodes[node].value);
+    if (result.has_value()) {
+      eval_cache.insert({constraint.nodes[node].expr, *result});
+    }
+  }
+}
+
+}  // namespace
+
 // Like Eval, but ensuring the result is a bool. Caches Boolean results and
 // checks cache before evaluation to avoid recomputation.
-absl::StatusOr<bool> EvalToBool(const Expression& expr,
+absl::StatusOr<bool> EvalToBool(const FlatConstraint& constraint, int node,
                                 const EvaluationContext& context,
-                                EvaluationCache* eval_cache) {
+                                FlatEvaluationCache* eval_cache) {
+  // Results are memoized by value, so repeated subexpressions are evaluated
+  // once.
+  const int value = constraint.nodes[node].value;
   if (eval_cache != nullptr) {
-    auto cache_result = eval_cache->find(&expr);
-    if (cache_result != eval_cache->end()) return cache_result->second;
+    std::optional<bool> cache_result = eval_cache->Find(value);
+    if (cache_result.has_value()) return *cache_result;
   }
-  ASSIGN_OR_RETURN(EvalResult result, Eval(expr, context, eval_cache));
+  ASSIGN_OR_RETURN(EvalResult result,
+                   Eval(constraint, node, context, eval_cache));
   if (absl::holds_alternative<bool>(result)) {
-    if (eval_cache != nullptr)
-      eval_cache->insert({&expr, absl::get<bool>(result)});
+    if (eval_cache != nullptr) {
+      eval_cache->Insert(value, absl::get<bool>(result));
+    }
     return absl::get<bool>(result);
   } else {
+    const Expression& expr = *constraint.nodes[node].expr;
     return RuntimeTypeError(context.constraint_source, expr.start_location(),
                             expr.end_location())
            << "expected expression of type bool";
@@ -290,35 +470,45 @@ absl::StatusOr<bool> EvalToBool(const Expression& expr,
 }
 
 // Like Eval, but ensuring the result is a BigInt.
-absl::StatusOr<BigInt> EvalToInt(const Expression& expr,
+absl::StatusOr<BigInt> EvalToInt(const FlatConstraint& constraint, int node,
                                  const EvaluationContext& context,
-                                 EvaluationCache* eval_cache) {
-  ASSIGN_OR_RETURN(EvalResult result, Eval(expr, context, eval_cache));
+                                 FlatEvaluationCache* eval_cache) {
+  ASSIGN_OR_RETURN(EvalResult result,
+                   Eval(constraint, node, context, eval_cache));
   if (absl::holds_alternative<BigInt>(result)) return absl::get<BigInt>(result);
+  const Expression& expr = *constraint.nodes[node].expr;
   return RuntimeTypeError(context.constraint_source, expr.start_location(),
                           expr.end_location())
          << "expected expression of integral type";
 }
 
 absl::StatusOr<EvalResult> EvalAndCastTo(const Type& type,
-                                         const Expression& expr,
+                                         const FlatConstraint& constraint,
+                                         int node,
                                          const EvaluationContext& context,
-                                         EvaluationCache* eval_cache) {
-  ASSIGN_OR_RETURN(EvalResult result, Eval(expr, context, eval_cache));
+                                         FlatEvaluationCache* eval_cache) {
+  ASSIGN_OR_RETURN(EvalResult result,
+                   Eval(constraint, node, context, eval_cache));
   if (absl::holds_alternative<BigInt>(result)) {
-    const BigInt value = absl::get<BigInt>(result);
-    const BigInt one = BigInt(1);
-    const BigInt zero = BigInt(0);
+    const BigInt& value = absl::get<BigInt>(result);
     const int bitwidth = TypeBitwidth(type).value_or(-1);
     DCHECK_NE(bitwidth, -1) << "can only cast to fixed-size types";
     switch (type.type_case()) {
       // int ~~> bit<W>
       //   n |~> n mod 2^W
       case Type::kFixedUnsigned: {
-        BigInt domain_size = one << bitwidth;  // 2^W
-        BigInt fixed_value = value % domain_size;
+        const BigInt* domain_size =
+            context.constant_pool == nullptr
+                ? nullptr
+                : FindDomainSize(*context.constant_pool, bitwidth);
+        BigInt computed_domain_size;
+        if (domain_size == nullptr) {
+          computed_domain_size = BigInt(1) << bitwidth;  // 2^W
+          domain_size = &computed_domain_size;
+        }
+        BigInt fixed_value = value % *domain_size;
         // operator% may return negative values.
-        if (fixed_value < zero) fixed_value += domain_size;
+        if (fixed_value < 0) fixed_value += *domain_size;
         return {fixed_value};
       }
 
@@ -331,8 +521,13 @@ absl::StatusOr<EvalResult> EvalAndCastTo(const Type& type,
       //      n |~> Ternary { value = n; mask = 2^W-1 }
       case Type::kTernary:
       case Type::kOptionalMatch: {
-        BigInt mask = (one << bitwidth) - one;  // 2^W - 1
-        return {Ternary{.value = value, .mask = mask}};
+        const BigInt* mask = context.constant_pool == nullptr
+                                 ? nullptr
+                                 : FindMask(*context.constant_pool, bitwidth);
+        return {Ternary{
+            .value = value,
+            .mask = mask != nullptr ? *mask : MaxValueForBitwidth(bitwidth),
+        }};
       }
 
       // bit<W> ~~> LPM<W>
@@ -349,6 +544,7 @@ absl::StatusOr<EvalResult> EvalAndCastTo(const Type& type,
         break;
     }
   }
+  const Expression& expr = *constraint.nodes[node].expr;
   return RuntimeTypeError(context.constraint_source, expr.start_location(),
                           expr.end_location())
          << "cannot cast expression of type " << expr.type() << " to type "
@@ -356,16 +552,18 @@ absl::StatusOr<EvalResult> EvalAndCastTo(const Type& type,
 }
 
 absl::StatusOr<bool> EvalBinaryExpression(ast::BinaryOperator binop,
-                                          const Expression& left_expr,
-                                          const Expression& right_expr,
+                                          const FlatConstraint& constraint,
+                                          int left_node, int right_node,
                                           const EvaluationContext& context,
-                                          EvaluationCache* eval_cache) {
+                                          FlatEvaluationCache* eval_cache) {
   switch (binop) {
     // (In-)Equality comparison.
     case ast::EQ:
     case ast::NE: {
-      ASSIGN_OR_RETURN(EvalResult left, Eval(left_expr, context, eval_cache));
-      ASSIGN_OR_RETURN(EvalResult right, Eval(right_expr, context, eval_cache));
+      ASSIGN_OR_RETURN(EvalResult left,
+                       Eval(constraint, left_node, context, eval_cache));
+      ASSIGN_OR_RETURN(EvalResult right,
+                       Eval(constraint, right_node, context, eval_cache));
       // Avoid != so we don't have to define it for Exact/Ternary/Lpm/Range.
       return (binop == ast::EQ) ? (left == right) : !(left == right);
     }
@@ -377,9 +575,11 @@ absl::StatusOr<bool> EvalBinaryExpression(ast::BinaryOperator binop,
     case ast::LE: {
       // Ordered comparison (<, <=, >, >=) is only supported by types whose run-
       // time representation is BigInt; the type checker should have our back.
-      ASSIGN_OR_RETURN(BigInt left, EvalToInt(left_expr, context, eval_cache),
+      ASSIGN_OR_RETURN(BigInt left,
+                       EvalToInt(constraint, left_node, context, eval_cache),
                        _ << " in ordered comparison");
-      ASSIGN_OR_RETURN(BigInt right, EvalToInt(right_expr, context, eval_cache),
+      ASSIGN_OR_RETURN(BigInt right,
+                       EvalToInt(constraint, right_node, context, eval_cache),
                        _ << " in ordered comparison");
       switch (binop) {
         case ast::GT:
@@ -401,21 +601,21 @@ absl::StatusOr<bool> EvalBinaryExpression(ast::BinaryOperator binop,
     case ast::IMPLIES: {
       // Short circuit boolean operations.
       ASSIGN_OR_RETURN(bool left_true,
-                       EvalToBool(left_expr, context, eval_cache));
+                       EvalToBool(constraint, left_node, context, eval_cache));
       switch (binop) {
         case ast::AND:
           if (left_true)
-            return EvalToBool(right_expr, context, eval_cache);
+            return EvalToBool(constraint, right_node, context, eval_cache);
           else
             return false;
         case ast::OR:
           if (left_true)
             return true;
           else
-            return EvalToBool(right_expr, context, eval_cache);
+            return EvalToBool(constraint, right_node, context, eval_cache);
         case ast::IMPLIES:
           if (left_true)
-            return EvalToBool(right_expr, context, eval_cache);
+            return EvalToBool(constraint, right_node, context, eval_cache);
           else
             return true;
         default:
@@ -431,33 +631,35 @@ absl::StatusOr<bool> EvalBinaryExpression(ast::BinaryOperator binop,
 }
 
 struct EvalFieldAccess {
-  const absl::string_view field;
+  const FieldSelector field;
+  // For error messages.
+  const absl::string_view field_name;
 
   absl::Status Error(const std::string& type) {
     return gutil::InvalidArgumentErrorBuilder()
-           << "value of type " << type << " has no field " << field;
+           << "value of type " << type << " has no field " << field_name;
   }
 
   absl::StatusOr<EvalResult> operator()(const Exact& exact) {
-    if (field == "value") return {exact.value};
+    if (field == FieldSelector::kValue) return {exact.value};
     return Error("exact");
   }
 
   absl::StatusOr<EvalResult> operator()(const Ternary& ternary) {
-    if (field == "value") return {ternary.value};
-    if (field == "mask") return {ternary.mask};
+    if (field == FieldSelector::kValue) return {ternary.value};
+    if (field == FieldSelector::kMask) return {ternary.mask};
     return Error("ternary");
   }
 
   absl::StatusOr<EvalResult> operator()(const Lpm& lpm) {
-    if (field == "value") return {lpm.value};
-    if (field == "prefix_length") return {lpm.prefix_length};
+    if (field == FieldSelector::kValue) return {lpm.value};
+    if (field == FieldSelector::kPrefixLength) return {lpm.prefix_length};
     return Error("lpm");
   }
 
   absl::StatusOr<EvalResult> operator()(const Range& range) {
-    if (field == "low") return {range.low};
-    if (field == "high") return {range.high};
+    if (field == FieldSelector::kLow) return {range.low};
+    if (field == FieldSelector::kHigh) return {range.high};
     return Error("range");
   }
   absl::StatusOr<EvalResult> operator()(bool) { return Error("bool"); }
@@ -467,21 +669,42 @@ struct EvalFieldAccess {
 
 // -- Explainer ----------------------------------------------------------------
 
-absl::StatusOr<const Expression*> MinimalSubexpressionLeadingToEvalResult(
-    const Expression& expression, const EvaluationContext& context,
-    EvaluationCache& eval_cache, ast::SizeCache& size_cache) {
-  switch (expression.expression_case()) {
+// Returns true if `left` starts before `right` in the constraint source.
+bool ComesFirstInSource(const Expression& left, const Expression& right) {
+  return std::make_pair(left.start_location().line(),
+                        left.start_location().column()) <
+         std::make_pair(right.start_location().line(),
+                        right.start_location().column());
+}
+
+// A subexpression explaining the result of a Boolean node, and its truth value.
+struct Explanation {
+  int node;
+  bool truth_value;
+};
+
+// Returns the minimal subexpression leading to `truth_value`, the result of
+// the given node of `constraint`. Each node is visited at most once, and its
+// operands are evaluated through `eval_cache`, only as far as the result of
+// the node does not already determine them.
+absl::StatusOr<Explanation> Explain(const FlatConstraint& constraint, int node,
+                                    bool truth_value,
+                                    const EvaluationContext& context,
+                                    FlatEvaluationCache& eval_cache) {
+  const FlatNode& flat_node = constraint.nodes[node];
+  switch (flat_node.kind) {
     case Expression::kBooleanConstant:
-      return &expression;
+      return Explanation{node, truth_value};
 
-    case Expression::kBooleanNegation: {
-      return MinimalSubexpressionLeadingToEvalResult(
-          expression.boolean_negation(), context, eval_cache, size_cache);
-    }
+    case Expression::kBooleanNegation:
+      return Explain(constraint, flat_node.operand, !truth_value, context,
+                     eval_cache);
 
     case Expression::kBinaryExpression: {
-      const ast::BinaryExpression& binexpr = expression.binary_expression();
-      const ast::BinaryOperator& binop = binexpr.binop();
+      const ast::BinaryOperator binop = flat_node.binop;
+      // The results that make the left (resp. right) operand a candidate, i.e.
+      // a reason for the result of the node.
+      bool left_reason, right_reason;
       switch (binop) {
         // Search terminates on non-boolean comparisons because descendants
         // are all non-boolean, so no refinement is possible.
@@ -491,7 +714,7 @@ absl::StatusOr<const Expression*> MinimalSubexpressionLeadingToEvalResult(
         case ast::GE:
         case ast::LT:
         case ast::LE:
-          return &expression;
+          return Explanation{node, truth_value};
 
         // Boolean comparisons may require further search to find minimal
         // reason, if no such refinement is possible, terminate search.
@@ -502,65 +725,20 @@ absl::StatusOr<const Expression*> MinimalSubexpressionLeadingToEvalResult(
         // OR       was  False -> terminate search
         // IMPLIES  was  False -> terminate search
         case ast::AND:
+          if (truth_value) return Explanation{node, truth_value};
+          left_reason = false;
+          right_reason = false;
+          break;
         case ast::OR:
-        case ast::IMPLIES: {
-          ASSIGN_OR_RETURN(bool left_result_is_true,
-                           EvalToBool(binexpr.left(), context, &eval_cache));
-          ASSIGN_OR_RETURN(bool right_result_is_true,
-                           EvalToBool(binexpr.right(), context, &eval_cache));
-
-          std::vector<const Expression*> candidate_subexpressions;
-
-          switch (binop) {
-            case ast::AND: {
-              if (!left_result_is_true)
-                candidate_subexpressions.push_back(&binexpr.left());
-              if (!right_result_is_true)
-                candidate_subexpressions.push_back(&binexpr.right());
-              break;
-            }
-            case ast::OR: {
-              if (left_result_is_true)
-                candidate_subexpressions.push_back(&binexpr.left());
-              if (right_result_is_true)
-                candidate_subexpressions.push_back(&binexpr.right());
-              break;
-            }
-            case ast::IMPLIES: {
-              if (!left_result_is_true)
-                candidate_subexpressions.push_back(&binexpr.left());
-              if (right_result_is_true)
-                candidate_subexpressions.push_back(&binexpr.right());
-              break;
-            }
-            default:
-              return gutil::InternalErrorBuilder()
-                     << "unreachable code reached";
-          }
-
-          if (candidate_subexpressions.empty()) return &expression;
-          // Returns `MinimalSubexpressionLeadingToEvalResult` of sole
-          // candidate.
-          if (candidate_subexpressions.size() == 1) {
-            return MinimalSubexpressionLeadingToEvalResult(
-                *candidate_subexpressions[0], context, eval_cache, size_cache);
-          }
-          // Returns the `MinimalSubexpressionLeadingToEvalResult` from the
-          // candidate who has the smallest such subexpression.
-          ASSIGN_OR_RETURN(auto* subexpression_0,
-                           MinimalSubexpressionLeadingToEvalResult(
-                               *candidate_subexpressions[0], context,
-                               eval_cache, size_cache));
-          ASSIGN_OR_RETURN(auto* subexpression_1,
-                           MinimalSubexpressionLeadingToEvalResult(
-                               *candidate_subexpressions[1], context,
-                               eval_cache, size_cache));
-          ASSIGN_OR_RETURN(int size_0,
-                           ast::Size(*subexpression_0, &size_cache));
-          ASSIGN_OR_RETURN(int size_1,
-                           ast::Size(*subexpression_1, &size_cache));
-          return size_0 <= size_1 ? subexpression_0 : subexpression_1;
-        }
+          if (!truth_value) return Explanation{node, truth_value};
+          left_reason = true;
+          right_reason = true;
+          break;
+        case ast::IMPLIES:
+          if (!truth_value) return Explanation{node, truth_value};
+          left_reason = false;
+          right_reason = true;
+          break;
 
         default:
           return gutil::InternalErrorBuilder()
@@ -568,45 +746,138 @@ absl::StatusOr<const Expression*> MinimalSubexpressionLeadingToEvalResult(
                  << ast::BinaryOperator_Name(binop)
                  << " encountered at runtime";
       }
+
+      // At least one operand is a candidate. If the left one is not, the
+      // right one must be, and need not be evaluated.
+      const int left = flat_node.operand;
+      const int right = flat_node.right;
+      ASSIGN_OR_RETURN(bool left_result,
+                       EvalToBool(constraint, left, context, &eval_cache));
+      if (left_result != left_reason) {
+        return Explain(constraint, right, right_reason, context, eval_cache);
+      }
+      ASSIGN_OR_RETURN(bool right_result,
+                       EvalToBool(constraint, right, context, &eval_cache));
+      if (right_result != right_reason) {
+        return Explain(constraint, left, left_reason, context, eval_cache);
+      }
+      // Returns the explanation of the candidate that has the smallest such
+      // subexpression, or the one that comes first in the source if both are
+      // equally small. Since operands may have been reordered when loading the
+      // constraint, the position in the AST does not break ties
+      // deterministically.
+      ASSIGN_OR_RETURN(
+          Explanation explanation_0,
+          Explain(constraint, left, left_reason, context, eval_cache));
+      ASSIGN_OR_RETURN(
+          Explanation explanation_1,
+          Explain(constraint, right, right_reason, context, eval_cache));
+      const FlatNode& node_0 = constraint.nodes[explanation_0.node];
+      const FlatNode& node_1 = constraint.nodes[explanation_1.node];
+      if (node_0.size != node_1.size) {
+        return node_0.size < node_1.size ? explanation_0 : explanation_1;
+      }
+      return ComesFirstInSource(*node_1.expr, *node_0.expr) ? explanation_1
+                                                             : explanation_0;
     }
 
     default:
       return gutil::InternalErrorBuilder()
              << "Explanation search should terminate at boolean expressions\n "
-             << "Non-boolean expression reached: " << expression.DebugString();
+             << "Non-boolean expression reached: "
+             << flat_node.expr->DebugString();
   }
 }
 
-// Returns human readable explanation of constraint violation.
-absl::StatusOr<std::string> ExplainConstraintViolation(
-    const Expression& expr, const EvaluationContext& context,
-    EvaluationCache& eval_cache, ast::SizeCache& size_cache) {
-  ASSIGN_OR_RETURN(const ast::Expression* explanation,
-                   MinimalSubexpressionLeadingToEvalResult(
-                       expr, context, eval_cache, size_cache));
+absl::StatusOr<int> MinimalSubexpressionLeadingToEvalResult(
+    const FlatConstraint& constraint, int node,
+    const EvaluationContext& context, FlatEvaluationCache& eval_cache) {
   ASSIGN_OR_RETURN(bool truth_value,
-                   EvalToBool(*explanation, context, &eval_cache));
+                   EvalToBool(constraint, node, context, &eval_cache));
+  ASSIGN_OR_RETURN(Explanation explanation,
+                   Explain(constraint, node, truth_value, context, eval_cache));
+  return explanation.node;
+}
+
+absl::StatusOr<const Expression*> MinimalSubexpressionLeadingToEvalResult(
+    const Expression& expression, const EvaluationContext& context,
+    EvaluationCache& eval_cache) {
+  const FlatConstraint constraint = FlattenConstraint(
+      expression, /*slot_by_name=*/nullptr, context.constant_pool);
+  FlatEvaluationCache flat_cache;
+  SeedFlatCache(constraint, eval_cache, flat_cache);
+  absl::StatusOr<int> result = MinimalSubexpressionLeadingToEvalResult(
+      constraint, RootNode(constraint), context, flat_cache);
+  WriteBackFlatCache(constraint, flat_cache, eval_cache);
+  if (!result.ok()) return result.status();
+  return constraint.nodes[*result].expr;
+}
+
+absl::StatusOr<ViolationReason> FindViolationReason(
+    const FlatConstraint& constraint, const EvaluationContext& context,
+    FlatEvaluationCache& eval_cache) {
+  const int root = RootNode(constraint);
+  ASSIGN_OR_RETURN(bool truth_value,
+                   EvalToBool(constraint, root, context, &eval_cache));
+  ASSIGN_OR_RETURN(Explanation explanation,
+                   Explain(constraint, root, truth_value, context, eval_cache));
+  return ViolationReason{
+      .node = explanation.node,
+      .subexpression = constraint.nodes[explanation.node].expr,
+      .truth_value = explanation.truth_value,
+  };
+}
+
+// Returns the slots of the keys (resp. action parameters) in `layout` that the
+// subexpression rooted at the given node of `constraint` refers to.
+absl::InlinedVector<bool, 16> RelevantSlots(const FlatConstraint& constraint,
+                                            int node,
+                                            const EntryLayout* layout) {
+  absl::InlinedVector<bool, 16> relevant(
+      layout == nullptr ? 0 : layout->names.size(), false);
+  for (int i = constraint.nodes[node].first; i <= node; ++i) {
+    const FlatNode& flat_node = constraint.nodes[i];
+    absl::string_view name;
+    if (flat_node.kind == Expression::kKey) {
+      name = flat_node.expr->key();
+    } else if (flat_node.kind == Expression::kActionParameter) {
+      name = flat_node.expr->action_parameter();
+    } else {
+      continue;
+    }
+    const int slot = SlotOf(constraint, flat_node, layout, name);
+    if (slot >= 0 && slot < relevant.size()) relevant[slot] = true;
+  }
+  return relevant;
+}
+
+// Returns human readable explanation of constraint violation.
+absl::StatusOr<std::string> RenderViolationReason(
+    const FlatConstraint& constraint, const ViolationReason& violation_reason,
+    const EvaluationContext& context) {
+  const Expression* explanation = violation_reason.subexpression;
+  const bool truth_value = violation_reason.truth_value;
   ASSIGN_OR_RETURN(std::string reason,
                    QuoteSubConstraint(context.constraint_source,
                                       explanation->start_location(),
                                       explanation->end_location()));
 
-  const absl::flat_hash_set<std::string> relevant_fields =
-      ast::GetVariables(*explanation);
   return std::visit(
       gutil::Overload{
           [&](const TableEntry& table_entry) -> std::string {
-            // Ordered for determinism when golden testing.
-            std::string key_info = absl::StrJoin(
-                gutil::AsOrderedView(table_entry.keys), "",
-                [&](std::string* out,
-                    const std::pair<std::string, EvalResult>& pair) {
-                  if (relevant_fields.contains(pair.first)) {
-                    absl::StrAppend(
-                        out, "Field: \"", pair.first,
-                        "\" -> Value: ", EvalResultToString(pair.second), "\n");
-                  }
-                });
+            const absl::InlinedVector<bool, 16> relevant =
+                RelevantSlots(constraint, violation_reason.node,
+                              table_entry.layout.get());
+            // Slots are ordered by name, for determinism when golden testing.
+            std::string key_info;
+            for (int slot = 0; slot < table_entry.keys.size(); ++slot) {
+              const std::string& name = table_entry.layout->names[slot];
+              if (relevant[slot]) {
+                absl::StrAppend(&key_info, "Field: \"", name, "\" -> Value: ",
+                                EvalResultToString(table_entry.keys[slot]),
+                                "\n");
+              }
+            }
             return absl::StrFormat(
                 "All entries must %ssatisfy:"
                 "\n\n%s\n"
@@ -620,16 +891,20 @@ absl::StatusOr<std::string> ExplainConstraintViolation(
                 table_entry.priority, key_info);
           },
           [&](const ActionInvocation& action_invocation) -> std::string {
-            std::string param_info = absl::StrJoin(
-                gutil::AsOrderedView(action_invocation.action_parameters), "",
-                [&](std::string* out,
-                    const std::pair<std::string, BigInt>& pair) {
-                  if (relevant_fields.contains(pair.first)) {
-                    absl::StrAppend(
-                        out, "Param name: \"", pair.first,
-                        "\" -> Value: ", BigIntToString(pair.second), "\n");
-                  }
-                });
+            const absl::InlinedVector<bool, 16> relevant =
+                RelevantSlots(constraint, violation_reason.node,
+                              action_invocation.layout.get());
+            std::string param_info;
+            for (int slot = 0;
+                 slot < action_invocation.action_parameters.size(); ++slot) {
+              const std::string& name = action_invocation.layout->names[slot];
+              const std::optional<BigInt>& value =
+                  action_invocation.action_parameters[slot];
+              if (value.has_value() && relevant[slot]) {
+                absl::StrAppend(&param_info, "Param name: \"", name,
+                                "\" -> Value: ", BigIntToString(*value), "\n");
+              }
+            }
             return absl::StrFormat(
                 "All actions must %ssatisfy:"
                 "\n\n%s\n"
@@ -644,21 +919,33 @@ absl::StatusOr<std::string> ExplainConstraintViolation(
       },
       context.constraint_context);
 }
+
+absl::StatusOr<std::string> ExplainConstraintViolation(
+    const FlatConstraint& constraint, const EvaluationContext& context,
+    FlatEvaluationCache& eval_cache) {
+  ASSIGN_OR_RETURN(ViolationReason reason,
+                   FindViolationReason(constraint, context, eval_cache));
+  return RenderViolationReason(constraint, reason, context);
+}
+
 // -- Main evaluator -----------------------------------------------------------
 
-// Evaluates Expression over given table entry, returning EvalResult if
+// Evaluates the given node over given table entry, returning EvalResult if
 // successful or InternalError Status if a type mismatch is detected.
 //
 // Eval (without underscore) is a thin wrapper around Eval_, see further down;
 // Eval_ should never be called directly, except by Eval.
-absl::StatusOr<EvalResult> Eval_(const Expression& expr,
+absl::StatusOr<EvalResult> Eval_(const FlatConstraint& constraint, int node,
                                  const EvaluationContext& context,
-                                 EvaluationCache* eval_cache) {
-  switch (expr.expression_case()) {
+                                 FlatEvaluationCache* eval_cache) {
+  const FlatNode& flat_node = constraint.nodes[node];
+  const Expression& expr = *flat_node.expr;
+  switch (flat_node.kind) {
     case Expression::kBooleanConstant:
       return {expr.boolean_constant()};
 
     case Expression::kIntegerConstant: {
+      if (flat_node.literal != nullptr) return {*flat_node.literal};
       ASSIGN_OR_RETURN(BigInt result, ParseBigInt(expr.integer_constant(), 10),
                        _ << "AST invariant violated; invalid decimal string: "
                          << expr.integer_constant());
@@ -674,14 +961,16 @@ absl::StatusOr<EvalResult> Eval_(const Expression& expr,
                << "Found a reference to a key in an action constraint.";
       }
 
-      auto it = table_entry->keys.find(expr.key());
-      if (it == table_entry->keys.end()) {
+      const EvalResult* value = KeyAt(
+          *table_entry, SlotOf(constraint, flat_node, table_entry->layout.get(),
+                               expr.key()));
+      if (value == nullptr) {
         return RuntimeTypeError(context.constraint_source,
                                 expr.start_location(), expr.end_location())
                << "unknown key " << expr.key() << " in table "
                << table_entry->table_name;
       }
-      return it->second;
+      return *value;
     }
 
     case Expression::kActionParameter: {
@@ -693,15 +982,17 @@ absl::StatusOr<EvalResult> Eval_(const Expression& expr,
                << "Found a reference to an action parameter in a table "
                   "constraint.";
       }
-      auto it =
-          action_invocation->action_parameters.find(expr.action_parameter());
-      if (it == action_invocation->action_parameters.end()) {
+      const BigInt* value = ActionParameterAt(
+          *action_invocation,
+          SlotOf(constraint, flat_node, action_invocation->layout.get(),
+                 expr.action_parameter()));
+      if (value == nullptr) {
         return RuntimeTypeError(context.constraint_source,
                                 expr.start_location(), expr.end_location())
                << "unknown action parameter " << expr.action_parameter()
                << " in action " << action_invocation->action_name;
       }
-      return it->second;
+      return *value;
     }
 
     case Expression::kAttributeAccess: {
@@ -712,47 +1003,50 @@ absl::StatusOr<EvalResult> Eval_(const Expression& expr,
                                 expr.start_location(), expr.end_location())
                << "The constraint context does not contain a TableEntry.";
       }
-      const std::string attribute_name =
-          expr.attribute_access().attribute_name();
-      if (attribute_name == "priority") {
-        return BigInt(table_entry->priority);
-      } else {
-        return RuntimeTypeError(context.constraint_source,
-                                expr.start_location(), expr.end_location())
-               << "unknown attribute '" << attribute_name << "'";
+      switch (flat_node.attribute) {
+        case AttributeId::kPriority:
+          return BigInt(table_entry->priority);
+        case AttributeId::kUnknown:
+          break;
       }
+      return RuntimeTypeError(context.constraint_source, expr.start_location(),
+                              expr.end_location())
+             << "unknown attribute '"
+             << expr.attribute_access().attribute_name() << "'";
     }
 
     case Expression::kBooleanNegation: {
-      ASSIGN_OR_RETURN(bool result, EvalToBool(expr.boolean_negation(), context,
-                                               eval_cache));
+      ASSIGN_OR_RETURN(bool result, EvalToBool(constraint, flat_node.operand,
+                                               context, eval_cache));
       return {!result};
     }
 
     case Expression::kArithmeticNegation: {
-      ASSIGN_OR_RETURN(BigInt result, EvalToInt(expr.arithmetic_negation(),
+      ASSIGN_OR_RETURN(BigInt result, EvalToInt(constraint, flat_node.operand,
                                                 context, eval_cache));
       return {-result};
     }
 
     case Expression::kTypeCast: {
-      return EvalAndCastTo(expr.type(), expr.type_cast(), context, eval_cache);
+      return EvalAndCastTo(expr.type(), constraint, flat_node.operand, context,
+                           eval_cache);
     }
 
     case Expression::kBinaryExpression: {
-      const ast::BinaryExpression& binexpr = expr.binary_expression();
-      return EvalBinaryExpression(binexpr.binop(), binexpr.left(),
-                                  binexpr.right(), context, eval_cache);
+      return EvalBinaryExpression(flat_node.binop, constraint,
+                                  flat_node.operand, flat_node.right, context,
+                                  eval_cache);
     }
 
     case Expression::kFieldAccess: {
-      const Expression& composite_expr = expr.field_access().expr();
-      const std::string& field = expr.field_access().field();
-      ASSIGN_OR_RETURN(EvalResult composite_value,
-                       Eval(composite_expr, context, eval_cache));
-
-      absl::StatusOr<EvalResult> result =
-          absl::visit(EvalFieldAccess{.field = field}, composite_value);
+      ASSIGN_OR_RETURN(
+          EvalResult composite_value,
+          Eval(constraint, flat_node.operand, context, eval_cache));
+
+      absl::StatusOr<EvalResult> result = absl::visit(
+          EvalFieldAccess{.field = flat_node.field,
+                          .field_name = expr.field_access().field()},
+          composite_value);
       if (!result.ok()) {
         return RuntimeTypeError(context.constraint_source,
                                 expr.start_location(), expr.end_location())
@@ -810,76 +1104,89 @@ absl::Status DynamicTypeCheck(const ConstraintSource& source,
 // directly; call Eval instead. `eval_cache` is used for caching boolean results
 // in order to avoid recomputation if an explanation is desired. Passing a
 // nullptr will disable caching. Caching is implemented in EvalToBool.
-absl::StatusOr<EvalResult> Eval(const Expression& expr,
+absl::StatusOr<EvalResult> Eval(const FlatConstraint& constraint, int node,
                                 const EvaluationContext& context,
-                                EvaluationCache* eval_cache) {
-  ASSIGN_OR_RETURN(EvalResult result, Eval_(expr, context, eval_cache));
-  RETURN_IF_ERROR(DynamicTypeCheck(context.constraint_source, expr, result));
+                                FlatEvaluationCache* eval_cache) {
+  ASSIGN_OR_RETURN(EvalResult result,
+                   Eval_(constraint, node, context, eval_cache));
+  RETURN_IF_ERROR(DynamicTypeCheck(context.constraint_source,
+                                   *constraint.nodes[node].expr, result));
   return result;
 }
 
-absl::StatusOr<std::string> ReasonEntryViolatesConstraint(
-    const p4::v1::Action& action, const ConstraintInfo& constraint_info) {
-  const uint32_t action_id = action.action_id();
-  auto* action_info = GetActionInfoOrNull(constraint_info, action_id);
-  if (action_info == nullptr) {
-    return gutil::InvalidArgumentErrorBuilder()
-           << "action entry with unknown action ID " << P4IDToString(action_id);
-  }
-  // Check if action has an action restriction.
-  if (!action_info->constraint.has_value()) return "";
-
-  const Expression& constraint = *action_info->constraint;
-  if (constraint.type().type_case() != Type::kBoolean) {
-    return gutil::InvalidArgumentErrorBuilder()
-           << "action " << action_info->name
-           << " has non-boolean constraint: " << constraint.DebugString();
+absl::StatusOr<EvalResult> Eval(const Expression& expr,
+                                const EvaluationContext& context,
+                                EvaluationCache* eval_cache) {
+  const FlatConstraint constraint = FlattenConstraint(
+      expr, /*slot_by_name=*/nullptr, context.constant_pool);
+  if (eval_cache == nullptr) {
+    return Eval(constraint, RootNode(constraint), context, nullptr);
   }
+  FlatEvaluationCache flat_cache;
+  SeedFlatCache(constraint, *eval_cache, flat_cache);
+  absl::StatusOr<EvalResult> result =
+      Eval(constraint, RootNode(constraint), context, &flat_cache);
+  WriteBackFlatCache(constraint, flat_cache, *eval_cache);
+  return result;
+}
 
-  EvaluationCache eval_cache;
-  ast::SizeCache size_cache;
-  ASSIGN_OR_RETURN(const EvaluationContext eval_context,
-                   ParseAction(action, *action_info),
-                   _ << " while parsing P4RT table entry for action '"
-                     << action_info->name << "':");
-
-  ASSIGN_OR_RETURN(bool entry_meets_constraint,
-                   EvalToBool(constraint, eval_context, &eval_cache));
-  if (!entry_meets_constraint) {
-    return ExplainConstraintViolation(constraint, eval_context, eval_cache,
-                                      size_cache);
+absl::StatusOr<bool> EvalToBool(const Expression& expr,
+                                const EvaluationContext& context,
+                                EvaluationCache* eval_cache) {
+  const FlatConstraint constraint = FlattenConstraint(
+      expr, /*slot_by_name=*/nullptr, context.constant_pool);
+  if (eval_cache == nullptr) {
+    return EvalToBool(constraint, RootNode(constraint), context, nullptr);
   }
-  return "";
+  FlatEvaluationCache flat_cache;
+  SeedFlatCache(constraint, *eval_cache, flat_cache);
+  absl::StatusOr<bool> result =
+      EvalToBool(constraint, RootNode(constraint), context, &flat_cache);
+  WriteBackFlatCache(constraint, flat_cache, *eval_cache);
+  return result;
 }
 
-absl::StatusOr<std::string> ReasonEntryViolatesConstraint(
-    const p4::v1::ActionProfileActionSet& action_set,
-    const ConstraintInfo& constraint_info) {
-  for (const p4::v1::ActionProfileAction& action_profile_action :
-       action_set.action_profile_actions()) {
-    ASSIGN_OR_RETURN(std::string reason,
-                     ReasonEntryViolatesConstraint(
-                         action_profile_action.action(), constraint_info));
-    if (!reason.empty()) return reason;
+// Returns true iff the entry in `context` satisfies `constraint`. Executes the
+// compiled `program` if present, and falls back to the reference interpreter
+// otherwise or if the VM reports an error, since only the latter can quote the
+// constraint in its error messages.
+absl::StatusOr<bool> EntrySatisfiesConstraint(const FlatConstraint& constraint,
+                                              const Program* program,
+                                              const EvaluationContext& context,
+                                              FlatEvaluationCache* eval_cache) {
+  if (program != nullptr) {
+    absl::StatusOr<bool> result = ExecuteProgram(*program, context);
+    if (result.ok()) return result;
   }
-  return "";
+  return EvalToBool(constraint, RootNode(constraint), context, eval_cache);
 }
 
-}  // namespace internal_interpreter
-
-// -- Public interface ---------------------------------------------------------
+absl::Status ParseTableEntryOf(const TableInfo& table_info,
+                               const p4::v1::TableEntry& entry,
+                               TableEntry& table_entry) {
+  RETURN_IF_ERROR(ParseTableEntryInto(entry, table_info,
+                                      ParsedValues::kReferenced, table_entry))
+      << " while parsing P4RT table entry for table '" << table_info.name
+      << "':";
+  return absl::OkStatus();
+}
 
-absl::StatusOr<std::string> ReasonEntryViolatesConstraint(
-    const p4::v1::TableEntry& entry, const ConstraintInfo& constraint_info) {
-  using ::p4_constraints::internal_interpreter::EvalToBool;
-  using ::p4_constraints::internal_interpreter::EvaluationCache;
-  using ::p4_constraints::internal_interpreter::EvaluationContext;
-  using ::p4_constraints::internal_interpreter::ExplainConstraintViolation;
-  using ::p4_constraints::internal_interpreter::P4IDToString;
-  using ::p4_constraints::internal_interpreter::ParseAction;
-  using ::p4_constraints::internal_interpreter::ParseTableEntry;
-  using ::p4_constraints::internal_interpreter::TableEntry;
+absl::Status ParseActionOf(const ActionInfo& action_info,
+                           const p4::v1::Action& action,
+                           ActionInvocation& action_invocation) {
+  RETURN_IF_ERROR(ParseActionInto(action, action_info,
+                                  ParsedValues::kReferenced, action_invocation))
+      << " while parsing P4RT table entry for action '" << action_info.name
+      << "':";
+  return absl::OkStatus();
+}
 
+absl::StatusOr<bool> ForTableConstraintOf(
+    const p4::v1::TableEntry& entry, const ConstraintInfo& constraint_info,
+    TableEntry& table_entry,
+    absl::FunctionRef<absl::StatusOr<bool>(const TableInfo&,
+                                           const EvaluationContext&)>
+        check) {
   // Find table associated with entry.
   auto* table_info = GetTableInfoOrNull(constraint_info, entry.table_id());
   if (table_info == nullptr) {
@@ -888,35 +1195,79 @@ absl::StatusOr<std::string> ReasonEntryViolatesConstraint(
            << P4IDToString(entry.table_id());
   }
   // Check if entry satisfies table constraint (if present).
-  if (table_info->constraint.has_value()) {
-    const Expression& constraint = table_info->constraint.value();
-    if (constraint.type().type_case() != Type::kBoolean) {
-      return gutil::InvalidArgumentErrorBuilder()
-             << "table " << table_info->name
-             << " has non-boolean constraint: " << constraint.DebugString();
-    }
-    // Parse entry and check constraint.
-    ASSIGN_OR_RETURN(const EvaluationContext eval_context,
-                     ParseTableEntry(entry, *table_info),
-                     _ << " while parsing P4RT table entry for table '"
-                       << table_info->name << "':");
-    EvaluationCache eval_cache;
-    ast::SizeCache size_cache;
-    ASSIGN_OR_RETURN(bool entry_satisfies_constraint,
-                     EvalToBool(constraint, eval_context, &eval_cache));
-
-    if (!entry_satisfies_constraint) {
-      return ExplainConstraintViolation(constraint, eval_context, eval_cache,
-                                        size_cache);
-    }
+  if (table_info->constraint == nullptr) return false;
+
+  const Expression& constraint = *table_info->constraint;
+  if (constraint.type().type_case() != Type::kBoolean) {
+    return gutil::InvalidArgumentErrorBuilder()
+           << "table " << table_info->name
+           << " has non-boolean constraint: " << constraint.DebugString();
   }
+  RETURN_IF_ERROR(ParseTableEntryOf(*table_info, entry, table_entry));
+  EvaluationContext context{
+      .constraint_context = std::move(table_entry),
+      .constraint_source = table_info->constraint_source,
+      .constant_pool = table_info->constant_pool.get(),
+  };
+  absl::StatusOr<bool> result = check(*table_info, context);
+  // Hands the storage back for the next entry.
+  table_entry = std::move(std::get<TableEntry>(context.constraint_context));
+  return result;
+}
 
-  if (!entry.has_action()) return "";
+namespace {
+
+// Implements `ForEachActionRestrictionOf` for `action`, the `action_index`-th
+// action of the entry.
+absl::StatusOr<bool> ForActionRestrictionOf(
+    const p4::v1::Action& action, int action_index,
+    const ConstraintInfo& constraint_info, ActionInvocation& action_invocation,
+    absl::FunctionRef<absl::StatusOr<bool>(
+        const ActionInfo&, int action_index, const EvaluationContext&)>
+        check) {
+  const uint32_t action_id = action.action_id();
+  auto* action_info = GetActionInfoOrNull(constraint_info, action_id);
+  if (action_info == nullptr) {
+    return gutil::InvalidArgumentErrorBuilder()
+           << "action entry with unknown action ID " << P4IDToString(action_id);
+  }
+  // Check if action has an action restriction.
+  if (action_info->constraint == nullptr) return false;
+
+  const Expression& constraint = *action_info->constraint;
+  if (constraint.type().type_case() != Type::kBoolean) {
+    return gutil::InvalidArgumentErrorBuilder()
+           << "action " << action_info->name
+           << " has non-boolean constraint: " << constraint.DebugString();
+  }
+  RETURN_IF_ERROR(ParseActionOf(*action_info, action, action_invocation));
+  EvaluationContext context{
+      .constraint_context = std::move(action_invocation),
+      .constraint_source = action_info->constraint_source,
+      .constant_pool = action_info->constant_pool.get(),
+  };
+  absl::StatusOr<bool> result = check(*action_info, action_index, context);
+  // Hands the storage back for the next action.
+  action_invocation =
+      std::move(std::get<ActionInvocation>(context.constraint_context));
+  return result;
+}
+
+}  // namespace
+
+absl::StatusOr<bool> ForEachActionRestrictionOf(
+    const p4::v1::TableEntry& entry, const ConstraintInfo& constraint_info,
+    ActionInvocation& action_invocation,
+    absl::FunctionRef<absl::StatusOr<bool>(
+        const ActionInfo&, int action_index, const EvaluationContext&)>
+        check) {
+  if (!entry.has_action()) return false;
 
   switch (entry.action().type_case()) {
     case p4::v1::TableAction::kAction:
-      return internal_interpreter::ReasonEntryViolatesConstraint(
-          entry.action().action(), constraint_info);
+      return ForActionRestrictionOf(entry.action().action(),
+                                    /*action_index=*/0, constraint_info,
+                                    action_invocation, check);
     case p4::v1::TableAction::kActionProfileMemberId:
     case p4::v1::TableAction::kActionProfileGroupId:
       return gutil::InvalidArgumentErrorBuilder()
@@ -924,8 +1275,16 @@ absl::StatusOr<std::string> ReasonEntryViolatesConstraint(
                 "kind of action: "
              << entry.DebugString();
     case p4::v1::TableAction::kActionProfileActionSet: {
-      return internal_interpreter::ReasonEntryViolatesConstraint(
-          entry.action().action_profile_action_set(), constraint_info);
+      const auto& actions =
+          entry.action().action_profile_action_set().action_profile_actions();
+      for (int i = 0; i < actions.size(); ++i) {
+        ASSIGN_OR_RETURN(bool stop,
+                         ForActionRestrictionOf(actions[i].action(), i,
+                                                constraint_info,
+                                                action_invocation, check));
+        if (stop) return true;
+      }
+      return false;
     }
     case p4::v1::TableAction::TYPE_NOT_SET:
       break;
@@ -934,4 +1293,76 @@ absl::StatusOr<std::string> ReasonEntryViolatesConstraint(
          << "unknown action type " << entry.action().type_case();
 }
 
+namespace {
+
+// Returns the empty string if the entry in `context` satisfies `constraint`,
+// and a human-readable explanation of the violation otherwise.
+// `flat_constraint` and `program` are the precomputed forms of `constraint`,
+// or null.
+absl::StatusOr<std::string> ReasonContextViolatesConstraint(
+    const Expression& constraint, const FlatConstraint* flat_constraint,
+    const Program* program, const EvaluationContext& context) {
+  std::optional<FlatConstraint> flattened;
+  if (flat_constraint == nullptr) {
+    flattened = FlattenConstraint(constraint, /*slot_by_name=*/nullptr,
+                                  context.constant_pool);
+    flat_constraint = &*flattened;
+  }
+  FlatEvaluationCache eval_cache;
+  eval_cache.Reset(flat_constraint->nodes.size());
+  ASSIGN_OR_RETURN(bool entry_satisfies_constraint,
+                   EntrySatisfiesConstraint(*flat_constraint, program, context,
+                                            &eval_cache));
+  if (entry_satisfies_constraint) return "";
+  return ExplainConstraintViolation(*flat_constraint, context, eval_cache);
+}
+
+}  // namespace
+}  // namespace internal_interpreter
+
+// -- Public interface ---------------------------------------------------------
+
+absl::StatusOr<std::string> ReasonEntryViolatesConstraint(
+    const p4::v1::TableEntry& entry, const ConstraintInfo& constraint_info) {
+  using ::p4_constraints::internal_interpreter::ActionInvocation;
+  using ::p4_constraints::internal_interpreter::EvaluationContext;
+  using ::p4_constraints::internal_interpreter::ForEachActionRestrictionOf;
+  using ::p4_constraints::internal_interpreter::ForTableConstraintOf;
+  using ::p4_constraints::internal_interpreter::
+      ReasonContextViolatesConstraint;
+  using ::p4_constraints::internal_interpreter::TableEntry;
+
+  // The explanation of the first violated constraint, if any.
+  std::string reason;
+  TableEntry table_entry;
+  ASSIGN_OR_RETURN(
+      bool violated,
+      ForTableConstraintOf(
+          entry, constraint_info, table_entry,
+          [&](const TableInfo& table_info,
+              const EvaluationContext& context) -> absl::StatusOr<bool> {
+            ASSIGN_OR_RETURN(reason, ReasonContextViolatesConstraint(
+                                         *table_info.constraint,
+                                         table_info.flat_constraint.get(),
+                                         table_info.program.get(), context));
+            return !reason.empty();
+          }));
+  if (violated) return reason;
+
+  ActionInvocation action_invocation;
+  RETURN_IF_ERROR(
+      ForEachActionRestrictionOf(
+          entry, constraint_info, action_invocation,
+          [&](const ActionInfo& action_info, int /*action_index*/,
+              const EvaluationContext& context) -> absl::StatusOr<bool> {
+            ASSIGN_OR_RETURN(reason, ReasonContextViolatesConstraint(
+                                         *action_info.constraint,
+                                         action_info.flat_constraint.get(),
+                                         action_info.program.get(), context));
+            return !reason.empty();
+          })
+          .status());
+  return reason;
+}
+
 }  // namespace p4_constraints
@@ -22,17 +22,25 @@
 
 #include <stdint.h>
 
-#include <ostream>
+#include <memory>
+#include <optional>
 #include <string>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
-#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
 #include "absl/types/variant.h"
 #include "p4/v1/p4runtime.pb.h"
 #include "p4_constraints/ast.h"
 #include "p4_constraints/ast.pb.h"
+#include "p4_constraints/backend/constant_pool.h"
 #include "p4_constraints/backend/constraint_info.h"
+#include "p4_constraints/backend/eval_result.h"
+#include "p4_constraints/backend/flat_constraint.h"
+#include "p4_constraints/backend/program.h"
 #include "p4_constraints/big_int.h"
 
 namespace p4_constraints {
@@ -44,6 +52,8 @@ namespace p4_constraints {
 // string explaining why it is not the case otherwise. Returns an
 // `InvalidArgument` if the entry's table or action is not defined in
 // `ConstraintInfo`, or if `entry` is inconsistent with these definitions.
+//
+// To check many entries, prefer reusing a `Validator` (see validator.h).
 absl::StatusOr<std::string> ReasonEntryViolatesConstraint(
     const p4::v1::TableEntry& entry, const ConstraintInfo& constraint_info);
 
@@ -52,107 +62,74 @@ absl::StatusOr<std::string> ReasonEntryViolatesConstraint(
 // Exposed for testing only.
 namespace internal_interpreter {
 
-// -- Runtime representations --------------------------------------------------
-
-// We use p4_constraints::BigInt to represent all integers, including
-// arbitrary-precision and fixed-width signed/unsigned integers.
-
-struct Exact {
-  BigInt value;
-};
-
-// Used to represent both ternary and optional keys at runtime, since an
-// optional key is just a ternary key whose mask is all zeros or all ones.
-struct Ternary {
-  BigInt value;
-  BigInt mask;
-};
-
-struct Lpm {
-  BigInt value;
-  BigInt prefix_length;
-};
-
-struct Range {
-  BigInt low;
-  BigInt high;
-};
-
-// Evaluation can result in a value of various types.
-// We use a tagged union to ease debugging (see DynamicTypeCheck); an untagged
-// union would work just fine assuming the type checker has no bugs.
-using EvalResult = absl::variant<bool, BigInt, Exact, Ternary, Lpm, Range>;
-
-inline bool operator==(const Exact& left, const Exact& right) {
-  return left.value == right.value;
-}
-
-inline bool operator==(const Ternary& left, const Ternary& right) {
-  return left.value == right.value && left.mask == right.mask;
-}
-
-inline bool operator==(const Lpm& left, const Lpm& right) {
-  return left.value == right.value && left.prefix_length == right.prefix_length;
-}
-
-inline bool operator==(const Range& left, const Range& right) {
-  return left.low == right.low && left.high == right.high;
-}
-
-inline std::ostream& operator<<(std::ostream& os, const BigInt& integer) {
-  return os << BigIntToString(integer);
-}
-
-inline std::ostream& operator<<(std::ostream& os, const Exact& exact) {
-  return os << absl::StrFormat("Exact{.value = %s}",
-                               BigIntToString(exact.value));
-}
-
-inline std::ostream& operator<<(std::ostream& os, const Ternary& ternary) {
-  return os << absl::StrFormat("Ternary{.value = %s, .mask = %s}",
-                               BigIntToString(ternary.value),
-                               BigIntToString(ternary.mask));
-}
-
-inline std::ostream& operator<<(std::ostream& os, const Lpm& lpm) {
-  return os << absl::StrFormat("Lpm{.value = %s, .prefix_length = %s}",
-                               BigIntToString(lpm.value),
-                               BigIntToString(lpm.prefix_length));
-}
-
-inline std::ostream& operator<<(std::ostream& os, const Range& range) {
-  return os << absl::StrFormat("Range{.low = %s, .high = %s}",
-                               BigIntToString(range.low),
-                               BigIntToString(range.high));
-}
-
 // Converts EvalResult to readable string.
 std::string EvalResultToString(const EvalResult& result);
 
+// Returns P4Info object ID as string, both including and excluding its object
+// type.
+std::string P4IDToString(uint32_t p4_object_id);
+
 // TODO(smolkaj): The code below does not compile with C++11. Find workaround.
 // inline std::ostream& operator<<(std::ostream& os, const EvalResult& result) {
 //   absl::visit([&](const auto& result) { os << result; }, result);
 //   return os;
 // }
 
+// The keys (resp. params) that parsing a table entry (resp. action) converts.
+enum class ParsedValues {
+  // All of them, so that the entry can be evaluated against any expression.
+  kAll,
+  // Only those that the constraint of the table (resp. action) references (see
+  // `EntryLayout::referenced`); the others are validated, but not converted.
+  // Suffices for, and speeds up, checking entries against their constraint.
+  kReferenced,
+};
+
 // Parsed representation of p4::v1::TableEntry.
 struct TableEntry {
   std::string table_name;
   int32_t priority;
-  // All table keys, by name.
-  // In contrast to p4::v1::TableEntry, all keys must be present, i.e. this must
-  // be a total map from key names to values.
-  absl::flat_hash_map<std::string, EvalResult> keys;
+  // All table keys, indexed by their slot in `layout`.
+  // In contrast to p4::v1::TableEntry, all keys must be present, i.e. there
+  // must be a value for every slot. If only referenced values were parsed, keys
+  // that are not referenced by the constraint hold an unspecified value.
+  std::vector<EvalResult> keys;
+  std::shared_ptr<const EntryLayout> layout;
+  ParsedValues parsed_values = ParsedValues::kAll;
 };
 
 // Parsed representation of p4::v1::Action.
 struct ActionInvocation {
   uint32_t action_id;
   std::string action_name;
-  // Map of param names to param values.
-  absl::flat_hash_map<std::string, BigInt> action_parameters;
+  // Param values, indexed by their slot in `layout`. Params that are missing
+  // from the action, or that are not referenced by the constraint if only
+  // referenced values were parsed, are nullopt.
+  std::vector<std::optional<BigInt>> action_parameters;
+  std::shared_ptr<const EntryLayout> layout;
 };
 
+// Returns the value of the key with the given name, or nullptr if there is no
+// such key or it was not parsed because the constraint does not reference it.
+const EvalResult* FindKey(const TableEntry& table_entry,
+                          absl::string_view name);
+
+// Returns the value of the action parameter with the given name, or nullptr if
+// there is no such parameter.
+const BigInt* FindActionParameter(const ActionInvocation& action_invocation,
+                                  absl::string_view name);
+
+// Builds a TableEntry (resp. ActionInvocation) from values given by name, with
+// slots assigned in order of names. Convenient for constructing entries by
+// hand, e.g. in tests; entries of P4Runtime tables should be obtained using
+// `ParseTableEntry` (resp. `ParseAction`) instead.
+TableEntry MakeTableEntry(
+    std::string table_name, int32_t priority,
+    const absl::flat_hash_map<std::string, EvalResult>& keys);
+ActionInvocation MakeActionInvocation(
+    uint32_t action_id, std::string action_name,
+    const absl::flat_hash_map<std::string, BigInt>& action_parameters);
+
 // Context under which an `Expression` is evaluated. An `EvaluationContext` is
 // "valid" for a given `Expression` iff the following holds:
 // - If the `Expression` being evaluated is a Table constraint, then
@@ -163,6 +140,11 @@ struct ActionInvocation {
 //   -`source` must be the source from which the expression was parsed. If not,
 //     behaviour is undefined (depending on the source, either an InternalError
 //     will be given or a non-sense quote will be returned)
+//   -`constant_pool`, if non-null, must be the pool built from the expression
+//     (see constant_pool.h). Its literals are resolved when the expression is
+//     flattened, so a precomputed `FlatConstraint` must have been flattened
+//     with the pool to use them. Constants missing from the pool are computed
+//     on the fly.
 //
 // ***WARNING***: This struct's members are references in order to avoid
 // expensive copies. This leads to the possibility of dangling references, use
@@ -170,6 +152,7 @@ struct ActionInvocation {
 struct EvaluationContext {
   std::variant<ActionInvocation, TableEntry> constraint_context;
   const ConstraintSource& constraint_source;
+  const ConstantPool* constant_pool = nullptr;
 };
 
 // Parses p4::v1::TableEntry into an EvaluationContext using keys, table name,
@@ -179,6 +162,14 @@ struct EvaluationContext {
 absl::StatusOr<EvaluationContext> ParseTableEntry(
     const p4::v1::TableEntry& entry, const TableInfo& table_info);
 
+// Same as `ParseTableEntry`, but only parses the given `parsed_values`, into
+// `table_entry`, reusing its storage across calls. `table_entry` is left in an
+// unspecified state on error.
+absl::Status ParseTableEntryInto(const p4::v1::TableEntry& entry,
+                                const TableInfo& table_info,
+                                ParsedValues parsed_values,
+                                TableEntry& table_entry);
+
 // Parses p4::v1::Action into an EvaluationContext using action parameters,
 // action name, and constraint source from action_info. Returns InvalidArgument
 // if an Action parameter cannot be found in action_info or if there are
@@ -186,18 +177,95 @@ absl::StatusOr<EvaluationContext> ParseTableEntry(
 absl::StatusOr<EvaluationContext> ParseAction(const p4::v1::Action& action,
                                               const ActionInfo& action_info);
 
+// Same as `ParseAction`, but only parses the given `parsed_values`, into
+// `action_invocation`, reusing its storage across calls. `action_invocation` is
+// left in an unspecified state on error.
+absl::Status ParseActionInto(const p4::v1::Action& action,
+                             const ActionInfo& action_info,
+                             ParsedValues parsed_values,
+                             ActionInvocation& action_invocation);
+
+// Same as `ParseTableEntryInto` (resp. `ParseActionInto`) with
+// `ParsedValues::kReferenced`, but names the table (resp. action) in the error
+// message. Only for checking the entry against the constraint of its table
+// (resp. action).
+absl::Status ParseTableEntryOf(const TableInfo& table_info,
+                               const p4::v1::TableEntry& entry,
+                               TableEntry& table_entry);
+absl::Status ParseActionOf(const ActionInfo& action_info,
+                           const p4::v1::Action& action,
+                           ActionInvocation& action_invocation);
+
+// Looks up the table of `entry` and, if it has a constraint, parses `entry`
+// into `table_entry` and calls `check` on the table and the resulting context,
+// handing the storage back to `table_entry` afterwards. Returns the result of
+// `check` (e.g. whether it found the constraint violated), false if the table
+// has no constraint, or InvalidArgument if the table is unknown, its constraint
+// is not boolean, or `entry` cannot be parsed.
+//
+// Together with `ForEachActionRestrictionOf`, this is how both
+// `ReasonEntryViolatesConstraint` and the `Validator` (see validator.h) find
+// the constraints of an entry; they differ only in their `check`.
+absl::StatusOr<bool> ForTableConstraintOf(
+    const p4::v1::TableEntry& entry, const ConstraintInfo& constraint_info,
+    TableEntry& table_entry,
+    absl::FunctionRef<absl::StatusOr<bool>(const TableInfo&,
+                                           const EvaluationContext&)>
+        check);
+
+// Same as above, but for the restrictions of the actions of `entry`, parsed
+// into `action_invocation`, in order. Stops at the first action for which
+// `check` returns true. `check` is also passed the index of the action in the
+// entry's action profile action set, or 0 for a direct action.
+absl::StatusOr<bool> ForEachActionRestrictionOf(
+    const p4::v1::TableEntry& entry, const ConstraintInfo& constraint_info,
+    ActionInvocation& action_invocation,
+    absl::FunctionRef<absl::StatusOr<bool>(
+        const ActionInfo&, int action_index, const EvaluationContext&)>
+        check);
+
 // Used to memoize evaluation results to avoid re-computation.
 using EvaluationCache = absl::flat_hash_map<const ast::Expression*, bool>;
 
+// Same as `EvaluationCache`, but for a `FlatConstraint` (see
+// flat_constraint.h), indexed by the values of its nodes, so that a result is
+// shared by all nodes with the same value.
+class FlatEvaluationCache {
+ public:
+  // Forgets all results and makes room for the values of a constraint with
+  // `num_nodes` nodes. Must be called before the cache is used for another
+  // constraint.
+  void Reset(int num_nodes) { results_.assign(num_nodes, kUnknown); }
+
+  std::optional<bool> Find(int value) const {
+    if (results_[value] == kUnknown) return std::nullopt;
+    return results_[value] != 0;
+  }
+  void Insert(int value, bool result) { results_[value] = result; }
+
+ private:
+  static constexpr int8_t kUnknown = -1;
+  std::vector<int8_t> results_;
+};
+
 // Evaluates `expr` over `context.entry` to an `EvalResult`. Returns error
 // status if AST is malformed and uses `context.constraint_source` to quote
 // constraint. `eval_cache` holds boolean results, useful for avoiding
 // recomputation when an explanation is desired. Passing a nullptr for
 // `eval-cache` disables caching.
+//
+// Flattens `expr` first; to evaluate the same constraint repeatedly, flatten
+// it once and use the overload below.
 absl::StatusOr<EvalResult> Eval(const ast::Expression& expr,
                                 const EvaluationContext& context,
                                 EvaluationCache* eval_cache);
 
+// Same as above, but evaluates the given node of `constraint`. `eval_cache`
+// must have been reset for `constraint`.
+absl::StatusOr<EvalResult> Eval(const FlatConstraint& constraint, int node,
+                                const EvaluationContext& context,
+                                FlatEvaluationCache* eval_cache);
+
 // Provides a minimal explanation for why `expression` resolved to true/false
 // under `context.entry` as a pointer to a subexpression that implies the
 // result. In the formal sense, finds the smallest subexpression `s` of `e` s.t.
@@ -208,24 +276,79 @@ absl::StatusOr<EvalResult> Eval(const ast::Expression& expr,
 //
 //           eval(e, entry2)  =>  eval(s, entry2) != eval(s, entry1)
 //
-// Uses `eval_cache` and `size_cache` to avoid recomputation, allowing it to run
-// in linear time. Given current language specification, search only requires
-// traversal of nodes with type boolean. Traversal of non-boolean nodes or an
-// invalid AST will return InternalError Status. Uses
-// `context.constraint_source` to quote constraint on error.
+// Runs in a single pass over the nodes, in linear time: uses `eval_cache` to
+// avoid recomputation, and only evaluates the operands of a node as far as its
+// result does not already determine them.
+// Given current language specification, search only requires traversal of
+// nodes with type boolean. Traversal of non-boolean nodes or an invalid AST
+// will return InternalError Status. Uses `context.constraint_source` to quote
+// constraint on error.
+//
+// Flattens `expression` first, and copies `eval_cache` to and from the flat
+// form; to explain the same constraint repeatedly, flatten it once and use the
+// overload below.
 absl::StatusOr<const ast::Expression*> MinimalSubexpressionLeadingToEvalResult(
     const ast::Expression& expression, const EvaluationContext& context,
-    EvaluationCache& eval_cache, ast::SizeCache& size_cache);
+    EvaluationCache& eval_cache);
+
+// Same as above, but explains the given node of `constraint` and returns the
+// id of the subexpression.
+absl::StatusOr<int> MinimalSubexpressionLeadingToEvalResult(
+    const FlatConstraint& constraint, int node,
+    const EvaluationContext& context, FlatEvaluationCache& eval_cache);
 
-// Same as `Eval` except forces boolean result.
+// Same as `Eval` except forces boolean result. Like `Eval`, the first overload
+// flattens `expr` on every call.
 absl::StatusOr<bool> EvalToBool(const ast::Expression& expr,
                                 const EvaluationContext& context,
                                 EvaluationCache* eval_cache);
+absl::StatusOr<bool> EvalToBool(const FlatConstraint& constraint, int node,
+                                const EvaluationContext& context,
+                                FlatEvaluationCache* eval_cache);
+
+// Returns true iff the entry in `context` satisfies `constraint`. Executes the
+// compiled `program` if non-null (see vm.h), and falls back to `EvalToBool`
+// otherwise or if the VM reports an error. `eval_cache` must have been reset
+// for `constraint`, if non-null.
+absl::StatusOr<bool> EntrySatisfiesConstraint(const FlatConstraint& constraint,
+                                              const Program* program,
+                                              const EvaluationContext& context,
+                                              FlatEvaluationCache* eval_cache);
+
+// The reason why an entry violates a constraint: the minimal subexpression of
+// the constraint that explains the violation (see
+// `MinimalSubexpressionLeadingToEvalResult`), and its truth value for the
+// entry.
+struct ViolationReason {
+  // The id of the subexpression in the flat form of the constraint.
+  int node;
+  const ast::Expression* subexpression;
+  bool truth_value;
+};
+
+// Returns the reason why the entry in `context` violates `constraint`.
+// `eval_cache` must have been reset for `constraint`, but may hold results
+// already.
+absl::StatusOr<ViolationReason> FindViolationReason(
+    const FlatConstraint& constraint, const EvaluationContext& context,
+    FlatEvaluationCache& eval_cache);
+
+// Returns a human-readable explanation of the violation of `constraint` with
+// the given `reason` by the entry in `context`. This is where the cost of
+// explaining violations lies: quoting the constraint and formatting the entry.
+absl::StatusOr<std::string> RenderViolationReason(
+    const FlatConstraint& constraint, const ViolationReason& reason,
+    const EvaluationContext& context);
+
+// Same as `RenderViolationReason(FindViolationReason(...))`.
+absl::StatusOr<std::string> ExplainConstraintViolation(
+    const FlatConstraint& constraint, const EvaluationContext& context,
+    FlatEvaluationCache& eval_cache);
 
 // Converts a P4 integer in binary string format to BigInt format. For details
 // on the conversion, see
 // https://p4.org/p4-spec/docs/p4runtime-spec-working-draft-html-version.html#sec-bytestrings.
-BigInt ParseP4RTInteger(std::string int_str);
+BigInt ParseP4RTInteger(absl::string_view int_str);
 
 }  // namespace internal_interpreter
 }  // namespace p4_constraints
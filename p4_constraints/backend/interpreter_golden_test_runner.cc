@@ -18,7 +18,10 @@
 
 #include <cstdint>
 #include <iostream>
+#include <memory>
+#include <optional>
 #include <string>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -30,12 +33,14 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
-#include "gutil/ordered_map.h"
 #include "gutil/testing.h"
 #include "p4_constraints/ast.pb.h"
+#include "p4_constraints/backend/compiler.h"
 #include "p4_constraints/backend/constraint_info.h"
 #include "p4_constraints/backend/interpreter.h"
+#include "p4_constraints/backend/program.h"
 #include "p4_constraints/backend/type_checker.h"
+#include "p4_constraints/big_int.h"
 #include "p4_constraints/constraint_source.h"
 #include "p4_constraints/frontend/constraint_kind.h"
 #include "p4_constraints/frontend/parser.h"
@@ -113,7 +118,10 @@ absl::StatusOr<ConstraintInfo> MakeConstraintInfo(TestCase test_case) {
                      ParseConstraint(ConstraintKind::kTableConstraint,
                                      table_info.constraint_source));
     RETURN_IF_ERROR(InferAndCheckTypes(&constraint, table_info));
-    table_info.constraint = constraint;
+    ASSIGN_OR_RETURN(Program program, CompileConstraint(constraint));
+    table_info.constraint =
+        std::make_shared<const Expression>(std::move(constraint));
+    table_info.program = std::make_shared<const Program>(std::move(program));
   }
   absl::flat_hash_map<uint32_t, ActionInfo> action_info_by_id;
   if (!test_case.constraint_by_action_id.empty()) {
@@ -128,7 +136,11 @@ absl::StatusOr<ConstraintInfo> MakeConstraintInfo(TestCase test_case) {
                        ParseConstraint(ConstraintKind::kActionConstraint,
                                        action_info.constraint_source));
       RETURN_IF_ERROR(InferAndCheckTypes(&constraint, action_info));
-      action_info.constraint = constraint;
+      ASSIGN_OR_RETURN(Program program, CompileConstraint(constraint));
+      action_info.constraint =
+          std::make_shared<const Expression>(std::move(constraint));
+      action_info.program =
+          std::make_shared<const Program>(std::move(program));
       action_info_by_id.insert({action_id, action_info});
     }
   }
@@ -408,12 +420,14 @@ absl::StatusOr<std::string> EntryToString(const EvaluationContext& context,
     return gutil::InvalidArgumentErrorBuilder()
            << "The constraint context does not contain a TableEntry.";
   }
-  std::string key_info = absl::StrJoin(
-      gutil::AsOrderedView(table_entry->keys), "\n",
-      [](std::string* out, auto pair) {
-        absl::StrAppend(out, "Key:\"", pair.first,
-                        "\" -> Value: ", EvalResultToString(pair.second));
-      });
+  // Slots are ordered by name.
+  std::vector<std::string> keys;
+  for (int slot = 0; slot < table_entry->keys.size(); ++slot) {
+    keys.push_back(absl::StrCat("Key:\"", table_entry->layout->names[slot],
+                                "\" -> Value: ",
+                                EvalResultToString(table_entry->keys[slot])));
+  }
+  std::string key_info = absl::StrJoin(keys, "\n");
 
   return absl::StrFormat(
       "Table Name: \"%s\"\n"
@@ -430,12 +444,17 @@ absl::StatusOr<std::string> ActionToString(const EvaluationContext& context) {
            << "The constraint context does not contain an "
               "ActionInvocation.";
   }
-  std::string param_info = absl::StrJoin(
-      gutil::AsOrderedView(action_invocation->action_parameters), "\n",
-      [](std::string* out, auto pair) {
-        absl::StrAppend(out, "-- Action Parameter:\"", pair.first,
-                        "\" -> Value: ", EvalResultToString(pair.second));
-      });
+  std::vector<std::string> params;
+  for (int slot = 0; slot < action_invocation->action_parameters.size();
+       ++slot) {
+    const std::optional<BigInt>& value =
+        action_invocation->action_parameters[slot];
+    if (!value.has_value()) continue;
+    params.push_back(absl::StrCat("-- Action Parameter:\"",
+                                  action_invocation->layout->names[slot],
+                                  "\" -> Value: ", EvalResultToString(*value)));
+  }
+  std::string param_info = absl::StrJoin(params, "\n");
 
   return absl::StrFormat(
       "Action Name: \"%s\"\n"
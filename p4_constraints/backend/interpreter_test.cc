@@ -19,6 +19,7 @@
 #include <gtest/gtest.h>
 #include <stdint.h>
 
+#include <memory>
 #include <string>
 #include <utility>
 #include <variant>
@@ -36,7 +37,9 @@
 #include "p4/v1/p4runtime.pb.h"
 #include "p4_constraints/ast.h"
 #include "p4_constraints/ast.pb.h"
+#include "p4_constraints/backend/constant_pool.h"
 #include "p4_constraints/backend/constraint_info.h"
+#include "p4_constraints/backend/flat_constraint.h"
 #include "p4_constraints/big_int.h"
 #include "p4_constraints/constraint_source.h"
 
@@ -51,9 +54,12 @@ using ::gutil::StatusIs;
 using ::p4_constraints::ast::Expression;
 using ::p4_constraints::ast::Type;
 using ::testing::Contains;
+using ::testing::ElementsAre;
 using ::testing::Eq;
 using ::testing::Not;
+using ::testing::Optional;
 using ::testing::Pair;
+using ::testing::Pointee;
 using ::testing::UnorderedElementsAre;
 
 BigInt ParseBigIntForTest(absl::string_view text, int base = 10) {
@@ -109,9 +115,9 @@ class ReasonEntryViolatesConstraintTest : public ::testing::Test {
           {"optional32", {5, "optional32", kOptional32}},
       }};
 
-  const TableEntry kParsedEntry = {
-      .table_name = "table",
-      .keys = {
+  const TableEntry kParsedEntry = MakeTableEntry(
+      "table", /*priority=*/0,
+      {
           {"exact32", {Exact{.value = BigInt(42)}}},
           {"ternary32", {Ternary{.value = BigInt(12), .mask = BigInt(128)}}},
           {"lpm32", {Lpm{.value = BigInt(0), .prefix_length = BigInt(32)}}},
@@ -119,7 +125,7 @@ class ReasonEntryViolatesConstraintTest : public ::testing::Test {
           {"optional32",
            {Ternary{.value = BigInt(12),
                     .mask = (BigInt(1) << 32) - BigInt(1)}}},
-      }};
+      });
 
   const EvaluationContext kEvaluationContext = {
       .constraint_context = kParsedEntry,
@@ -137,7 +143,7 @@ class ReasonEntryViolatesConstraintTest : public ::testing::Test {
 
   ConstraintInfo MakeConstraintInfo(const Expression& expr) {
     TableInfo table_info = kTableInfo;
-    table_info.constraint = expr;
+    table_info.constraint = std::make_shared<const Expression>(expr);
     table_info.constraint_source.constraint_location.set_table_name(
         table_info.name);
     return {
@@ -231,7 +237,8 @@ class ReasonEntryViolatesConstraintTest : public ::testing::Test {
   const ActionInfo kMulticastGroupIdActionInfo = {
       .id = 123,
       .name = "multicast_group_id",
-      .constraint = kMulticastGroupIdConstraint,
+      .constraint =
+          std::make_shared<const Expression>(kMulticastGroupIdConstraint),
       .params_by_id = {{1, {1, "multicast_group_id", kFixedUnsigned32}}},
       .params_by_name = {{"multicast_group_id",
                           {1, "multicast_group_id", kFixedUnsigned32}}},
@@ -240,13 +247,14 @@ class ReasonEntryViolatesConstraintTest : public ::testing::Test {
   const ActionInfo kActionInfoVlanId = {
       .id = 124,
       .name = "vlan_id",
-      .constraint = kVlanIdConstraint,
+      .constraint = std::make_shared<const Expression>(kVlanIdConstraint),
       .params_by_id = {{1, {1, "vlan_id", kFixedUnsigned32}}},
       .params_by_name = {{"vlan_id", {1, "vlan_id", kFixedUnsigned32}}},
   };
 };
 
 class EvalTest : public ReasonEntryViolatesConstraintTest {};
+class ParseTableEntryTest : public ReasonEntryViolatesConstraintTest {};
 class EvalToBoolCacheTest : public ReasonEntryViolatesConstraintTest {};
 
 TEST_F(ReasonEntryViolatesConstraintTest, EntryShouldMeetActionConstraint) {
@@ -389,7 +397,8 @@ TEST_F(ReasonEntryViolatesConstraintTest, EntryShouldViolateActionConstraint) {
   )pb");
 
   ActionInfo action_info = kMulticastGroupIdActionInfo;
-  action_info.constraint = multicast_group_id_constraint;
+  action_info.constraint =
+      std::make_shared<const Expression>(multicast_group_id_constraint);
   action_info.constraint_source.constraint_location.set_action_name(
       "multicast_group_id");
 
@@ -505,11 +514,13 @@ TEST_F(ReasonEntryViolatesConstraintTest,
   ActionInfo multicast_group_id_action_info = kMulticastGroupIdActionInfo;
   ActionInfo vlan_id_action_info = kActionInfoVlanId;
 
-  multicast_group_id_action_info.constraint = multicast_group_id_constraint;
+  multicast_group_id_action_info.constraint =
+      std::make_shared<const Expression>(multicast_group_id_constraint);
   multicast_group_id_action_info.constraint_source.constraint_location
       .set_action_name("multicast_group_id");
 
-  vlan_id_action_info.constraint = vlan_id_constraint;
+  vlan_id_action_info.constraint =
+      std::make_shared<const Expression>(vlan_id_constraint);
   vlan_id_action_info.constraint_source.constraint_location.set_action_name(
       "vlan_id");
 
@@ -761,7 +772,7 @@ TEST_F(EvalTest, Key) {
   for (auto& name_and_key_info : kTableInfo.keys_by_name) {
     auto key_name = name_and_key_info.first;
     const Expression kExpr = KeyExpr(key_name);
-    EvalResult result = kParsedEntry.keys.find(key_name)->second;
+    EvalResult result = *FindKey(kParsedEntry, key_name);
     if (kExpr.type().type_case() == Type::kUnknown ||
         kExpr.type().type_case() == Type::kUnsupported) {
       EXPECT_THAT(Eval(kExpr, kEvaluationContext, nullptr),
@@ -842,6 +853,30 @@ TEST_F(EvalTest, TypeCast) {
   }
 }
 
+TEST_F(EvalTest, TypeCastWithConstantPool) {
+  const BigInt max_uint32 = (BigInt(1) << 32) - 1;  // 2^32 - 1
+
+  for (int n : {-1, 42}) {
+    const BigInt unsigned_n = (n == -1) ? max_uint32 : BigInt(n);
+    Expression fixed32 = ExpressionWithType(kFixedUnsigned32, "");
+    *fixed32.mutable_type_cast() = ExpressionWithType(
+        kArbitraryInt, absl::Substitute(R"(integer_constant: "$0")", n));
+    Expression expr = ExpressionWithType(kTernary32, "");
+    *expr.mutable_type_cast() = fixed32;
+
+    ASSERT_OK_AND_ASSIGN(const ConstantPool pool, BuildConstantPool(expr));
+    const EvaluationContext context = {
+        .constraint_context = kParsedEntry,
+        .constraint_source = kDummySource,
+        .constant_pool = &pool,
+    };
+    EvalResult result = unsigned_n;
+    EXPECT_THAT(Eval(fixed32, context, nullptr), IsOkAndHolds(Eq(result)));
+    result = Ternary{.value = unsigned_n, .mask = max_uint32};
+    EXPECT_THAT(Eval(expr, context, nullptr), IsOkAndHolds(Eq(result)));
+  }
+}
+
 TEST_F(EvalTest, BinaryExpression_BooleanArguments) {
   const Expression kConstTrue =
       ExpressionWithType(kBool, "boolean_constant: true");
@@ -985,8 +1020,14 @@ TEST_F(EvalTest, FieldAccess) {
   BigInt value2 = BigInt(-21);
   EvalResult result2 = value2;
 
+  // Overrides the value of the given key of `entry`.
+  auto set_key = [](TableEntry& entry, const std::string& name,
+                    EvalResult value) {
+    entry.keys[entry.layout->slot_by_name.at(name)] = std::move(value);
+  };
+
   TableEntry entry = kParsedEntry;
-  entry.keys["exact32"] = Exact{.value = value};
+  set_key(entry, "exact32", Exact{.value = value});
   EXPECT_THAT(Eval(FieldAccessExpr("value", "exact32", kFixedUnsigned32),
                    MakeEvaluationContext(entry), nullptr),
               IsOkAndHolds(Eq(result)));
@@ -997,7 +1038,7 @@ TEST_F(EvalTest, FieldAccess) {
   }
 
   entry = kParsedEntry;  // Reset.
-  entry.keys["ternary32"] = Ternary{.value = value, .mask = value2};
+  set_key(entry, "ternary32", Ternary{.value = value, .mask = value2});
   EXPECT_THAT(Eval(FieldAccessExpr("value", "ternary32", kFixedUnsigned32),
                    MakeEvaluationContext(entry), nullptr),
               IsOkAndHolds(Eq(result)));
@@ -1011,7 +1052,7 @@ TEST_F(EvalTest, FieldAccess) {
   }
 
   entry = kParsedEntry;  // Reset.
-  entry.keys["lpm32"] = Lpm{.value = value, .prefix_length = value2};
+  set_key(entry, "lpm32", Lpm{.value = value, .prefix_length = value2});
   EXPECT_THAT(Eval(FieldAccessExpr("value", "lpm32", kFixedUnsigned32),
                    MakeEvaluationContext(entry), nullptr),
               IsOkAndHolds(Eq(result)));
@@ -1025,7 +1066,7 @@ TEST_F(EvalTest, FieldAccess) {
   }
 
   entry = kParsedEntry;  // Reset.
-  entry.keys["range32"] = Range{.low = value, .high = value2};
+  set_key(entry, "range32", Range{.low = value, .high = value2});
   EXPECT_THAT(Eval(FieldAccessExpr("low", "range32", kFixedUnsigned32),
                    MakeEvaluationContext(entry), nullptr),
               IsOkAndHolds(Eq(result)));
@@ -1138,15 +1179,28 @@ TEST_F(EvalToBoolCacheTest, CacheIsUsed) {
               Eq(false));
 }
 
+TEST_F(EvalToBoolCacheTest, CacheIsSharedByIdenticalSubexpressions) {
+  const Expression kConstraint = BinaryBooleanExpr(false, ast::AND, false);
+  EvaluationCache eval_cache;
+  eval_cache.insert({&kConstraint.binary_expression().left(), true});
+  // Evaluating the right operand yields the cached result of the left one.
+  EXPECT_THAT(EvalToBool(kConstraint, kEvaluationContext, &eval_cache),
+              IsOkAndHolds(true));
+  EXPECT_THAT(eval_cache,
+              UnorderedElementsAre(
+                  Pair(&kConstraint, true),
+                  Pair(&kConstraint.binary_expression().left(), true),
+                  Pair(&kConstraint.binary_expression().right(), true)));
+}
+
 class MinimalSubexpressionLeadingToEvalResultTest
     : public ReasonEntryViolatesConstraintTest {
  public:
   absl::StatusOr<const Expression*>
   MinimalSubexpressionLeadingToEvalResultHelper(const Expression& kConstraint) {
     EvaluationCache eval_cache;
-    ast::SizeCache size_cache;
     return MinimalSubexpressionLeadingToEvalResult(
-        kConstraint, kEvaluationContext, eval_cache, size_cache);
+        kConstraint, kEvaluationContext, eval_cache);
   }
 };
 
@@ -1291,6 +1345,202 @@ TEST_F(MinimalSubexpressionLeadingToEvalResultTest,
               IsOkAndHolds(Eq(&kConstraint)));
 }
 
+TEST_F(MinimalSubexpressionLeadingToEvalResultTest,
+       ViolationReasonCarriesTruthValueThroughNegation) {
+  Expression constraint = ExpressionWithType(kBool, "");
+  *constraint.mutable_boolean_negation() =
+      BinaryBooleanExpr(true, ast::AND, true);
+  const FlatConstraint flat = FlattenConstraint(constraint);
+  FlatEvaluationCache eval_cache;
+  eval_cache.Reset(flat.nodes.size());
+  ASSERT_OK_AND_ASSIGN(
+      ViolationReason reason,
+      FindViolationReason(flat, kEvaluationContext, eval_cache));
+  // The nodes are `true`, `true`, the conjunction, and its negation.
+  EXPECT_EQ(reason.node, 2);
+  EXPECT_EQ(reason.subexpression, &constraint.boolean_negation());
+  EXPECT_TRUE(reason.truth_value);
+}
+
+TEST_F(ParseTableEntryTest, OmittedKeysGetPrebuiltDefaultValues) {
+  TableInfo table_info = kTableInfo;
+  table_info.key_layout =
+      std::make_shared<const EntryLayout>(MakeKeyLayout(table_info));
+  ASSERT_OK_AND_ASSIGN(const EvaluationContext context,
+                       ParseTableEntry(kTableEntry, table_info));
+  const TableEntry& entry = std::get<TableEntry>(context.constraint_context);
+  EXPECT_EQ(entry.layout, table_info.key_layout);
+  EXPECT_THAT(entry.layout->names,
+              ElementsAre("exact32", "lpm32", "optional32", "range32",
+                          "ternary32"));
+  EXPECT_THAT(entry.keys,
+              ElementsAre(EvalResult(Exact{.value = 65}), EvalResult(Lpm{}),
+                          EvalResult(Ternary{}),
+                          EvalResult(Range{.low = 0,
+                                           .high = (BigInt(1) << 32) - 1}),
+                          EvalResult(Ternary{})));
+}
+
+TEST_F(ParseTableEntryTest, LayoutIsDerivedOnTheFlyIfAbsent) {
+  ASSERT_OK_AND_ASSIGN(const EvaluationContext context,
+                       ParseTableEntry(kTableEntry, kTableInfo));
+  const TableEntry& entry = std::get<TableEntry>(context.constraint_context);
+  EXPECT_THAT(FindKey(entry, "exact32"),
+              Pointee(Eq(EvalResult(Exact{.value = 65}))));
+  EXPECT_EQ(FindKey(entry, "unknown"), nullptr);
+}
+
+TEST_F(ParseTableEntryTest, DuplicateKeysAreRejected) {
+  p4::v1::TableEntry table_entry = kTableEntry;
+  *table_entry.add_match() = table_entry.match(0);
+  EXPECT_THAT(ParseTableEntry(table_entry, kTableInfo),
+              StatusIs(StatusCode::kInvalidArgument));
+}
+
+TEST_F(ParseTableEntryTest, MissingExactKeyIsRejected) {
+  EXPECT_THAT(ParseTableEntry(p4::v1::TableEntry(), kTableInfo),
+              StatusIs(StatusCode::kInvalidArgument));
+}
+
+TEST_F(ParseTableEntryTest, UnreferencedKeysAreValidatedButNotConverted) {
+  TableInfo table_info = kTableInfo;
+  table_info.keys_by_id[2] = table_info.keys_by_name.at("ternary32");
+  table_info.constraint = std::make_shared<const Expression>(
+      ParseProtoOrDie<Expression>(R"pb(key: "exact32")pb"));
+  table_info.key_layout =
+      std::make_shared<const EntryLayout>(MakeKeyLayout(table_info));
+  EXPECT_THAT(table_info.key_layout->referenced,
+              ElementsAre(true, false, false, false, false));
+
+  p4::v1::TableEntry table_entry = kTableEntry;
+  *table_entry.add_match() = ParseProtoOrDie<p4::v1::FieldMatch>(R"pb(
+    field_id: 2
+    ternary { value: "\x0c" mask: "\x80" }
+  )pb");
+  TableEntry entry;
+  ASSERT_OK(ParseTableEntryInto(table_entry, table_info,
+                                ParsedValues::kReferenced, entry));
+  EXPECT_THAT(FindKey(entry, "exact32"),
+              Pointee(Eq(EvalResult(Exact{.value = 65}))));
+  EXPECT_EQ(FindKey(entry, "ternary32"), nullptr);
+
+  // Unreferenced keys are still checked for duplicates and consistency.
+  p4::v1::TableEntry duplicate_entry = table_entry;
+  *duplicate_entry.add_match() = table_entry.match(1);
+  EXPECT_THAT(ParseTableEntryInto(duplicate_entry, table_info,
+                                  ParsedValues::kReferenced, entry),
+              StatusIs(StatusCode::kInvalidArgument));
+  p4::v1::TableEntry inconsistent_entry = kTableEntry;
+  *inconsistent_entry.add_match() = ParseProtoOrDie<p4::v1::FieldMatch>(R"pb(
+    field_id: 2
+    exact { value: "\x0c" }
+  )pb");
+  EXPECT_THAT(ParseTableEntryInto(inconsistent_entry, table_info,
+                                  ParsedValues::kReferenced, entry),
+              StatusIs(StatusCode::kInternal));
+  p4::v1::TableEntry unknown_key_entry = kTableEntry;
+  unknown_key_entry.add_match()->set_field_id(6);
+  EXPECT_THAT(ParseTableEntryInto(unknown_key_entry, table_info,
+                                  ParsedValues::kReferenced, entry),
+              StatusIs(StatusCode::kInvalidArgument));
+}
+
+TEST_F(ParseTableEntryTest, ParseTableEntryConvertsUnreferencedKeys) {
+  TableInfo table_info = kTableInfo;
+  table_info.keys_by_id[2] = table_info.keys_by_name.at("ternary32");
+  table_info.constraint = std::make_shared<const Expression>(
+      ParseProtoOrDie<Expression>(R"pb(key: "exact32")pb"));
+  table_info.key_layout =
+      std::make_shared<const EntryLayout>(MakeKeyLayout(table_info));
+
+  p4::v1::TableEntry table_entry = kTableEntry;
+  *table_entry.add_match() = ParseProtoOrDie<p4::v1::FieldMatch>(R"pb(
+    field_id: 2
+    ternary { value: "\x0c" mask: "\x80" }
+  )pb");
+  ASSERT_OK_AND_ASSIGN(const EvaluationContext context,
+                       ParseTableEntry(table_entry, table_info));
+  const TableEntry& entry = std::get<TableEntry>(context.constraint_context);
+  EXPECT_THAT(FindKey(entry, "ternary32"),
+              Pointee(Eq(EvalResult(Ternary{.value = 12, .mask = 128}))));
+  // Omitted keys get their default values, whether or not they are referenced.
+  EXPECT_THAT(FindKey(entry, "range32"),
+              Pointee(Eq(EvalResult(
+                  Range{.low = 0, .high = (BigInt(1) << 32) - 1}))));
+
+  // So the entry can be evaluated against expressions other than the
+  // constraint.
+  const Expression expr = ParseProtoOrDie<Expression>(R"pb(
+    key: "ternary32"
+    type { ternary { bitwidth: 32 } }
+  )pb");
+  EXPECT_THAT(Eval(expr, context, nullptr),
+              IsOkAndHolds(Eq(EvalResult(Ternary{.value = 12, .mask = 128}))));
+}
+
+TEST_F(ParseTableEntryTest, UnreferencedOmittedKeysGetNoDefaultValues) {
+  TableInfo table_info = kTableInfo;
+  table_info.constraint = std::make_shared<const Expression>(
+      ParseProtoOrDie<Expression>(R"pb(key: "range32")pb"));
+  table_info.key_layout =
+      std::make_shared<const EntryLayout>(MakeKeyLayout(table_info));
+  TableEntry entry;
+  ASSERT_OK(ParseTableEntryInto(kTableEntry, table_info,
+                                ParsedValues::kReferenced, entry));
+  EXPECT_THAT(FindKey(entry, "range32"),
+              Pointee(Eq(EvalResult(
+                  Range{.low = 0, .high = (BigInt(1) << 32) - 1}))));
+  EXPECT_EQ(FindKey(entry, "exact32"), nullptr);
+  EXPECT_EQ(FindKey(entry, "lpm32"), nullptr);
+  EXPECT_EQ(FindKey(entry, "optional32"), nullptr);
+  EXPECT_EQ(FindKey(entry, "ternary32"), nullptr);
+}
+
+TEST_F(ParseTableEntryTest, ActionParamsAreStoredBySlot) {
+  ASSERT_OK_AND_ASSIGN(const EvaluationContext context,
+                       ParseAction(ParseProtoOrDie<p4::v1::Action>(R"pb(
+                                     action_id: 124
+                                     params { param_id: 1 value: "\x05" }
+                                   )pb"),
+                                   kActionInfoVlanId));
+  const ActionInvocation& action =
+      std::get<ActionInvocation>(context.constraint_context);
+  EXPECT_THAT(action.action_parameters, ElementsAre(Optional(Eq(5))));
+  EXPECT_THAT(FindActionParameter(action, "vlan_id"), Pointee(Eq(5)));
+  EXPECT_EQ(FindActionParameter(action, "port"), nullptr);
+}
+
+TEST_F(ParseTableEntryTest, UnreferencedActionParamsAreValidatedButNotParsed) {
+  ActionInfo action_info = kActionInfoVlanId;
+  action_info.params_by_id[2] = {2, "port", kFixedUnsigned32};
+  action_info.params_by_name["port"] = {2, "port", kFixedUnsigned32};
+  const p4::v1::Action action = ParseProtoOrDie<p4::v1::Action>(R"pb(
+    action_id: 124
+    params { param_id: 1 value: "\x05" }
+    params { param_id: 2 value: "\x07" }
+  )pb");
+  ActionInvocation invocation;
+  ASSERT_OK(ParseActionInto(action, action_info, ParsedValues::kReferenced,
+                            invocation));
+  EXPECT_THAT(FindActionParameter(invocation, "vlan_id"), Pointee(Eq(5)));
+  EXPECT_EQ(FindActionParameter(invocation, "port"), nullptr);
+
+  // Unreferenced params are still checked for duplicates.
+  p4::v1::Action duplicate_action = action;
+  *duplicate_action.add_params() = action.params(1);
+  EXPECT_THAT(ParseActionInto(duplicate_action, action_info,
+                              ParsedValues::kReferenced, invocation),
+              StatusIs(StatusCode::kInvalidArgument));
+
+  // `ParseAction` parses all params.
+  ASSERT_OK_AND_ASSIGN(const EvaluationContext context,
+                       ParseAction(action, action_info));
+  EXPECT_THAT(FindActionParameter(
+                  std::get<ActionInvocation>(context.constraint_context),
+                  "port"),
+              Pointee(Eq(7)));
+}
+
 TEST(ParseP4RTInteger, ParsesZeroCorrectly) {
   auto zero_string = std::string(1, '\0');
   ASSERT_EQ(zero_string.size(), 1);
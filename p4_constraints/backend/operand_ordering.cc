@@ -0,0 +1,358 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "p4_constraints/backend/operand_ordering.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "absl/functional/function_ref.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "gutil/status.h"
+#include "p4_constraints/ast.h"
+#include "p4_constraints/ast.pb.h"
+
+namespace p4_constraints {
+
+namespace {
+
+using ::p4_constraints::ast::Expression;
+using ::p4_constraints::ast::SourceLocation;
+using ::p4_constraints::ast::Type;
+
+// Estimated probability that an equality holds, e.g. that a key matches one of
+// the values it is compared against.
+constexpr double kProbabilityEqual = 0.1;
+
+// Returns the number of 64-bit words needed to represent values of `type`.
+double Words(const Type& type) {
+  const int bitwidth = ast::TypeBitwidth(type).value_or(64);
+  return std::max(1, (bitwidth + 63) / 64);
+}
+
+// Returns the cost of evaluating `expr`; see `OperandEstimate::cost`.
+double Cost(const Expression& expr) {
+  switch (expr.expression_case()) {
+    case Expression::kKey:
+    case Expression::kActionParameter:
+    case Expression::kAttributeAccess:
+      return 1 + Words(expr.type());
+    case Expression::kBooleanNegation:
+      return 1 + Cost(expr.boolean_negation());
+    case Expression::kArithmeticNegation:
+      return 1 + Cost(expr.arithmetic_negation());
+    case Expression::kTypeCast:
+      return Cost(expr.type_cast());
+    case Expression::kFieldAccess:
+      return Cost(expr.field_access().expr());
+    case Expression::kBinaryExpression: {
+      const ast::BinaryExpression& binexpr = expr.binary_expression();
+      double cost = 1 + Cost(binexpr.left()) + Cost(binexpr.right());
+      // Comparisons are proportional to the width of the compared values.
+      if (!binexpr.left().type().has_boolean()) {
+        cost += Words(binexpr.left().type());
+      }
+      return cost;
+    }
+    default:
+      return 0;
+  }
+}
+
+double ProbabilityTrue(const Expression& expr) {
+  switch (expr.expression_case()) {
+    case Expression::kBooleanConstant:
+      return expr.boolean_constant() ? 1 : 0;
+    case Expression::kBooleanNegation:
+      return 1 - ProbabilityTrue(expr.boolean_negation());
+    case Expression::kBinaryExpression: {
+      const ast::BinaryExpression& binexpr = expr.binary_expression();
+      switch (binexpr.binop()) {
+        case ast::EQ:
+          return kProbabilityEqual;
+        case ast::NE:
+          return 1 - kProbabilityEqual;
+        case ast::AND:
+          return ProbabilityTrue(binexpr.left()) *
+                 ProbabilityTrue(binexpr.right());
+        case ast::OR:
+          return 1 - (1 - ProbabilityTrue(binexpr.left())) *
+                         (1 - ProbabilityTrue(binexpr.right()));
+        case ast::IMPLIES:
+          return 1 - ProbabilityTrue(binexpr.left()) *
+                         (1 - ProbabilityTrue(binexpr.right()));
+        default:
+          return 0.5;
+      }
+    }
+    default:
+      return 0.5;
+  }
+}
+
+// Returns the rank of an operand of a chain of `binop`s; evaluating operands in
+// order of increasing rank minimizes the expected cost of the chain. Operands
+// that never decide the chain go last.
+double Rank(const OperandEstimate& estimate, ast::BinaryOperator binop) {
+  const double probability_decisive = binop == ast::AND
+                                           ? 1 - estimate.probability_true
+                                           : estimate.probability_true;
+  if (probability_decisive <= 0) return std::numeric_limits<double>::infinity();
+  return estimate.cost / probability_decisive;
+}
+
+bool IsChainOf(ast::BinaryOperator binop, const Expression& expr) {
+  return expr.has_binary_expression() &&
+         expr.binary_expression().binop() == binop;
+}
+
+// Moves the operands of the chain of `binop`s rooted at `expr` into
+// `operands`, in source order.
+void CollectOperands(ast::BinaryOperator binop, Expression& expr,
+                     std::vector<ast::ExpressionPtr>& operands) {
+  if (!IsChainOf(binop, expr)) {
+    operands.push_back(ast::TakeExpression(&expr));
+    return;
+  }
+  CollectOperands(binop, *expr.mutable_binary_expression()->mutable_left(),
+                  operands);
+  CollectOperands(binop, *expr.mutable_binary_expression()->mutable_right(),
+                  operands);
+}
+
+bool IsBefore(const SourceLocation& left, const SourceLocation& right) {
+  return std::make_pair(left.line(), left.column()) <
+         std::make_pair(right.line(), right.column());
+}
+
+// Collects the operands of the chain of `binop`s rooted at `expr`, in source
+// order.
+void CollectOperands(ast::BinaryOperator binop, const Expression& expr,
+                     std::vector<const Expression*>& operands) {
+  if (!IsChainOf(binop, expr)) {
+    operands.push_back(&expr);
+    return;
+  }
+  CollectOperands(binop, expr.binary_expression().left(), operands);
+  CollectOperands(binop, expr.binary_expression().right(), operands);
+}
+
+// Returns the order in which to evaluate the operands of a chain of `binop`s
+// with the given estimates, as indices into `estimates`: by increasing rank,
+// and in source order among operands of equal rank.
+std::vector<int> RankedOrder(ast::BinaryOperator binop,
+                             absl::Span<const OperandEstimate> estimates) {
+  std::vector<double> ranks;
+  ranks.reserve(estimates.size());
+  for (const OperandEstimate& estimate : estimates) {
+    ranks.push_back(Rank(estimate, binop));
+  }
+  std::vector<int> order(estimates.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](int left, int right) {
+    return ranks[left] < ranks[right];
+  });
+  return order;
+}
+
+// Implements `ReorderOperands` for `expr`, whose first chain operand (if any)
+// has the estimate `estimates[next]`. Advances `next` past its operands, which
+// are visited in the order of `ChainOperands`.
+void Reorder(Expression* expr, absl::Span<const OperandEstimate> estimates,
+             int& next) {
+  switch (expr->expression_case()) {
+    case Expression::kBooleanNegation:
+      Reorder(expr->mutable_boolean_negation(), estimates, next);
+      return;
+    case Expression::kBinaryExpression:
+      break;
+    default:
+      // Only Boolean connectives have Boolean subexpressions.
+      return;
+  }
+
+  const ast::BinaryOperator binop = expr->binary_expression().binop();
+  if (binop != ast::AND && binop != ast::OR) {
+    // Not commutative, but operands may contain chains, e.g. in
+    // `(a && b) -> c` or `(a || b) == c`.
+    ast::BinaryExpression& binexpr = *expr->mutable_binary_expression();
+    Reorder(binexpr.mutable_left(), estimates, next);
+    Reorder(binexpr.mutable_right(), estimates, next);
+    return;
+  }
+
+  std::vector<ast::ExpressionPtr> operands;
+  CollectOperands(binop, *expr, operands);
+  const absl::Span<const OperandEstimate> chain_estimates =
+      estimates.subspan(next, operands.size());
+  next += operands.size();
+  for (ast::ExpressionPtr& operand : operands) {
+    Reorder(operand.get(), estimates, next);
+  }
+  const std::vector<int> order = RankedOrder(binop, chain_estimates);
+
+  // Rebuilds the chain, nested to the left like the parser does, so that
+  // operands are evaluated in order of increasing rank. The operands are moved
+  // rather than copied, on the arena of `expr` if it has one.
+  ast::ExpressionPtr chain = std::move(operands[order[0]]);
+  for (int i = 1; i < order.size(); ++i) {
+    ast::ExpressionPtr operand = std::move(operands[order[i]]);
+    ast::ExpressionPtr connective = ast::NewExpression(expr->GetArena());
+    *connective->mutable_type() = expr->type();
+    *connective->mutable_start_location() =
+        IsBefore(chain->start_location(), operand->start_location())
+            ? chain->start_location()
+            : operand->start_location();
+    *connective->mutable_end_location() =
+        IsBefore(chain->end_location(), operand->end_location())
+            ? operand->end_location()
+            : chain->end_location();
+    ast::BinaryExpression& binexpr = *connective->mutable_binary_expression();
+    binexpr.set_binop(binop);
+    binexpr.set_allocated_left(chain.release());
+    binexpr.set_allocated_right(operand.release());
+    chain = std::move(connective);
+  }
+  *chain->mutable_start_location() = expr->start_location();
+  *chain->mutable_end_location() = expr->end_location();
+  expr->Swap(chain.get());
+}
+
+// Same as `Reorder`, but only computes the resulting order of the operands of
+// `expr` (see `OperandOrder`) and returns it, leaving `expr` unchanged.
+std::vector<int> OrderOf(const Expression& expr,
+                         absl::Span<const OperandEstimate> estimates,
+                         int& next) {
+  switch (expr.expression_case()) {
+    case Expression::kBooleanNegation:
+      return OrderOf(expr.boolean_negation(), estimates, next);
+    case Expression::kBinaryExpression:
+      break;
+    default:
+      return {};
+  }
+
+  const ast::BinaryOperator binop = expr.binary_expression().binop();
+  if (binop != ast::AND && binop != ast::OR) {
+    std::vector<int> order =
+        OrderOf(expr.binary_expression().left(), estimates, next);
+    std::vector<int> right_order =
+        OrderOf(expr.binary_expression().right(), estimates, next);
+    order.insert(order.end(), right_order.begin(), right_order.end());
+    return order;
+  }
+
+  std::vector<const Expression*> operands;
+  CollectOperands(binop, expr, operands);
+  const int first = next;
+  next += operands.size();
+  // The operands of nested chains follow in the source order of the operands
+  // that hold them, and are moved along with them.
+  std::vector<std::vector<int>> nested_orders;
+  nested_orders.reserve(operands.size());
+  for (const Expression* operand : operands) {
+    nested_orders.push_back(OrderOf(*operand, estimates, next));
+  }
+  const std::vector<int> chain_order =
+      RankedOrder(binop, estimates.subspan(first, operands.size()));
+  std::vector<int> order;
+  for (int i : chain_order) order.push_back(first + i);
+  for (int i : chain_order) {
+    order.insert(order.end(), nested_orders[i].begin(), nested_orders[i].end());
+  }
+  return order;
+}
+
+// Returns an error unless there are as many `estimates` as operands in `expr`.
+absl::Status CheckEstimatesFor(const Expression& expr,
+                               absl::Span<const OperandEstimate> estimates) {
+  const int num_operands = ChainOperands(expr).size();
+  if (estimates.size() != num_operands) {
+    return gutil::InvalidArgumentErrorBuilder()
+           << "got " << estimates.size() << " estimates for " << num_operands
+           << " operands";
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+OperandEstimate EstimateOperand(const Expression& expr) {
+  return OperandEstimate{
+      .cost = Cost(expr),
+      .probability_true = ProbabilityTrue(expr),
+  };
+}
+
+absl::Status ReorderOperands(
+    Expression* expr,
+    absl::FunctionRef<OperandEstimate(const Expression&)> estimate) {
+  std::vector<OperandEstimate> estimates;
+  for (const Expression* operand : ChainOperands(*expr)) {
+    estimates.push_back(estimate(*operand));
+  }
+  return ReorderOperands(expr, estimates);
+}
+
+absl::Status ReorderOperands(Expression* expr,
+                             absl::Span<const OperandEstimate> estimates) {
+  RETURN_IF_ERROR(CheckEstimatesFor(*expr, estimates));
+  int next = 0;
+  Reorder(expr, estimates, next);
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::vector<int>> OperandOrder(
+    const Expression& expr, absl::Span<const OperandEstimate> estimates) {
+  RETURN_IF_ERROR(CheckEstimatesFor(expr, estimates));
+  int next = 0;
+  return OrderOf(expr, estimates, next);
+}
+
+absl::Status ReorderOperandsByCost(Expression* expr) {
+  return ReorderOperands(expr, EstimateOperand);
+}
+
+std::vector<const Expression*> ChainOperands(const Expression& expr) {
+  std::vector<const Expression*> operands;
+  std::vector<const Expression*> worklist = {&expr};
+  while (!worklist.empty()) {
+    const Expression& subexpr = *worklist.back();
+    worklist.pop_back();
+    if (subexpr.has_boolean_negation()) {
+      worklist.push_back(&subexpr.boolean_negation());
+      continue;
+    }
+    if (!subexpr.has_binary_expression()) continue;
+    const ast::BinaryExpression& binexpr = subexpr.binary_expression();
+    if (binexpr.binop() != ast::AND && binexpr.binop() != ast::OR) {
+      worklist.push_back(&binexpr.right());
+      worklist.push_back(&binexpr.left());
+      continue;
+    }
+    // Collects the chain's operands in source order, then visits them.
+    std::vector<const Expression*> chain = {&subexpr};
+    const size_t first = operands.size();
+    while (!chain.empty()) {
+      const Expression& link = *chain.back();
+      chain.pop_back();
+      if (IsChainOf(binexpr.binop(), link)) {
+        chain.push_back(&link.binary_expression().right());
+        chain.push_back(&link.binary_expression().left());
+      } else {
+        operands.push_back(&link);
+      }
+    }
+    for (size_t i = operands.size(); i > first; --i) {
+      worklist.push_back(operands[i - 1]);
+    }
+  }
+  return operands;
+}
+
+}  // namespace p4_constraints
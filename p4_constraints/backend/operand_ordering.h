@@ -0,0 +1,80 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+// Reorders the operands of Boolean connectives so that cheap and selective
+// operands are evaluated first.
+//
+// Constraints are written for readability: a restriction with dozens of
+// clauses often starts with the clauses that read wide keys or nest deeply,
+// while `&&` and `||` short-circuit strictly left to right. Since conjunction
+// and disjunction are commutative, the operands of `&&`/`||` chains (including
+// `;`-separated sequences, which parse as `&&`) may be evaluated in any order
+// without changing the verdict.
+
+#ifndef P4_CONSTRAINTS_BACKEND_OPERAND_ORDERING_H_
+#define P4_CONSTRAINTS_BACKEND_OPERAND_ORDERING_H_
+
+#include <vector>
+
+#include "absl/functional/function_ref.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "p4_constraints/ast.pb.h"
+
+namespace p4_constraints {
+
+// Estimates used to order the operands of a Boolean connective.
+struct OperandEstimate {
+  // Relative cost of evaluating the operand, growing with the number of keys
+  // and parameters read, their width in 64-bit words, and the operand's size.
+  double cost = 0;
+  // Estimated probability that the operand evaluates to true, e.g. 1/2 for
+  // ordering comparisons and less for equalities.
+  double probability_true = 0.5;
+};
+
+// Returns the static estimates for the given type-checked Boolean expression.
+OperandEstimate EstimateOperand(const ast::Expression& expr);
+
+// Reorders the operands of the `&&` and `||` chains in the given type-checked
+// expression in place. A chain is a maximal tree of binary expressions with the
+// same operator, e.g. `a && (b && c) && d`; its operands are sorted by
+// increasing `cost / P(operand decides the chain)`, as estimated by `estimate`,
+// which minimizes the expected cost of short-circuit evaluation for
+// independent operands. The order is deterministic: operands with equal rank
+// keep their source order.
+//
+// Operands keep their source locations. The connectives of a reordered chain
+// span the locations of their operands, and the root of the chain keeps its
+// location.
+absl::Status ReorderOperands(
+    ast::Expression* expr,
+    absl::FunctionRef<OperandEstimate(const ast::Expression&)> estimate);
+
+// Same as above, but with the given estimates of the operands of `expr`,
+// aligned with `ChainOperands(*expr)`. Since operands are moved when their
+// chain is rebuilt, this identifies them by position rather than by address.
+// Returns InvalidArgument if there are not as many estimates as operands.
+absl::Status ReorderOperands(ast::Expression* expr,
+                             absl::Span<const OperandEstimate> estimates);
+
+// Returns the order in which `ReorderOperands(expr, estimates)` would leave the
+// operands of `expr`, without modifying it: the i-th element of
+// `ChainOperands` of the reordered expression is the `order[i]`-th element of
+// `ChainOperands(expr)`. Lets callers skip copying and reordering an expression
+// whose order would not change.
+absl::StatusOr<std::vector<int>> OperandOrder(
+    const ast::Expression& expr, absl::Span<const OperandEstimate> estimates);
+
+// Same as `ReorderOperands` with the static estimates of `EstimateOperand`.
+absl::Status ReorderOperandsByCost(ast::Expression* expr);
+
+// Returns the operands of all `&&` and `||` chains in `expr`, including those
+// of chains nested in operands. The operands of each chain are returned in
+// order, and before the operands of the chains nested in them.
+std::vector<const ast::Expression*> ChainOperands(const ast::Expression& expr);
+
+}  // namespace p4_constraints
+
+#endif  // P4_CONSTRAINTS_BACKEND_OPERAND_ORDERING_H_
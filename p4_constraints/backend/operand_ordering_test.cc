@@ -0,0 +1,227 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "p4_constraints/backend/operand_ordering.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/status/status.h"
+#include "gutil/proto_matchers.h"
+#include "gutil/status_matchers.h"
+#include "gutil/testing.h"
+#include "p4/config/v1/p4info.pb.h"
+#include "p4/v1/p4runtime.pb.h"
+#include "p4_constraints/ast.pb.h"
+#include "p4_constraints/backend/constraint_info.h"
+#include "p4_constraints/backend/interpreter.h"
+#include "p4_constraints/backend/test_util.h"
+
+namespace p4_constraints {
+namespace {
+
+using ::gutil::EqualsProto;
+using ::gutil::ParseProtoOrDie;
+using ::p4_constraints::ast::Expression;
+using ::p4_constraints::ast::Type;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::Lt;
+using ::testing::Not;
+
+// The table that constraints are type checked against.
+TableInfo TestTable() {
+  return MakeTableInfo({
+      KeyInfo{.id = 1,
+              .name = "exact16",
+              .type = ParseProtoOrDie<Type>("exact { bitwidth: 16 }")},
+      KeyInfo{.id = 2,
+              .name = "lpm128",
+              .type = ParseProtoOrDie<Type>("lpm { bitwidth: 128 }")},
+      KeyInfo{.id = 3,
+              .name = "ternary144",
+              .type = ParseProtoOrDie<Type>("ternary { bitwidth: 144 }")},
+  });
+}
+
+Expression TypeChecked(const std::string& constraint) {
+  return TypeCheckedConstraint(constraint, TestTable());
+}
+
+// Appends the source text of the operands of the chain of `binop`s rooted at
+// `expr` to `operands`, in evaluation order. Expects a single-line constraint.
+void CollectOperands(ast::BinaryOperator binop, const Expression& expr,
+                     const std::string& constraint,
+                     std::vector<std::string>& operands) {
+  if (expr.has_binary_expression() &&
+      expr.binary_expression().binop() == binop) {
+    CollectOperands(binop, expr.binary_expression().left(), constraint,
+                    operands);
+    CollectOperands(binop, expr.binary_expression().right(), constraint,
+                    operands);
+    return;
+  }
+  const int start = expr.start_location().column();
+  operands.push_back(
+      constraint.substr(start, expr.end_location().column() - start));
+}
+
+std::vector<std::string> ReorderedOperands(ast::BinaryOperator binop,
+                                           const std::string& constraint) {
+  Expression expr = TypeChecked(constraint);
+  CHECK_OK(ReorderOperandsByCost(&expr));
+  std::vector<std::string> operands;
+  CollectOperands(binop, expr, constraint, operands);
+  return operands;
+}
+
+TEST(EstimateOperandTest, WiderKeysAreMoreExpensive) {
+  const OperandEstimate narrow = EstimateOperand(TypeChecked("exact16 == 1"));
+  const OperandEstimate wide = EstimateOperand(TypeChecked("lpm128 == 1"));
+  const OperandEstimate both =
+      EstimateOperand(TypeChecked("lpm128 == 1 && exact16 == 1"));
+  EXPECT_THAT(narrow.cost, Lt(wide.cost));
+  EXPECT_THAT(wide.cost, Lt(both.cost));
+}
+
+TEST(EstimateOperandTest, EqualitiesAreSelective) {
+  const OperandEstimate equality = EstimateOperand(TypeChecked("exact16 == 1"));
+  const OperandEstimate disequality =
+      EstimateOperand(TypeChecked("exact16 != 1"));
+  EXPECT_THAT(equality.probability_true, Lt(disequality.probability_true));
+  EXPECT_EQ(EstimateOperand(TypeChecked("!false")).probability_true, 1);
+}
+
+TEST(ReorderOperandsByCostTest, EvaluatesCheapOperandsFirst) {
+  EXPECT_THAT(ReorderedOperands(ast::AND, "lpm128 == 1 && exact16 == 1"),
+              ElementsAre("exact16 == 1", "lpm128 == 1"));
+  EXPECT_THAT(ReorderedOperands(ast::OR, "lpm128 == 1 || exact16 == 1"),
+              ElementsAre("exact16 == 1", "lpm128 == 1"));
+}
+
+TEST(ReorderOperandsByCostTest, EvaluatesSelectiveOperandsFirst) {
+  // An equality is likely to falsify a conjunction.
+  EXPECT_THAT(ReorderedOperands(ast::AND, "exact16 != 1 && exact16 == 2"),
+              ElementsAre("exact16 == 2", "exact16 != 1"));
+  // An inequality is likely to satisfy a disjunction.
+  EXPECT_THAT(ReorderedOperands(ast::OR, "exact16 == 1 || exact16 != 2"),
+              ElementsAre("exact16 != 2", "exact16 == 1"));
+}
+
+TEST(ReorderOperandsByCostTest, ReordersWholeChainsIncludingSequences) {
+  EXPECT_THAT(
+      ReorderedOperands(ast::AND,
+                        "ternary144 == 1; lpm128 == 1 && (exact16 == 1; "
+                        "exact16 != 2 || lpm128 != 2)"),
+      ElementsAre("exact16 == 1", "lpm128 == 1", "ternary144 == 1",
+                  "exact16 != 2 || lpm128 != 2"));
+}
+
+TEST(ReorderOperandsByCostTest, ReordersChainsInsideOtherExpressions) {
+  EXPECT_THAT(
+      ReorderedOperands(ast::IMPLIES,
+                        "lpm128 == 1 && exact16 == 1 -> lpm128 == 2"),
+      ElementsAre("lpm128 == 1 && exact16 == 1", "lpm128 == 2"));
+  Expression expr =
+      TypeChecked("!(lpm128 == 1 && exact16 == 1) -> lpm128 == 2");
+  ASSERT_OK(ReorderOperandsByCost(&expr));
+  const Expression& conjunction =
+      expr.binary_expression().left().boolean_negation();
+  EXPECT_EQ(conjunction.binary_expression().left().start_location().column(),
+            17);
+}
+
+TEST(ReorderOperandsByCostTest, KeepsSourceOrderOfEquallyRankedOperands) {
+  const std::string constraint =
+      "exact16 == 1 && exact16 == 2 && exact16 == 3; exact16 == 4";
+  EXPECT_THAT(ReorderedOperands(ast::AND, constraint),
+              ElementsAre("exact16 == 1", "exact16 == 2", "exact16 == 3",
+                          "exact16 == 4"));
+  Expression expr = TypeChecked(constraint);
+  const Expression original = expr;
+  ASSERT_OK(ReorderOperandsByCost(&expr));
+  EXPECT_THAT(expr, EqualsProto(original));
+}
+
+TEST(ReorderOperandsByCostTest, KeepsSourceLocationOfChain) {
+  const Expression original = TypeChecked("lpm128 == 1 && exact16 == 1");
+  Expression expr = original;
+  ASSERT_OK(ReorderOperandsByCost(&expr));
+  EXPECT_THAT(expr.start_location(), EqualsProto(original.start_location()));
+  EXPECT_THAT(expr.end_location(), EqualsProto(original.end_location()));
+}
+
+TEST(OperandOrderTest, MatchesReorderOperands) {
+  const Expression original = TypeChecked(
+      "(lpm128 == 1 || exact16 == 1) && !(ternary144 == 1 && exact16 == 2) && "
+      "exact16 == 3");
+  const std::vector<const Expression*> operands = ChainOperands(original);
+  std::vector<OperandEstimate> estimates;
+  for (const Expression* operand : operands) {
+    estimates.push_back(EstimateOperand(*operand));
+  }
+  ASSERT_OK_AND_ASSIGN(const std::vector<int> order,
+                       OperandOrder(original, estimates));
+
+  Expression reordered = original;
+  ASSERT_OK(ReorderOperands(&reordered, estimates));
+  const std::vector<const Expression*> reordered_operands =
+      ChainOperands(reordered);
+  ASSERT_EQ(order.size(), reordered_operands.size());
+  for (int i = 0; i < order.size(); ++i) {
+    EXPECT_THAT(*reordered_operands[i], EqualsProto(*operands[order[i]]));
+  }
+  // The chains are actually reordered, not just left alone.
+  EXPECT_NE(order.front(), 0);
+}
+
+TEST(OperandOrderTest, RejectsWrongNumberOfEstimates) {
+  Expression expr = TypeChecked("exact16 == 1 && exact16 == 2");
+  const std::vector<OperandEstimate> estimates(1);
+  EXPECT_THAT(OperandOrder(expr, estimates),
+              gutil::StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(ReorderOperands(&expr, estimates),
+              gutil::StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(ReorderOperandsByCostTest, ExplanationsFollowSourceOrder) {
+  ASSERT_OK_AND_ASSIGN(
+      const ConstraintInfo constraint_info,
+      P4ToConstraintInfo(ParseProtoOrDie<p4::config::v1::P4Info>(R"pb(
+        tables {
+          preamble {
+            id: 1
+            name: "table"
+            annotations: "@entry_restriction(\"lpm128 != 1; exact16 != 1\")"
+          }
+          match_fields { id: 1 name: "exact16" bitwidth: 16 match_type: EXACT }
+          match_fields { id: 2 name: "lpm128" bitwidth: 128 match_type: LPM }
+        }
+      )pb")));
+
+  // Violates both conjuncts; the cheaper one is evaluated first, but the
+  // first one in the source is reported.
+  ASSERT_OK_AND_ASSIGN(
+      const std::string reason,
+      ReasonEntryViolatesConstraint(ParseProtoOrDie<p4::v1::TableEntry>(R"pb(
+                                      table_id: 1
+                                      match {
+                                        field_id: 1
+                                        exact { value: "\x01" }
+                                      }
+                                      match {
+                                        field_id: 2
+                                        lpm { value: "\x01" prefix_len: 128 }
+                                      }
+                                    )pb"),
+                                    constraint_info));
+  EXPECT_THAT(reason, HasSubstr("Field: \"lpm128\""));
+  EXPECT_THAT(reason, Not(HasSubstr("Field: \"exact16\"")));
+}
+
+}  // namespace
+}  // namespace p4_constraints
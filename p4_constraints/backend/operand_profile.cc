@@ -0,0 +1,212 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "p4_constraints/backend/operand_profile.h"
+
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "gutil/status.h"
+#include "p4_constraints/ast.pb.h"
+#include "p4_constraints/backend/constraint_info.h"
+#include "p4_constraints/backend/flat_constraint.h"
+#include "p4_constraints/backend/interpreter.h"
+#include "p4_constraints/backend/operand_ordering.h"
+
+namespace p4_constraints {
+
+namespace {
+
+using ::p4_constraints::ast::Expression;
+using ::p4_constraints::internal_interpreter::EvaluationContext;
+using ::p4_constraints::internal_interpreter::EvalToBool;
+
+// Increments a count that is only written by the calling thread.
+void Increment(std::atomic<uint64_t>& count) {
+  count.store(count.load(std::memory_order_relaxed) + 1,
+              std::memory_order_relaxed);
+}
+
+}  // namespace
+
+struct OperandProfile::TableProfile {
+  const TableInfo* table_info;
+  // The flat form of the constraint in `table_info`.
+  std::shared_ptr<const FlatConstraint> flat_constraint;
+  // The node ids of the operands of the chains of the constraint.
+  std::vector<int> operands;
+  // Index of the table's first count in `Counters::counts_`.
+  int first_count;
+  // The current plan, replaced by `ReorderLocked`.
+  mutable absl::Mutex plan_mutex;
+  std::shared_ptr<const EvaluationPlan> plan ABSL_GUARDED_BY(plan_mutex);
+};
+
+OperandProfile::OperandProfile(const ConstraintInfo& constraint_info,
+                               OperandProfileOptions options)
+    : options_(options) {
+  for (const auto& [table_id, table_info] : constraint_info.table_info_by_id) {
+    // Only the program is reordered (see `Validator`), so sampling a
+    // constraint without one would be wasted.
+    if (table_info.constraint == nullptr || table_info.program == nullptr) {
+      continue;
+    }
+    std::vector<const Expression*> operands =
+        ChainOperands(*table_info.constraint);
+    if (operands.empty()) continue;
+    auto table = std::make_unique<TableProfile>();
+    table->table_info = &table_info;
+    table->flat_constraint = table_info.flat_constraint;
+    if (table->flat_constraint == nullptr) {
+      table->flat_constraint = std::make_shared<const FlatConstraint>(
+          FlattenConstraint(*table_info.constraint, /*slot_by_name=*/nullptr,
+                            table_info.constant_pool.get()));
+    }
+    absl::flat_hash_map<const Expression*, int> node_by_expression;
+    for (int node = 0; node < table->flat_constraint->nodes.size(); ++node) {
+      node_by_expression[table->flat_constraint->nodes[node].expr] = node;
+    }
+    for (const Expression* operand : operands) {
+      table->operands.push_back(node_by_expression.at(operand));
+    }
+    table->first_count = num_operands_ + tables_.size();
+    num_operands_ += operands.size();
+    {
+      absl::WriterMutexLock lock(&table->plan_mutex);
+      table->plan = std::make_shared<const EvaluationPlan>(EvaluationPlan{
+          .operands = std::move(operands),
+          .program = table_info.program,
+      });
+    }
+    tables_[table_id] = std::move(table);
+  }
+}
+
+OperandProfile::~OperandProfile() = default;
+
+OperandProfile::Counters* OperandProfile::NewCounters() {
+  // One count of samples per table, and one count per operand.
+  auto counters = std::make_unique<Counters>(num_operands_ + tables_.size());
+  counters->samples_until_reorder_ = options_.reorder_period;
+  absl::MutexLock lock(&mutex_);
+  counters_.push_back(std::move(counters));
+  return counters_.back().get();
+}
+
+std::shared_ptr<const EvaluationPlan> OperandProfile::GetPlan(
+    uint32_t table_id) const {
+  auto it = tables_.find(table_id);
+  if (it == tables_.end()) return nullptr;
+  absl::ReaderMutexLock lock(&it->second->plan_mutex);
+  return it->second->plan;
+}
+
+void OperandProfile::Record(Counters& counters, uint32_t table_id,
+                            const EvaluationContext& context) {
+  if (--counters.checks_until_sample_ > 0) return;
+  counters.checks_until_sample_ = options_.sample_period;
+  auto it = tables_.find(table_id);
+  if (it == tables_.end()) return;
+  const TableProfile& table = *it->second;
+
+  // Evaluates all operands, not just the ones the current plan would evaluate,
+  // so that the statistics do not depend on the plan.
+  absl::InlinedVector<bool, 32> holds;
+  const FlatConstraint& constraint = *table.flat_constraint;
+  counters.eval_cache_.Reset(constraint.nodes.size());
+  for (int operand : table.operands) {
+    absl::StatusOr<bool> result =
+        EvalToBool(constraint, operand, context, &counters.eval_cache_);
+    // Entries that cannot be evaluated are reported by the check itself.
+    if (!result.ok()) return;
+    holds.push_back(*result);
+  }
+  Increment(counters.counts_[table.first_count]);
+  for (int i = 0; i < holds.size(); ++i) {
+    if (holds[i]) Increment(counters.counts_[table.first_count + 1 + i]);
+  }
+
+  if (options_.reorder_period <= 0 || --counters.samples_until_reorder_ > 0) {
+    return;
+  }
+  counters.samples_until_reorder_ = options_.reorder_period;
+  // Leaves the reordering to the thread that is already at it, if any.
+  if (!mutex_.TryLock()) return;
+  absl::Status status = ReorderLocked();
+  mutex_.Unlock();
+  if (!status.ok()) LOG(WARNING) << "Failed to reorder operands: " << status;
+}
+
+absl::Status OperandProfile::Reorder() {
+  absl::MutexLock lock(&mutex_);
+  return ReorderLocked();
+}
+
+absl::Status OperandProfile::ReorderLocked() {
+  for (auto& [table_id, table] : tables_) {
+    uint64_t samples = 0;
+    std::vector<uint64_t> holds(table->operands.size());
+    for (const std::unique_ptr<Counters>& counters : counters_) {
+      const std::vector<std::atomic<uint64_t>>& counts = counters->counts_;
+      samples += counts[table->first_count].load(std::memory_order_relaxed);
+      for (int i = 0; i < holds.size(); ++i) {
+        holds[i] +=
+            counts[table->first_count + 1 + i].load(std::memory_order_relaxed);
+      }
+    }
+    if (samples == 0) continue;
+
+    // Operands are identified by their position in `ChainOperands`, like
+    // `table->operands`. Laplace smoothing keeps operands that were always
+    // (resp. never) observed to hold from being ranked as if they could never
+    // decide their chain.
+    std::vector<const Expression*> operands;
+    std::vector<OperandEstimate> estimates;
+    for (int i = 0; i < holds.size(); ++i) {
+      const Expression& operand =
+          *table->flat_constraint->nodes[table->operands[i]].expr;
+      operands.push_back(&operand);
+      OperandEstimate estimate = EstimateOperand(operand);
+      estimate.probability_true = (holds[i] + 1.0) / (samples + 2.0);
+      estimates.push_back(estimate);
+    }
+    const Expression& source_constraint = *table->table_info->constraint;
+    ASSIGN_OR_RETURN(std::vector<int> order,
+                     OperandOrder(source_constraint, estimates));
+    EvaluationPlan plan;
+    for (int i : order) plan.operands.push_back(operands[i]);
+    {
+      absl::ReaderMutexLock lock(&table->plan_mutex);
+      if (plan.operands == table->plan->operands) continue;
+    }
+    // Only copies and compiles the constraint once its order has changed.
+    Expression constraint = source_constraint;
+    RETURN_IF_ERROR(ReorderOperands(&constraint, estimates));
+    ASSIGN_OR_RETURN(plan.program,
+                     CompileForVm(constraint, *table->table_info->key_layout),
+                     _ << "while compiling the reordered constraint of table "
+                       << table->table_info->name);
+    auto new_plan = std::make_shared<const EvaluationPlan>(std::move(plan));
+    {
+      absl::WriterMutexLock lock(&table->plan_mutex);
+      table->plan.swap(new_plan);
+    }
+    // Bumped after the swap, so that callers who see the new version also see
+    // the new plan.
+    version_.fetch_add(1, std::memory_order_acq_rel);
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace p4_constraints
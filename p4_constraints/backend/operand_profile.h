@@ -0,0 +1,134 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+// Profile-guided ordering of the operands of `&&` and `||` chains in table
+// constraints.
+//
+// The static estimates of operand_ordering.h cannot know which clauses of a
+// constraint decide it for the entries of a given deployment. An
+// `OperandProfile` samples the entries checked by `Validator`s, counts how
+// often each operand holds, and periodically reorders the table constraints by
+// the observed probabilities instead, so that the operand that most often
+// short-circuits its chain is evaluated first.
+
+#ifndef P4_CONSTRAINTS_BACKEND_OPERAND_PROFILE_H_
+#define P4_CONSTRAINTS_BACKEND_OPERAND_PROFILE_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "p4_constraints/ast.pb.h"
+#include "p4_constraints/backend/constraint_info.h"
+#include "p4_constraints/backend/interpreter.h"
+#include "p4_constraints/backend/program.h"
+
+namespace p4_constraints {
+
+// An order of evaluation of the operands of a table constraint, and the
+// program that evaluates them in that order.
+struct EvaluationPlan {
+  // The operands of the chains of the constraint (see `ChainOperands`), in
+  // evaluation order. Point into the `ConstraintInfo` of the profile.
+  std::vector<const ast::Expression*> operands;
+  std::shared_ptr<const Program> program;
+};
+
+struct OperandProfileOptions {
+  // Every `sample_period`-th entry checked with a set of counters is sampled.
+  int sample_period = 64;
+  // Tables are reordered whenever a set of counters has recorded
+  // `reorder_period` samples. If 0, tables are only reordered by `Reorder`.
+  int reorder_period = 4096;
+};
+
+// Collects operand statistics and publishes reordered evaluation plans for the
+// table constraints of a `ConstraintInfo`.
+//
+// Statistics are recorded into `Counters`, which each belong to a single
+// thread (e.g. to a `Validator`), so recording involves no synchronization
+// between threads. Plans are shared pointers, read and replaced under a lock
+// of their own: checks that are in flight keep the plan they started with, and
+// validators only take the lock when `version` has changed. Since
+// explanations do not depend on the order of operands (see interpreter.h),
+// reordering never changes the result of a check.
+//
+// Thread-safe. `constraint_info` must outlive the profile.
+class OperandProfile {
+ public:
+  // Statistics of a single thread; see `NewCounters`.
+  class Counters;
+
+  explicit OperandProfile(const ConstraintInfo& constraint_info,
+                          OperandProfileOptions options = {});
+  ~OperandProfile();
+
+  OperandProfile(const OperandProfile&) = delete;
+  OperandProfile& operator=(const OperandProfile&) = delete;
+
+  // Returns counters for exclusive use by the calling thread. The counters are
+  // owned by the profile.
+  Counters* NewCounters();
+
+  // Returns the current plan of the given table, or null if the table has no
+  // constraint with operands to reorder, or no compiled program. Constraints
+  // that are not compiled for the VM are evaluated in source order, and are
+  // not sampled.
+  std::shared_ptr<const EvaluationPlan> GetPlan(uint32_t table_id) const;
+
+  // Returns a number that changes whenever a plan is replaced, so that callers
+  // may keep plans around until it changes.
+  uint64_t version() const { return version_.load(std::memory_order_acquire); }
+
+  // Records how the operands of the constraint of the given table evaluate on
+  // the entry in `context`, if the entry is sampled. Reorders the table
+  // constraints every `reorder_period` samples.
+  void Record(Counters& counters, uint32_t table_id,
+              const internal_interpreter::EvaluationContext& context);
+
+  // Reorders the table constraints by the statistics recorded so far.
+  absl::Status Reorder() ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  struct TableProfile;
+
+  absl::Status ReorderLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const OperandProfileOptions options_;
+  // Immutable after construction, except for the plans.
+  absl::flat_hash_map<uint32_t, std::unique_ptr<TableProfile>> tables_;
+  // Total number of operands of all tables.
+  int num_operands_ = 0;
+  std::atomic<uint64_t> version_ = 0;
+
+  absl::Mutex mutex_;
+  std::vector<std::unique_ptr<Counters>> counters_ ABSL_GUARDED_BY(mutex_);
+};
+
+class OperandProfile::Counters {
+ public:
+  explicit Counters(int size) : counts_(size) {}
+
+ private:
+  friend class OperandProfile;
+
+  // Owned by a single thread.
+  int checks_until_sample_ = 0;
+  int samples_until_reorder_ = 0;
+  internal_interpreter::FlatEvaluationCache eval_cache_;
+
+  // Written by the owning thread only, read by `Reorder`. Holds, for each
+  // table, the number of samples followed by the number of samples in which
+  // each operand held.
+  std::vector<std::atomic<uint64_t>> counts_;
+};
+
+}  // namespace p4_constraints
+
+#endif  // P4_CONSTRAINTS_BACKEND_OPERAND_PROFILE_H_
@@ -0,0 +1,247 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "p4_constraints/backend/operand_profile.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "gutil/status_matchers.h"
+#include "gutil/testing.h"
+#include "p4/config/v1/p4info.pb.h"
+#include "p4/v1/p4runtime.pb.h"
+#include "p4_constraints/ast.h"
+#include "p4_constraints/backend/constraint_info.h"
+#include "p4_constraints/backend/operand_ordering.h"
+#include "p4_constraints/backend/thread_pool.h"
+#include "p4_constraints/backend/validator.h"
+
+namespace p4_constraints {
+namespace {
+
+using ::gutil::ParseProtoOrDie;
+using ::testing::NotNull;
+using ::testing::UnorderedElementsAre;
+using ::testing::UnorderedElementsAreArray;
+
+// Both operands of the constraint of table 1 have the same static estimates,
+// so they are evaluated in source order until a profile says otherwise.
+constexpr char kP4Info[] = R"pb(
+  tables {
+    preamble {
+      id: 1
+      name: "table"
+      annotations: "@entry_restriction(\"a == 1 && b == 1\")"
+    }
+    match_fields { id: 1 name: "a" bitwidth: 8 match_type: EXACT }
+    match_fields { id: 2 name: "b" bitwidth: 8 match_type: EXACT }
+  }
+  tables {
+    preamble { id: 2 name: "unconstrained_table" }
+    match_fields { id: 1 name: "a" bitwidth: 8 match_type: EXACT }
+  }
+)pb";
+
+p4::v1::TableEntry MakeEntry(int a, int b) {
+  return ParseProtoOrDie<p4::v1::TableEntry>(absl::StrCat(
+      "table_id: 1 match { field_id: 1 exact { value: \"\\", a,
+      "\" } } match { field_id: 2 exact { value: \"\\", b, "\" } }"));
+}
+
+// Returns the variables of the first operand of the given table's plan.
+std::vector<std::string> FirstOperandVariables(const OperandProfile& profile,
+                                               uint32_t table_id) {
+  std::shared_ptr<const EvaluationPlan> plan = profile.GetPlan(table_id);
+  const absl::flat_hash_set<std::string> variables =
+      ast::GetVariables(*plan->operands.front());
+  return std::vector<std::string>(variables.begin(), variables.end());
+}
+
+// Clears the source locations of `expr` and of its binary subexpressions, as
+// if it had been built by hand.
+void ClearLocations(ast::Expression& expr) {
+  expr.clear_start_location();
+  expr.clear_end_location();
+  if (expr.has_binary_expression()) {
+    ClearLocations(*expr.mutable_binary_expression()->mutable_left());
+    ClearLocations(*expr.mutable_binary_expression()->mutable_right());
+  }
+}
+
+class OperandProfileTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_OK_AND_ASSIGN(
+        constraint_info_,
+        P4ToConstraintInfo(ParseProtoOrDie<p4::config::v1::P4Info>(kP4Info)));
+  }
+
+  ConstraintInfo constraint_info_;
+};
+
+TEST_F(OperandProfileTest, StartsWithLoadedPlans) {
+  OperandProfile profile(constraint_info_);
+  std::shared_ptr<const EvaluationPlan> plan = profile.GetPlan(1);
+  ASSERT_THAT(plan, NotNull());
+  EXPECT_EQ(plan->operands,
+            ChainOperands(*constraint_info_.table_info_by_id.at(1).constraint));
+  EXPECT_EQ(plan->program, constraint_info_.table_info_by_id.at(1).program);
+  EXPECT_EQ(profile.GetPlan(2), nullptr);
+  EXPECT_EQ(profile.GetPlan(3), nullptr);
+}
+
+TEST_F(OperandProfileTest, IgnoresConstraintsWithoutProgram) {
+  ConstraintInfo constraint_info = constraint_info_;
+  constraint_info.table_info_by_id.at(1).program = nullptr;
+  OperandProfile profile(constraint_info,
+                         {.sample_period = 1, .reorder_period = 0});
+  EXPECT_EQ(profile.GetPlan(1), nullptr);
+
+  Validator validator(constraint_info, /*verdict_cache=*/nullptr, &profile);
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_THAT(validator.ReasonEntryViolatesConstraint(MakeEntry(1, 2)),
+                gutil::IsOk());
+  }
+  const uint64_t version = profile.version();
+  ASSERT_OK(profile.Reorder());
+  EXPECT_EQ(profile.version(), version);
+}
+
+TEST_F(OperandProfileTest, EvaluatesMostOftenDecisiveOperandFirst) {
+  OperandProfile profile(constraint_info_,
+                         {.sample_period = 1, .reorder_period = 0});
+  Validator validator(constraint_info_, /*verdict_cache=*/nullptr, &profile);
+  ASSERT_THAT(FirstOperandVariables(profile, 1), UnorderedElementsAre("a"));
+
+  // `b == 1` decides the constraint.
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_THAT(
+        validator.ReasonEntryViolatesConstraint(MakeEntry(1, 2 + i % 2)),
+        gutil::IsOk());
+  }
+  const uint64_t version = profile.version();
+  ASSERT_OK(profile.Reorder());
+  EXPECT_NE(profile.version(), version);
+  EXPECT_THAT(FirstOperandVariables(profile, 1), UnorderedElementsAre("b"));
+  EXPECT_THAT(profile.GetPlan(1)->program, NotNull());
+
+  // Now `a == 1` does, by a larger margin.
+  for (int i = 0; i < 30; ++i) {
+    ASSERT_THAT(validator.ReasonEntryViolatesConstraint(MakeEntry(2, 1)),
+                gutil::IsOk());
+  }
+  ASSERT_OK(profile.Reorder());
+  EXPECT_THAT(FirstOperandVariables(profile, 1), UnorderedElementsAre("a"));
+}
+
+TEST_F(OperandProfileTest, TellsApartOperandsWithoutSourceLocations) {
+  ConstraintInfo constraint_info = constraint_info_;
+  TableInfo& table_info = constraint_info.table_info_by_id.at(1);
+  auto constraint = std::make_shared<ast::Expression>(*table_info.constraint);
+  ClearLocations(*constraint);
+  table_info.constraint = constraint;
+  table_info.flat_constraint = nullptr;
+  OperandProfile profile(constraint_info,
+                         {.sample_period = 1, .reorder_period = 0});
+  Validator validator(constraint_info, /*verdict_cache=*/nullptr, &profile);
+
+  // `b == 1` decides the constraint. Explanations would quote the missing
+  // source, so violations are only found.
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_THAT(validator.FindViolation(MakeEntry(1, 2 + i % 2)),
+                gutil::IsOk());
+  }
+  ASSERT_OK(profile.Reorder());
+  EXPECT_THAT(FirstOperandVariables(profile, 1), UnorderedElementsAre("b"));
+  EXPECT_THAT(profile.GetPlan(1)->operands,
+              UnorderedElementsAreArray(ChainOperands(*constraint)));
+}
+
+TEST_F(OperandProfileTest, KeepsPlanIfOrderIsUnchanged) {
+  OperandProfile profile(constraint_info_,
+                         {.sample_period = 1, .reorder_period = 0});
+  Validator validator(constraint_info_, /*verdict_cache=*/nullptr, &profile);
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_THAT(validator.ReasonEntryViolatesConstraint(MakeEntry(2, 1)),
+                gutil::IsOk());
+  }
+  const std::shared_ptr<const EvaluationPlan> plan = profile.GetPlan(1);
+  const uint64_t version = profile.version();
+  ASSERT_OK(profile.Reorder());
+  EXPECT_EQ(profile.GetPlan(1), plan);
+  EXPECT_EQ(profile.version(), version);
+}
+
+TEST_F(OperandProfileTest, SamplesAndReordersPeriodically) {
+  OperandProfile profile(constraint_info_,
+                         {.sample_period = 5, .reorder_period = 2});
+  Validator validator(constraint_info_, /*verdict_cache=*/nullptr, &profile);
+  // Samples the 1st and the 6th entry, and reorders after the 6th.
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_THAT(validator.ReasonEntryViolatesConstraint(MakeEntry(1, 2)),
+                gutil::IsOk());
+  }
+  EXPECT_THAT(FirstOperandVariables(profile, 1), UnorderedElementsAre("a"));
+  ASSERT_THAT(validator.ReasonEntryViolatesConstraint(MakeEntry(1, 2)),
+              gutil::IsOk());
+  EXPECT_THAT(FirstOperandVariables(profile, 1), UnorderedElementsAre("b"));
+}
+
+TEST_F(OperandProfileTest, ReorderingDoesNotChangeResults) {
+  OperandProfile profile(constraint_info_,
+                         {.sample_period = 1, .reorder_period = 0});
+  Validator profiled_validator(constraint_info_, /*verdict_cache=*/nullptr,
+                               &profile);
+  Validator validator(constraint_info_);
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_THAT(
+        profiled_validator.ReasonEntryViolatesConstraint(MakeEntry(1, 2)),
+        gutil::IsOk());
+  }
+  ASSERT_OK(profile.Reorder());
+  ASSERT_THAT(FirstOperandVariables(profile, 1), UnorderedElementsAre("b"));
+
+  // Includes an entry that violates both operands, whose explanation quotes
+  // the first operand in the source.
+  for (const p4::v1::TableEntry& entry :
+       {MakeEntry(1, 1), MakeEntry(1, 2), MakeEntry(2, 1), MakeEntry(2, 2)}) {
+    SCOPED_TRACE(entry.DebugString());
+    ASSERT_OK_AND_ASSIGN(std::string expected,
+                         validator.ReasonEntryViolatesConstraint(entry));
+    EXPECT_THAT(profiled_validator.ReasonEntryViolatesConstraint(entry),
+                gutil::IsOkAndHolds(expected));
+  }
+}
+
+TEST_F(OperandProfileTest, RecordsAndReordersConcurrently) {
+  OperandProfile profile(constraint_info_,
+                         {.sample_period = 1, .reorder_period = 16});
+  ThreadPool thread_pool(4);
+  std::vector<std::unique_ptr<Validator>> validators;
+  for (int i = 0; i < thread_pool.num_threads(); ++i) {
+    validators.push_back(std::make_unique<Validator>(
+        constraint_info_, /*verdict_cache=*/nullptr, &profile));
+  }
+  constexpr int kNumEntries = 2000;
+  std::vector<absl::StatusOr<std::string>> reasons(kNumEntries);
+  thread_pool.ParallelFor(kNumEntries, [&](int task, int worker) {
+    // `a == 1` decides the first half of the entries, `b == 1` the second.
+    reasons[task] = validators[worker]->ReasonEntryViolatesConstraint(
+        task < kNumEntries / 2 ? MakeEntry(task % 2 + 1, 1)
+                               : MakeEntry(1, task % 2 + 1));
+  });
+  for (int task = 0; task < kNumEntries; ++task) {
+    ASSERT_OK(reasons[task].status());
+    EXPECT_EQ(reasons[task]->empty(), task % 2 == 0) << "Entry #" << task;
+  }
+}
+
+}  // namespace
+}  // namespace p4_constraints
@@ -0,0 +1,257 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "p4_constraints/backend/program.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "gutil/status.h"
+#include "p4_constraints/big_int.h"
+
+namespace p4_constraints {
+
+absl::StatusOr<std::vector<int>> ValidateProgram(const Program& program) {
+  const int size = program.instructions.size();
+  if (program.representation != ValueRepresentation::kUint64 &&
+      program.representation != ValueRepresentation::kUint128 &&
+      program.representation != ValueRepresentation::kBigInt) {
+    return gutil::InvalidArgumentErrorBuilder()
+           << "invalid value representation "
+           << static_cast<int>(program.representation);
+  }
+  if (program.representation != ValueRepresentation::kBigInt &&
+      program.fixed_width_constants.size() != program.constants.size()) {
+    return gutil::InvalidArgumentErrorBuilder()
+           << "program has " << program.constants.size() << " constants, but "
+           << program.fixed_width_constants.size() << " fixed-width constants";
+  }
+
+  std::vector<int> depth(size + 1, -1);
+  depth[0] = 0;
+  // Records that the stack holds `new_depth` values before instruction `pc`.
+  auto flow = [&](int pc, int new_depth) -> absl::Status {
+    if (new_depth > program.max_stack_size) {
+      return gutil::InvalidArgumentErrorBuilder()
+             << "stack overflow before instruction " << pc;
+    }
+    if (depth[pc] >= 0 && depth[pc] != new_depth) {
+      return gutil::InvalidArgumentErrorBuilder()
+             << "inconsistent stack depth before instruction " << pc;
+    }
+    depth[pc] = new_depth;
+    return absl::OkStatus();
+  };
+  for (int pc = 0; pc < size; ++pc) {
+    const Instruction& instruction = program.instructions[pc];
+    const int operand = instruction.operand;
+    const int d = depth[pc];
+    if (d < 0) continue;
+    // Returns an error unless the stack holds at least `n` values.
+    auto pops = [&](int n) -> absl::Status {
+      if (d < n) {
+        return gutil::InvalidArgumentErrorBuilder()
+               << "stack underflow at instruction " << pc;
+      }
+      return absl::OkStatus();
+    };
+    switch (instruction.opcode) {
+      case Opcode::kPushConstant:
+        if (operand < 0 || operand >= program.constants.size()) {
+          return gutil::InvalidArgumentErrorBuilder()
+                 << "unknown constant " << operand << " at instruction " << pc;
+        }
+        [[fallthrough]];
+      case Opcode::kPushInteger:
+      case Opcode::kLoadPriority:
+        RETURN_IF_ERROR(flow(pc + 1, d + 1));
+        break;
+      case Opcode::kLoadKey:
+        if (instruction.field > KeyField::kHigh) {
+          return gutil::InvalidArgumentErrorBuilder()
+                 << "invalid key field at instruction " << pc;
+        }
+        [[fallthrough]];
+      case Opcode::kLoadParam:
+        if (operand < 0 || operand >= program.variables.size()) {
+          return gutil::InvalidArgumentErrorBuilder()
+                 << "unknown variable " << operand << " at instruction " << pc;
+        }
+        RETURN_IF_ERROR(flow(pc + 1, d + 1));
+        break;
+      case Opcode::kDup:
+        RETURN_IF_ERROR(pops(1));
+        RETURN_IF_ERROR(flow(pc + 1, d + 1));
+        break;
+      case Opcode::kMod:
+        if (operand < 0 || operand >= program.constants.size() ||
+            program.constants[operand] <= 0) {
+          return gutil::InvalidArgumentErrorBuilder()
+                 << "invalid modulus at instruction " << pc;
+        }
+        [[fallthrough]];
+      case Opcode::kNot:
+      case Opcode::kNegate:
+        RETURN_IF_ERROR(pops(1));
+        RETURN_IF_ERROR(flow(pc + 1, d));
+        break;
+      case Opcode::kEq:
+      case Opcode::kNe:
+        if (operand < 1) {
+          return gutil::InvalidArgumentErrorBuilder()
+                 << "invalid number of components at instruction " << pc;
+        }
+        // Checked before doubling `operand`, which might overflow.
+        if (operand > d / 2) {
+          return gutil::InvalidArgumentErrorBuilder()
+                 << "stack underflow at instruction " << pc;
+        }
+        RETURN_IF_ERROR(flow(pc + 1, d - 2 * operand + 1));
+        break;
+      case Opcode::kLt:
+      case Opcode::kLe:
+      case Opcode::kGt:
+      case Opcode::kGe:
+        RETURN_IF_ERROR(pops(2));
+        RETURN_IF_ERROR(flow(pc + 1, d - 1));
+        break;
+      case Opcode::kJumpIfFalseElsePop:
+      case Opcode::kJumpIfTrueElsePop:
+        if (operand <= pc || operand > size) {
+          return gutil::InvalidArgumentErrorBuilder()
+                 << "invalid jump target " << operand << " at instruction "
+                 << pc;
+        }
+        RETURN_IF_ERROR(pops(1));
+        RETURN_IF_ERROR(flow(operand, d));
+        RETURN_IF_ERROR(flow(pc + 1, d - 1));
+        break;
+      default:
+        return gutil::InvalidArgumentErrorBuilder()
+               << "invalid opcode " << static_cast<int>(instruction.opcode)
+               << " at instruction " << pc;
+    }
+  }
+  if (depth[size] != 1) {
+    return gutil::InvalidArgumentErrorBuilder()
+           << "program ends with " << depth[size]
+           << " values on the stack; expected exactly 1";
+  }
+  return depth;
+}
+
+std::string OpcodeName(Opcode opcode) {
+  switch (opcode) {
+    case Opcode::kPushInteger:
+      return "push_integer";
+    case Opcode::kPushConstant:
+      return "push_constant";
+    case Opcode::kLoadKey:
+      return "load_key";
+    case Opcode::kLoadParam:
+      return "load_param";
+    case Opcode::kLoadPriority:
+      return "load_priority";
+    case Opcode::kDup:
+      return "dup";
+    case Opcode::kNot:
+      return "not";
+    case Opcode::kNegate:
+      return "negate";
+    case Opcode::kMod:
+      return "mod";
+    case Opcode::kEq:
+      return "eq";
+    case Opcode::kNe:
+      return "ne";
+    case Opcode::kLt:
+      return "lt";
+    case Opcode::kLe:
+      return "le";
+    case Opcode::kGt:
+      return "gt";
+    case Opcode::kGe:
+      return "ge";
+    case Opcode::kJumpIfFalseElsePop:
+      return "jump_if_false_else_pop";
+    case Opcode::kJumpIfTrueElsePop:
+      return "jump_if_true_else_pop";
+  }
+  return absl::StrCat("<unknown opcode ", static_cast<int>(opcode), ">");
+}
+
+std::string KeyFieldName(KeyField field) {
+  switch (field) {
+    case KeyField::kValue:
+      return "value";
+    case KeyField::kMask:
+      return "mask";
+    case KeyField::kPrefixLength:
+      return "prefix_length";
+    case KeyField::kLow:
+      return "low";
+    case KeyField::kHigh:
+      return "high";
+  }
+  return absl::StrCat("<unknown field ", static_cast<int>(field), ">");
+}
+
+std::string ValueRepresentationName(ValueRepresentation representation) {
+  switch (representation) {
+    case ValueRepresentation::kUint64:
+      return "uint64";
+    case ValueRepresentation::kUint128:
+      return "uint128";
+    case ValueRepresentation::kBigInt:
+      return "big_int";
+  }
+  return absl::StrCat("<unknown representation ",
+                      static_cast<int>(representation), ">");
+}
+
+std::string ProgramToString(const Program& program) {
+  std::string result = absl::StrCat(
+      "; values: ", ValueRepresentationName(program.representation), "\n");
+  for (int pc = 0; pc < program.instructions.size(); ++pc) {
+    const Instruction& instruction = program.instructions[pc];
+    absl::StrAppendFormat(&result, "%3d: %s", pc,
+                          OpcodeName(instruction.opcode));
+    switch (instruction.opcode) {
+      case Opcode::kPushConstant:
+      case Opcode::kMod:
+        absl::StrAppend(
+            &result, " ",
+            BigIntToString(program.constants[instruction.operand]));
+        break;
+      case Opcode::kLoadKey:
+        absl::StrAppend(&result, " ",
+                        program.variables[instruction.operand].name,
+                        "::", KeyFieldName(instruction.field));
+        break;
+      case Opcode::kLoadParam:
+        absl::StrAppend(&result, " ",
+                        program.variables[instruction.operand].name);
+        break;
+      case Opcode::kLoadPriority:
+      case Opcode::kDup:
+      case Opcode::kNot:
+      case Opcode::kNegate:
+      case Opcode::kLt:
+      case Opcode::kLe:
+      case Opcode::kGt:
+      case Opcode::kGe:
+        break;
+      default:
+        absl::StrAppend(&result, " ", instruction.operand);
+        break;
+    }
+    absl::StrAppend(&result, "\n");
+  }
+  return result;
+}
+
+}  // namespace p4_constraints
@@ -0,0 +1,153 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+// Compiled representation of a constraint.
+//
+// A `Program` is a flat sequence of instructions for a simple stack machine
+// (see vm.h) that decides whether an entry satisfies a constraint. Programs are
+// produced by the compiler (see compiler.h) from type-checked constraints.
+//
+// Composite values (Exact, Ternary, Lpm, Range) are scalarized at compile
+// time: a value with N components occupies N consecutive stack slots, so the
+// machine only ever operates on integers. Booleans are represented as 0 and 1.
+//
+// Most constraints only involve narrow keys (e.g. a 16-bit ether type or a
+// 32-bit IPv4 address), so the compiler also picks the narrowest machine
+// integer type that can hold the program's values, letting the VM avoid
+// arbitrary precision arithmetic.
+
+#ifndef P4_CONSTRAINTS_BACKEND_PROGRAM_H_
+#define P4_CONSTRAINTS_BACKEND_PROGRAM_H_
+
+#include <stdint.h>
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "absl/numeric/int128.h"
+#include "absl/status/statusor.h"
+#include "p4_constraints/ast.pb.h"
+#include "p4_constraints/big_int.h"
+
+namespace p4_constraints {
+
+enum class Opcode : uint8_t {
+  // Pushes `operand`.
+  kPushInteger,
+  // Pushes `constants[operand]`.
+  kPushConstant,
+  // Pushes component `field` of key `variables[operand]`.
+  kLoadKey,
+  // Pushes action parameter `variables[operand]`.
+  kLoadParam,
+  // Pushes the priority of the table entry.
+  kLoadPriority,
+  // Duplicates the top of the stack.
+  kDup,
+  // Replaces the top of the stack, a Boolean b, with !b.
+  kNot,
+  // Replaces the top of the stack, an integer n, with -n.
+  kNegate,
+  // Replaces the top of the stack, an integer n, with n mod m, where
+  // m = `constants[operand]` is positive. The result is never negative.
+  kMod,
+  // Pops two values with `operand` components each and pushes whether they
+  // are (not) equal.
+  kEq,
+  kNe,
+  // Pops two integers and pushes the result of comparing them.
+  kLt,
+  kLe,
+  kGt,
+  kGe,
+  // If the top of the stack is false (resp. true), jumps to instruction
+  // `operand`, leaving the stack untouched. Otherwise, pops it.
+  kJumpIfFalseElsePop,
+  kJumpIfTrueElsePop,
+};
+
+// Component of a composite key value.
+enum class KeyField : uint8_t {
+  kValue,
+  kMask,
+  kPrefixLength,
+  kLow,
+  kHigh,
+};
+
+// Integer type used by the VM to represent values during execution.
+enum class ValueRepresentation : uint8_t {
+  kUint64,
+  kUint128,
+  kBigInt,
+};
+
+struct Instruction {
+  Opcode opcode;
+  KeyField field = KeyField::kValue;  // Only meaningful for kLoadKey.
+  int32_t operand = 0;
+};
+
+// A key or action parameter read by a program.
+struct Variable {
+  std::string name;
+  // The static type of the variable, e.g. Ternary<16> or bit<32>.
+  ast::Type type;
+  // Slot of the variable in the entries of its table (resp. action), see
+  // `EntryLayout`. Assigned when the program is attached to a table (resp.
+  // action); -1 if unassigned, in which case the variable is looked up by
+  // name.
+  int slot = -1;
+};
+
+struct Program {
+  std::vector<Instruction> instructions;
+  // Constants used by the program, computed at compile time: integer literals
+  // (with any casts applied to them folded in), masks, and domain sizes.
+  std::vector<BigInt> constants;
+  // Keys (for table constraints) or action parameters (for action
+  // constraints) read by the program, deduplicated.
+  std::vector<Variable> variables;
+  // Upper bound on the number of stack slots used during execution.
+  int max_stack_size = 0;
+  // The narrowest representation that can hold all constants and all values of
+  // the variables at their static types. Priorities and values of ill-typed
+  // entries are checked at runtime, falling back to BigInt if they do not fit.
+  // Programs that negate integers always use BigInt, as intermediate values may
+  // be negative.
+  ValueRepresentation representation = ValueRepresentation::kBigInt;
+  // `constants` as fixed-width integers. Empty if `representation` is kBigInt.
+  std::vector<absl::uint128> fixed_width_constants;
+};
+
+// -- Validation ---------------------------------------------------------------
+
+// Checks that `program` is well-formed, i.e. that executing it stays within its
+// constants, variables, and stack, and returns the stack depth before each
+// instruction, followed by the depth at the end of the program. Instructions
+// that are not reachable have depth -1.
+//
+// Programs produced by the compiler are well-formed: jumps only go forward, the
+// stack depth before an instruction is the same on all paths to it, and
+// programs end with exactly one value on the stack. Returns an InvalidArgument
+// error otherwise, e.g. for programs read from a corrupted snapshot (see
+// constraint_info_snapshot.h).
+absl::StatusOr<std::vector<int>> ValidateProgram(const Program& program);
+
+// -- Pretty Printers ----------------------------------------------------------
+
+std::string OpcodeName(Opcode opcode);
+std::string KeyFieldName(KeyField field);
+std::string ValueRepresentationName(ValueRepresentation representation);
+
+// Returns a human-readable listing of the program, one instruction per line.
+std::string ProgramToString(const Program& program);
+
+inline std::ostream& operator<<(std::ostream& os, const Program& program) {
+  return os << ProgramToString(program);
+}
+
+}  // namespace p4_constraints
+
+#endif  // P4_CONSTRAINTS_BACKEND_PROGRAM_H_
@@ -342,8 +342,14 @@ absl::StatusOr<SymbolicEvalResult> EvalSymbolically(
       return !bool_result;
     }
 
-    case ast::Expression::kIntegerConstant:
+    case ast::Expression::kIntegerConstant: {
+      // Constant folding turns casts of literals into literals of type bit<W>.
+      if (expr.type().type_case() == ast::Type::kFixedUnsigned) {
+        ASSIGN_OR_RETURN(int bitwidth, ast::TypeBitwidthOrStatus(expr.type()));
+        return solver.ctx().bv_val(expr.integer_constant().c_str(), bitwidth);
+      }
       return solver.ctx().int_val(expr.integer_constant().c_str());
+    }
 
     case ast::Expression::kArithmeticNegation: {
       ASSIGN_OR_RETURN(
@@ -804,7 +810,7 @@ absl::StatusOr<ConstraintSolver> ConstraintSolver::Create(
         {kSymbolicPriorityAttributeName, std::move(priority)});
   }
 
-  if (table.constraint.has_value()) {
+  if (table.constraint != nullptr) {
     ASSIGN_OR_RETURN(bool modeled_constraint_added,
                      constraint_solver.AddConstraint(*table.constraint,
                                                      table.constraint_source));
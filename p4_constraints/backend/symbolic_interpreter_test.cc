@@ -19,7 +19,7 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
-#include <optional>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -525,7 +525,8 @@ TableInfo GetTableInfoWithConstraint(absl::string_view constraint_string) {
                                     table_info.constraint_source);
   CHECK_OK(constraint);
   CHECK_OK(InferAndCheckTypes(&(*constraint), table_info));
-  table_info.constraint = *constraint;
+  table_info.constraint =
+      std::make_shared<const Expression>(*std::move(constraint));
 
   // Constraint type must be boolean to not fail early.
   // constraint.mutable_type()->mutable_boolean();
@@ -551,12 +552,13 @@ TEST(EvaluateConstraintSymbolicallyTest,
   z3::solver solver(solver_context);
 
   TableInfo table_info = GetTableInfoWithConstraint("true");
-  table_info.constraint->clear_type();
+  Expression constraint = *table_info.constraint;
+  constraint.clear_type();
 
   for (const auto& [name, key] : table_info.keys_by_name) {
     ASSERT_OK(AddSymbolicKey(key, solver));
   }
-  EXPECT_THAT(EvaluateConstraintSymbolically(*table_info.constraint,
+  EXPECT_THAT(EvaluateConstraintSymbolically(constraint,
                                              table_info.constraint_source,
                                              /*environment=*/{}, solver),
               StatusIs(absl::StatusCode::kInvalidArgument));
@@ -602,7 +604,7 @@ TEST_P(ConstraintTest,
 
 TEST(CreateConstraintSolver, WorksWithoutConstraints) {
   TableInfo table_info = GetTableInfoWithConstraint("true");
-  table_info.constraint = std::nullopt;
+  table_info.constraint = nullptr;
 
   EXPECT_OK(ConstraintSolver::Create(table_info));
 }
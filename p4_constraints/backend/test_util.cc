@@ -0,0 +1,40 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "p4_constraints/backend/test_util.h"
+
+#include <string>
+
+#include "absl/log/check.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "p4_constraints/ast.pb.h"
+#include "p4_constraints/backend/constraint_info.h"
+#include "p4_constraints/backend/type_checker.h"
+#include "p4_constraints/constraint_source.h"
+#include "p4_constraints/frontend/constraint_kind.h"
+#include "p4_constraints/frontend/parser.h"
+
+namespace p4_constraints {
+
+TableInfo MakeTableInfo(absl::Span<const KeyInfo> keys) {
+  TableInfo table_info{.id = 1, .name = "table"};
+  for (const KeyInfo& key : keys) {
+    table_info.keys_by_id[key.id] = key;
+    table_info.keys_by_name[key.name] = key;
+  }
+  return table_info;
+}
+
+ast::Expression TypeCheckedConstraint(absl::string_view constraint,
+                                      const TableInfo& table_info) {
+  ast::Expression expr =
+      ParseConstraint(
+          ConstraintKind::kTableConstraint,
+          ConstraintSource{.constraint_string = std::string(constraint)})
+          .value();
+  CHECK_OK(InferAndCheckTypes(&expr, table_info));
+  return expr;
+}
+
+}  // namespace p4_constraints
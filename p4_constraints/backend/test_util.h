@@ -0,0 +1,26 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+// Helpers for tests of backend passes that take type-checked constraints.
+
+#ifndef P4_CONSTRAINTS_BACKEND_TEST_UTIL_H_
+#define P4_CONSTRAINTS_BACKEND_TEST_UTIL_H_
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "p4_constraints/ast.pb.h"
+#include "p4_constraints/backend/constraint_info.h"
+
+namespace p4_constraints {
+
+// Returns the table with ID 1, named "table", that has the given `keys`.
+TableInfo MakeTableInfo(absl::Span<const KeyInfo> keys);
+
+// Parses the table constraint `constraint` and type checks it against
+// `table_info`. CHECK-fails on errors.
+ast::Expression TypeCheckedConstraint(absl::string_view constraint,
+                                      const TableInfo& table_info);
+
+}  // namespace p4_constraints
+
+#endif  // P4_CONSTRAINTS_BACKEND_TEST_UTIL_H_
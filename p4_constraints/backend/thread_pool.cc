@@ -0,0 +1,115 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "p4_constraints/backend/thread_pool.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <thread>  // NOLINT: absl has no thread abstraction.
+
+#include "absl/functional/function_ref.h"
+#include "absl/synchronization/mutex.h"
+
+namespace p4_constraints {
+
+ThreadPool::ThreadPool(int num_threads) {
+  if (num_threads <= 0) {
+    num_threads = std::max<int>(1, std::thread::hardware_concurrency());
+  }
+  for (int worker = 0; worker < num_threads; ++worker) {
+    queues_.push_back(std::make_unique<Queue>());
+  }
+  // Worker 0 is the thread calling `ParallelFor`.
+  for (int worker = 1; worker < num_threads; ++worker) {
+    threads_.emplace_back([this, worker] { WorkerLoop(worker); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    absl::MutexLock lock(&mutex_);
+    shutting_down_ = true;
+  }
+  for (std::thread& thread : threads_) thread.join();
+}
+
+void ThreadPool::ParallelFor(int num_tasks,
+                             absl::FunctionRef<void(int, int)> fn) {
+  if (num_tasks <= 0) return;
+  if (threads_.empty()) {
+    for (int task = 0; task < num_tasks; ++task) fn(task, /*worker=*/0);
+    return;
+  }
+  const int workers = num_threads();
+  for (int worker = 0; worker < workers; ++worker) {
+    Queue& queue = *queues_[worker];
+    absl::MutexLock lock(&queue.mutex);
+    for (int task = int64_t{num_tasks} * worker / workers;
+         task < int64_t{num_tasks} * (worker + 1) / workers; ++task) {
+      queue.tasks.push_back(task);
+    }
+  }
+
+  {
+    absl::MutexLock lock(&mutex_);
+    fn_ = &fn;
+    busy_threads_ = threads_.size();
+    ++generation_;
+  }
+  RunTasks(/*worker=*/0, fn);
+  // `fn` must outlive all calls to it.
+  absl::MutexLock lock(&mutex_);
+  auto done = [this]() ABSL_SHARED_LOCKS_REQUIRED(mutex_) {
+    return busy_threads_ == 0;
+  };
+  mutex_.Await(absl::Condition(&done));
+  fn_ = nullptr;
+}
+
+void ThreadPool::RunTasks(int worker, absl::FunctionRef<void(int, int)> fn) {
+  const int workers = num_threads();
+  while (true) {
+    std::optional<int> task;
+    // Takes the next task of this worker, or steals the last one of another.
+    for (int i = 0; i < workers && !task.has_value(); ++i) {
+      Queue& queue = *queues_[(worker + i) % workers];
+      absl::MutexLock lock(&queue.mutex);
+      if (queue.tasks.empty()) continue;
+      if (i == 0) {
+        task = queue.tasks.front();
+        queue.tasks.pop_front();
+      } else {
+        task = queue.tasks.back();
+        queue.tasks.pop_back();
+      }
+    }
+    // Tasks are only added before the workers start, so all are taken.
+    if (!task.has_value()) return;
+    fn(*task, worker);
+  }
+}
+
+void ThreadPool::WorkerLoop(int worker) {
+  int64_t seen_generation = 0;
+  while (true) {
+    const absl::FunctionRef<void(int, int)>* fn;
+    {
+      absl::MutexLock lock(&mutex_);
+      auto wake = [&]() ABSL_SHARED_LOCKS_REQUIRED(mutex_) {
+        return shutting_down_ || generation_ != seen_generation;
+      };
+      mutex_.Await(absl::Condition(&wake));
+      if (shutting_down_) return;
+      seen_generation = generation_;
+      fn = fn_;
+    }
+    RunTasks(worker, *fn);
+    absl::MutexLock lock(&mutex_);
+    --busy_threads_;
+  }
+}
+
+}  // namespace p4_constraints
@@ -0,0 +1,75 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+// A minimal fixed-size thread pool for data-parallel loops.
+
+#ifndef P4_CONSTRAINTS_BACKEND_THREAD_POOL_H_
+#define P4_CONSTRAINTS_BACKEND_THREAD_POOL_H_
+
+#include <stdint.h>
+
+#include <deque>
+#include <memory>
+#include <thread>  // NOLINT: absl has no thread abstraction.
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/function_ref.h"
+#include "absl/synchronization/mutex.h"
+
+namespace p4_constraints {
+
+// Runs loops of independent tasks on a fixed set of workers: the calling
+// thread plus `num_threads - 1` background threads. Tasks are dealt out to the
+// workers in contiguous blocks, so that neighbouring tasks tend to run on the
+// same worker; workers that run out of tasks steal from the back of other
+// workers' blocks.
+//
+// `ParallelFor` must not be called concurrently or reentrantly.
+class ThreadPool {
+ public:
+  // Uses `std::thread::hardware_concurrency()` workers if `num_threads` <= 0.
+  explicit ThreadPool(int num_threads = 0);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  // Number of workers, including the thread calling `ParallelFor`.
+  int num_threads() const { return queues_.size(); }
+
+  // Calls `fn(task, worker)` for each `task` in [0, num_tasks), where `worker`
+  // in [0, num_threads()) identifies the calling worker: calls with the same
+  // `worker` never run concurrently. Returns once all calls have returned.
+  void ParallelFor(int num_tasks, absl::FunctionRef<void(int, int)> fn);
+
+ private:
+  // The tasks dealt to a worker.
+  struct Queue {
+    absl::Mutex mutex;
+    std::deque<int> tasks ABSL_GUARDED_BY(mutex);
+  };
+
+  // Runs tasks as `worker` until there are none left.
+  void RunTasks(int worker, absl::FunctionRef<void(int, int)> fn);
+  // Body of background thread `worker`.
+  void WorkerLoop(int worker);
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread> threads_;
+
+  absl::Mutex mutex_;
+  // Incremented for every call to `ParallelFor`, to wake up the workers.
+  int64_t generation_ ABSL_GUARDED_BY(mutex_) = 0;
+  // The loop body of the ongoing `ParallelFor`, if any.
+  const absl::FunctionRef<void(int, int)>* fn_ ABSL_GUARDED_BY(mutex_) =
+      nullptr;
+  // Number of background threads still running tasks of the ongoing
+  // `ParallelFor`.
+  int busy_threads_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool shutting_down_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+}  // namespace p4_constraints
+
+#endif  // P4_CONSTRAINTS_BACKEND_THREAD_POOL_H_
@@ -0,0 +1,76 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "p4_constraints/backend/thread_pool.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>  // NOLINT: absl has no thread abstraction.
+#include <vector>
+
+#include "absl/synchronization/notification.h"
+
+namespace p4_constraints {
+namespace {
+
+using ::testing::Each;
+using ::testing::Eq;
+
+TEST(ThreadPoolTest, RunsEachTaskExactlyOnce) {
+  for (int num_threads : {1, 2, 7}) {
+    ThreadPool thread_pool(num_threads);
+    EXPECT_EQ(thread_pool.num_threads(), num_threads);
+    // Reuses the pool across loops of different sizes.
+    for (int num_tasks : {0, 1, 5, 1000}) {
+      std::vector<std::atomic<int>> runs(num_tasks);
+      thread_pool.ParallelFor(num_tasks,
+                              [&](int task, int worker) { ++runs[task]; });
+      std::vector<int> counts(runs.begin(), runs.end());
+      EXPECT_THAT(counts, Each(Eq(1)))
+          << num_threads << " threads, " << num_tasks << " tasks";
+    }
+  }
+}
+
+TEST(ThreadPoolTest, CallsOfTheSameWorkerDoNotOverlap) {
+  ThreadPool thread_pool(4);
+  std::vector<std::atomic<int>> active(thread_pool.num_threads());
+  std::atomic<bool> overlapped = false;
+  thread_pool.ParallelFor(10000, [&](int task, int worker) {
+    ASSERT_GE(worker, 0);
+    ASSERT_LT(worker, thread_pool.num_threads());
+    if (active[worker]++ != 0) overlapped = true;
+    --active[worker];
+  });
+  EXPECT_FALSE(overlapped);
+}
+
+TEST(ThreadPoolTest, IdleWorkersStealTasks) {
+  // Blocks the first task until all others have run. Without stealing, the
+  // tasks dealt to the same worker as the first one would never run.
+  ThreadPool thread_pool(2);
+  constexpr int kNumTasks = 100;
+  std::atomic<int> finished = 0;
+  absl::Notification others_finished;
+  thread_pool.ParallelFor(kNumTasks, [&](int task, int worker) {
+    if (task == 0) {
+      others_finished.WaitForNotification();
+    } else if (++finished == kNumTasks - 1) {
+      others_finished.Notify();
+    }
+  });
+  EXPECT_EQ(finished, kNumTasks - 1);
+}
+
+TEST(ThreadPoolTest, DefaultsToHardwareConcurrency) {
+  ThreadPool thread_pool;
+  EXPECT_GE(thread_pool.num_threads(), 1);
+  EXPECT_EQ(thread_pool.num_threads(),
+            std::max<int>(1, std::thread::hardware_concurrency()));
+}
+
+}  // namespace
+}  // namespace p4_constraints
@@ -123,13 +123,12 @@ absl::optional<Type> LeastUpperBound(const Type& left, const Type& right) {
 
 // Mutates the input expression, wrapping it with a type_cast to the given type.
 void WrapWithCast(Expression* expr, Type type) {
-  Expression cast;
-  *cast.mutable_start_location() = expr->start_location();
-  *cast.mutable_end_location() = expr->end_location();
-  *cast.mutable_type() = type;
-  // Need std::move to make this an O(1)-operation; copying would be O(|expr|).
-  *cast.mutable_type_cast() = std::move(*expr);
-  *expr = std::move(cast);
+  // O(1), also if `expr` lives on an arena; copying would be O(|expr|).
+  ast::ExpressionPtr operand = ast::TakeExpression(expr);
+  *expr->mutable_start_location() = operand->start_location();
+  *expr->mutable_end_location() = operand->end_location();
+  *expr->mutable_type() = std::move(type);
+  expr->set_allocated_type_cast(operand.release());
 }
 
 // Mutates the input expression, wrapping it with a chain of zero or more type
@@ -0,0 +1,492 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "p4_constraints/backend/validator.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "gutil/status.h"
+#include "p4/v1/p4runtime.pb.h"
+#include "p4_constraints/ast.pb.h"
+#include "p4_constraints/backend/constraint_info.h"
+#include "p4_constraints/backend/flat_constraint.h"
+#include "p4_constraints/backend/interpreter.h"
+#include "p4_constraints/backend/operand_profile.h"
+#include "p4_constraints/backend/program.h"
+#include "p4_constraints/backend/thread_pool.h"
+#include "p4_constraints/backend/vm.h"
+#include "p4_constraints/frontend/constraint_kind.h"
+
+namespace p4_constraints {
+
+using ::p4_constraints::ast::Expression;
+using ::p4_constraints::ast::Type;
+using ::p4_constraints::internal_interpreter::ActionInvocation;
+using ::p4_constraints::internal_interpreter::EntrySatisfiesConstraint;
+using ::p4_constraints::internal_interpreter::EvaluationContext;
+using ::p4_constraints::internal_interpreter::FindViolationReason;
+using ::p4_constraints::internal_interpreter::ForEachActionRestrictionOf;
+using ::p4_constraints::internal_interpreter::ForTableConstraintOf;
+using ::p4_constraints::internal_interpreter::P4IDToString;
+using ::p4_constraints::internal_interpreter::ParseActionOf;
+using ::p4_constraints::internal_interpreter::ParseTableEntryOf;
+using ::p4_constraints::internal_interpreter::RenderViolationReason;
+using ::p4_constraints::internal_interpreter::TableEntry;
+using ::p4_constraints::internal_interpreter::ViolationReason;
+
+namespace {
+
+// Returns the `action_index`-th action of `entry` (see `Violation`).
+absl::StatusOr<const p4::v1::Action*> ActionOf(const p4::v1::TableEntry& entry,
+                                                int action_index) {
+  const p4::v1::TableAction& table_action = entry.action();
+  if (table_action.has_action() && action_index == 0) {
+    return &table_action.action();
+  }
+  if (table_action.has_action_profile_action_set() && action_index >= 0 &&
+      action_index < table_action.action_profile_action_set()
+                         .action_profile_actions_size()) {
+    return &table_action.action_profile_action_set()
+                .action_profile_actions(action_index)
+                .action();
+  }
+  return gutil::InvalidArgumentErrorBuilder()
+         << "entry has no action with index " << action_index;
+}
+
+// Returns an error unless `violation` refers to a node of `flat_constraint`.
+absl::Status CheckRefersTo(const Violation& violation,
+                           const FlatConstraint& flat_constraint) {
+  if (violation.reason_node < 0 ||
+      violation.reason_node >= flat_constraint.nodes.size() ||
+      flat_constraint.nodes[violation.reason_node].expr != violation.reason) {
+    return gutil::InvalidArgumentErrorBuilder()
+           << "violation does not refer to the constraint of "
+           << (violation.kind == ConstraintKind::kTableConstraint ? "table "
+                                                                   : "action ")
+           << P4IDToString(violation.id);
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+const FlatConstraint& Validator::FlatFormOf(
+    const Expression& constraint, const FlatConstraint* flat_constraint,
+    const ConstantPool* constant_pool) {
+  if (flat_constraint != nullptr) return *flat_constraint;
+  auto [it, inserted] = flat_forms_.try_emplace(&constraint);
+  if (inserted) {
+    it->second = FlattenConstraint(constraint, /*slot_by_name=*/nullptr,
+                                   constant_pool);
+  }
+  return it->second;
+}
+
+absl::StatusOr<std::optional<ViolationReason>> Validator::Check(
+    const Expression& constraint, const FlatConstraint* flat_constraint,
+    const Program* program, const EvaluationContext& context) {
+  flat_constraint =
+      &FlatFormOf(constraint, flat_constraint, context.constant_pool);
+  // The interpreter, if used, evaluates repeated subexpressions once, and
+  // finding the reason for a violation reuses its results.
+  eval_cache_.Reset(flat_constraint->nodes.size());
+  ASSIGN_OR_RETURN(bool entry_satisfies_constraint,
+                   EntrySatisfiesConstraint(*flat_constraint, program, context,
+                                            &eval_cache_));
+  if (entry_satisfies_constraint) return std::nullopt;
+  return FindViolationReason(*flat_constraint, context, eval_cache_);
+}
+
+absl::StatusOr<std::string> Validator::ReasonEntryViolatesConstraint(
+    const p4::v1::TableEntry& entry) {
+  if (verdict_cache_ == nullptr) return CheckEntry(entry);
+  MakeVerdictCacheKey(entry, constraint_info_.generation, verdict_cache_key_);
+  std::string reason;
+  if (verdict_cache_->Lookup(verdict_cache_key_, reason)) return reason;
+  absl::StatusOr<std::string> result = CheckEntry(entry);
+  if (result.ok()) verdict_cache_->Insert(verdict_cache_key_, *result);
+  return result;
+}
+
+absl::StatusOr<std::string> Validator::CheckEntry(
+    const p4::v1::TableEntry& entry) {
+  return Explain(entry, FindViolation(entry));
+}
+
+absl::StatusOr<std::string> Validator::Explain(
+    const p4::v1::TableEntry& entry,
+    const absl::StatusOr<std::optional<Violation>>& violation) {
+  if (!violation.ok()) return violation.status();
+  if (!violation->has_value()) return "";
+  return ExplainViolation(entry, **violation);
+}
+
+absl::StatusOr<std::optional<Violation>> Validator::FindViolation(
+    const p4::v1::TableEntry& entry) {
+  std::optional<Violation> violation;
+  ASSIGN_OR_RETURN(
+      bool violated,
+      ForTableConstraintOf(
+          entry, constraint_info_, table_entry_,
+          [&](const TableInfo& table_info,
+              const EvaluationContext& context) -> absl::StatusOr<bool> {
+            const Program* program = table_info.program.get();
+            if (operand_profile_ != nullptr) {
+              // Only the program is reordered: the interpreter evaluates the
+              // original constraint, since explanations do not depend on the
+              // order of operands.
+              if (const EvaluationPlan* plan = CurrentPlan(table_info.id)) {
+                program = plan->program.get();
+              }
+            }
+            absl::StatusOr<std::optional<ViolationReason>> reason =
+                Check(*table_info.constraint, table_info.flat_constraint.get(),
+                      program, context);
+            if (operand_profile_ != nullptr) {
+              operand_profile_->Record(*operand_counters_, table_info.id,
+                                       context);
+            }
+            if (!reason.ok()) return reason.status();
+            if (!reason->has_value()) return false;
+            violation = Violation{
+                .kind = ConstraintKind::kTableConstraint,
+                .id = table_info.id,
+                .reason = (*reason)->subexpression,
+                .reason_node = (*reason)->node,
+                .reason_holds = (*reason)->truth_value,
+            };
+            return true;
+          }));
+  if (violated) return violation;
+  return FindActionViolation(entry);
+}
+
+absl::StatusOr<std::string> Validator::ExplainViolation(
+    const p4::v1::TableEntry& entry, const Violation& violation) {
+  const ViolationReason reason{
+      .node = violation.reason_node,
+      .subexpression = violation.reason,
+      .truth_value = violation.reason_holds,
+  };
+  switch (violation.kind) {
+    case ConstraintKind::kTableConstraint: {
+      auto* table_info = GetTableInfoOrNull(constraint_info_, violation.id);
+      if (table_info == nullptr || table_info->constraint == nullptr) {
+        return gutil::InvalidArgumentErrorBuilder()
+               << "violation of unknown table constraint "
+               << P4IDToString(violation.id);
+      }
+      const FlatConstraint& flat_constraint =
+          FlatFormOf(*table_info->constraint, table_info->flat_constraint.get(),
+                     table_info->constant_pool.get());
+      RETURN_IF_ERROR(CheckRefersTo(violation, flat_constraint));
+      RETURN_IF_ERROR(ParseTableEntryOf(*table_info, entry, table_entry_));
+      EvaluationContext context{
+          .constraint_context = std::move(table_entry_),
+          .constraint_source = table_info->constraint_source,
+          .constant_pool = table_info->constant_pool.get(),
+      };
+      absl::StatusOr<std::string> explanation =
+          RenderViolationReason(flat_constraint, reason, context);
+      table_entry_ =
+          std::move(std::get<TableEntry>(context.constraint_context));
+      return explanation;
+    }
+    case ConstraintKind::kActionConstraint: {
+      auto* action_info = GetActionInfoOrNull(constraint_info_, violation.id);
+      if (action_info == nullptr || action_info->constraint == nullptr) {
+        return gutil::InvalidArgumentErrorBuilder()
+               << "violation of unknown action restriction "
+               << P4IDToString(violation.id);
+      }
+      const FlatConstraint& flat_constraint = FlatFormOf(
+          *action_info->constraint, action_info->flat_constraint.get(),
+          action_info->constant_pool.get());
+      RETURN_IF_ERROR(CheckRefersTo(violation, flat_constraint));
+      ASSIGN_OR_RETURN(const p4::v1::Action* action,
+                       ActionOf(entry, violation.action_index));
+      RETURN_IF_ERROR(ParseActionOf(*action_info, *action, action_invocation_));
+      EvaluationContext context{
+          .constraint_context = std::move(action_invocation_),
+          .constraint_source = action_info->constraint_source,
+          .constant_pool = action_info->constant_pool.get(),
+      };
+      absl::StatusOr<std::string> explanation =
+          RenderViolationReason(flat_constraint, reason, context);
+      action_invocation_ =
+          std::move(std::get<ActionInvocation>(context.constraint_context));
+      return explanation;
+    }
+  }
+  return gutil::InvalidArgumentErrorBuilder()
+         << "unknown constraint kind " << static_cast<int>(violation.kind);
+}
+
+const EvaluationPlan* Validator::CurrentPlan(uint32_t table_id) {
+  const uint64_t version = operand_profile_->version();
+  if (version != plans_version_) {
+    plans_.clear();
+    plans_version_ = version;
+  }
+  auto [it, inserted] = plans_.try_emplace(table_id);
+  if (inserted) it->second = operand_profile_->GetPlan(table_id);
+  return it->second.get();
+}
+
+absl::StatusOr<std::optional<Violation>> Validator::FindActionViolation(
+    const p4::v1::TableEntry& entry) {
+  std::optional<Violation> violation;
+  RETURN_IF_ERROR(
+      ForEachActionRestrictionOf(
+          entry, constraint_info_, action_invocation_,
+          [&](const ActionInfo& action_info, int action_index,
+              const EvaluationContext& context) -> absl::StatusOr<bool> {
+            ASSIGN_OR_RETURN(
+                std::optional<ViolationReason> reason,
+                Check(*action_info.constraint,
+                      action_info.flat_constraint.get(),
+                      action_info.program.get(), context));
+            if (!reason.has_value()) return false;
+            violation = Violation{
+                .kind = ConstraintKind::kActionConstraint,
+                .id = action_info.id,
+                .action_index = action_index,
+                .reason = reason->subexpression,
+                .reason_node = reason->node,
+                .reason_holds = reason->truth_value,
+            };
+            return true;
+          })
+          .status());
+  return violation;
+}
+
+void Validator::CheckBatch(
+    const TableInfo& table_info,
+    absl::Span<const p4::v1::TableEntry* const> entries,
+    absl::Span<absl::StatusOr<std::string>> reasons) {
+  if (batch_entries_.size() < entries.size()) {
+    batch_entries_.resize(entries.size());
+  }
+  batch_indices_.clear();
+  for (int i = 0; i < entries.size(); ++i) {
+    absl::Status status = ParseTableEntryOf(
+        table_info, *entries[i], batch_entries_[batch_indices_.size()]);
+    if (status.ok()) {
+      batch_indices_.push_back(i);
+    } else {
+      reasons[i] = std::move(status);
+    }
+  }
+
+  absl::StatusOr<std::vector<bool>> verdicts = ExecuteProgramOnBatch(
+      *table_info.program,
+      absl::MakeConstSpan(batch_entries_.data(), batch_indices_.size()));
+  for (int j = 0; j < batch_indices_.size(); ++j) {
+    const int i = batch_indices_[j];
+    if (verdicts.ok() && (*verdicts)[j]) {
+      reasons[i] = Explain(*entries[i], FindActionViolation(*entries[i]));
+    } else {
+      // Explains the violation, or consults the interpreter if the VM failed.
+      reasons[i] =
+          ExplainParsedEntry(table_info, *entries[i], batch_entries_[j]);
+    }
+  }
+}
+
+absl::StatusOr<std::string> Validator::ExplainParsedEntry(
+    const TableInfo& table_info, const p4::v1::TableEntry& entry,
+    TableEntry& table_entry) {
+  const FlatConstraint& flat_constraint =
+      FlatFormOf(*table_info.constraint, table_info.flat_constraint.get(),
+                 table_info.constant_pool.get());
+  EvaluationContext context{
+      .constraint_context = std::move(table_entry),
+      .constraint_source = table_info.constraint_source,
+      .constant_pool = table_info.constant_pool.get(),
+  };
+  // Evaluates the constraint with the interpreter, whose results the
+  // explanation reuses.
+  absl::StatusOr<std::optional<ViolationReason>> reason = Check(
+      *table_info.constraint, &flat_constraint, /*program=*/nullptr, context);
+  absl::StatusOr<std::string> explanation = "";
+  if (!reason.ok()) {
+    explanation = reason.status();
+  } else if (reason->has_value()) {
+    explanation = RenderViolationReason(flat_constraint, **reason, context);
+  }
+  // Hands the storage back for the next batch.
+  table_entry = std::move(std::get<TableEntry>(context.constraint_context));
+  if (!explanation.ok() || !explanation->empty()) return explanation;
+  return Explain(entry, FindActionViolation(entry));
+}
+
+void Validator::ReasonEntriesViolateConstraint(
+    absl::Span<const p4::v1::TableEntry* const> entries,
+    absl::Span<absl::StatusOr<std::string>> reasons) {
+  int begin = 0;
+  while (begin < entries.size()) {
+    const uint32_t table_id = entries[begin]->table_id();
+    int end = begin + 1;
+    while (end < entries.size() && entries[end]->table_id() == table_id) ++end;
+
+    const TableInfo* table_info =
+        GetTableInfoOrNull(constraint_info_, table_id);
+    const bool check_as_batch =
+        verdict_cache_ == nullptr && operand_profile_ == nullptr &&
+        end - begin > 1 &&
+        table_info != nullptr && table_info->constraint != nullptr &&
+        table_info->constraint->type().type_case() == Type::kBoolean &&
+        table_info->program != nullptr;
+    if (check_as_batch) {
+      CheckBatch(*table_info, entries.subspan(begin, end - begin),
+                 reasons.subspan(begin, end - begin));
+    } else {
+      for (int i = begin; i < end; ++i) {
+        reasons[i] = ReasonEntryViolatesConstraint(*entries[i]);
+      }
+    }
+    begin = end;
+  }
+}
+
+namespace {
+
+// Same as `ReasonEntriesViolateConstraints`, but skips null entries, leaving
+// their results unspecified.
+std::vector<absl::StatusOr<std::string>> CheckEntries(
+    absl::Span<const p4::v1::TableEntry* const> entries,
+    const ConstraintInfo& constraint_info, ThreadPool& thread_pool) {
+  // Large enough to amortize scheduling, small enough to balance the load.
+  constexpr int kEntriesPerTask = 256;
+
+  // Checks entries in order of table ID, so that consecutive entries share
+  // their TableInfo and the layout of their keys.
+  std::vector<int> order;
+  order.reserve(entries.size());
+  for (int i = 0; i < entries.size(); ++i) {
+    if (entries[i] != nullptr) order.push_back(i);
+  }
+  std::stable_sort(order.begin(), order.end(), [&](int i, int j) {
+    return entries[i]->table_id() < entries[j]->table_id();
+  });
+
+  std::vector<std::unique_ptr<Validator>> validators;
+  for (int worker = 0; worker < thread_pool.num_threads(); ++worker) {
+    validators.push_back(std::make_unique<Validator>(constraint_info));
+  }
+  std::vector<const p4::v1::TableEntry*> sorted_entries;
+  sorted_entries.reserve(order.size());
+  for (int i : order) sorted_entries.push_back(entries[i]);
+  std::vector<absl::StatusOr<std::string>> sorted_results(order.size());
+
+  const int num_entries = order.size();
+  const int num_tasks = (num_entries + kEntriesPerTask - 1) / kEntriesPerTask;
+  thread_pool.ParallelFor(num_tasks, [&](int task, int worker) {
+    const int begin = task * kEntriesPerTask;
+    const int size = std::min(num_entries - begin, kEntriesPerTask);
+    validators[worker]->ReasonEntriesViolateConstraint(
+        absl::MakeConstSpan(sorted_entries).subspan(begin, size),
+        absl::MakeSpan(sorted_results).subspan(begin, size));
+  });
+
+  std::vector<absl::StatusOr<std::string>> results(entries.size());
+  for (int i = 0; i < num_entries; ++i) {
+    results[order[i]] = std::move(sorted_results[i]);
+  }
+  return results;
+}
+
+}  // namespace
+
+std::vector<absl::StatusOr<std::string>> ReasonEntriesViolateConstraints(
+    absl::Span<const p4::v1::TableEntry> entries,
+    const ConstraintInfo& constraint_info, ThreadPool& thread_pool) {
+  std::vector<const p4::v1::TableEntry*> entry_pointers;
+  entry_pointers.reserve(entries.size());
+  for (const p4::v1::TableEntry& entry : entries) {
+    entry_pointers.push_back(&entry);
+  }
+  return CheckEntries(entry_pointers, constraint_info, thread_pool);
+}
+
+std::vector<absl::StatusOr<std::string>> ReasonEntriesViolateConstraints(
+    absl::Span<const p4::v1::TableEntry> entries,
+    const ConstraintInfo& constraint_info, int num_threads) {
+  ThreadPool thread_pool(num_threads);
+  return ReasonEntriesViolateConstraints(entries, constraint_info,
+                                         thread_pool);
+}
+
+namespace {
+
+// Implements `ValidateUpdates` for any random-access container of updates.
+template <class Updates>
+std::vector<absl::Status> ValidateUpdatesImpl(
+    const Updates& updates, const ConstraintInfo& constraint_info,
+    ThreadPool& thread_pool) {
+  std::vector<const p4::v1::TableEntry*> entries(updates.size(), nullptr);
+  for (int i = 0; i < updates.size(); ++i) {
+    const p4::v1::Update& update = updates[i];
+    // Entries being deleted need not satisfy constraints.
+    if (update.type() == p4::v1::Update::DELETE) continue;
+    if (!update.entity().has_table_entry()) continue;
+    entries[i] = &update.entity().table_entry();
+  }
+  std::vector<absl::StatusOr<std::string>> reasons =
+      CheckEntries(entries, constraint_info, thread_pool);
+
+  std::vector<absl::Status> statuses(updates.size());
+  for (int i = 0; i < updates.size(); ++i) {
+    if (entries[i] == nullptr) continue;
+    if (!reasons[i].ok()) {
+      statuses[i] = std::move(reasons[i]).status();
+    } else if (!reasons[i]->empty()) {
+      statuses[i] = absl::InvalidArgumentError(*reasons[i]);
+    }
+  }
+  return statuses;
+}
+
+}  // namespace
+
+std::vector<absl::Status> ValidateUpdates(
+    absl::Span<const p4::v1::Update> updates,
+    const ConstraintInfo& constraint_info, ThreadPool& thread_pool) {
+  return ValidateUpdatesImpl(updates, constraint_info, thread_pool);
+}
+
+std::vector<absl::Status> ValidateUpdates(
+    absl::Span<const p4::v1::Update> updates,
+    const ConstraintInfo& constraint_info, int num_threads) {
+  ThreadPool thread_pool(num_threads);
+  return ValidateUpdates(updates, constraint_info, thread_pool);
+}
+
+std::vector<absl::Status> ValidateWriteRequest(
+    const p4::v1::WriteRequest& write_request,
+    const ConstraintInfo& constraint_info, ThreadPool& thread_pool) {
+  return ValidateUpdatesImpl(write_request.updates(), constraint_info,
+                             thread_pool);
+}
+
+std::vector<absl::Status> ValidateWriteRequest(
+    const p4::v1::WriteRequest& write_request,
+    const ConstraintInfo& constraint_info, int num_threads) {
+  ThreadPool thread_pool(num_threads);
+  return ValidateWriteRequest(write_request, constraint_info, thread_pool);
+}
+
+}  // namespace p4_constraints
@@ -0,0 +1,238 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+// A reusable checker for table entries, for callers that validate many
+// entries against the same `ConstraintInfo`.
+
+#ifndef P4_CONSTRAINTS_BACKEND_VALIDATOR_H_
+#define P4_CONSTRAINTS_BACKEND_VALIDATOR_H_
+
+#include <stdint.h>
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/node_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "p4/v1/p4runtime.pb.h"
+#include "p4_constraints/ast.h"
+#include "p4_constraints/ast.pb.h"
+#include "p4_constraints/backend/constant_pool.h"
+#include "p4_constraints/backend/constraint_info.h"
+#include "p4_constraints/backend/flat_constraint.h"
+#include "p4_constraints/backend/interpreter.h"
+#include "p4_constraints/backend/operand_profile.h"
+#include "p4_constraints/backend/program.h"
+#include "p4_constraints/backend/thread_pool.h"
+#include "p4_constraints/backend/verdict_cache.h"
+#include "p4_constraints/frontend/constraint_kind.h"
+
+namespace p4_constraints {
+
+// A violation of a table constraint or action restriction by a table entry, as
+// found by `Validator::FindViolation`. Cheap to produce and copy; the
+// human-readable explanation is only rendered on demand, by
+// `Validator::ExplainViolation`.
+struct Violation {
+  // Whether the table constraint or an action restriction is violated.
+  ConstraintKind kind;
+  // The ID of the table (resp. action) whose constraint is violated.
+  uint32_t id;
+  // The index of the violating action in the entry's action profile action set,
+  // or 0 for direct actions.
+  int action_index = 0;
+  // The minimal subexpression of the constraint leading to the violation (see
+  // `MinimalSubexpressionLeadingToEvalResult`), and whether it holds. Points
+  // into the `ConstraintInfo` of the `Validator`.
+  const ast::Expression* reason = nullptr;
+  // The id of `reason` in the flat form of the constraint.
+  int reason_node = -1;
+  bool reason_holds = false;
+};
+
+// Checks table entries like `ReasonEntryViolatesConstraint`, but keeps its
+// scratch state across calls instead of rebuilding it for every entry:
+// - Entries are parsed into key (resp. parameter) slots that are reused, and
+//   grow to the widest table (resp. action) seen.
+// - The evaluation cache is cleared, not reallocated, before each check.
+// Once warmed up, checking an entry that satisfies its constraints does not
+// allocate, as long as its constraints are compiled for the VM and its values
+// fit into 128 bits.
+//
+// If given a `verdict_cache`, entries are looked up in the cache before being
+// checked, and successful results are cached. Errors are not cached. The cache
+// is ignored for a `constraint_info` constructed by hand (of generation 0),
+// which cannot be told apart from other such infos sharing the cache.
+//
+// If given an `operand_profile`, table constraints are evaluated in the order
+// of the profile's current plans, and checked entries are sampled into the
+// profile's statistics (see operand_profile.h).
+//
+// Not thread-safe; use one `Validator` per thread (the cache and the profile
+// may be shared). `constraint_info`, `verdict_cache`, and `operand_profile`
+// must outlive the `Validator`, and `constraint_info` must not be modified
+// while the `Validator` is in use.
+class Validator {
+ public:
+  explicit Validator(const ConstraintInfo& constraint_info,
+                     VerdictCache* verdict_cache = nullptr,
+                     OperandProfile* operand_profile = nullptr)
+      : constraint_info_(constraint_info),
+        verdict_cache_(constraint_info.generation == 0 ? nullptr
+                                                       : verdict_cache),
+        operand_profile_(operand_profile),
+        operand_counters_(operand_profile == nullptr
+                              ? nullptr
+                              : operand_profile->NewCounters()) {}
+
+  Validator(const Validator&) = delete;
+  Validator& operator=(const Validator&) = delete;
+
+  // Same as `p4_constraints::ReasonEntryViolatesConstraint`.
+  absl::StatusOr<std::string> ReasonEntryViolatesConstraint(
+      const p4::v1::TableEntry& entry);
+
+  // Returns the violation of the first constraint that `entry` violates, or
+  // nullopt if it satisfies all of its constraints. Bypasses the verdict cache.
+  absl::StatusOr<std::optional<Violation>> FindViolation(
+      const p4::v1::TableEntry& entry);
+
+  // Renders `violation`, found by `FindViolation(entry)`, the way
+  // `ReasonEntryViolatesConstraint(entry)` explains it.
+  absl::StatusOr<std::string> ExplainViolation(const p4::v1::TableEntry& entry,
+                                               const Violation& violation);
+
+  // Checks each of `entries` like `ReasonEntryViolatesConstraint`, storing the
+  // results in the corresponding elements of `reasons`. Runs of consecutive
+  // entries of the same table are checked as a batch: their table constraint
+  // is evaluated column by column (see `ExecuteProgramOnBatch`), and only
+  // entries that violate it are then explained one at a time. With a
+  // `verdict_cache` or an `operand_profile`, entries are checked one at a time
+  // instead.
+  void ReasonEntriesViolateConstraint(
+      absl::Span<const p4::v1::TableEntry* const> entries,
+      absl::Span<absl::StatusOr<std::string>> reasons);
+
+ private:
+  // Same as `ReasonEntryViolatesConstraint`, bypassing the verdict cache.
+  absl::StatusOr<std::string> CheckEntry(const p4::v1::TableEntry& entry);
+
+  // Checks the run of `entries` of the table described by `table_info`, which
+  // has a compiled constraint, as a batch.
+  void CheckBatch(const TableInfo& table_info,
+                  absl::Span<const p4::v1::TableEntry* const> entries,
+                  absl::Span<absl::StatusOr<std::string>> reasons);
+
+  // Same as `ReasonEntryViolatesConstraint(entry)`, for an `entry` of the table
+  // described by `table_info` that is already parsed into `table_entry`, and
+  // whose table constraint the VM found violated (or failed to evaluate).
+  absl::StatusOr<std::string> ExplainParsedEntry(
+      const TableInfo& table_info, const p4::v1::TableEntry& entry,
+      internal_interpreter::TableEntry& table_entry);
+
+  // Returns the current plan of the given table in `operand_profile_`, or null
+  // if the table has none.
+  const EvaluationPlan* CurrentPlan(uint32_t table_id);
+
+  // Returns the explanation of `violation`, or the empty string if there is
+  // none.
+  absl::StatusOr<std::string> Explain(
+      const p4::v1::TableEntry& entry,
+      const absl::StatusOr<std::optional<Violation>>& violation);
+
+  // Checks the action(s) of `entry` against their action restrictions.
+  absl::StatusOr<std::optional<Violation>> FindActionViolation(
+      const p4::v1::TableEntry& entry);
+
+  // Returns `*flat_constraint`, the flat form of `constraint`, or the flat form
+  // of `constraint` in `flat_forms_` if it is null, flattening it with its
+  // `constant_pool`, if any, on first use.
+  const FlatConstraint& FlatFormOf(const ast::Expression& constraint,
+                                   const FlatConstraint* flat_constraint,
+                                   const ConstantPool* constant_pool);
+
+  // Returns nullopt if the entry in `context` satisfies `constraint` and the
+  // reason for the violation otherwise. `flat_constraint` is the flat form of
+  // `constraint`, or null to flatten it on the fly.
+  absl::StatusOr<std::optional<internal_interpreter::ViolationReason>> Check(
+      const ast::Expression& constraint, const FlatConstraint* flat_constraint,
+      const Program* program,
+      const internal_interpreter::EvaluationContext& context);
+
+  const ConstraintInfo& constraint_info_;
+  VerdictCache* const verdict_cache_;
+  OperandProfile* const operand_profile_;
+  OperandProfile::Counters* const operand_counters_;
+
+  // Scratch state, reused across calls.
+  internal_interpreter::TableEntry table_entry_;
+  internal_interpreter::ActionInvocation action_invocation_;
+  internal_interpreter::FlatEvaluationCache eval_cache_;
+  // Flat forms of the constraints that `constraint_info_` lacks them for, e.g.
+  // because it was constructed by hand. Node-based, as references to them are
+  // held across insertions.
+  absl::node_hash_map<const ast::Expression*, FlatConstraint> flat_forms_;
+  // Scratch state for batches: the parsed entries, and the index of each in
+  // the batch passed to `CheckBatch`.
+  std::vector<internal_interpreter::TableEntry> batch_entries_;
+  std::vector<int> batch_indices_;
+  // Key of the current entry in `verdict_cache_`.
+  std::string verdict_cache_key_;
+  // Plans of `operand_profile_` in use, by table ID, as of version
+  // `plans_version_` of the profile.
+  absl::flat_hash_map<uint32_t, std::shared_ptr<const EvaluationPlan>> plans_;
+  uint64_t plans_version_ = 0;
+};
+
+// Checks each of `entries` like `ReasonEntryViolatesConstraint`, spreading the
+// work across the workers of `thread_pool`, and returns the results in input
+// order. Entries are grouped by table ID internally, so that each worker tends
+// to check entries of the same table in a row.
+std::vector<absl::StatusOr<std::string>> ReasonEntriesViolateConstraints(
+    absl::Span<const p4::v1::TableEntry> entries,
+    const ConstraintInfo& constraint_info, ThreadPool& thread_pool);
+
+// Same as above, but uses a thread pool with `num_threads` threads (see
+// `ThreadPool`) for the duration of the call. By default, checks the entries on
+// the calling thread. Starting threads costs more than checking a few entries,
+// so callers that check small batches in parallel should reuse a `ThreadPool`.
+std::vector<absl::StatusOr<std::string>> ReasonEntriesViolateConstraints(
+    absl::Span<const p4::v1::TableEntry> entries,
+    const ConstraintInfo& constraint_info, int num_threads = 1);
+
+// Checks the entities of `updates` against their constraints, in parallel on
+// the workers of `thread_pool`. Returns one status per update, aligned with
+// `updates`, to be mapped into a P4Runtime batch error:
+// - OK if the update is a DELETE, its entity is not a table entry (which is
+//   not subject to constraints), or its entry satisfies its constraints.
+// - InvalidArgument explaining the violation if the entry violates its
+//   constraints.
+// - The error of `ReasonEntryViolatesConstraint` if the entry could not be
+//   checked.
+// The second overload uses a thread pool with `num_threads` threads for the
+// duration of the call, and by default checks the entries on the calling
+// thread (see `ReasonEntriesViolateConstraints`).
+std::vector<absl::Status> ValidateUpdates(
+    absl::Span<const p4::v1::Update> updates,
+    const ConstraintInfo& constraint_info, ThreadPool& thread_pool);
+
+std::vector<absl::Status> ValidateUpdates(
+    absl::Span<const p4::v1::Update> updates,
+    const ConstraintInfo& constraint_info, int num_threads = 1);
+
+// Same as `ValidateUpdates` on the updates of `write_request`.
+std::vector<absl::Status> ValidateWriteRequest(
+    const p4::v1::WriteRequest& write_request,
+    const ConstraintInfo& constraint_info, ThreadPool& thread_pool);
+std::vector<absl::Status> ValidateWriteRequest(
+    const p4::v1::WriteRequest& write_request,
+    const ConstraintInfo& constraint_info, int num_threads = 1);
+
+}  // namespace p4_constraints
+
+#endif  // P4_CONSTRAINTS_BACKEND_VALIDATOR_H_
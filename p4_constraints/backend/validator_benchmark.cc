@@ -0,0 +1,242 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+// Measures the time and heap allocations it takes to check conforming entries
+// of a SAI-style ACL table, with and without reusing a `Validator`, and the
+// throughput of batch validation across threads.
+
+#include <benchmark/benchmark.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <atomic>
+#include <new>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "p4/config/v1/p4info.pb.h"
+#include "p4/v1/p4runtime.pb.h"
+#include "p4_constraints/backend/constraint_info.h"
+#include "p4_constraints/backend/interpreter.h"
+#include "p4_constraints/backend/thread_pool.h"
+#include "p4_constraints/backend/validator.h"
+
+namespace {
+
+// Number of calls to the replaceable allocation functions below.
+std::atomic<int64_t> allocation_count{0};
+
+}  // namespace
+
+void* operator new(size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  if (void* pointer = malloc(size == 0 ? 1 : size)) return pointer;
+  throw std::bad_alloc();
+}
+void operator delete(void* pointer) noexcept { free(pointer); }
+void operator delete(void* pointer, size_t) noexcept { free(pointer); }
+
+namespace p4_constraints {
+namespace {
+
+using ::p4::config::v1::MatchField;
+
+// Modeled after the ACL tables of SAI P4.
+constexpr char kAclConstraint[] = R"(
+  dst_ip::mask != 0 -> is_ipv4 == 1;
+  dst_ipv6::mask != 0 -> is_ipv6 == 1;
+  ttl::mask != 0 -> (is_ip == 1 || is_ipv4 == 1 || is_ipv6 == 1);
+  l4_dst_port::mask != 0 -> (ip_protocol::mask == 0xff &&
+                             (ip_protocol::value == 6 ||
+                              ip_protocol::value == 17));
+  is_ip::mask != 0 -> (is_ipv4::mask == 0 && is_ipv6::mask == 0);
+  is_ipv4::mask != 0 -> (is_ip::mask == 0 && is_ipv6::mask == 0);
+  is_ipv6::mask != 0 -> (is_ip::mask == 0 && is_ipv4::mask == 0);
+  ::priority > 0;
+)";
+
+struct Key {
+  std::string name;
+  int bitwidth;
+  MatchField::MatchType match_type;
+};
+
+const std::vector<Key>& AclKeys() {
+  static const auto* const kKeys = new std::vector<Key>{
+      {"is_ip", 1, MatchField::OPTIONAL},
+      {"is_ipv4", 1, MatchField::OPTIONAL},
+      {"is_ipv6", 1, MatchField::OPTIONAL},
+      {"ether_type", 16, MatchField::TERNARY},
+      {"dst_ip", 32, MatchField::TERNARY},
+      {"dst_ipv6", 128, MatchField::TERNARY},
+      {"src_ipv6", 128, MatchField::TERNARY},
+      {"ttl", 8, MatchField::TERNARY},
+      {"dscp", 6, MatchField::TERNARY},
+      {"ip_protocol", 8, MatchField::TERNARY},
+      {"l4_dst_port", 16, MatchField::TERNARY},
+      {"in_port", 32, MatchField::OPTIONAL},
+  };
+  return *kKeys;
+}
+
+p4::config::v1::P4Info MakeAclP4Info() {
+  p4::config::v1::P4Info p4info;
+  p4::config::v1::Table& table = *p4info.add_tables();
+  table.mutable_preamble()->set_id(1);
+  table.mutable_preamble()->set_name("acl_ingress_table");
+  table.mutable_preamble()->add_annotations(
+      absl::StrCat("@entry_restriction(\"", kAclConstraint, "\")"));
+  for (int i = 0; i < AclKeys().size(); ++i) {
+    MatchField& field = *table.add_match_fields();
+    field.set_id(i + 1);
+    field.set_name(AclKeys()[i].name);
+    field.set_bitwidth(AclKeys()[i].bitwidth);
+    field.set_match_type(AclKeys()[i].match_type);
+  }
+  p4::config::v1::Action& action = *p4info.add_actions();
+  action.mutable_preamble()->set_id(2);
+  action.mutable_preamble()->set_name("acl_set_vlan");
+  action.mutable_preamble()->add_annotations(
+      "@action_restriction(\"vlan_id != 0\")");
+  p4::config::v1::Action::Param& param = *action.add_params();
+  param.set_id(1);
+  param.set_name("vlan_id");
+  param.set_bitwidth(12);
+  return p4info;
+}
+
+// Returns `bitwidth` random bits as a P4Runtime bytestring.
+std::string RandomBytes(int bitwidth, std::mt19937& rng) {
+  std::string bytes((bitwidth + 7) / 8, '\0');
+  for (char& byte : bytes) {
+    byte = static_cast<char>(std::uniform_int_distribution<int>(0, 255)(rng));
+  }
+  if (bitwidth % 8 != 0) bytes[0] &= (1 << (bitwidth % 8)) - 1;
+  return bytes;
+}
+
+// Returns entries that satisfy all constraints and wildcard most keys, as is
+// typical for ACL entries.
+std::vector<p4::v1::TableEntry> MakeConformingAclEntries(
+    const ConstraintInfo& constraint_info) {
+  std::mt19937 rng(/*seed=*/0);
+  std::vector<p4::v1::TableEntry> entries;
+  while (entries.size() < 1000) {
+    p4::v1::TableEntry entry;
+    entry.set_table_id(1);
+    entry.set_priority(std::uniform_int_distribution<int32_t>(1, 100)(rng));
+    for (int i = 0; i < AclKeys().size(); ++i) {
+      const Key& key = AclKeys()[i];
+      if (std::bernoulli_distribution(0.7)(rng)) continue;
+      p4::v1::FieldMatch& match = *entry.add_match();
+      match.set_field_id(i + 1);
+      if (key.match_type == MatchField::OPTIONAL) {
+        match.mutable_optional()->set_value(RandomBytes(key.bitwidth, rng));
+      } else {
+        match.mutable_ternary()->set_value(RandomBytes(key.bitwidth, rng));
+        match.mutable_ternary()->set_mask(
+            std::string((key.bitwidth + 7) / 8, '\xff'));
+        if (key.bitwidth % 8 != 0) {
+          (*match.mutable_ternary()->mutable_mask())[0] =
+              static_cast<char>((1 << (key.bitwidth % 8)) - 1);
+        }
+        (*match.mutable_ternary()->mutable_value())[0] &=
+            match.ternary().mask()[0];
+      }
+    }
+    p4::v1::Action& action = *entry.mutable_action()->mutable_action();
+    action.set_action_id(2);
+    p4::v1::Action::Param& param = *action.add_params();
+    param.set_param_id(1);
+    param.set_value(RandomBytes(12, rng));
+    absl::StatusOr<std::string> reason =
+        ReasonEntryViolatesConstraint(entry, constraint_info);
+    CHECK_OK(reason.status());
+    if (reason->empty()) entries.push_back(std::move(entry));
+  }
+  return entries;
+}
+
+struct Fixture {
+  ConstraintInfo constraint_info;
+  std::vector<p4::v1::TableEntry> entries;
+};
+
+Fixture MakeFixture() {
+  absl::StatusOr<ConstraintInfo> constraint_info =
+      P4ToConstraintInfo(MakeAclP4Info());
+  CHECK_OK(constraint_info.status());
+  Fixture fixture{.constraint_info = *std::move(constraint_info)};
+  fixture.entries = MakeConformingAclEntries(fixture.constraint_info);
+  return fixture;
+}
+
+void SetCounters(benchmark::State& state, int64_t allocations, int entries) {
+  state.SetItemsProcessed(state.iterations() * entries);
+  state.counters["allocs_per_entry"] =
+      static_cast<double>(allocations) / (state.iterations() * entries);
+}
+
+void BM_ReasonEntryViolatesConstraint(benchmark::State& state) {
+  const Fixture fixture = MakeFixture();
+  const int64_t allocations_before = allocation_count.load();
+  for (auto _ : state) {
+    for (const p4::v1::TableEntry& entry : fixture.entries) {
+      benchmark::DoNotOptimize(
+          ReasonEntryViolatesConstraint(entry, fixture.constraint_info));
+    }
+  }
+  SetCounters(state, allocation_count.load() - allocations_before,
+              fixture.entries.size());
+}
+BENCHMARK(BM_ReasonEntryViolatesConstraint);
+
+void BM_Validator(benchmark::State& state) {
+  const Fixture fixture = MakeFixture();
+  Validator validator(fixture.constraint_info);
+  // Warms up the validator's scratch state.
+  for (const p4::v1::TableEntry& entry : fixture.entries) {
+    CHECK_OK(validator.ReasonEntryViolatesConstraint(entry).status());
+  }
+  const int64_t allocations_before = allocation_count.load();
+  for (auto _ : state) {
+    for (const p4::v1::TableEntry& entry : fixture.entries) {
+      benchmark::DoNotOptimize(validator.ReasonEntryViolatesConstraint(entry));
+    }
+  }
+  SetCounters(state, allocation_count.load() - allocations_before,
+              fixture.entries.size());
+}
+BENCHMARK(BM_Validator);
+
+// Takes the number of threads as argument.
+void BM_ReasonEntriesViolateConstraints(benchmark::State& state) {
+  const Fixture fixture = MakeFixture();
+  // Replicates the entries to the size of a reconciliation batch.
+  std::vector<p4::v1::TableEntry> entries;
+  for (int i = 0; i < 100; ++i) {
+    entries.insert(entries.end(), fixture.entries.begin(),
+                   fixture.entries.end());
+  }
+  ThreadPool thread_pool(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ReasonEntriesViolateConstraints(
+        entries, fixture.constraint_info, thread_pool));
+  }
+  state.SetItemsProcessed(state.iterations() * entries.size());
+}
+BENCHMARK(BM_ReasonEntriesViolateConstraints)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace p4_constraints
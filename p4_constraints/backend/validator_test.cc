@@ -0,0 +1,476 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "p4_constraints/backend/validator.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "gutil/status_matchers.h"
+#include "gutil/testing.h"
+#include "p4/config/v1/p4info.pb.h"
+#include "p4/v1/p4runtime.pb.h"
+#include "p4_constraints/ast.pb.h"
+#include "p4_constraints/backend/constraint_info.h"
+#include "p4_constraints/backend/interpreter.h"
+#include "p4_constraints/backend/thread_pool.h"
+#include "p4_constraints/backend/verdict_cache.h"
+#include "p4_constraints/frontend/constraint_kind.h"
+
+namespace p4_constraints {
+namespace {
+
+using ::gutil::IsOkAndHolds;
+using ::gutil::ParseProtoOrDie;
+using ::gutil::StatusIs;
+using ::testing::HasSubstr;
+using ::testing::IsEmpty;
+
+// A wide and a narrow table, so that slots are reused across layouts.
+constexpr char kP4Info[] = R"pb(
+  tables {
+    preamble {
+      id: 1
+      name: "wide_table"
+      annotations: "@entry_restriction(\"ternary16::mask != 0 -> exact8 != 0; ::priority > 0\")"
+    }
+    match_fields { id: 1 name: "exact8" bitwidth: 8 match_type: EXACT }
+    match_fields { id: 2 name: "ternary16" bitwidth: 16 match_type: TERNARY }
+    match_fields { id: 3 name: "lpm32" bitwidth: 32 match_type: LPM }
+    match_fields { id: 4 name: "range8" bitwidth: 8 match_type: RANGE }
+  }
+  tables {
+    preamble {
+      id: 2
+      name: "narrow_table"
+      annotations: "@entry_restriction(\"lpm32::prefix_length <= 24\")"
+    }
+    match_fields { id: 1 name: "lpm32" bitwidth: 32 match_type: LPM }
+  }
+  actions {
+    preamble {
+      id: 3
+      name: "set_vlan"
+      annotations: "@action_restriction(\"vlan_id != 0\")"
+    }
+    params { id: 1 name: "vlan_id" bitwidth: 12 }
+  }
+)pb";
+
+class ValidatorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_OK_AND_ASSIGN(
+        constraint_info_,
+        P4ToConstraintInfo(ParseProtoOrDie<p4::config::v1::P4Info>(kP4Info)));
+  }
+
+  ConstraintInfo constraint_info_;
+};
+
+TEST_F(ValidatorTest, AgreesWithReasonEntryViolatesConstraint) {
+  const std::vector<p4::v1::TableEntry> entries = {
+      // Satisfies the constraint.
+      ParseProtoOrDie<p4::v1::TableEntry>(R"pb(
+        table_id: 1
+        priority: 10
+        match { field_id: 1 exact { value: "\x01" } }
+        match { field_id: 2 ternary { value: "\x00\x10" mask: "\x00\xf0" } }
+      )pb"),
+      // Violates the constraint.
+      ParseProtoOrDie<p4::v1::TableEntry>(R"pb(
+        table_id: 1
+        priority: 10
+        match { field_id: 1 exact { value: "\x00" } }
+        match { field_id: 2 ternary { value: "\x00\x10" mask: "\x00\xf0" } }
+      )pb"),
+      ParseProtoOrDie<p4::v1::TableEntry>(R"pb(
+        table_id: 2
+        match { field_id: 1 lpm { value: "\x0a\x00\x00\x00" prefix_len: 32 } }
+      )pb"),
+      ParseProtoOrDie<p4::v1::TableEntry>(R"pb(
+        table_id: 2
+        match { field_id: 1 lpm { value: "\x0a\x00\x00\x00" prefix_len: 8 } }
+        action {
+          action {
+            action_id: 3
+            params { param_id: 1 value: "\x00" }
+          }
+        }
+      )pb"),
+      ParseProtoOrDie<p4::v1::TableEntry>(R"pb(
+        table_id: 2
+        action {
+          action_profile_action_set {
+            action_profile_actions {
+              action {
+                action_id: 3
+                params { param_id: 1 value: "\x01" }
+              }
+            }
+          }
+        }
+      )pb"),
+      // Invalid: missing exact key, duplicate key, unknown table.
+      ParseProtoOrDie<p4::v1::TableEntry>(R"pb(
+        table_id: 1 priority: 10
+      )pb"),
+      ParseProtoOrDie<p4::v1::TableEntry>(R"pb(
+        table_id: 2
+        match { field_id: 1 lpm { value: "\x0a\x00\x00\x00" prefix_len: 8 } }
+        match { field_id: 1 lpm { value: "\x0a\x00\x00\x00" prefix_len: 8 } }
+      )pb"),
+      ParseProtoOrDie<p4::v1::TableEntry>(R"pb(
+        table_id: 42
+      )pb"),
+  };
+
+  Validator validator(constraint_info_);
+  // Twice, to exercise reused scratch state.
+  for (int round = 0; round < 2; ++round) {
+    for (const p4::v1::TableEntry& entry : entries) {
+      SCOPED_TRACE(entry.DebugString());
+      absl::StatusOr<std::string> expected =
+          ReasonEntryViolatesConstraint(entry, constraint_info_);
+      absl::StatusOr<std::string> actual =
+          validator.ReasonEntryViolatesConstraint(entry);
+      ASSERT_EQ(actual.status(), expected.status());
+      if (expected.ok()) EXPECT_EQ(*actual, *expected);
+    }
+  }
+}
+
+TEST_F(ValidatorTest, ExplainsViolationsOnlyInTermsOfTheCurrentEntry) {
+  Validator validator(constraint_info_);
+  ASSERT_THAT(validator.ReasonEntryViolatesConstraint(
+                  ParseProtoOrDie<p4::v1::TableEntry>(R"pb(
+                    table_id: 1
+                    priority: 10
+                    match { field_id: 1 exact { value: "\x00" } }
+                    match {
+                      field_id: 2
+                      ternary { value: "\x00\x10" mask: "\x00\xf0" }
+                    }
+                  )pb")),
+              IsOkAndHolds(HasSubstr("exact8")));
+  EXPECT_THAT(validator.ReasonEntryViolatesConstraint(
+                  ParseProtoOrDie<p4::v1::TableEntry>(R"pb(
+                    table_id: 1
+                    priority: 0
+                    match { field_id: 1 exact { value: "\x01" } }
+                  )pb")),
+              IsOkAndHolds(HasSubstr("::priority > 0")));
+  EXPECT_THAT(validator.ReasonEntryViolatesConstraint(
+                  ParseProtoOrDie<p4::v1::TableEntry>(R"pb(
+                    table_id: 1
+                    priority: 1
+                    match { field_id: 1 exact { value: "\x01" } }
+                  )pb")),
+              IsOkAndHolds(IsEmpty()));
+}
+
+TEST_F(ValidatorTest, FindsViolationsWithoutExplainingThem) {
+  const p4::v1::TableEntry satisfying = ParseProtoOrDie<p4::v1::TableEntry>(
+      R"pb(
+        table_id: 1
+        priority: 1
+        match { field_id: 1 exact { value: "\x01" } }
+      )pb");
+  const p4::v1::TableEntry violating_table = ParseProtoOrDie<
+      p4::v1::TableEntry>(R"pb(
+    table_id: 1
+    priority: 0
+    match { field_id: 1 exact { value: "\x01" } }
+  )pb");
+  const p4::v1::TableEntry violating_action = ParseProtoOrDie<
+      p4::v1::TableEntry>(R"pb(
+    table_id: 2
+    action {
+      action_profile_action_set {
+        action_profile_actions {
+          action {
+            action_id: 3
+            params { param_id: 1 value: "\x01" }
+          }
+        }
+        action_profile_actions {
+          action {
+            action_id: 3
+            params { param_id: 1 value: "\x00" }
+          }
+        }
+      }
+    }
+  )pb");
+
+  Validator validator(constraint_info_);
+  ASSERT_OK_AND_ASSIGN(std::optional<Violation> no_violation,
+                       validator.FindViolation(satisfying));
+  EXPECT_FALSE(no_violation.has_value());
+
+  ASSERT_OK_AND_ASSIGN(std::optional<Violation> table_violation,
+                       validator.FindViolation(violating_table));
+  ASSERT_TRUE(table_violation.has_value());
+  EXPECT_EQ(table_violation->kind, ConstraintKind::kTableConstraint);
+  EXPECT_EQ(table_violation->id, 1);
+  ASSERT_NE(table_violation->reason, nullptr);
+  EXPECT_EQ(table_violation->reason->binary_expression().binop(), ast::GT);
+  EXPECT_FALSE(table_violation->reason_holds);
+
+  ASSERT_OK_AND_ASSIGN(std::optional<Violation> action_violation,
+                       validator.FindViolation(violating_action));
+  ASSERT_TRUE(action_violation.has_value());
+  EXPECT_EQ(action_violation->kind, ConstraintKind::kActionConstraint);
+  EXPECT_EQ(action_violation->id, 3);
+  EXPECT_EQ(action_violation->action_index, 1);
+  EXPECT_FALSE(action_violation->reason_holds);
+
+  // Explaining in any order agrees with `ReasonEntryViolatesConstraint`.
+  for (const auto& [entry, violation] :
+       {std::pair(&violating_action, *action_violation),
+        std::pair(&violating_table, *table_violation)}) {
+    ASSERT_OK_AND_ASSIGN(std::string expected,
+                         ReasonEntryViolatesConstraint(*entry,
+                                                       constraint_info_));
+    EXPECT_THAT(validator.ExplainViolation(*entry, violation),
+                IsOkAndHolds(expected));
+  }
+}
+
+TEST_F(ValidatorTest, BatchResultsAreInInputOrder) {
+  // Interleaves tables, and both satisfying and violating entries.
+  std::vector<p4::v1::TableEntry> entries;
+  for (int i = 0; i < 2000; ++i) {
+    p4::v1::TableEntry entry;
+    if (i % 3 == 0) {
+      entry.set_table_id(2);
+      p4::v1::FieldMatch& match = *entry.add_match();
+      match.set_field_id(1);
+      match.mutable_lpm()->set_value(std::string("\x0a\x00\x00\x00", 4));
+      match.mutable_lpm()->set_prefix_len(i % 33);
+    } else if (i % 3 == 1) {
+      entry.set_table_id(1);
+      entry.set_priority(i % 5);
+      p4::v1::FieldMatch& match = *entry.add_match();
+      match.set_field_id(1);
+      match.mutable_exact()->set_value(std::string(1, static_cast<char>(i)));
+    } else {
+      entry.set_table_id(i % 7 == 0 ? 42 : 1);
+    }
+    entries.push_back(entry);
+  }
+
+  std::vector<absl::StatusOr<std::string>> expected;
+  for (const p4::v1::TableEntry& entry : entries) {
+    expected.push_back(ReasonEntryViolatesConstraint(entry, constraint_info_));
+  }
+  for (int num_threads : {1, 4}) {
+    SCOPED_TRACE(absl::StrCat(num_threads, " threads"));
+    EXPECT_EQ(
+        ReasonEntriesViolateConstraints(entries, constraint_info_, num_threads),
+        expected);
+  }
+  ThreadPool thread_pool(3);
+  EXPECT_EQ(
+      ReasonEntriesViolateConstraints(entries, constraint_info_, thread_pool),
+      expected);
+  EXPECT_THAT(
+      ReasonEntriesViolateConstraints({}, constraint_info_, thread_pool),
+      IsEmpty());
+}
+
+TEST_F(ValidatorTest, BatchesKeepGoingPastInvalidEntries) {
+  // A batch of entries of one table, one of which cannot be parsed.
+  std::vector<p4::v1::TableEntry> entries;
+  for (int prefix_len : {8, 32, 16, 24, 30}) {
+    p4::v1::TableEntry& entry = entries.emplace_back();
+    entry.set_table_id(2);
+    p4::v1::FieldMatch& match = *entry.add_match();
+    match.set_field_id(1);
+    match.mutable_lpm()->set_value(std::string("\x0a\x00\x00\x00", 4));
+    match.mutable_lpm()->set_prefix_len(prefix_len);
+  }
+  // Duplicate key.
+  *entries[2].add_match() = entries[2].match(0);
+  // Satisfies the table constraint, violates the action restriction.
+  *entries[3].mutable_action() = ParseProtoOrDie<p4::v1::TableAction>(R"pb(
+    action {
+      action_id: 3
+      params { param_id: 1 value: "\x00" }
+    }
+  )pb");
+
+  std::vector<const p4::v1::TableEntry*> entry_pointers;
+  std::vector<absl::StatusOr<std::string>> expected;
+  for (const p4::v1::TableEntry& entry : entries) {
+    entry_pointers.push_back(&entry);
+    expected.push_back(ReasonEntryViolatesConstraint(entry, constraint_info_));
+  }
+  ASSERT_THAT(expected[0], IsOkAndHolds(IsEmpty()));
+  ASSERT_THAT(expected[1], IsOkAndHolds(HasSubstr("prefix_length <= 24")));
+  ASSERT_THAT(expected[2], StatusIs(absl::StatusCode::kInvalidArgument,
+                                    HasSubstr("narrow_table")));
+  ASSERT_THAT(expected[3], IsOkAndHolds(HasSubstr("vlan_id != 0")));
+
+  Validator validator(constraint_info_);
+  // Twice, to exercise reused scratch state.
+  for (int round = 0; round < 2; ++round) {
+    std::vector<absl::StatusOr<std::string>> actual(entries.size());
+    validator.ReasonEntriesViolateConstraint(entry_pointers,
+                                             absl::MakeSpan(actual));
+    EXPECT_EQ(actual, expected);
+  }
+}
+
+TEST_F(ValidatorTest, ValidatesInsertsAndModifiesOfWriteRequests) {
+  const auto write_request = ParseProtoOrDie<p4::v1::WriteRequest>(R"pb(
+    # Satisfies the constraint.
+    updates {
+      type: INSERT
+      entity {
+        table_entry {
+          table_id: 2
+          match { field_id: 1 lpm { value: "\x0a\x00\x00\x00" prefix_len: 8 } }
+        }
+      }
+    }
+    # Violates the constraint.
+    updates {
+      type: MODIFY
+      entity {
+        table_entry {
+          table_id: 2
+          match { field_id: 1 lpm { value: "\x0a\x00\x00\x00" prefix_len: 32 } }
+        }
+      }
+    }
+    # Violates the constraint, but is deleted.
+    updates {
+      type: DELETE
+      entity {
+        table_entry {
+          table_id: 2
+          match { field_id: 1 lpm { value: "\x0a\x00\x00\x00" prefix_len: 32 } }
+        }
+      }
+    }
+    # Not a table entry.
+    updates {
+      type: INSERT
+      entity { action_profile_member { action_profile_id: 1 member_id: 1 } }
+    }
+    # Invalid.
+    updates {
+      type: INSERT
+      entity { table_entry { table_id: 42 } }
+    }
+  )pb");
+
+  for (int num_threads : {1, 4}) {
+    SCOPED_TRACE(absl::StrCat(num_threads, " threads"));
+    std::vector<absl::Status> statuses =
+        ValidateWriteRequest(write_request, constraint_info_, num_threads);
+    ASSERT_EQ(statuses.size(), write_request.updates_size());
+    EXPECT_OK(statuses[0]);
+    EXPECT_THAT(statuses[1], StatusIs(absl::StatusCode::kInvalidArgument,
+                                      HasSubstr("lpm32::prefix_length")));
+    EXPECT_OK(statuses[2]);
+    EXPECT_OK(statuses[3]);
+    EXPECT_THAT(statuses[4], StatusIs(absl::StatusCode::kInvalidArgument,
+                                      HasSubstr("unknown table ID")));
+
+    const std::vector<p4::v1::Update> updates(write_request.updates().begin(),
+                                              write_request.updates().end());
+    EXPECT_EQ(ValidateUpdates(updates, constraint_info_, num_threads),
+              statuses);
+  }
+  EXPECT_THAT(ValidateUpdates({}, constraint_info_), IsEmpty());
+}
+
+TEST_F(ValidatorTest, CachesVerdictsButNotErrors) {
+  const std::vector<p4::v1::TableEntry> entries = {
+      ParseProtoOrDie<p4::v1::TableEntry>(R"pb(
+        table_id: 2
+        match { field_id: 1 lpm { value: "\x0a\x00\x00\x00" prefix_len: 8 } }
+      )pb"),
+      ParseProtoOrDie<p4::v1::TableEntry>(R"pb(
+        table_id: 2
+        match { field_id: 1 lpm { value: "\x0a\x00\x00\x00" prefix_len: 32 } }
+      )pb"),
+      ParseProtoOrDie<p4::v1::TableEntry>(R"pb(
+        table_id: 1 priority: 10
+      )pb"),
+  };
+  VerdictCache cache(/*capacity=*/10);
+  Validator validator(constraint_info_, &cache);
+  for (int round = 0; round < 3; ++round) {
+    for (const p4::v1::TableEntry& entry : entries) {
+      absl::StatusOr<std::string> expected =
+          ReasonEntryViolatesConstraint(entry, constraint_info_);
+      absl::StatusOr<std::string> actual =
+          validator.ReasonEntryViolatesConstraint(entry);
+      ASSERT_EQ(actual.status(), expected.status());
+      if (expected.ok()) EXPECT_EQ(*actual, *expected);
+    }
+  }
+  const VerdictCache::Stats stats = cache.stats();
+  EXPECT_EQ(stats.size, 2);
+  EXPECT_EQ(stats.hits, 4);
+  EXPECT_EQ(stats.misses, 5);
+
+  // Verdicts are not shared with other translations of the same P4Info.
+  ASSERT_OK_AND_ASSIGN(
+      const ConstraintInfo other_constraint_info,
+      P4ToConstraintInfo(ParseProtoOrDie<p4::config::v1::P4Info>(kP4Info)));
+  ASSERT_NE(other_constraint_info.generation, constraint_info_.generation);
+  ASSERT_OK(Validator(other_constraint_info, &cache)
+                .ReasonEntryViolatesConstraint(entries[0]));
+  EXPECT_EQ(cache.stats().misses, 6);
+}
+
+TEST_F(ValidatorTest, IgnoresVerdictCacheForHandBuiltConstraintInfo) {
+  // Hand-built infos all have generation 0, so their verdicts would collide.
+  ConstraintInfo hand_built = constraint_info_;
+  hand_built.generation = 0;
+  ConstraintInfo other_hand_built = constraint_info_;
+  other_hand_built.generation = 0;
+  other_hand_built.table_info_by_id.erase(2);
+  const p4::v1::TableEntry entry = ParseProtoOrDie<p4::v1::TableEntry>(R"pb(
+    table_id: 2
+    match { field_id: 1 lpm { value: "\x0a\x00\x00\x00" prefix_len: 8 } }
+  )pb");
+
+  VerdictCache cache(/*capacity=*/10);
+  EXPECT_THAT(
+      Validator(hand_built, &cache).ReasonEntryViolatesConstraint(entry),
+      IsOkAndHolds(IsEmpty()));
+  EXPECT_THAT(
+      Validator(other_hand_built, &cache).ReasonEntryViolatesConstraint(entry),
+      StatusIs(absl::StatusCode::kInvalidArgument));
+  const VerdictCache::Stats stats = cache.stats();
+  EXPECT_EQ(stats.size, 0);
+  EXPECT_EQ(stats.hits, 0);
+  EXPECT_EQ(stats.misses, 0);
+}
+
+TEST_F(ValidatorTest, ParseErrorsMentionTheTable) {
+  Validator validator(constraint_info_);
+  EXPECT_THAT(validator.ReasonEntryViolatesConstraint(
+                  ParseProtoOrDie<p4::v1::TableEntry>(R"pb(
+                    table_id: 1 priority: 10
+                  )pb")),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("wide_table")));
+}
+
+}  // namespace
+}  // namespace p4_constraints
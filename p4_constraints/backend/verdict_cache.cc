@@ -0,0 +1,192 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "p4_constraints/backend/verdict_cache.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+
+#include "absl/container/inlined_vector.h"
+#include "absl/log/check.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "p4/v1/p4runtime.pb.h"
+
+namespace p4_constraints {
+
+VerdictCache::VerdictCache(int capacity) : capacity_(capacity) {
+  CHECK_GT(capacity, 0);
+}
+
+bool VerdictCache::Lookup(absl::string_view key, std::string& reason) {
+  absl::ReaderMutexLock lock(&mutex_);
+  auto it = verdicts_.find(key);
+  if (it == verdicts_.end()) {
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  hits_.fetch_add(1, std::memory_order_relaxed);
+  // Only a hint for eviction, so needs no ordering.
+  it->second.referenced.store(true, std::memory_order_relaxed);
+  reason = it->second.reason;
+  return true;
+}
+
+void VerdictCache::Insert(absl::string_view key, absl::string_view reason) {
+  absl::WriterMutexLock lock(&mutex_);
+  if (auto it = verdicts_.find(key); it != verdicts_.end()) {
+    // Inserted concurrently by another thread.
+    it->second.reason = std::string(reason);
+    return;
+  }
+  if (clock_.size() < capacity_) {
+    clock_.push_back(&*verdicts_.try_emplace(key, reason).first);
+    return;
+  }
+  // Advances the hand to the first entry that was not hit since the hand last
+  // passed it, and replaces that entry.
+  while (clock_[hand_]->second.referenced.exchange(
+      false, std::memory_order_relaxed)) {
+    hand_ = (hand_ + 1) % capacity_;
+  }
+  verdicts_.erase(verdicts_.find(clock_[hand_]->first));
+  ++evictions_;
+  clock_[hand_] = &*verdicts_.try_emplace(key, reason).first;
+  hand_ = (hand_ + 1) % capacity_;
+}
+
+VerdictCache::Stats VerdictCache::stats() const {
+  absl::ReaderMutexLock lock(&mutex_);
+  return Stats{
+      .hits = hits_.load(std::memory_order_relaxed),
+      .misses = misses_.load(std::memory_order_relaxed),
+      .evictions = evictions_,
+      .size = static_cast<int>(verdicts_.size()),
+  };
+}
+
+namespace {
+
+void AppendUint32(uint32_t value, std::string& key) {
+  key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void AppendUint64(uint64_t value, std::string& key) {
+  key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// Appends a P4Runtime bytestring, stripped of leading zero bytes, preceded by
+// its length.
+void AppendInteger(absl::string_view bytes, std::string& key) {
+  const size_t leading_zeros = std::min(bytes.find_first_not_of('\0'),
+                                        bytes.size());
+  bytes.remove_prefix(leading_zeros);
+  AppendUint32(bytes.size(), key);
+  key.append(bytes.data(), bytes.size());
+}
+
+void AppendFieldMatch(const p4::v1::FieldMatch& match, std::string& key) {
+  AppendUint32(match.field_id(), key);
+  AppendUint32(match.field_match_type_case(), key);
+  switch (match.field_match_type_case()) {
+    case p4::v1::FieldMatch::kExact:
+      AppendInteger(match.exact().value(), key);
+      break;
+    case p4::v1::FieldMatch::kTernary:
+      AppendInteger(match.ternary().value(), key);
+      AppendInteger(match.ternary().mask(), key);
+      break;
+    case p4::v1::FieldMatch::kLpm:
+      AppendInteger(match.lpm().value(), key);
+      AppendUint32(match.lpm().prefix_len(), key);
+      break;
+    case p4::v1::FieldMatch::kRange:
+      AppendInteger(match.range().low(), key);
+      AppendInteger(match.range().high(), key);
+      break;
+    case p4::v1::FieldMatch::kOptional:
+      AppendInteger(match.optional().value(), key);
+      break;
+    default: {
+      // Not supported by the interpreter, so the entry's check fails anyway;
+      // still keeps keys distinct.
+      const std::string bytes = match.SerializeAsString();
+      AppendUint32(bytes.size(), key);
+      key.append(bytes);
+      break;
+    }
+  }
+}
+
+void AppendAction(const p4::v1::Action& action, std::string& key) {
+  AppendUint32(action.action_id(), key);
+  absl::InlinedVector<const p4::v1::Action::Param*, 16> params;
+  for (const p4::v1::Action::Param& param : action.params()) {
+    params.push_back(&param);
+  }
+  std::stable_sort(params.begin(), params.end(),
+                   [](const p4::v1::Action::Param* left,
+                      const p4::v1::Action::Param* right) {
+                     return left->param_id() < right->param_id();
+                   });
+  AppendUint32(params.size(), key);
+  for (const p4::v1::Action::Param* param : params) {
+    AppendUint32(param->param_id(), key);
+    AppendInteger(param->value(), key);
+  }
+}
+
+}  // namespace
+
+void MakeVerdictCacheKey(const p4::v1::TableEntry& entry, uint64_t generation,
+                         std::string& key) {
+  key.clear();
+  AppendUint64(generation, key);
+  AppendUint32(entry.table_id(), key);
+  AppendUint32(entry.priority(), key);
+
+  absl::InlinedVector<const p4::v1::FieldMatch*, 16> matches;
+  for (const p4::v1::FieldMatch& match : entry.match()) {
+    matches.push_back(&match);
+  }
+  std::stable_sort(
+      matches.begin(), matches.end(),
+      [](const p4::v1::FieldMatch* left, const p4::v1::FieldMatch* right) {
+        return left->field_id() < right->field_id();
+      });
+  AppendUint32(matches.size(), key);
+  for (const p4::v1::FieldMatch* match : matches) {
+    AppendFieldMatch(*match, key);
+  }
+
+  const p4::v1::TableAction& action = entry.action();
+  AppendUint32(action.type_case(), key);
+  switch (action.type_case()) {
+    case p4::v1::TableAction::kAction:
+      AppendAction(action.action(), key);
+      break;
+    case p4::v1::TableAction::kActionProfileMemberId:
+      AppendUint32(action.action_profile_member_id(), key);
+      break;
+    case p4::v1::TableAction::kActionProfileGroupId:
+      AppendUint32(action.action_profile_group_id(), key);
+      break;
+    case p4::v1::TableAction::kActionProfileActionSet: {
+      // Weights and watch ports are not constrained.
+      const auto& actions =
+          action.action_profile_action_set().action_profile_actions();
+      AppendUint32(actions.size(), key);
+      for (const p4::v1::ActionProfileAction& action_profile_action : actions) {
+        AppendAction(action_profile_action.action(), key);
+      }
+      break;
+    }
+    case p4::v1::TableAction::TYPE_NOT_SET:
+      break;
+  }
+}
+
+}  // namespace p4_constraints
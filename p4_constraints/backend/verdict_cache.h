@@ -0,0 +1,96 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+// A bounded cache of the results of checking table entries against their
+// constraints, for controllers that check the same entries over and over
+// (reconciliation, retries, MODIFYs that only change counters or metadata).
+
+#ifndef P4_CONSTRAINTS_BACKEND_VERDICT_CACHE_H_
+#define P4_CONSTRAINTS_BACKEND_VERDICT_CACHE_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/node_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "p4/v1/p4runtime.pb.h"
+
+namespace p4_constraints {
+
+// Maps keys (see `MakeVerdictCacheKey`) to the reason the corresponding entry
+// violates its constraints, or the empty string if it satisfies them.
+//
+// Holds at most `capacity` entries, evicting with the CLOCK algorithm: a hit
+// marks an entry as recently used, and eviction skips (and unmarks) marked
+// entries, approximating LRU without reordering on every hit. Since marking an
+// entry needs no reordering, lookups only take a reader lock, and run
+// concurrently with each other; only insertions are exclusive.
+//
+// Thread-safe.
+class VerdictCache {
+ public:
+  // Counters for sizing the cache.
+  struct Stats {
+    int64_t hits = 0;
+    int64_t misses = 0;
+    int64_t evictions = 0;
+    // Number of cached entries.
+    int size = 0;
+  };
+
+  // `capacity` must be positive.
+  explicit VerdictCache(int capacity);
+
+  VerdictCache(const VerdictCache&) = delete;
+  VerdictCache& operator=(const VerdictCache&) = delete;
+
+  // Returns true and sets `reason` to the cached reason if `key` is cached.
+  bool Lookup(absl::string_view key, std::string& reason)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Caches `reason` under `key`, evicting an entry if the cache is full.
+  void Insert(absl::string_view key, absl::string_view reason)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  Stats stats() const ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  struct Verdict {
+    explicit Verdict(absl::string_view reason) : reason(reason) {}
+
+    std::string reason;
+    // Set on hits, under a reader lock, and cleared when the clock hand passes.
+    std::atomic<bool> referenced = false;
+  };
+  using Map = absl::node_hash_map<std::string, Verdict>;
+
+  const int capacity_;
+  mutable absl::Mutex mutex_;
+  Map verdicts_ ABSL_GUARDED_BY(mutex_);
+  // The cached entries in clock order. Points into `verdicts_`, whose nodes
+  // are stable.
+  std::vector<Map::value_type*> clock_ ABSL_GUARDED_BY(mutex_);
+  int hand_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Counted under a reader lock.
+  std::atomic<int64_t> hits_ = 0;
+  std::atomic<int64_t> misses_ = 0;
+  int64_t evictions_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+// Sets `key` to a canonical encoding of everything in `entry` that checking it
+// against a `ConstraintInfo` of the given `generation` depends on: the table
+// ID, the priority, the matches (ordered by field ID), and the action(s).
+// Integers are encoded like `ParseP4RTInteger` reads them, i.e. without
+// leading zero bytes, so that entries that only differ in how their values are
+// padded share a key. Reuses the storage of `key`.
+void MakeVerdictCacheKey(const p4::v1::TableEntry& entry, uint64_t generation,
+                         std::string& key);
+
+}  // namespace p4_constraints
+
+#endif  // P4_CONSTRAINTS_BACKEND_VERDICT_CACHE_H_
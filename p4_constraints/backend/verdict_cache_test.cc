@@ -0,0 +1,176 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "p4_constraints/backend/verdict_cache.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string>
+
+#include "gutil/testing.h"
+#include "p4/v1/p4runtime.pb.h"
+#include "p4_constraints/backend/thread_pool.h"
+
+namespace p4_constraints {
+namespace {
+
+using ::gutil::ParseProtoOrDie;
+
+std::string Key(const std::string& entry, uint64_t generation = 1) {
+  std::string key;
+  MakeVerdictCacheKey(ParseProtoOrDie<p4::v1::TableEntry>(entry), generation,
+                      key);
+  return key;
+}
+
+TEST(MakeVerdictCacheKeyTest, IgnoresPaddingOrderAndUnconstrainedFields) {
+  EXPECT_EQ(Key(R"pb(
+              table_id: 1
+              priority: 10
+              match { field_id: 1 exact { value: "\x00\x05" } }
+              match { field_id: 2 ternary { value: "\x01" mask: "\x00\xff" } }
+              action {
+                action {
+                  action_id: 3
+                  params { param_id: 1 value: "\x07" }
+                  params { param_id: 2 value: "\x00" }
+                }
+              }
+            )pb"),
+            Key(R"pb(
+              table_id: 1
+              priority: 10
+              match { field_id: 2 ternary { value: "\x00\x01" mask: "\xff" } }
+              match { field_id: 1 exact { value: "\x05" } }
+              action {
+                action {
+                  action_id: 3
+                  params { param_id: 2 value: "" }
+                  params { param_id: 1 value: "\x00\x07" }
+                }
+              }
+              metadata: "cookie"
+            )pb"));
+}
+
+TEST(MakeVerdictCacheKeyTest, DistinguishesEntriesCheckedDifferently) {
+  const std::string entry = R"pb(
+    table_id: 1
+    priority: 10
+    match { field_id: 1 exact { value: "\x05" } }
+  )pb";
+  const std::string key = Key(entry);
+  EXPECT_NE(key, Key(entry, /*generation=*/2));
+  EXPECT_NE(key, Key(R"pb(
+              table_id: 2
+              priority: 10
+              match { field_id: 1 exact { value: "\x05" } }
+            )pb"));
+  EXPECT_NE(key, Key(R"pb(
+              table_id: 1
+              priority: 11
+              match { field_id: 1 exact { value: "\x05" } }
+            )pb"));
+  EXPECT_NE(key, Key(R"pb(
+              table_id: 1
+              priority: 10
+              match { field_id: 1 exact { value: "\x05\x00" } }
+            )pb"));
+  EXPECT_NE(key, Key(R"pb(
+              table_id: 1
+              priority: 10
+              match { field_id: 1 optional { value: "\x05" } }
+            )pb"));
+  EXPECT_NE(key, Key(R"pb(
+              table_id: 1
+              priority: 10
+              match { field_id: 2 exact { value: "\x05" } }
+            )pb"));
+  EXPECT_NE(key, Key(R"pb(
+              table_id: 1
+              priority: 10
+              match { field_id: 1 exact { value: "\x05" } }
+              action { action { action_id: 1 } }
+            )pb"));
+}
+
+TEST(VerdictCacheTest, CountsHitsAndMisses) {
+  VerdictCache cache(/*capacity=*/10);
+  std::string reason;
+  EXPECT_FALSE(cache.Lookup("a", reason));
+  cache.Insert("a", "violated");
+  cache.Insert("b", "");
+  EXPECT_TRUE(cache.Lookup("a", reason));
+  EXPECT_EQ(reason, "violated");
+  EXPECT_TRUE(cache.Lookup("b", reason));
+  EXPECT_EQ(reason, "");
+
+  const VerdictCache::Stats stats = cache.stats();
+  EXPECT_EQ(stats.hits, 2);
+  EXPECT_EQ(stats.misses, 1);
+  EXPECT_EQ(stats.evictions, 0);
+  EXPECT_EQ(stats.size, 2);
+}
+
+TEST(VerdictCacheTest, EvictsEntriesThatWereNotHitRecently) {
+  VerdictCache cache(/*capacity=*/3);
+  cache.Insert("a", "");
+  cache.Insert("b", "");
+  cache.Insert("c", "");
+  std::string reason;
+  ASSERT_TRUE(cache.Lookup("a", reason));
+  ASSERT_TRUE(cache.Lookup("c", reason));
+
+  // Evicts "b", the only entry that was not hit.
+  cache.Insert("d", "");
+  EXPECT_TRUE(cache.Lookup("a", reason));
+  EXPECT_FALSE(cache.Lookup("b", reason));
+  EXPECT_TRUE(cache.Lookup("c", reason));
+  EXPECT_TRUE(cache.Lookup("d", reason));
+
+  EXPECT_EQ(cache.stats().evictions, 1);
+  EXPECT_EQ(cache.stats().size, 3);
+}
+
+TEST(VerdictCacheTest, StaysWithinCapacity) {
+  VerdictCache cache(/*capacity=*/4);
+  std::string reason;
+  for (int i = 0; i < 100; ++i) {
+    const std::string key = std::to_string(i);
+    cache.Insert(key, key);
+    ASSERT_TRUE(cache.Lookup(key, reason));
+    EXPECT_EQ(reason, key);
+    EXPECT_LE(cache.stats().size, 4);
+  }
+  EXPECT_EQ(cache.stats().evictions, 96);
+}
+
+TEST(VerdictCacheTest, CanBeSharedBetweenThreads) {
+  constexpr int kNumKeys = 100;
+  constexpr int kLookupsPerTask = 1000;
+  constexpr int kNumTasks = 64;
+  VerdictCache cache(/*capacity=*/kNumKeys / 2);
+  ThreadPool thread_pool(4);
+  std::atomic<int> mismatches = 0;
+  thread_pool.ParallelFor(kNumTasks, [&](int task, int /*worker*/) {
+    std::string reason;
+    for (int i = 0; i < kLookupsPerTask; ++i) {
+      const std::string key = std::to_string((task * 7 + i) % kNumKeys);
+      if (!cache.Lookup(key, reason)) {
+        cache.Insert(key, key);
+      } else if (reason != key) {
+        ++mismatches;
+      }
+    }
+  });
+
+  EXPECT_EQ(mismatches, 0);
+  const VerdictCache::Stats stats = cache.stats();
+  EXPECT_EQ(stats.hits + stats.misses, kNumTasks * kLookupsPerTask);
+  EXPECT_LE(stats.size, kNumKeys / 2);
+}
+
+}  // namespace
+}  // namespace p4_constraints
@@ -0,0 +1,674 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "p4_constraints/backend/vm.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/container/inlined_vector.h"
+#include "absl/numeric/int128.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "gutil/status.h"
+#include "p4_constraints/ast.h"
+#include "p4_constraints/ast.pb.h"
+#include "p4_constraints/backend/constraint_info.h"
+#include "p4_constraints/backend/eval_result.h"
+#include "p4_constraints/backend/interpreter.h"
+#include "p4_constraints/backend/program.h"
+#include "p4_constraints/big_int.h"
+
+namespace p4_constraints {
+
+namespace {
+
+using ::p4_constraints::ast::Type;
+using ::p4_constraints::internal_interpreter::ActionInvocation;
+using ::p4_constraints::internal_interpreter::EvalResult;
+using ::p4_constraints::internal_interpreter::EvaluationContext;
+using ::p4_constraints::internal_interpreter::Exact;
+using ::p4_constraints::internal_interpreter::Lpm;
+using ::p4_constraints::internal_interpreter::Range;
+using ::p4_constraints::internal_interpreter::TableEntry;
+using ::p4_constraints::internal_interpreter::Ternary;
+
+// Values of the variables of a program, indexed like `Program::variables`.
+using Keys = absl::InlinedVector<const EvalResult*, 16>;
+using Params = absl::InlinedVector<const BigInt*, 16>;
+
+// Returns true iff `value` is the runtime representation of a key of the given
+// type, mirroring `DynamicTypeCheck` in the interpreter.
+bool IsRepresentationOf(const EvalResult& value, const Type& type) {
+  switch (type.type_case()) {
+    case Type::kExact:
+      return std::holds_alternative<Exact>(value);
+    case Type::kTernary:
+    case Type::kOptionalMatch:
+      return std::holds_alternative<Ternary>(value);
+    case Type::kLpm:
+      return std::holds_alternative<Lpm>(value);
+    case Type::kRange:
+      return std::holds_alternative<Range>(value);
+    default:
+      return false;
+  }
+}
+
+// Returns the given component of a key value. The caller must ensure that the
+// key has the given component.
+const BigInt& KeyComponent(const EvalResult& value, KeyField field) {
+  switch (field) {
+    case KeyField::kValue:
+      if (auto* exact = std::get_if<Exact>(&value)) return exact->value;
+      if (auto* ternary = std::get_if<Ternary>(&value)) return ternary->value;
+      return std::get<Lpm>(value).value;
+    case KeyField::kMask:
+      return std::get<Ternary>(value).mask;
+    case KeyField::kPrefixLength:
+      return std::get<Lpm>(value).prefix_length;
+    case KeyField::kLow:
+      return std::get<Range>(value).low;
+    case KeyField::kHigh:
+      return std::get<Range>(value).high;
+  }
+  return std::get<Range>(value).high;  // Unreachable.
+}
+
+// Returns the slot of `variable` in `layout`, preferring the slot assigned at
+// load time and falling back to a lookup by name if the entry was not laid out
+// like the program's table (resp. action). Returns -1 if there is no such
+// slot.
+int SlotOf(const Variable& variable, const EntryLayout* layout) {
+  if (layout == nullptr) return -1;
+  if (variable.slot >= 0 && variable.slot < layout->names.size() &&
+      layout->names[variable.slot] == variable.name) {
+    return variable.slot;
+  }
+  auto it = layout->slot_by_name.find(variable.name);
+  if (it == layout->slot_by_name.end()) return -1;
+  return it->second;
+}
+
+// Resolves the variables of `program` to their values in `table_entry`.
+absl::StatusOr<Keys> ResolveKeys(const Program& program,
+                                 const TableEntry& table_entry) {
+  Keys keys;
+  keys.reserve(program.variables.size());
+  for (const Variable& variable : program.variables) {
+    const int slot = SlotOf(variable, table_entry.layout.get());
+    if (slot < 0 || slot >= table_entry.keys.size()) {
+      return gutil::InternalErrorBuilder()
+             << "unknown key " << variable.name << " in table "
+             << table_entry.table_name;
+    }
+    const EvalResult& value = table_entry.keys[slot];
+    if (!IsRepresentationOf(value, variable.type)) {
+      return gutil::InternalErrorBuilder()
+             << "unexpected runtime representation of key " << variable.name
+             << " of type " << variable.type;
+    }
+    keys.push_back(&value);
+  }
+  return keys;
+}
+
+// Resolves the variables of `program` to their values in `action_invocation`.
+absl::StatusOr<Params> ResolveParams(
+    const Program& program, const ActionInvocation& action_invocation) {
+  Params params;
+  params.reserve(program.variables.size());
+  for (const Variable& variable : program.variables) {
+    const int slot = SlotOf(variable, action_invocation.layout.get());
+    if (slot < 0 || slot >= action_invocation.action_parameters.size() ||
+        !action_invocation.action_parameters[slot].has_value()) {
+      return gutil::InternalErrorBuilder()
+             << "unknown action parameter " << variable.name << " in action "
+             << action_invocation.action_name;
+    }
+    params.push_back(&*action_invocation.action_parameters[slot]);
+  }
+  return params;
+}
+
+// Converts `value` to the representation `Value`, returning false if it does
+// not fit.
+bool Narrow(const BigInt& value, BigInt& result) {
+  result = value;
+  return true;
+}
+bool Narrow(const BigInt& value, uint64_t& result) {
+  std::optional<uint64_t> narrow_value = BigIntToUint64(value);
+  if (!narrow_value.has_value()) return false;
+  result = *narrow_value;
+  return true;
+}
+bool Narrow(const BigInt& value, absl::uint128& result) {
+  std::optional<absl::uint128> narrow_value = BigIntToUint128(value);
+  if (!narrow_value.has_value()) return false;
+  result = *narrow_value;
+  return true;
+}
+
+template <typename Value>
+void LoadConstant(const Program& program, int index, Value& result) {
+  if constexpr (std::is_same_v<Value, BigInt>) {
+    result = program.constants[index];
+  } else {
+    result = static_cast<Value>(program.fixed_width_constants[index]);
+  }
+}
+
+// Executes `program` using `Value` to represent values. Returns nullopt if a
+// value read from the entry does not fit into `Value`; the caller should then
+// retry with a wider representation. `keys` resp. `params` must be the
+// resolved variables of the program.
+template <typename Value>
+absl::StatusOr<std::optional<bool>> Run(
+    const Program& program, const TableEntry* table_entry,
+    const Keys& keys, const Params& params) {
+  absl::InlinedVector<Value, 8> stack(program.max_stack_size);
+  int size = 0;
+  const int program_size = program.instructions.size();
+  for (int pc = 0; pc < program_size; ++pc) {
+    const Instruction& instruction = program.instructions[pc];
+    switch (instruction.opcode) {
+      case Opcode::kPushInteger:
+        stack[size++] = instruction.operand;
+        break;
+      case Opcode::kPushConstant:
+        LoadConstant(program, instruction.operand, stack[size++]);
+        break;
+      case Opcode::kLoadKey:
+        if (table_entry == nullptr) {
+          return gutil::InternalErrorBuilder()
+                 << "found a reference to a key in an action constraint";
+        }
+        if (!Narrow(KeyComponent(*keys[instruction.operand], instruction.field),
+                    stack[size++])) {
+          return std::nullopt;
+        }
+        break;
+      case Opcode::kLoadParam:
+        if (table_entry != nullptr) {
+          return gutil::InternalErrorBuilder()
+                 << "found a reference to an action parameter in a table "
+                    "constraint";
+        }
+        if (!Narrow(*params[instruction.operand], stack[size++])) {
+          return std::nullopt;
+        }
+        break;
+      case Opcode::kLoadPriority:
+        if (table_entry == nullptr) {
+          return gutil::InternalErrorBuilder()
+                 << "found a reference to the priority in an action "
+                    "constraint";
+        }
+        if (!Narrow(BigInt(table_entry->priority), stack[size++])) {
+          return std::nullopt;
+        }
+        break;
+      case Opcode::kDup:
+        stack[size] = stack[size - 1];
+        ++size;
+        break;
+      case Opcode::kNot:
+        stack[size - 1] = stack[size - 1] == 0 ? 1 : 0;
+        break;
+      case Opcode::kNegate:
+        if constexpr (std::is_same_v<Value, BigInt>) {
+          stack[size - 1] = -stack[size - 1];
+        } else {
+          // The compiler only picks fixed-width representations for programs
+          // without negation.
+          return std::nullopt;
+        }
+        break;
+      case Opcode::kMod: {
+        Value modulus;
+        LoadConstant(program, instruction.operand, modulus);
+        Value& value = stack[size - 1];
+        value %= modulus;
+        if constexpr (std::is_same_v<Value, BigInt>) {
+          // operator% may return negative values.
+          if (value < 0) value += modulus;
+        }
+        break;
+      }
+      case Opcode::kEq:
+      case Opcode::kNe: {
+        const int components = instruction.operand;
+        const Value* left = &stack[size - 2 * components];
+        const Value* right = &stack[size - components];
+        bool equal = true;
+        for (int i = 0; i < components && equal; ++i) {
+          equal = left[i] == right[i];
+        }
+        size -= 2 * components;
+        stack[size++] = (instruction.opcode == Opcode::kEq) == equal ? 1 : 0;
+        break;
+      }
+      case Opcode::kLt:
+      case Opcode::kLe:
+      case Opcode::kGt:
+      case Opcode::kGe: {
+        const Value& left = stack[size - 2];
+        const Value& right = stack[size - 1];
+        bool result;
+        switch (instruction.opcode) {
+          case Opcode::kLt:
+            result = left < right;
+            break;
+          case Opcode::kLe:
+            result = left <= right;
+            break;
+          case Opcode::kGt:
+            result = left > right;
+            break;
+          default:
+            result = left >= right;
+            break;
+        }
+        --size;
+        stack[size - 1] = result ? 1 : 0;
+        break;
+      }
+      case Opcode::kJumpIfFalseElsePop:
+        if (stack[size - 1] == 0) {
+          pc = instruction.operand - 1;
+        } else {
+          --size;
+        }
+        break;
+      case Opcode::kJumpIfTrueElsePop:
+        if (stack[size - 1] != 0) {
+          pc = instruction.operand - 1;
+        } else {
+          --size;
+        }
+        break;
+    }
+  }
+  if (size != 1) {
+    return gutil::InternalErrorBuilder()
+           << "program terminated with " << size
+           << " values on the stack; expected exactly 1";
+  }
+  return stack[0] != 0;
+}
+
+// Executes `program` in its representation, falling back to `BigInt` if a
+// value does not fit.
+absl::StatusOr<bool> RunWithFallback(const Program& program,
+                                     const TableEntry* table_entry,
+                                     const Keys& keys, const Params& params) {
+  std::optional<bool> result;
+  switch (program.representation) {
+    case ValueRepresentation::kUint64: {
+      ASSIGN_OR_RETURN(result,
+                       Run<uint64_t>(program, table_entry, keys, params));
+      break;
+    }
+    case ValueRepresentation::kUint128: {
+      ASSIGN_OR_RETURN(result,
+                       Run<absl::uint128>(program, table_entry, keys, params));
+      break;
+    }
+    case ValueRepresentation::kBigInt:
+      break;
+  }
+  // Entries with values that exceed their static types (or negative
+  // priorities) fall back to arbitrary precision.
+  if (!result.has_value()) {
+    ASSIGN_OR_RETURN(result, Run<BigInt>(program, table_entry, keys, params));
+  }
+  // Every value fits into a BigInt, so `result` is set at this point.
+  return *result;
+}
+
+// -- Batch execution ----------------------------------------------------------
+
+// Values of one stack slot (or one key component), one per entry of a batch.
+template <typename Value>
+using Column = std::vector<Value>;
+
+// Values of the variables of a program for each entry of a batch.
+class BatchKeys {
+ public:
+  BatchKeys(const Program& program, int num_entries)
+      : num_variables_(program.variables.size()) {
+    values_.reserve(num_entries * num_variables_);
+  }
+
+  // Resolves the variables of `program` in `table_entry`, appending the
+  // results as the values of the next entry. Like `ResolveKeys`, but looks up
+  // the slots of the variables only once per layout.
+  absl::Status Add(const Program& program, const TableEntry& table_entry) {
+    if (table_entry.layout.get() != layout_ || layout_ == nullptr) {
+      layout_ = table_entry.layout.get();
+      slots_.clear();
+      for (const Variable& variable : program.variables) {
+        slots_.push_back(SlotOf(variable, layout_));
+      }
+    }
+    for (int variable = 0; variable < num_variables_; ++variable) {
+      const int slot = slots_[variable];
+      if (slot < 0 || slot >= table_entry.keys.size() ||
+          !IsRepresentationOf(table_entry.keys[slot],
+                              program.variables[variable].type)) {
+        // Yields a descriptive error.
+        return ResolveKeys(program, table_entry).status();
+      }
+      values_.push_back(&table_entry.keys[slot]);
+    }
+    return absl::OkStatus();
+  }
+
+  // Returns the value of `variable` in entry `entry`.
+  const EvalResult* Get(int entry, int variable) const {
+    return values_[entry * num_variables_ + variable];
+  }
+
+  // Returns the values of all variables in entry `entry`.
+  Keys GetAll(int entry) const {
+    auto begin = values_.begin() + entry * num_variables_;
+    return Keys(begin, begin + num_variables_);
+  }
+
+ private:
+  const int num_variables_;
+  // The last layout seen, and the slots of the variables in it.
+  const EntryLayout* layout_ = nullptr;
+  std::vector<int> slots_;
+  // Indexed by entry, then variable.
+  std::vector<const EvalResult*> values_;
+};
+
+// A component of a key read by a program, see `Opcode::kLoadKey`.
+struct KeyLoad {
+  int variable;
+  KeyField field;
+};
+
+// Executes `program`, which must be a table constraint, over all `entries` at
+// once, column by column: each key component read by the program is gathered
+// into a column holding its values across entries, and each instruction is
+// applied to whole columns in straight-line loops, which compilers vectorize
+// for `uint64_t`.
+//
+// Short-circuiting is replaced by eager evaluation, which is equivalent since
+// fixed-width execution cannot fail once the columns are gathered:
+//   l; jump_if_false_else_pop end; r; end:  ~~>  l; r; end: and
+//   l; jump_if_true_else_pop end; r; end:   ~~>  l; r; end: or
+//
+// `Value` must be a fixed-width representation. Returns nullopt if the program
+// cannot be executed with `Value` at all.
+// Otherwise, returns the verdict of each entry, and sets `overflowed[i]` for
+// entries with values that do not fit into `Value`; their verdicts must be
+// recomputed with a wider representation.
+template <typename Value>
+absl::StatusOr<std::optional<std::vector<bool>>> RunBatch(
+    const Program& program, absl::Span<const TableEntry> entries,
+    const BatchKeys& keys, std::vector<bool>& overflowed) {
+  const int num_entries = entries.size();
+
+  // Gathers the key components (and priorities) read by the program.
+  std::vector<KeyLoad> loads;
+  std::vector<Column<Value>> inputs;
+  std::optional<Column<Value>> priorities;
+  for (const Instruction& instruction : program.instructions) {
+    switch (instruction.opcode) {
+      case Opcode::kLoadKey: {
+        const KeyLoad load{.variable = instruction.operand,
+                           .field = instruction.field};
+        bool gathered = false;
+        for (const KeyLoad& other : loads) {
+          gathered |= other.variable == load.variable &&
+                      other.field == load.field;
+        }
+        if (gathered) break;
+        loads.push_back(load);
+        Column<Value>& column = inputs.emplace_back(num_entries);
+        for (int i = 0; i < num_entries; ++i) {
+          if (!Narrow(KeyComponent(*keys.Get(i, load.variable), load.field),
+                      column[i])) {
+            overflowed[i] = true;
+          }
+        }
+        break;
+      }
+      case Opcode::kLoadPriority:
+        if (priorities.has_value()) break;
+        priorities.emplace(num_entries);
+        for (int i = 0; i < num_entries; ++i) {
+          if (!Narrow(BigInt(entries[i].priority), (*priorities)[i])) {
+            overflowed[i] = true;
+          }
+        }
+        break;
+      case Opcode::kLoadParam:
+        return gutil::InternalErrorBuilder()
+               << "found a reference to an action parameter in a table "
+                  "constraint";
+      case Opcode::kNegate:
+        // The compiler only picks fixed-width representations for programs
+        // without negation.
+        return std::nullopt;
+      default:
+        break;
+    }
+  }
+
+  // The operand stack, one column per slot. Slots are allocated on first use
+  // and reused afterwards.
+  std::vector<Column<Value>> stack;
+  int size = 0;
+  auto push = [&]() -> Value* {
+    if (size == stack.size()) stack.emplace_back(num_entries);
+    return stack[size++].data();
+  };
+  // Pending short circuits, innermost last: the index of the instruction
+  // after the right operand, and whether the operator is a conjunction.
+  std::vector<std::pair<int, bool>> pending;
+  auto combine_pending = [&](int pc) {
+    while (!pending.empty() && pending.back().first == pc) {
+      Value* left = stack[size - 2].data();
+      const Value* right = stack[size - 1].data();
+      if (pending.back().second) {
+        for (int i = 0; i < num_entries; ++i) left[i] &= right[i];
+      } else {
+        for (int i = 0; i < num_entries; ++i) left[i] |= right[i];
+      }
+      --size;
+      pending.pop_back();
+    }
+  };
+
+  const int program_size = program.instructions.size();
+  for (int pc = 0; pc < program_size; ++pc) {
+    combine_pending(pc);
+    const Instruction& instruction = program.instructions[pc];
+    switch (instruction.opcode) {
+      case Opcode::kPushInteger: {
+        Value* top = push();
+        std::fill(top, top + num_entries, Value(instruction.operand));
+        break;
+      }
+      case Opcode::kPushConstant: {
+        Value constant;
+        LoadConstant(program, instruction.operand, constant);
+        Value* top = push();
+        std::fill(top, top + num_entries, constant);
+        break;
+      }
+      case Opcode::kLoadKey: {
+        int input = 0;
+        while (loads[input].variable != instruction.operand ||
+               loads[input].field != instruction.field) {
+          ++input;
+        }
+        Value* top = push();
+        std::copy(inputs[input].begin(), inputs[input].end(), top);
+        break;
+      }
+      case Opcode::kLoadPriority: {
+        Value* top = push();
+        std::copy(priorities->begin(), priorities->end(), top);
+        break;
+      }
+      case Opcode::kLoadParam:
+      case Opcode::kNegate:
+        break;  // Rejected above.
+      case Opcode::kDup: {
+        const Value* source = stack[size - 1].data();
+        Value* top = push();
+        std::copy(source, source + num_entries, top);
+        break;
+      }
+      case Opcode::kNot: {
+        Value* top = stack[size - 1].data();
+        for (int i = 0; i < num_entries; ++i) top[i] = top[i] == 0 ? 1 : 0;
+        break;
+      }
+      case Opcode::kMod: {
+        Value modulus;
+        LoadConstant(program, instruction.operand, modulus);
+        Value* top = stack[size - 1].data();
+        for (int i = 0; i < num_entries; ++i) top[i] %= modulus;
+        break;
+      }
+      case Opcode::kEq:
+      case Opcode::kNe: {
+        // Accumulates the result in the first component of the left operand.
+        const int components = instruction.operand;
+        const int left = size - 2 * components;
+        const int right = size - components;
+        Value* result = stack[left].data();
+        for (int c = 0; c < components; ++c) {
+          const Value* l = stack[left + c].data();
+          const Value* r = stack[right + c].data();
+          if (c == 0) {
+            for (int i = 0; i < num_entries; ++i) {
+              result[i] = l[i] == r[i] ? 1 : 0;
+            }
+          } else {
+            for (int i = 0; i < num_entries; ++i) {
+              result[i] &= l[i] == r[i] ? 1 : 0;
+            }
+          }
+        }
+        if (instruction.opcode == Opcode::kNe) {
+          for (int i = 0; i < num_entries; ++i) result[i] ^= 1;
+        }
+        size -= 2 * components - 1;
+        break;
+      }
+      case Opcode::kLt:
+      case Opcode::kLe:
+      case Opcode::kGt:
+      case Opcode::kGe: {
+        Value* left = stack[size - 2].data();
+        const Value* right = stack[size - 1].data();
+        switch (instruction.opcode) {
+          case Opcode::kLt:
+            for (int i = 0; i < num_entries; ++i) {
+              left[i] = left[i] < right[i] ? 1 : 0;
+            }
+            break;
+          case Opcode::kLe:
+            for (int i = 0; i < num_entries; ++i) {
+              left[i] = left[i] <= right[i] ? 1 : 0;
+            }
+            break;
+          case Opcode::kGt:
+            for (int i = 0; i < num_entries; ++i) {
+              left[i] = left[i] > right[i] ? 1 : 0;
+            }
+            break;
+          default:
+            for (int i = 0; i < num_entries; ++i) {
+              left[i] = left[i] >= right[i] ? 1 : 0;
+            }
+            break;
+        }
+        --size;
+        break;
+      }
+      case Opcode::kJumpIfFalseElsePop:
+      case Opcode::kJumpIfTrueElsePop:
+        // Keeps the left operand on the stack until the right one is known.
+        pending.push_back(
+            {instruction.operand,
+             instruction.opcode == Opcode::kJumpIfFalseElsePop});
+        break;
+    }
+  }
+  combine_pending(program_size);
+  if (size != 1 || !pending.empty()) {
+    return gutil::InternalErrorBuilder()
+           << "program terminated with " << size
+           << " values on the stack; expected exactly 1";
+  }
+  std::vector<bool> verdicts(num_entries);
+  const Value* result = stack[0].data();
+  for (int i = 0; i < num_entries; ++i) verdicts[i] = result[i] != 0;
+  return verdicts;
+}
+
+}  // namespace
+
+absl::StatusOr<bool> ExecuteProgram(const Program& program,
+                                    const EvaluationContext& context) {
+  const TableEntry* table_entry =
+      std::get_if<TableEntry>(&context.constraint_context);
+  const ActionInvocation* action_invocation =
+      std::get_if<ActionInvocation>(&context.constraint_context);
+
+  Keys keys;
+  Params params;
+  if (table_entry != nullptr) {
+    ASSIGN_OR_RETURN(keys, ResolveKeys(program, *table_entry));
+  } else {
+    ASSIGN_OR_RETURN(params, ResolveParams(program, *action_invocation));
+  }
+
+  return RunWithFallback(program, table_entry, keys, params);
+}
+
+absl::StatusOr<std::vector<bool>> ExecuteProgramOnBatch(
+    const Program& program, absl::Span<const TableEntry> entries) {
+  BatchKeys keys(program, entries.size());
+  for (const TableEntry& entry : entries) {
+    RETURN_IF_ERROR(keys.Add(program, entry));
+  }
+
+  std::vector<bool> overflowed(entries.size());
+  std::optional<std::vector<bool>> verdicts;
+  // Columns of wider integers are not vectorized, and turned out to be slower
+  // than short-circuiting execution one entry at a time.
+  if (program.representation == ValueRepresentation::kUint64) {
+    ASSIGN_OR_RETURN(verdicts,
+                     RunBatch<uint64_t>(program, entries, keys, overflowed));
+  }
+  if (!verdicts.has_value()) {
+    verdicts.emplace(entries.size());
+    overflowed.assign(entries.size(), true);
+  }
+  for (int i = 0; i < entries.size(); ++i) {
+    if (!overflowed[i]) continue;
+    ASSIGN_OR_RETURN((*verdicts)[i], RunWithFallback(program, &entries[i],
+                                                     keys.GetAll(i), Params()));
+  }
+  return *std::move(verdicts);
+}
+
+}  // namespace p4_constraints
@@ -0,0 +1,58 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+// The VM executes compiled constraints (see program.h) over parsed entries.
+//
+// The VM is a faster alternative to the reference interpreter (see
+// interpreter.h) for deciding whether an entry satisfies a constraint. It does
+// not produce explanations; these are left to the interpreter.
+//
+// Values are represented as `uint64_t`, `absl::uint128`, or `BigInt`, as
+// chosen by the compiler (see `Program::representation`). If an entry holds a
+// value that does not fit the chosen fixed-width representation, the VM
+// re-executes the program with `BigInt`s, so results never depend on the
+// representation.
+
+#ifndef P4_CONSTRAINTS_BACKEND_VM_H_
+#define P4_CONSTRAINTS_BACKEND_VM_H_
+
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "p4_constraints/backend/interpreter.h"
+#include "p4_constraints/backend/program.h"
+
+namespace p4_constraints {
+
+// Executes `program` over the entry in `context`, returning true iff the entry
+// satisfies the constraint that `program` was compiled from.
+//
+// Returns an error if `context` is inconsistent with `program`, e.g. if a key
+// read by the program is missing or has an unexpected runtime representation.
+// In that case, the reference interpreter should be consulted for a
+// descriptive error (or result, in case the inconsistency is irrelevant due to
+// short-circuiting).
+absl::StatusOr<bool> ExecuteProgram(
+    const Program& program,
+    const internal_interpreter::EvaluationContext& context);
+
+// Executes `program`, a table constraint, over each of `entries`, returning a
+// bitmap whose i-th bit is set iff `entries[i]` satisfies the constraint.
+//
+// Meant for checking many entries of the same table. Programs represented
+// with `uint64_t`s are executed column by column rather than entry by entry:
+// the values of each key component read by the program are gathered into an
+// array, and each instruction is applied to whole arrays in loops that
+// compilers vectorize. Entries holding values that do not fit, and entries
+// checked by programs with wider representations, are executed one at a time.
+//
+// Returns an error if `ExecuteProgram` would return one for any of the
+// entries.
+absl::StatusOr<std::vector<bool>> ExecuteProgramOnBatch(
+    const Program& program,
+    absl::Span<const internal_interpreter::TableEntry> entries);
+
+}  // namespace p4_constraints
+
+#endif  // P4_CONSTRAINTS_BACKEND_VM_H_
@@ -0,0 +1,226 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+// Compares the reference interpreter against the VM, with and without
+// fixed-width value representations, and entry by entry against batch
+// execution, on SAI-style ACL table constraints.
+
+#include <benchmark/benchmark.h>
+#include <stdint.h>
+
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/strings/str_cat.h"
+#include "gutil/testing.h"
+#include "p4_constraints/ast.h"
+#include "p4_constraints/ast.pb.h"
+#include "p4_constraints/backend/compiler.h"
+#include "p4_constraints/backend/constant_pool.h"
+#include "p4_constraints/backend/constraint_info.h"
+#include "p4_constraints/backend/flat_constraint.h"
+#include "p4_constraints/backend/interpreter.h"
+#include "p4_constraints/backend/program.h"
+#include "p4_constraints/backend/type_checker.h"
+#include "p4_constraints/backend/vm.h"
+#include "p4_constraints/big_int.h"
+#include "p4_constraints/constraint_source.h"
+#include "p4_constraints/frontend/constraint_kind.h"
+#include "p4_constraints/frontend/parser.h"
+
+namespace p4_constraints {
+namespace {
+
+using ::gutil::ParseProtoOrDie;
+using ::p4_constraints::ast::Expression;
+using ::p4_constraints::ast::Type;
+using ::p4_constraints::internal_interpreter::EvalToBool;
+using ::p4_constraints::internal_interpreter::EvaluationContext;
+using ::p4_constraints::internal_interpreter::TableEntry;
+using ::p4_constraints::internal_interpreter::Ternary;
+
+// Modeled after the ACL tables of SAI P4.
+constexpr char kIpv4AclConstraint[] = R"(
+  // Only allow IP field matches for IP packets.
+  dst_ip::mask != 0 -> is_ipv4 == 1;
+  ttl::mask != 0 -> (is_ip == 1 || is_ipv4 == 1 || is_ipv6 == 1);
+  dscp::mask != 0 -> (is_ip == 1 || is_ipv4 == 1 || is_ipv6 == 1);
+  ip_protocol::mask != 0 -> (is_ip == 1 || is_ipv4 == 1 || is_ipv6 == 1);
+  // Only allow l4_dst_port matches for TCP/UDP packets.
+  l4_dst_port::mask != 0 -> (ip_protocol::mask == 0xff &&
+                             (ip_protocol::value == 6 ||
+                              ip_protocol::value == 17));
+  // Forbid illegal combinations of IP type requirements.
+  is_ip::mask != 0 -> (is_ipv4::mask == 0 && is_ipv6::mask == 0);
+  is_ipv4::mask != 0 -> (is_ip::mask == 0 && is_ipv6::mask == 0);
+  is_ipv6::mask != 0 -> (is_ip::mask == 0 && is_ipv4::mask == 0);
+  // Forbid unsupported combinations of IP type and ether type.
+  ether_type::mask != 0 -> is_ip::mask == 0;
+  ::priority > 0;
+)";
+
+constexpr char kIpv6AclConstraint[] = R"(
+  dst_ipv6::mask != 0 -> is_ipv6 == 1;
+  src_ipv6::mask != 0 -> is_ipv6 == 1;
+  dst_ipv6::value != 0 -> dst_ipv6::mask != 0;
+  l4_dst_port::mask != 0 -> (ip_protocol::mask == 0xff &&
+                             (ip_protocol::value == 6 ||
+                              ip_protocol::value == 17));
+  ::priority > 0;
+)";
+
+TableInfo MakeAclTableInfo(const std::string& constraint) {
+  TableInfo table_info{
+      .id = 1,
+      .name = "acl_ingress_table",
+      .constraint_source =
+          ConstraintSource{
+              .constraint_string = constraint,
+              .constraint_location = ast::SourceLocation(),
+          },
+  };
+  uint32_t id = 1;
+  for (const auto& [name, bitwidth] : std::vector<std::pair<std::string, int>>{
+           {"is_ip", 1},
+           {"is_ipv4", 1},
+           {"is_ipv6", 1},
+           {"ether_type", 16},
+           {"dst_ip", 32},
+           {"dst_ipv6", 128},
+           {"src_ipv6", 128},
+           {"ttl", 8},
+           {"dscp", 6},
+           {"ip_protocol", 8},
+           {"l4_dst_port", 16},
+       }) {
+    const std::string type =
+        bitwidth == 1
+            ? absl::StrCat("optional_match { bitwidth: ", bitwidth, " }")
+            : absl::StrCat("ternary { bitwidth: ", bitwidth, " }");
+    KeyInfo key{.id = id++, .name = name, .type = ParseProtoOrDie<Type>(type)};
+    table_info.keys_by_id[key.id] = key;
+    table_info.keys_by_name[key.name] = key;
+  }
+  table_info.key_layout =
+      std::make_shared<const EntryLayout>(MakeKeyLayout(table_info));
+  return table_info;
+}
+
+// Returns entries that wildcard most keys, as is typical for ACL entries.
+std::vector<TableEntry> MakeAclEntries(const TableInfo& table_info) {
+  std::mt19937 rng(/*seed=*/0);
+  std::vector<TableEntry> entries;
+  for (int i = 0; i < 1000; ++i) {
+    TableEntry entry{
+        .table_name = table_info.name,
+        .priority = std::uniform_int_distribution<int32_t>(0, 100)(rng),
+        .layout = table_info.key_layout,
+    };
+    for (const std::string& name : entry.layout->names) {
+      const int bitwidth =
+          *ast::TypeBitwidth(table_info.keys_by_name.at(name).type);
+      const BigInt max = (BigInt(1) << bitwidth) - 1;
+      if (std::bernoulli_distribution(0.7)(rng)) {
+        entry.keys.push_back(Ternary{.value = 0, .mask = 0});
+      } else {
+        const BigInt value = std::uniform_int_distribution<uint32_t>()(rng);
+        entry.keys.push_back(Ternary{.value = value & max, .mask = max});
+      }
+    }
+    entries.push_back(std::move(entry));
+  }
+  return entries;
+}
+
+struct Fixture {
+  TableInfo table_info;
+  Expression constraint;
+  ConstantPool constant_pool;
+  Program program;
+  std::vector<TableEntry> entries;
+};
+
+Fixture MakeFixture(const std::string& constraint_string) {
+  Fixture fixture{.table_info = MakeAclTableInfo(constraint_string)};
+  auto constraint = ParseConstraint(ConstraintKind::kTableConstraint,
+                                    fixture.table_info.constraint_source);
+  CHECK_OK(constraint.status());
+  fixture.constraint = *std::move(constraint);
+  CHECK_OK(InferAndCheckTypes(&fixture.constraint, fixture.table_info));
+  auto constant_pool = BuildConstantPool(fixture.constraint);
+  CHECK_OK(constant_pool.status());
+  fixture.constant_pool = *std::move(constant_pool);
+  auto program = CompileConstraint(fixture.constraint);
+  CHECK_OK(program.status());
+  fixture.program = *std::move(program);
+  for (Variable& variable : fixture.program.variables) {
+    variable.slot =
+        fixture.table_info.key_layout->slot_by_name.at(variable.name);
+  }
+  fixture.entries = MakeAclEntries(fixture.table_info);
+  return fixture;
+}
+
+enum class Engine { kInterpreter, kVmBigInt, kVm, kVmBatch };
+
+void BM_AclConstraint(benchmark::State& state, const char* constraint,
+                      Engine engine) {
+  Fixture fixture = MakeFixture(constraint);
+  if (engine == Engine::kVmBigInt) {
+    fixture.program.representation = ValueRepresentation::kBigInt;
+    fixture.program.fixed_width_constants.clear();
+  }
+  // Flattened once, like the constraints of a `ConstraintInfo`.
+  const FlatConstraint flat_constraint = FlattenConstraint(
+      fixture.constraint, &fixture.table_info.key_layout->slot_by_name,
+      &fixture.constant_pool);
+  std::vector<EvaluationContext> contexts;
+  for (const TableEntry& entry : fixture.entries) {
+    contexts.push_back(EvaluationContext{
+        .constraint_context = entry,
+        .constraint_source = fixture.table_info.constraint_source,
+        .constant_pool = &fixture.constant_pool,
+    });
+  }
+
+  for (auto _ : state) {
+    if (engine == Engine::kVmBatch) {
+      benchmark::DoNotOptimize(
+          ExecuteProgramOnBatch(fixture.program, fixture.entries));
+      continue;
+    }
+    for (const EvaluationContext& context : contexts) {
+      if (engine == Engine::kInterpreter) {
+        benchmark::DoNotOptimize(EvalToBool(flat_constraint,
+                                            RootNode(flat_constraint), context,
+                                            /*eval_cache=*/nullptr));
+      } else {
+        benchmark::DoNotOptimize(ExecuteProgram(fixture.program, context));
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * contexts.size());
+  state.SetLabel(ValueRepresentationName(fixture.program.representation));
+}
+
+BENCHMARK_CAPTURE(BM_AclConstraint, ipv4_interpreter, kIpv4AclConstraint,
+                  Engine::kInterpreter);
+BENCHMARK_CAPTURE(BM_AclConstraint, ipv4_vm_big_int, kIpv4AclConstraint,
+                  Engine::kVmBigInt);
+BENCHMARK_CAPTURE(BM_AclConstraint, ipv4_vm, kIpv4AclConstraint, Engine::kVm);
+BENCHMARK_CAPTURE(BM_AclConstraint, ipv4_vm_batch, kIpv4AclConstraint,
+                  Engine::kVmBatch);
+BENCHMARK_CAPTURE(BM_AclConstraint, ipv6_interpreter, kIpv6AclConstraint,
+                  Engine::kInterpreter);
+BENCHMARK_CAPTURE(BM_AclConstraint, ipv6_vm_big_int, kIpv6AclConstraint,
+                  Engine::kVmBigInt);
+BENCHMARK_CAPTURE(BM_AclConstraint, ipv6_vm, kIpv6AclConstraint, Engine::kVm);
+BENCHMARK_CAPTURE(BM_AclConstraint, ipv6_vm_batch, kIpv6AclConstraint,
+                  Engine::kVmBatch);
+
+}  // namespace
+}  // namespace p4_constraints
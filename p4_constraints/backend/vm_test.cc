@@ -0,0 +1,403 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "p4_constraints/backend/vm.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "gutil/status_matchers.h"
+#include "gutil/testing.h"
+#include "p4_constraints/ast.h"
+#include "p4_constraints/ast.pb.h"
+#include "p4_constraints/backend/compiler.h"
+#include "p4_constraints/backend/constraint_info.h"
+#include "p4_constraints/backend/interpreter.h"
+#include "p4_constraints/backend/program.h"
+#include "p4_constraints/backend/type_checker.h"
+#include "p4_constraints/big_int.h"
+#include "p4_constraints/constraint_source.h"
+#include "p4_constraints/frontend/constraint_kind.h"
+#include "p4_constraints/frontend/parser.h"
+
+namespace p4_constraints {
+namespace {
+
+using ::gutil::IsOkAndHolds;
+using ::gutil::ParseProtoOrDie;
+using ::gutil::StatusIs;
+using ::testing::IsEmpty;
+using ::p4_constraints::ast::Expression;
+using ::p4_constraints::ast::Type;
+using ::p4_constraints::internal_interpreter::ActionInvocation;
+using ::p4_constraints::internal_interpreter::EvalResult;
+using ::p4_constraints::internal_interpreter::EvalToBool;
+using ::p4_constraints::internal_interpreter::EvaluationContext;
+using ::p4_constraints::internal_interpreter::Exact;
+using ::p4_constraints::internal_interpreter::Lpm;
+using ::p4_constraints::internal_interpreter::MakeTableEntry;
+using ::p4_constraints::internal_interpreter::Range;
+using ::p4_constraints::internal_interpreter::TableEntry;
+using ::p4_constraints::internal_interpreter::Ternary;
+
+KeyInfo MakeKeyInfo(uint32_t id, const std::string& name,
+                    const std::string& type) {
+  return KeyInfo{
+      .id = id, .name = name, .type = ParseProtoOrDie<Type>(type)};
+}
+
+TableInfo MakeTableInfo() {
+  TableInfo table_info{.id = 1, .name = "table"};
+  for (const KeyInfo& key : {
+           MakeKeyInfo(1, "exact16", "exact { bitwidth: 16 }"),
+           MakeKeyInfo(2, "exact48", "exact { bitwidth: 48 }"),
+           MakeKeyInfo(3, "ternary32", "ternary { bitwidth: 32 }"),
+           MakeKeyInfo(4, "lpm32", "lpm { bitwidth: 32 }"),
+           MakeKeyInfo(5, "lpm128", "lpm { bitwidth: 128 }"),
+           MakeKeyInfo(6, "range16", "range { bitwidth: 16 }"),
+           MakeKeyInfo(7, "optional8", "optional_match { bitwidth: 8 }"),
+           MakeKeyInfo(8, "ternary144", "ternary { bitwidth: 144 }"),
+       }) {
+    table_info.keys_by_id[key.id] = key;
+    table_info.keys_by_name[key.name] = key;
+  }
+  table_info.key_layout =
+      std::make_shared<const EntryLayout>(MakeKeyLayout(table_info));
+  return table_info;
+}
+
+ActionInfo MakeActionInfo() {
+  ActionInfo action_info{.id = 1, .name = "action"};
+  for (const ParamInfo& param : {
+           ParamInfo{.id = 1,
+                     .name = "port",
+                     .type = ParseProtoOrDie<Type>(
+                         "fixed_unsigned { bitwidth: 9 }")},
+           ParamInfo{.id = 2,
+                     .name = "vlan_id",
+                     .type = ParseProtoOrDie<Type>(
+                         "fixed_unsigned { bitwidth: 12 }")},
+       }) {
+    action_info.params_by_id[param.id] = param;
+    action_info.params_by_name[param.name] = param;
+  }
+  action_info.param_layout =
+      std::make_shared<const EntryLayout>(MakeParamLayout(action_info));
+  return action_info;
+}
+
+// Assigns the slots of `layout` to the variables of `program`, as done when
+// loading constraints from a P4Info.
+void AssignSlots(const EntryLayout& layout, Program& program) {
+  for (Variable& variable : program.variables) {
+    variable.slot = layout.slot_by_name.at(variable.name);
+  }
+}
+
+// Returns a random value that fits into `bitwidth` bits most of the time, and
+// is biased towards small values and boundaries to make comparisons against
+// literals interesting.
+BigInt RandomValue(std::mt19937& rng, int bitwidth) {
+  const BigInt max = (BigInt(1) << bitwidth) - 1;
+  switch (std::uniform_int_distribution<int>(0, 5)(rng)) {
+    case 0:
+      return BigInt(std::uniform_int_distribution<int>(0, 12)(rng));
+    case 1:
+      return max;
+    case 2:
+      return max - std::uniform_int_distribution<int>(0, 3)(rng);
+    case 3:
+      // P4Runtime values are not checked against the key's bitwidth.
+      return max + 1 + std::uniform_int_distribution<int>(0, 3)(rng);
+    default: {
+      BigInt value = 0;
+      for (int i = 0; i < bitwidth; i += 32) {
+        value = (value << 32) | BigInt(std::uniform_int_distribution<uint32_t>(
+                                    0, 0xffffffff)(rng));
+      }
+      return value & max;
+    }
+  }
+}
+
+EvalResult RandomKeyValue(std::mt19937& rng, const Type& type) {
+  const int bitwidth = *ast::TypeBitwidth(type);
+  switch (type.type_case()) {
+    case Type::kExact:
+      return Exact{.value = RandomValue(rng, bitwidth)};
+    case Type::kTernary:
+    case Type::kOptionalMatch:
+      return Ternary{.value = RandomValue(rng, bitwidth),
+                     .mask = RandomValue(rng, bitwidth)};
+    case Type::kLpm:
+      return Lpm{.value = RandomValue(rng, bitwidth),
+                 .prefix_length = BigInt(std::uniform_int_distribution<int>(
+                     0, bitwidth)(rng))};
+    case Type::kRange:
+      return Range{.low = RandomValue(rng, bitwidth),
+                   .high = RandomValue(rng, bitwidth)};
+    default:
+      LOG(FATAL) << "unexpected key type " << type;
+  }
+}
+
+TableEntry RandomTableEntry(std::mt19937& rng, const TableInfo& table_info) {
+  TableEntry entry{
+      .table_name = table_info.name,
+      .priority = std::uniform_int_distribution<int32_t>(-3, 20)(rng),
+      .layout = table_info.key_layout,
+  };
+  for (const std::string& name : entry.layout->names) {
+    entry.keys.push_back(
+        RandomKeyValue(rng, table_info.keys_by_name.at(name).type));
+  }
+  return entry;
+}
+
+ActionInvocation RandomActionInvocation(std::mt19937& rng,
+                                        const ActionInfo& action_info) {
+  ActionInvocation invocation{.action_id = action_info.id,
+                              .action_name = action_info.name,
+                              .layout = action_info.param_layout};
+  for (const std::string& name : invocation.layout->names) {
+    invocation.action_parameters.push_back(RandomValue(
+        rng, *ast::TypeBitwidth(action_info.params_by_name.at(name).type)));
+  }
+  return invocation;
+}
+
+constexpr int kNumberOfRandomEntries = 300;
+
+class VmDifferentialTest : public ::testing::TestWithParam<std::string> {};
+
+TEST_P(VmDifferentialTest, AgreesWithInterpreterOnTableConstraint) {
+  TableInfo table_info = MakeTableInfo();
+  table_info.constraint_source = ConstraintSource{
+      .constraint_string = GetParam(),
+      .constraint_location = ast::SourceLocation(),
+  };
+  ASSERT_OK_AND_ASSIGN(Expression constraint,
+                       ParseConstraint(ConstraintKind::kTableConstraint,
+                                       table_info.constraint_source));
+  ASSERT_OK(InferAndCheckTypes(&constraint, table_info));
+  ASSERT_OK_AND_ASSIGN(Program program, CompileConstraint(constraint));
+  AssignSlots(*table_info.key_layout, program);
+
+  std::mt19937 rng(/*seed=*/42);
+  for (int i = 0; i < kNumberOfRandomEntries; ++i) {
+    const EvaluationContext context{
+        .constraint_context = RandomTableEntry(rng, table_info),
+        .constraint_source = table_info.constraint_source,
+    };
+    ASSERT_OK_AND_ASSIGN(bool expected,
+                         EvalToBool(constraint, context, nullptr));
+    ASSERT_THAT(ExecuteProgram(program, context), IsOkAndHolds(expected))
+        << "Entry #" << i << "; Program:\n"
+        << program;
+  }
+}
+
+TEST_P(VmDifferentialTest, BatchAgreesWithInterpreterOnTableConstraint) {
+  TableInfo table_info = MakeTableInfo();
+  table_info.constraint_source = ConstraintSource{
+      .constraint_string = GetParam(),
+      .constraint_location = ast::SourceLocation(),
+  };
+  ASSERT_OK_AND_ASSIGN(Expression constraint,
+                       ParseConstraint(ConstraintKind::kTableConstraint,
+                                       table_info.constraint_source));
+  ASSERT_OK(InferAndCheckTypes(&constraint, table_info));
+  ASSERT_OK_AND_ASSIGN(Program program, CompileConstraint(constraint));
+  AssignSlots(*table_info.key_layout, program);
+
+  std::mt19937 rng(/*seed=*/42);
+  std::vector<TableEntry> entries;
+  for (int i = 0; i < kNumberOfRandomEntries; ++i) {
+    entries.push_back(RandomTableEntry(rng, table_info));
+  }
+  ASSERT_OK_AND_ASSIGN(std::vector<bool> verdicts,
+                       ExecuteProgramOnBatch(program, entries));
+  ASSERT_EQ(verdicts.size(), entries.size());
+  for (int i = 0; i < entries.size(); ++i) {
+    const EvaluationContext context{
+        .constraint_context = entries[i],
+        .constraint_source = table_info.constraint_source,
+    };
+    ASSERT_OK_AND_ASSIGN(bool expected,
+                         EvalToBool(constraint, context, nullptr));
+    ASSERT_EQ(verdicts[i], expected) << "Entry #" << i << "; Program:\n"
+                                     << program;
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    TableConstraints, VmDifferentialTest,
+    ::testing::Values(
+        "true", "false", "!true", "exact16 == 5", "exact16 != 5",
+        "exact16::value > 3", "exact16::value <= 65535",
+        "exact48::value >= 0xfffffffffffe", "ternary32 == 7",
+        "ternary32::mask == 0 || ternary32::mask == -1",
+        "ternary32::mask != 0 -> exact16 == 0x0800",
+        "ternary32::value == ternary32::mask", "lpm32 == 3",
+        "lpm32::prefix_length > 24 && lpm32::value != 0",
+        "lpm128::prefix_length <= 64", "lpm128::value == -1",
+        "lpm128::value > 0xffffffffffffffff && exact48 != 0",
+        "range16 == 10", "range16::low <= range16::high",
+        "range16::low == 0 && range16::high == 65535", "optional8 == 9",
+        "optional8::mask == 0", "ternary144::mask == 0 || ternary144 == 1",
+        "ternary144::value > 0xffffffffffffffffffffffffffffffff",
+        "::priority > 10", "::priority < 0x7fffffff && ::priority >= -2",
+        "-lpm32::prefix_length < -3", "--::priority == ::priority",
+        "lpm32::prefix_length == exact16::value",
+        "exact16::value == -1 || exact16::value == 1",
+        "exact16 == 1 || exact16 == 2 || exact16 == 3 || exact16 == 4",
+        "!(exact16 == 1 && ternary32 == 2) -> (lpm32 == 3 || range16 == 4)",
+        "(true -> false) -> exact16 == 1",
+        "exact16 == 5;\n ternary32::mask == 0 || ternary32 == 7;\n "
+        "::priority > 0"));
+
+TEST(VmTest, AgreesWithInterpreterOnActionConstraint) {
+  ActionInfo action_info = MakeActionInfo();
+  action_info.constraint_source = ConstraintSource{
+      .constraint_string =
+          "port != 0 && vlan_id != 4095 -> vlan_id > 10 || port < 3",
+      .constraint_location = ast::SourceLocation(),
+  };
+  ASSERT_OK_AND_ASSIGN(Expression constraint,
+                       ParseConstraint(ConstraintKind::kActionConstraint,
+                                       action_info.constraint_source));
+  ASSERT_OK(InferAndCheckTypes(&constraint, action_info));
+  ASSERT_OK_AND_ASSIGN(Program program, CompileConstraint(constraint));
+  AssignSlots(*action_info.param_layout, program);
+
+  std::mt19937 rng(/*seed=*/42);
+  for (int i = 0; i < kNumberOfRandomEntries; ++i) {
+    const EvaluationContext context{
+        .constraint_context = RandomActionInvocation(rng, action_info),
+        .constraint_source = action_info.constraint_source,
+    };
+    ASSERT_OK_AND_ASSIGN(bool expected,
+                         EvalToBool(constraint, context, nullptr));
+    ASSERT_THAT(ExecuteProgram(program, context), IsOkAndHolds(expected));
+  }
+}
+
+TEST(VmTest, FallsBackToBigIntForValuesExceedingRepresentation) {
+  TableInfo table_info = MakeTableInfo();
+  table_info.constraint_source = ConstraintSource{
+      .constraint_string = "exact16::value != 3",
+      .constraint_location = ast::SourceLocation(),
+  };
+  ASSERT_OK_AND_ASSIGN(Expression constraint,
+                       ParseConstraint(ConstraintKind::kTableConstraint,
+                                       table_info.constraint_source));
+  ASSERT_OK(InferAndCheckTypes(&constraint, table_info));
+  ASSERT_OK_AND_ASSIGN(const Program program, CompileConstraint(constraint));
+  ASSERT_EQ(program.representation, ValueRepresentation::kUint64);
+
+  // Truncating 2^64 + 3 to 64 bits would yield 3.
+  const EvaluationContext context{
+      .constraint_context = MakeTableEntry(
+          "table", /*priority=*/0,
+          {{"exact16", Exact{.value = (BigInt(1) << 64) + 3}}}),
+      .constraint_source = table_info.constraint_source,
+  };
+  EXPECT_THAT(ExecuteProgram(program, context), IsOkAndHolds(true));
+}
+
+TEST(VmTest, ResolvesVariablesByNameIfEntryLayoutDiffers) {
+  TableInfo table_info = MakeTableInfo();
+  table_info.constraint_source = ConstraintSource{
+      .constraint_string = "ternary32 == 7",
+      .constraint_location = ast::SourceLocation(),
+  };
+  ASSERT_OK_AND_ASSIGN(Expression constraint,
+                       ParseConstraint(ConstraintKind::kTableConstraint,
+                                       table_info.constraint_source));
+  ASSERT_OK(InferAndCheckTypes(&constraint, table_info));
+  ASSERT_OK_AND_ASSIGN(Program program, CompileConstraint(constraint));
+  AssignSlots(*table_info.key_layout, program);
+  ASSERT_NE(program.variables[0].slot, 0);
+
+  const EvaluationContext context{
+      .constraint_context = MakeTableEntry(
+          "table", /*priority=*/0,
+          {{"ternary32", Ternary{.value = 7, .mask = 0xffffffff}}}),
+      .constraint_source = table_info.constraint_source,
+  };
+  EXPECT_THAT(ExecuteProgram(program, context), IsOkAndHolds(true));
+}
+
+TEST(VmTest, MissingKeyIsAnError) {
+  TableInfo table_info = MakeTableInfo();
+  table_info.constraint_source = ConstraintSource{
+      .constraint_string = "exact16 == 5",
+      .constraint_location = ast::SourceLocation(),
+  };
+  ASSERT_OK_AND_ASSIGN(Expression constraint,
+                       ParseConstraint(ConstraintKind::kTableConstraint,
+                                       table_info.constraint_source));
+  ASSERT_OK(InferAndCheckTypes(&constraint, table_info));
+  ASSERT_OK_AND_ASSIGN(const Program program, CompileConstraint(constraint));
+
+  const EvaluationContext context{
+      .constraint_context = MakeTableEntry("table", /*priority=*/0, {}),
+      .constraint_source = table_info.constraint_source,
+  };
+  EXPECT_THAT(ExecuteProgram(program, context),
+              StatusIs(absl::StatusCode::kInternal));
+}
+
+TEST(VmTest, BatchWithMissingKeyIsAnError) {
+  TableInfo table_info = MakeTableInfo();
+  table_info.constraint_source = ConstraintSource{
+      .constraint_string = "exact16 == 5",
+      .constraint_location = ast::SourceLocation(),
+  };
+  ASSERT_OK_AND_ASSIGN(Expression constraint,
+                       ParseConstraint(ConstraintKind::kTableConstraint,
+                                       table_info.constraint_source));
+  ASSERT_OK(InferAndCheckTypes(&constraint, table_info));
+  ASSERT_OK_AND_ASSIGN(const Program program, CompileConstraint(constraint));
+
+  const std::vector<TableEntry> entries = {
+      MakeTableEntry("table", /*priority=*/0, {{"exact16", Exact{.value = 5}}}),
+      MakeTableEntry("table", /*priority=*/0, {}),
+  };
+  EXPECT_THAT(ExecuteProgramOnBatch(program, entries),
+              StatusIs(absl::StatusCode::kInternal));
+  EXPECT_THAT(ExecuteProgramOnBatch(program, {}), IsOkAndHolds(IsEmpty()));
+}
+
+TEST(VmTest, KeyOfUnexpectedRepresentationIsAnError) {
+  TableInfo table_info = MakeTableInfo();
+  table_info.constraint_source = ConstraintSource{
+      .constraint_string = "exact16 == 5",
+      .constraint_location = ast::SourceLocation(),
+  };
+  ASSERT_OK_AND_ASSIGN(Expression constraint,
+                       ParseConstraint(ConstraintKind::kTableConstraint,
+                                       table_info.constraint_source));
+  ASSERT_OK(InferAndCheckTypes(&constraint, table_info));
+  ASSERT_OK_AND_ASSIGN(const Program program, CompileConstraint(constraint));
+
+  const EvaluationContext context{
+      .constraint_context = MakeTableEntry(
+          "table", /*priority=*/0,
+          {{"exact16", Ternary{.value = 5, .mask = 5}}}),
+      .constraint_source = table_info.constraint_source,
+  };
+  EXPECT_THAT(ExecuteProgram(program, context),
+              StatusIs(absl::StatusCode::kInternal));
+}
+
+}  // namespace
+}  // namespace p4_constraints
@@ -3,6 +3,12 @@
 
 #include "p4_constraints/big_int.h"
 
+#include <stdint.h>
+
+#include <limits>
+#include <optional>
+
+#include "absl/numeric/int128.h"
 #include "gutil/status.h"
 
 namespace p4_constraints {
@@ -62,4 +68,27 @@ BigInt ParseBigEndianBytes(absl::string_view bytes) {
   return result;
 }
 
+std::optional<uint64_t> BigIntToUint64(const BigInt& value) {
+  std::optional<absl::uint128> result = BigIntToUint128(value);
+  if (!result.has_value() || absl::Uint128High64(*result) != 0) {
+    return std::nullopt;
+  }
+  return absl::Uint128Low64(*result);
+}
+
+std::optional<absl::uint128> BigIntToUint128(const BigInt& value) {
+  // Reads the limbs directly; going through BigInt arithmetic would be much
+  // slower, defeating the purpose of fixed-width representations.
+  using Limb = boost::multiprecision::limb_type;
+  constexpr int kLimbBits = std::numeric_limits<Limb>::digits;
+  const auto& backend = value.backend();
+  // The limbs are normalized, i.e. there are no leading zero limbs.
+  if (backend.sign() || backend.size() * kLimbBits > 128) return std::nullopt;
+  absl::uint128 result = 0;
+  for (int i = backend.size() - 1; i >= 0; --i) {
+    result = (result << kLimbBits) | backend.limbs()[i];
+  }
+  return result;
+}
+
 }  // namespace p4_constraints
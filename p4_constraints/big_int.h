@@ -4,9 +4,13 @@
 #ifndef P4_CONSTRAINTS_BIG_INT_H_
 #define P4_CONSTRAINTS_BIG_INT_H_
 
+#include <stdint.h>
+
 #include <boost/multiprecision/cpp_int.hpp>
+#include <optional>
 #include <string>
 
+#include "absl/numeric/int128.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 
@@ -20,6 +24,11 @@ absl::StatusOr<BigInt> ParseBigInt(absl::string_view text, int base = 10);
 
 BigInt ParseBigEndianBytes(absl::string_view bytes);
 
+// Returns `value` as a fixed-width unsigned integer, or nullopt if `value` is
+// negative or does not fit.
+std::optional<uint64_t> BigIntToUint64(const BigInt& value);
+std::optional<absl::uint128> BigIntToUint128(const BigInt& value);
+
 }  // namespace p4_constraints
 
 #endif  // P4_CONSTRAINTS_BIG_INT_H_
@@ -3,8 +3,15 @@
 
 #include "p4_constraints/big_int.h"
 
+#include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <stdint.h>
 
+#include <limits>
+#include <optional>
+#include <string>
+
+#include "absl/numeric/int128.h"
 #include "gutil/status_matchers.h"
 
 namespace p4_constraints {
@@ -31,5 +38,22 @@ TEST(BigIntTest, BigIntToStringFormatsValue) {
             "12345678901234567890");
 }
 
+TEST(BigIntTest, BigIntToUint64ConvertsValuesInRange) {
+  EXPECT_EQ(BigIntToUint64(BigInt(0)), 0);
+  EXPECT_EQ(BigIntToUint64(BigInt("18446744073709551615")),
+            std::numeric_limits<uint64_t>::max());
+  EXPECT_EQ(BigIntToUint64(BigInt("18446744073709551616")), std::nullopt);
+  EXPECT_EQ(BigIntToUint64(BigInt(-1)), std::nullopt);
+}
+
+TEST(BigIntTest, BigIntToUint128ConvertsValuesInRange) {
+  EXPECT_EQ(BigIntToUint128(BigInt(42)), absl::uint128(42));
+  EXPECT_EQ(BigIntToUint128(BigInt("18446744073709551616")),
+            absl::MakeUint128(1, 0));
+  EXPECT_EQ(BigIntToUint128((BigInt(1) << 128) - 1), absl::Uint128Max());
+  EXPECT_EQ(BigIntToUint128(BigInt(1) << 128), std::nullopt);
+  EXPECT_EQ(BigIntToUint128(BigInt(-1)), std::nullopt);
+}
+
 }  // namespace
 }  // namespace p4_constraints
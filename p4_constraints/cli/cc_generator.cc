@@ -0,0 +1,92 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+// Usage: cc_generator --p4info=<file> --cc_namespace=<namespace>
+//          --header_path=<path> --out_header=<file> --out_source=<file>
+//
+// Generates a C++ library checking the constraints of the given P4 program (in
+// p4info.proto text format), see p4_constraints/codegen/cc_generator.h.
+//
+// Invoked by the `p4_constraints_cc_library` Bazel rule.
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/flags/usage.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/string_view.h"
+#include "google/protobuf/io/zero_copy_stream_impl.h"
+#include "google/protobuf/text_format.h"
+#include "p4/config/v1/p4info.pb.h"
+#include "p4_constraints/codegen/cc_generator.h"
+
+ABSL_FLAG(std::string, p4info, "", "p4info file (required)");
+ABSL_FLAG(std::string, cc_namespace, "",
+          "C++ namespace of the generated code (required)");
+ABSL_FLAG(std::string, header_path, "",
+          "path under which the generated header is included (required)");
+ABSL_FLAG(std::string, out_header, "", "output header file (required)");
+ABSL_FLAG(std::string, out_source, "", "output source file (required)");
+constexpr char kUsage[] =
+    "--p4info=<file> --cc_namespace=<namespace> --header_path=<path> "
+    "--out_header=<file> --out_source=<file>";
+
+bool WriteFile(const std::string& filename, absl::string_view contents) {
+  std::ofstream file(filename);
+  file << contents;
+  file.close();
+  if (!file) {
+    std::cerr << "Unable to write file: " << filename << "\n";
+    return false;
+  }
+  return true;
+}
+
+int main(int argc, char** argv) {
+  const absl::string_view usage[] = {"usage:", argv[0], kUsage};
+  absl::SetProgramUsageMessage(absl::StrJoin(usage, " "));
+  absl::ParseCommandLine(argc, argv);
+
+  const std::string p4info_filename = absl::GetFlag(FLAGS_p4info);
+  const std::string out_header = absl::GetFlag(FLAGS_out_header);
+  const std::string out_source = absl::GetFlag(FLAGS_out_source);
+  if (p4info_filename.empty() || out_header.empty() || out_source.empty()) {
+    std::cerr << "Missing argument: " << kUsage << "\n";
+    return 1;
+  }
+
+  // Open and parse p4info file.
+  std::ifstream p4info_file(p4info_filename);
+  if (!p4info_file.is_open()) {
+    std::cerr << "Unable to open p4info file: " << p4info_filename << "\n";
+    return 1;
+  }
+  p4::config::v1::P4Info p4info;
+  {
+    google::protobuf::io::IstreamInputStream stream(&p4info_file);
+    if (!google::protobuf::TextFormat::Parse(&stream, &p4info)) {
+      std::cerr << "Unable to parse p4info file: " << p4info_filename << "\n";
+      return 1;
+    }
+  }
+
+  absl::StatusOr<p4_constraints::GeneratedCc> generated =
+      p4_constraints::GenerateCc(
+          p4info, {
+                      .cc_namespace = absl::GetFlag(FLAGS_cc_namespace),
+                      .header_path = absl::GetFlag(FLAGS_header_path),
+                  });
+  if (!generated.ok()) {
+    std::cerr << generated.status().message() << "\n";
+    return 1;
+  }
+  if (!WriteFile(out_header, generated->header) ||
+      !WriteFile(out_source, generated->source)) {
+    return 1;
+  }
+  return 0;
+}
@@ -14,19 +14,33 @@
 // limitations under the License.
 
 // Usage: p4check --p4info=<file> [<table_entry_file> ...]
+//        p4check --constraint_info_snapshot=<file> [<table_entry_file> ...]
 //
 // Parses the table constraints in the given P4 program (in p4info.proto text
 // format) and checks if the given table entries (in p4runtime.proto text
 // format) satisfy the constraints imposed on their respective tables.
 //
+// With --write_constraint_info_snapshot=<file>, additionally writes a binary
+// snapshot of the parsed constraints (see constraint_info_snapshot.h), which
+// later runs can load with --constraint_info_snapshot=<file> instead of parsing
+// the P4 program again. If both --p4info and --constraint_info_snapshot are
+// given, the snapshot must have been taken from the given P4 program.
+//
+// With --print_constraint_stats, additionally prints how many distinct
+// subexpressions each constraint has, i.e. how much evaluating them benefits
+// from hash-consing (see flat_constraint.h).
+//
 // This CLI is not intended for use in production; it is intended for testing
 // and showcasing the p4_constraints library.
 
 #include <stdint.h>
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/flags/flag.h"
@@ -35,6 +49,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
@@ -43,15 +58,29 @@
 #include "p4/config/v1/p4info.pb.h"
 #include "p4/v1/p4runtime.pb.h"
 #include "p4_constraints/backend/constraint_info.h"
-#include "p4_constraints/backend/interpreter.h"
+#include "p4_constraints/backend/constraint_info_snapshot.h"
+#include "p4_constraints/backend/flat_constraint.h"
+#include "p4_constraints/backend/validator.h"
 
 using ::p4_constraints::ConstraintInfo;
+using ::p4_constraints::DedupRatio;
+using ::p4_constraints::FlatConstraint;
+using ::p4_constraints::P4InfoFingerprint;
 using ::p4_constraints::P4ToConstraintInfo;
-using ::p4_constraints::ReasonEntryViolatesConstraint;
-
-ABSL_FLAG(std::string, p4info, "", "p4info file (required)");
+using ::p4_constraints::ReadConstraintInfoSnapshot;
+using ::p4_constraints::Validator;
+
+ABSL_FLAG(std::string, p4info, "",
+          "p4info file (required unless --constraint_info_snapshot is given)");
+ABSL_FLAG(std::string, constraint_info_snapshot, "",
+          "constraint info snapshot file to load instead of parsing --p4info");
+ABSL_FLAG(std::string, write_constraint_info_snapshot, "",
+          "file to write a constraint info snapshot of --p4info to");
+ABSL_FLAG(bool, print_constraint_stats, false,
+          "print the number of distinct subexpressions of each constraint");
 constexpr char kUsage[] =
-    "--p4info=<file> [<table entry file in P4RT protobuf format> ...]";
+    "--p4info=<file> | --constraint_info_snapshot=<file> "
+    "[<table entry file in P4RT protobuf format> ...]";
 
 // The 8 most significant bits of any P4Runtime table ID must equal
 // p4::config::v1::P4Ids::TABLE. To ease writing table entries by hand in
@@ -66,49 +95,102 @@ std::string ToString(const absl::Status& status) {
                       status.message());
 }
 
+// Prints the number of (distinct) subexpressions of the constraints of all
+// tables and actions, ordered by name.
+void PrintConstraintStats(const ConstraintInfo& constraint_info) {
+  std::vector<std::pair<std::string, const FlatConstraint*>> constraints;
+  for (const auto& [id, table_info] : constraint_info.table_info_by_id) {
+    if (table_info.flat_constraint == nullptr) continue;
+    constraints.push_back({absl::StrCat("table ", table_info.name),
+                           table_info.flat_constraint.get()});
+  }
+  for (const auto& [id, action_info] : constraint_info.action_info_by_id) {
+    if (action_info.flat_constraint == nullptr) continue;
+    constraints.push_back({absl::StrCat("action ", action_info.name),
+                           action_info.flat_constraint.get()});
+  }
+  std::sort(constraints.begin(), constraints.end());
+  for (const auto& [name, constraint] : constraints) {
+    std::cout << absl::StreamFormat(
+        "%s: %d subexpressions, %d distinct (dedup ratio %.2f)\n", name,
+        constraint->nodes.size(), constraint->num_values,
+        DedupRatio(*constraint));
+  }
+}
+
 int main(int argc, char** argv) {
   const absl::string_view usage[] = {"usage:", argv[0], kUsage};
   absl::SetProgramUsageMessage(absl::StrJoin(usage, " "));
   std::vector<char*> positional_args = absl::ParseCommandLine(argc, argv);
 
-  // Read p4info flag.
+  // Read p4info and snapshot flags.
   const std::string p4info_filename = absl::GetFlag(FLAGS_p4info);
-  if (p4info_filename.empty()) {
-    std::cerr << "Missing argument: --p4info=<file>\n";
+  const std::string snapshot_filename =
+      absl::GetFlag(FLAGS_constraint_info_snapshot);
+  const std::string output_snapshot_filename =
+      absl::GetFlag(FLAGS_write_constraint_info_snapshot);
+  if (p4info_filename.empty() && snapshot_filename.empty()) {
+    std::cerr << "Missing argument: --p4info=<file> or "
+                 "--constraint_info_snapshot=<file>\n";
     return 1;
   }
-
-  // Open p4info file.
-  std::ifstream p4info_file(p4info_filename);
-  if (!p4info_file.is_open()) {
-    std::cerr << "Unable to open p4info file: " << p4info_filename << "\n";
+  if (!output_snapshot_filename.empty() && p4info_filename.empty()) {
+    std::cerr << "--write_constraint_info_snapshot requires --p4info\n";
     return 1;
   }
 
-  // Parse p4info file.
   p4::config::v1::P4Info p4info;
-  {
+  if (!p4info_filename.empty()) {
+    // Open p4info file.
+    std::ifstream p4info_file(p4info_filename);
+    if (!p4info_file.is_open()) {
+      std::cerr << "Unable to open p4info file: " << p4info_filename << "\n";
+      return 1;
+    }
+
+    // Parse p4info file.
     google::protobuf::io::IstreamInputStream stream(&p4info_file);
     if (!google::protobuf::TextFormat::Parse(&stream, &p4info)) {
       std::cerr << "Unable to parse p4info file: " << p4info_filename << "\n";
       return 1;
     }
-  }
-  // p4c 2019 and earlier does not set the 8 most significant bits of table IDs
-  // correctly, but p4c 2020 (since PR p4lang/p4c#2243) does. To make p4check
-  // compatible with both, we coerce all table IDs into the right format here.
-  for (auto& table : *p4info.mutable_tables()) {
-    table.mutable_preamble()->set_id(CoerceToTableId(table.preamble().id()));
+    // p4c 2019 and earlier does not set the 8 most significant bits of table
+    // IDs correctly, but p4c 2020 (since PR p4lang/p4c#2243) does. To make
+    // p4check compatible with both, we coerce all table IDs into the right
+    // format here.
+    for (auto& table : *p4info.mutable_tables()) {
+      table.mutable_preamble()->set_id(CoerceToTableId(table.preamble().id()));
+    }
   }
 
-  // Parse constraints and report potential errors.
-  absl::StatusOr<ConstraintInfo> constraint_info = P4ToConstraintInfo(p4info);
+  // Load the snapshot, or parse constraints, and report potential errors.
+  absl::StatusOr<ConstraintInfo> constraint_info =
+      snapshot_filename.empty()
+          ? P4ToConstraintInfo(p4info, /*num_threads=*/0)
+          : ReadConstraintInfoSnapshot(
+                snapshot_filename,
+                p4info_filename.empty()
+                    ? std::nullopt
+                    : std::make_optional(P4InfoFingerprint(p4info)));
   if (!constraint_info.ok()) {
     std::cerr << constraint_info.status().message();
     return 1;
   }
+  if (!output_snapshot_filename.empty()) {
+    absl::Status status = p4_constraints::WriteConstraintInfoSnapshot(
+        *constraint_info, p4info, output_snapshot_filename);
+    if (!status.ok()) {
+      std::cerr << status.message() << "\n";
+      return 1;
+    }
+  }
+
+  if (absl::GetFlag(FLAGS_print_constraint_stats)) {
+    PrintConstraintStats(*constraint_info);
+  }
 
   // Check table entries, if any where given.
+  Validator validator(*constraint_info);
   for (const char* entry_filename :
        absl::MakeSpan(positional_args).subspan(1)) {
     std::cout << "### P4Constraints Table Entry Test #######################\n";
@@ -140,7 +222,7 @@ int main(int argc, char** argv) {
 
     // Check entry.
     absl::StatusOr<std::string> result =
-        ReasonEntryViolatesConstraint(entry, *constraint_info);
+        validator.ReasonEntryViolatesConstraint(entry);
     if (!result.ok()) {
       std::cout << "Error: " << ToString(result.status()) << "\n\n";
       continue;
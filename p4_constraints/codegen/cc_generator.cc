@@ -0,0 +1,738 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "p4_constraints/codegen/cc_generator.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "absl/container/btree_map.h"
+#include "absl/container/btree_set.h"
+#include "absl/functional/function_ref.h"
+#include "absl/numeric/int128.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/string_view.h"
+#include "gutil/status.h"
+#include "p4/config/v1/p4info.pb.h"
+#include "p4_constraints/ast.pb.h"
+#include "p4_constraints/backend/constraint_info.h"
+#include "p4_constraints/backend/eval_result.h"
+#include "p4_constraints/backend/program.h"
+#include "p4_constraints/big_int.h"
+
+namespace p4_constraints {
+
+namespace {
+
+using ::p4_constraints::ast::Type;
+using ::p4_constraints::internal_interpreter::EvalResult;
+using ::p4_constraints::internal_interpreter::Exact;
+using ::p4_constraints::internal_interpreter::Lpm;
+using ::p4_constraints::internal_interpreter::Range;
+using ::p4_constraints::internal_interpreter::Ternary;
+
+// Number of bytes of the serialized P4Info per line of generated code.
+constexpr int kBytesPerLine = 24;
+
+std::string CppType(ValueRepresentation representation) {
+  return representation == ValueRepresentation::kUint64 ? "uint64_t"
+                                                         : "absl::uint128";
+}
+
+// Returns a C++ expression of type `CppType(representation)` for `value`, or
+// an Unimplemented error if `value` does not fit.
+absl::StatusOr<std::string> Literal(const BigInt& value,
+                                    ValueRepresentation representation) {
+  std::optional<absl::uint128> fixed_width_value = BigIntToUint128(value);
+  if (!fixed_width_value.has_value() ||
+      (representation == ValueRepresentation::kUint64 &&
+       absl::Uint128High64(*fixed_width_value) != 0)) {
+    return gutil::UnimplementedErrorBuilder()
+           << "constant " << BigIntToString(value) << " does not fit into "
+           << ValueRepresentationName(representation);
+  }
+  const uint64_t low = absl::Uint128Low64(*fixed_width_value);
+  const uint64_t high = absl::Uint128High64(*fixed_width_value);
+  if (representation == ValueRepresentation::kUint64) {
+    return absl::StrCat("uint64_t{", low, "u}");
+  }
+  if (high == 0) return absl::StrCat("absl::uint128(", low, "u)");
+  return absl::StrCat("absl::MakeUint128(", high, "u, ", low, "u)");
+}
+
+// Returns the given component of a key value, if it has one.
+std::optional<BigInt> KeyComponent(const EvalResult& value, KeyField field) {
+  if (auto* exact = std::get_if<Exact>(&value)) {
+    if (field == KeyField::kValue) return exact->value;
+  } else if (auto* ternary = std::get_if<Ternary>(&value)) {
+    if (field == KeyField::kValue) return ternary->value;
+    if (field == KeyField::kMask) return ternary->mask;
+  } else if (auto* lpm = std::get_if<Lpm>(&value)) {
+    if (field == KeyField::kValue) return lpm->value;
+    if (field == KeyField::kPrefixLength) return lpm->prefix_length;
+  } else if (auto* range = std::get_if<Range>(&value)) {
+    if (field == KeyField::kLow) return range->low;
+    if (field == KeyField::kHigh) return range->high;
+  }
+  return std::nullopt;
+}
+
+// How a P4Runtime `FieldMatch` on a key of a given type is read.
+struct MatchKind {
+  // The `FieldMatch::field_match_type_case()` of matches on the key.
+  std::string match_type_case;
+  // The accessor of the match, e.g. "ternary".
+  std::string accessor;
+};
+
+std::optional<MatchKind> MatchKindOf(const Type& type) {
+  switch (type.type_case()) {
+    case Type::kExact:
+      return MatchKind{"kExact", "exact"};
+    case Type::kTernary:
+      return MatchKind{"kTernary", "ternary"};
+    case Type::kOptionalMatch:
+      return MatchKind{"kOptional", "optional"};
+    case Type::kLpm:
+      return MatchKind{"kLpm", "lpm"};
+    case Type::kRange:
+      return MatchKind{"kRange", "range"};
+    default:
+      return std::nullopt;
+  }
+}
+
+// Returns the name of the local variable holding a component of a key, or a
+// parameter, in generated code.
+std::string KeyVariable(uint32_t key_id, KeyField field) {
+  return absl::StrCat("key_", key_id, "_", KeyFieldName(field));
+}
+std::string ParamVariable(uint32_t param_id) {
+  return absl::StrCat("param_", param_id);
+}
+
+// Returns statements that read component `field` of the matched value of key
+// `key` from `match`, returning nullopt from the generated function if the
+// component does not fit into `representation`.
+absl::StatusOr<std::string> EmitReadKeyComponent(
+    const KeyInfo& key, const MatchKind& match_kind, KeyField field,
+    ValueRepresentation representation) {
+  const std::string variable = KeyVariable(key.id, field);
+  std::string source;
+  switch (field) {
+    case KeyField::kValue:
+      source = "value";
+      break;
+    case KeyField::kMask:
+      if (key.type.has_optional_match()) {
+        // Optional matches are ternary matches with a full mask.
+        const int bitwidth = key.type.optional_match().bitwidth();
+        ASSIGN_OR_RETURN(
+            std::string mask,
+            Literal((BigInt(1) << bitwidth) - BigInt(1), representation));
+        return absl::StrFormat("        %s = %s;\n", variable, mask);
+      }
+      source = "mask";
+      break;
+    case KeyField::kPrefixLength:
+      // Negative prefix lengths do not fit into unsigned integers.
+      return absl::StrFormat(
+          "        if (match.lpm().prefix_len() < 0) return std::nullopt;\n"
+          "        %s = match.lpm().prefix_len();\n",
+          variable);
+    case KeyField::kLow:
+      source = "low";
+      break;
+    case KeyField::kHigh:
+      source = "high";
+      break;
+  }
+  return absl::StrFormat(
+      "        if (!ParseUnsigned(match.%s().%s(), %s)) {\n"
+      "          return std::nullopt;\n"
+      "        }\n",
+      match_kind.accessor, source, variable);
+}
+
+// Appends C++ statements to `code` that execute `program` on the stack slots
+// `s0`, `s1`, ... and return the verdict. `load` returns the expression read
+// by a load instruction. Returns an Unimplemented error if the program cannot
+// be translated, e.g. because it uses negative values.
+absl::Status EmitEvaluation(
+    const Program& program,
+    absl::FunctionRef<absl::StatusOr<std::string>(const Instruction&)> load,
+    std::string& code) {
+  const std::vector<Instruction>& instructions = program.instructions;
+  const int size = instructions.size();
+
+  // Stack depth before each instruction. Since the compiler emits structured
+  // code, the depth is the same on all paths to an instruction.
+  ASSIGN_OR_RETURN(const std::vector<int> depth, ValidateProgram(program));
+  std::vector<bool> is_jump_target(size + 1, false);
+  for (int pc = 0; pc < size; ++pc) {
+    const Instruction& instruction = instructions[pc];
+    if (depth[pc] >= 0 && (instruction.opcode == Opcode::kJumpIfFalseElsePop ||
+                           instruction.opcode == Opcode::kJumpIfTrueElsePop)) {
+      is_jump_target[instruction.operand] = true;
+    }
+  }
+
+  const std::string value_type = CppType(program.representation);
+  std::vector<std::string> slots;
+  const int num_slots = *std::max_element(depth.begin(), depth.end());
+  for (int i = 0; i < num_slots; ++i) {
+    slots.push_back(absl::StrCat("s", i, " = 0"));
+  }
+  absl::StrAppend(&code, "  ", value_type, " ", absl::StrJoin(slots, ", "),
+                  ";\n");
+  for (int pc = 0; pc < size; ++pc) {
+    const Instruction& instruction = instructions[pc];
+    if (is_jump_target[pc]) absl::StrAppend(&code, "pc_", pc, ":\n");
+    const int d = depth[pc];
+    if (d < 0) continue;
+    switch (instruction.opcode) {
+      case Opcode::kPushInteger:
+        if (instruction.operand < 0) {
+          return gutil::UnimplementedErrorBuilder()
+                 << "negative integer " << instruction.operand;
+        }
+        absl::StrAppend(&code, "  s", d, " = ", instruction.operand, ";\n");
+        break;
+      case Opcode::kPushConstant: {
+        ASSIGN_OR_RETURN(std::string constant,
+                         Literal(program.constants[instruction.operand],
+                                 program.representation));
+        absl::StrAppend(&code, "  s", d, " = ", constant, ";\n");
+        break;
+      }
+      case Opcode::kLoadKey:
+      case Opcode::kLoadParam:
+      case Opcode::kLoadPriority: {
+        ASSIGN_OR_RETURN(std::string value, load(instruction));
+        absl::StrAppend(&code, "  s", d, " = ", value, ";\n");
+        break;
+      }
+      case Opcode::kDup:
+        absl::StrAppend(&code, "  s", d, " = s", d - 1, ";\n");
+        break;
+      case Opcode::kNot:
+        absl::StrAppend(&code, "  s", d - 1, " = s", d - 1, " == 0 ? 1 : 0;\n");
+        break;
+      case Opcode::kNegate:
+        return gutil::UnimplementedErrorBuilder()
+               << "negation requires arbitrary precision";
+      case Opcode::kMod: {
+        ASSIGN_OR_RETURN(std::string modulus,
+                         Literal(program.constants[instruction.operand],
+                                 program.representation));
+        absl::StrAppend(&code, "  s", d - 1, " %= ", modulus, ";\n");
+        break;
+      }
+      case Opcode::kEq:
+      case Opcode::kNe: {
+        const int components = instruction.operand;
+        const bool eq = instruction.opcode == Opcode::kEq;
+        std::vector<std::string> comparisons;
+        for (int i = 0; i < components; ++i) {
+          comparisons.push_back(absl::StrCat("s", d - 2 * components + i,
+                                             eq ? " == " : " != ", "s",
+                                             d - components + i));
+        }
+        absl::StrAppend(&code, "  s", d - 2 * components, " = ",
+                        absl::StrJoin(comparisons, eq ? " && " : " || "),
+                        " ? 1 : 0;\n");
+        break;
+      }
+      case Opcode::kLt:
+      case Opcode::kLe:
+      case Opcode::kGt:
+      case Opcode::kGe: {
+        const char* op = instruction.opcode == Opcode::kLt   ? "<"
+                         : instruction.opcode == Opcode::kLe ? "<="
+                         : instruction.opcode == Opcode::kGt ? ">"
+                                                             : ">=";
+        absl::StrAppend(&code, "  s", d - 2, " = s", d - 2, " ", op, " s",
+                        d - 1, " ? 1 : 0;\n");
+        break;
+      }
+      case Opcode::kJumpIfFalseElsePop:
+      case Opcode::kJumpIfTrueElsePop:
+        absl::StrAppend(&code, "  if (s", d - 1,
+                        instruction.opcode == Opcode::kJumpIfFalseElsePop
+                            ? " == 0"
+                            : " != 0",
+                        ") goto pc_", instruction.operand, ";\n");
+        break;
+    }
+  }
+  if (is_jump_target[size]) absl::StrAppend(&code, "pc_", size, ":\n");
+  absl::StrAppend(&code, "  return s0 != 0;\n");
+  return absl::OkStatus();
+}
+
+// Returns the name of the generated function checking the constraint of the
+// given table (resp. action).
+std::string TableFunction(const TableInfo& table) {
+  return absl::StrCat("TableSatisfiesConstraint", table.id);
+}
+std::string ActionFunction(const ActionInfo& action) {
+  return absl::StrCat("ActionSatisfiesConstraint", action.id);
+}
+
+// Returns true if the generated code can check the constraint of a table or
+// action with the given program, subject to `EmitTableFunction` resp.
+// `EmitActionFunction` succeeding.
+bool HasFixedWidthProgram(const ast::Expression* constraint,
+                          const Program* program) {
+  return constraint != nullptr && constraint->type().has_boolean() &&
+         program != nullptr &&
+         program->representation != ValueRepresentation::kBigInt;
+}
+
+// Returns the definition of a function
+//
+//   std::optional<bool> TableSatisfiesConstraint<ID>(
+//       const p4::v1::TableEntry& entry);
+//
+// that returns true if `entry` satisfies the constraint of `table`, false if
+// it does not, and nullopt if the entry must be checked by the interpreter.
+absl::StatusOr<std::string> EmitTableFunction(const TableInfo& table) {
+  const Program& program = *table.program;
+  const ValueRepresentation representation = program.representation;
+  const std::string value_type = CppType(representation);
+  const EntryLayout layout = table.key_layout != nullptr ? *table.key_layout
+                                                         : MakeKeyLayout(table);
+
+  // The components of each key that the program loads, by key ID.
+  absl::btree_map<uint32_t, absl::btree_set<KeyField>> loaded_components;
+  bool loads_priority = false;
+  for (const Instruction& instruction : program.instructions) {
+    if (instruction.opcode == Opcode::kLoadPriority) loads_priority = true;
+    if (instruction.opcode != Opcode::kLoadKey) continue;
+    const std::string& name = program.variables[instruction.operand].name;
+    auto it = table.keys_by_name.find(name);
+    if (it == table.keys_by_name.end()) {
+      return gutil::InternalErrorBuilder()
+             << "unknown key " << name << " in table " << table.name;
+    }
+    loaded_components[it->second.id].insert(instruction.field);
+  }
+
+  absl::btree_map<uint32_t, const KeyInfo*> keys;
+  for (const auto& [id, key] : table.keys_by_id) keys[id] = &key;
+
+  std::string code = absl::StrFormat(
+      "// Table %s.\n"
+      "std::optional<bool> %s(const p4::v1::TableEntry& entry) {\n",
+      table.name, TableFunction(table));
+
+  // Keys, initialized to their values if omitted from the entry.
+  std::string missing_keys;
+  for (const auto& [id, key] : keys) {
+    absl::StrAppendFormat(&code, "  bool key_%d_present = false;\n", id);
+    auto slot = layout.slot_by_name.find(key->name);
+    const std::optional<EvalResult>* default_value =
+        slot == layout.slot_by_name.end()
+            ? nullptr
+            : &layout.default_values[slot->second];
+    if (default_value == nullptr || !default_value->has_value()) {
+      absl::StrAppendFormat(&missing_keys,
+                            "  if (!key_%d_present) return std::nullopt;\n",
+                            id);
+    }
+    for (KeyField field : loaded_components[id]) {
+      std::string initial_value = "0";
+      if (default_value != nullptr && default_value->has_value()) {
+        std::optional<BigInt> component = KeyComponent(**default_value, field);
+        if (!component.has_value()) {
+          return gutil::InternalErrorBuilder()
+                 << "key " << key->name << " has no component "
+                 << KeyFieldName(field);
+        }
+        ASSIGN_OR_RETURN(initial_value, Literal(*component, representation));
+      }
+      absl::StrAppendFormat(&code, "  %s %s = %s;\n", value_type,
+                            KeyVariable(id, field), initial_value);
+    }
+  }
+
+  // Reads the keys present in the entry, leaving malformed entries to the
+  // interpreter.
+  absl::StrAppend(&code,
+                  "  for (const p4::v1::FieldMatch& match : entry.match()) {\n"
+                  "    switch (match.field_id()) {\n");
+  for (const auto& [id, key] : keys) {
+    absl::StrAppendFormat(&code, "      case %d:  // %s\n", id, key->name);
+    std::optional<MatchKind> match_kind = MatchKindOf(key->type);
+    if (!match_kind.has_value()) {
+      absl::StrAppend(&code, "        return std::nullopt;\n");
+      continue;
+    }
+    absl::StrAppendFormat(&code,
+                          "        if (key_%d_present ||\n"
+                          "            match.field_match_type_case() !=\n"
+                          "                p4::v1::FieldMatch::%s) {\n"
+                          "          return std::nullopt;\n"
+                          "        }\n"
+                          "        key_%d_present = true;\n",
+                          id, match_kind->match_type_case, id);
+    for (KeyField field : loaded_components[id]) {
+      ASSIGN_OR_RETURN(std::string read,
+                       EmitReadKeyComponent(*key, *match_kind, field,
+                                            representation));
+      absl::StrAppend(&code, read);
+    }
+    absl::StrAppend(&code, "        break;\n");
+  }
+  absl::StrAppend(&code,
+                  "      default:\n"
+                  "        return std::nullopt;\n"
+                  "    }\n"
+                  "  }\n",
+                  missing_keys);
+  if (loads_priority) {
+    absl::StrAppendFormat(&code,
+                          "  if (entry.priority() < 0) return std::nullopt;\n"
+                          "  const %s priority = entry.priority();\n",
+                          value_type);
+  }
+
+  RETURN_IF_ERROR(EmitEvaluation(
+      program,
+      [&](const Instruction& instruction) -> absl::StatusOr<std::string> {
+        if (instruction.opcode == Opcode::kLoadPriority) return "priority";
+        if (instruction.opcode != Opcode::kLoadKey) {
+          return gutil::InternalErrorBuilder()
+                 << "found a reference to an action parameter in a table "
+                    "constraint";
+        }
+        const std::string& name = program.variables[instruction.operand].name;
+        return KeyVariable(table.keys_by_name.at(name).id, instruction.field);
+      },
+      code));
+  absl::StrAppend(&code, "}\n");
+  return code;
+}
+
+// Returns the definition of a function
+//
+//   std::optional<bool> ActionSatisfiesConstraint<ID>(
+//       const p4::v1::Action& action);
+//
+// analogous to `EmitTableFunction`.
+absl::StatusOr<std::string> EmitActionFunction(const ActionInfo& action) {
+  const Program& program = *action.program;
+  const std::string value_type = CppType(program.representation);
+
+  absl::btree_set<uint32_t> loaded_params;
+  for (const Instruction& instruction : program.instructions) {
+    if (instruction.opcode != Opcode::kLoadParam) continue;
+    const std::string& name = program.variables[instruction.operand].name;
+    auto it = action.params_by_name.find(name);
+    if (it == action.params_by_name.end()) {
+      return gutil::InternalErrorBuilder()
+             << "unknown action parameter " << name << " in action "
+             << action.name;
+    }
+    loaded_params.insert(it->second.id);
+  }
+  absl::btree_map<uint32_t, const ParamInfo*> params;
+  for (const auto& [id, param] : action.params_by_id) params[id] = &param;
+
+  std::string code = absl::StrFormat(
+      "// Action %s.\n"
+      "std::optional<bool> %s(const p4::v1::Action& action) {\n",
+      action.name, ActionFunction(action));
+  for (const auto& [id, param] : params) {
+    absl::StrAppendFormat(&code, "  bool param_%d_present = false;\n", id);
+    if (loaded_params.contains(id)) {
+      absl::StrAppendFormat(&code, "  %s %s = 0;\n", value_type,
+                            ParamVariable(id));
+    }
+  }
+  absl::StrAppend(&code,
+                  "  for (const p4::v1::Action_Param& param : "
+                  "action.params()) {\n"
+                  "    switch (param.param_id()) {\n");
+  for (const auto& [id, param] : params) {
+    absl::StrAppendFormat(&code,
+                          "      case %d:  // %s\n"
+                          "        if (param_%d_present) return std::nullopt;\n"
+                          "        param_%d_present = true;\n",
+                          id, param->name, id, id);
+    if (loaded_params.contains(id)) {
+      absl::StrAppendFormat(&code,
+                            "        if (!ParseUnsigned(param.value(), %s)) {\n"
+                            "          return std::nullopt;\n"
+                            "        }\n",
+                            ParamVariable(id));
+    }
+    absl::StrAppend(&code, "        break;\n");
+  }
+  absl::StrAppend(&code,
+                  "      default:\n"
+                  "        return std::nullopt;\n"
+                  "    }\n"
+                  "  }\n");
+  for (uint32_t id : loaded_params) {
+    absl::StrAppendFormat(
+        &code, "  if (!param_%d_present) return std::nullopt;\n", id);
+  }
+
+  RETURN_IF_ERROR(EmitEvaluation(
+      program,
+      [&](const Instruction& instruction) -> absl::StatusOr<std::string> {
+        if (instruction.opcode != Opcode::kLoadParam) {
+          return gutil::InternalErrorBuilder()
+                 << "found a reference to a key or attribute in an action "
+                    "constraint";
+        }
+        const std::string& name = program.variables[instruction.operand].name;
+        return ParamVariable(action.params_by_name.at(name).id);
+      },
+      code));
+  absl::StrAppend(&code, "}\n");
+  return code;
+}
+
+// Returns `p4info`, serialized, as a sequence of C++ string literals.
+std::string EmitSerializedP4Info(const p4::config::v1::P4Info& p4info) {
+  const std::string bytes = p4info.SerializeAsString();
+  std::string code;
+  for (int i = 0; i < bytes.size(); i += kBytesPerLine) {
+    // Octal escapes never extend into the next literal.
+    absl::StrAppend(&code, "    \"",
+                    absl::CEscape(absl::string_view(bytes).substr(
+                        i, kBytesPerLine)),
+                    "\"\n");
+  }
+  if (code.empty()) code = "    \"\"\n";
+  return code;
+}
+
+std::string HeaderGuard(absl::string_view header_path) {
+  std::string guard;
+  for (char c : header_path) {
+    guard.push_back(absl::ascii_isalnum(c) ? absl::ascii_toupper(c) : '_');
+  }
+  return absl::StrCat(guard, "_");
+}
+
+}  // namespace
+
+absl::StatusOr<GeneratedCc> GenerateCc(const p4::config::v1::P4Info& p4info,
+                                       const CcGeneratorOptions& options) {
+  if (options.cc_namespace.empty()) {
+    return gutil::InvalidArgumentErrorBuilder() << "missing namespace";
+  }
+  ASSIGN_OR_RETURN(const ConstraintInfo constraint_info,
+                   P4ToConstraintInfo(p4info));
+
+  absl::btree_map<uint32_t, const TableInfo*> tables;
+  for (const auto& [id, table] : constraint_info.table_info_by_id) {
+    tables[id] = &table;
+  }
+  absl::btree_map<uint32_t, const ActionInfo*> actions;
+  for (const auto& [id, action] : constraint_info.action_info_by_id) {
+    actions[id] = &action;
+  }
+
+  // Functions checking individual tables and actions, and the cases of the
+  // switches dispatching to them.
+  std::string functions;
+  std::string table_cases;
+  std::string action_cases;
+  // Appends `function` to `functions`, returning false if the generated code
+  // leaves the constraint to the interpreter.
+  auto add_function = [&](absl::StatusOr<std::string> function,
+                          absl::string_view kind,
+                          absl::string_view name) -> absl::StatusOr<bool> {
+    if (absl::IsUnimplemented(function.status())) return false;
+    RETURN_IF_ERROR(function.status())
+        << "while generating code for " << kind << " " << name;
+    absl::StrAppend(&functions, "\n", *function);
+    return true;
+  };
+
+  // Entries of unconstrained tables only need to satisfy their actions'
+  // constraints.
+  for (const auto& [id, table] : tables) {
+    if (table->constraint == nullptr) {
+      absl::StrAppendFormat(&table_cases, "    case %d:  // %s\n", id,
+                            table->name);
+    }
+  }
+  if (!table_cases.empty()) absl::StrAppend(&table_cases, "      break;\n");
+  for (const auto& [id, table] : tables) {
+    if (!HasFixedWidthProgram(table->constraint.get(), table->program.get())) {
+      continue;
+    }
+    ASSIGN_OR_RETURN(bool added, add_function(EmitTableFunction(*table),
+                                              "table", table->name));
+    if (!added) continue;
+    absl::StrAppendFormat(&table_cases,
+                          "    case %d:  // %s\n"
+                          "      if (!IsTrue(%s(entry))) return false;\n"
+                          "      break;\n",
+                          id, table->name, TableFunction(*table));
+  }
+
+  // Unconstrained actions are satisfied by definition.
+  for (const auto& [id, action] : actions) {
+    if (action->constraint == nullptr) {
+      absl::StrAppendFormat(&action_cases, "    case %d:  // %s\n", id,
+                            action->name);
+    }
+  }
+  if (!action_cases.empty()) {
+    absl::StrAppend(&action_cases, "      return true;\n");
+  }
+  for (const auto& [id, action] : actions) {
+    if (!HasFixedWidthProgram(action->constraint.get(),
+                              action->program.get())) {
+      continue;
+    }
+    ASSIGN_OR_RETURN(bool added, add_function(EmitActionFunction(*action),
+                                              "action", action->name));
+    if (!added) continue;
+    absl::StrAppendFormat(&action_cases,
+                          "    case %d:  // %s\n"
+                          "      return %s(action);\n",
+                          id, action->name, ActionFunction(*action));
+  }
+
+  GeneratedCc generated;
+  const std::string guard = HeaderGuard(options.header_path);
+  generated.header = absl::StrFormat(
+      R"(// Generated by the p4-constraints C++ generator. DO NOT EDIT.
+
+#ifndef %s
+#define %s
+
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "p4/v1/p4runtime.pb.h"
+#include "p4_constraints/backend/constraint_info.h"
+
+namespace %s {
+
+// Returns an empty string if the given table entry satisfies all constraints
+// of the P4 program, or a human-readable explanation why it does not.
+// Equivalent to `p4_constraints::ReasonEntryViolatesConstraint(entry,
+// GetConstraintInfo())`, but checks entries that satisfy their constraints
+// without interpretation where possible.
+absl::StatusOr<std::string> ReasonEntryViolatesConstraint(
+    const p4::v1::TableEntry& entry);
+
+// Returns the constraints of the P4 program, translated on first use.
+const p4_constraints::ConstraintInfo& GetConstraintInfo();
+
+}  // namespace %s
+
+#endif  // %s
+)",
+      guard, guard, options.cc_namespace, options.cc_namespace, guard);
+
+  generated.source = absl::StrFormat(
+      R"(// Generated by the p4-constraints C++ generator. DO NOT EDIT.
+
+#include "%s"
+
+#include <stdint.h>
+
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "absl/log/check.h"
+#include "absl/numeric/int128.h"
+#include "absl/status/statusor.h"
+#include "p4/config/v1/p4info.pb.h"
+#include "p4/v1/p4runtime.pb.h"
+#include "p4_constraints/backend/constraint_info.h"
+#include "p4_constraints/backend/interpreter.h"
+#include "p4_constraints/codegen/runtime.h"
+
+namespace %s {
+
+namespace {
+
+using ::p4_constraints::codegen_runtime::ParseUnsigned;
+
+// The P4Info the code was generated from, serialized.
+constexpr char kP4Info[] =
+%s;
+
+bool IsTrue(std::optional<bool> satisfied) { return satisfied == true; }
+%s
+std::optional<bool> ActionSatisfiesConstraint(const p4::v1::Action& action) {
+  switch (action.action_id()) {
+%s    default:
+      return std::nullopt;
+  }
+}
+
+// Returns true if `entry` is known to satisfy its constraints. False means
+// that the entry must be checked by the interpreter.
+bool EntrySatisfiesConstraints(const p4::v1::TableEntry& entry) {
+  switch (entry.table_id()) {
+%s    default:
+      return false;
+  }
+  if (!entry.has_action()) return true;
+  switch (entry.action().type_case()) {
+    case p4::v1::TableAction::kAction:
+      return IsTrue(ActionSatisfiesConstraint(entry.action().action()));
+    case p4::v1::TableAction::kActionProfileActionSet:
+      for (const p4::v1::ActionProfileAction& action :
+           entry.action().action_profile_action_set()
+               .action_profile_actions()) {
+        if (!IsTrue(ActionSatisfiesConstraint(action.action()))) return false;
+      }
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+const p4_constraints::ConstraintInfo& GetConstraintInfo() {
+  static const p4_constraints::ConstraintInfo* const constraint_info = [] {
+    p4::config::v1::P4Info p4info;
+    CHECK(p4info.ParseFromArray(kP4Info, sizeof(kP4Info) - 1));
+    absl::StatusOr<p4_constraints::ConstraintInfo> constraint_info =
+        p4_constraints::P4ToConstraintInfo(p4info);
+    CHECK(constraint_info.ok()) << constraint_info.status();
+    return new p4_constraints::ConstraintInfo(*std::move(constraint_info));
+  }();
+  return *constraint_info;
+}
+
+absl::StatusOr<std::string> ReasonEntryViolatesConstraint(
+    const p4::v1::TableEntry& entry) {
+  if (EntrySatisfiesConstraints(entry)) return "";
+  return p4_constraints::ReasonEntryViolatesConstraint(entry,
+                                                       GetConstraintInfo());
+}
+
+}  // namespace %s
+)",
+      options.header_path, options.cc_namespace, EmitSerializedP4Info(p4info),
+      functions, action_cases, table_cases, options.cc_namespace);
+  return generated;
+}
+
+}  // namespace p4_constraints
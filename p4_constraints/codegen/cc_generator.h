@@ -0,0 +1,65 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+// Ahead-of-time compilation of the constraints of a P4 program to C++.
+//
+// For programs whose P4Info is known at build time, the constraints can be
+// checked without loading them at runtime. The generator emits one function
+// per table and per action with a compiled constraint (see program.h), which
+// reads keys and parameters by their P4Info IDs and evaluates the constraint
+// with native integers, as the VM would, but without dispatching on opcodes.
+//
+// The generated functions only ever decide that an entry satisfies its
+// constraints. Entries that violate a constraint, are malformed, or use
+// features the generated code does not handle (e.g. constraints that need
+// arbitrary precision) are passed to the interpreter, which explains the
+// violation or reports the error. The generated
+// `ReasonEntryViolatesConstraint` hence returns exactly what
+// `p4_constraints::ReasonEntryViolatesConstraint` returns for the P4Info the
+// code was generated from.
+//
+// Use the `p4_constraints_cc_library` Bazel rule (see
+// p4_constraints_cc_library.bzl) rather than invoking the generator directly.
+
+#ifndef P4_CONSTRAINTS_CODEGEN_CC_GENERATOR_H_
+#define P4_CONSTRAINTS_CODEGEN_CC_GENERATOR_H_
+
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "p4/config/v1/p4info.pb.h"
+
+namespace p4_constraints {
+
+struct CcGeneratorOptions {
+  // Namespace of the generated code, e.g. "my_program::constraints".
+  std::string cc_namespace;
+  // Path under which the generated header is included by the generated
+  // source, e.g. "my_program/constraints.h".
+  std::string header_path;
+};
+
+struct GeneratedCc {
+  std::string header;
+  std::string source;
+};
+
+// Generates a C++ header and source checking the constraints of `p4info`.
+// Returns an error if the constraints of `p4info` are invalid, like
+// `P4ToConstraintInfo` does.
+//
+// The header declares, in `options.cc_namespace`:
+//
+//   // Same as `p4_constraints::ReasonEntryViolatesConstraint(entry,
+//   // GetConstraintInfo())`.
+//   absl::StatusOr<std::string> ReasonEntryViolatesConstraint(
+//       const p4::v1::TableEntry& entry);
+//
+//   // The constraints of `p4info`, translated on first use.
+//   const p4_constraints::ConstraintInfo& GetConstraintInfo();
+absl::StatusOr<GeneratedCc> GenerateCc(const p4::config::v1::P4Info& p4info,
+                                       const CcGeneratorOptions& options);
+
+}  // namespace p4_constraints
+
+#endif  // P4_CONSTRAINTS_CODEGEN_CC_GENERATOR_H_
@@ -0,0 +1,133 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "p4_constraints/codegen/cc_generator.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "absl/status/status.h"
+#include "gutil/status_matchers.h"
+#include "gutil/testing.h"
+#include "p4/config/v1/p4info.pb.h"
+
+namespace p4_constraints {
+namespace {
+
+using ::gutil::ParseProtoOrDie;
+using ::gutil::StatusIs;
+using ::testing::AllOf;
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+constexpr char kP4Info[] = R"pb(
+  tables {
+    preamble {
+      id: 1
+      name: "narrow_table"
+      annotations: "@entry_restriction(\"a::mask != 0 -> a::value == 1\")"
+    }
+    match_fields { id: 1 name: "a" bitwidth: 8 match_type: TERNARY }
+  }
+  tables {
+    preamble {
+      id: 2
+      name: "wide_table"
+      annotations: "@entry_restriction(\"b != 1\")"
+    }
+    match_fields { id: 1 name: "b" bitwidth: 100 match_type: EXACT }
+  }
+  tables {
+    preamble {
+      id: 3
+      name: "huge_table"
+      annotations: "@entry_restriction(\"c != 1\")"
+    }
+    match_fields { id: 1 name: "c" bitwidth: 200 match_type: EXACT }
+  }
+  tables {
+    preamble { id: 4 name: "unconstrained_table" }
+    match_fields { id: 1 name: "d" bitwidth: 8 match_type: EXACT }
+  }
+  actions {
+    preamble {
+      id: 10
+      name: "act"
+      annotations: "@action_restriction(\"x != 0\")"
+    }
+    params { id: 1 name: "x" bitwidth: 16 }
+  }
+)pb";
+
+const CcGeneratorOptions kOptions = {
+    .cc_namespace = "my_program::constraints",
+    .header_path = "my_program/constraints.h",
+};
+
+TEST(CcGeneratorTest, GeneratesHeader) {
+  ASSERT_OK_AND_ASSIGN(
+      GeneratedCc generated,
+      GenerateCc(ParseProtoOrDie<p4::config::v1::P4Info>(kP4Info), kOptions));
+  EXPECT_THAT(generated.header,
+              AllOf(HasSubstr("#ifndef MY_PROGRAM_CONSTRAINTS_H_"),
+                    HasSubstr("namespace my_program::constraints {"),
+                    HasSubstr("ReasonEntryViolatesConstraint("),
+                    HasSubstr("GetConstraintInfo()")));
+  EXPECT_THAT(generated.source,
+              HasSubstr("#include \"my_program/constraints.h\""));
+}
+
+TEST(CcGeneratorTest, UsesNativeIntegersForFixedWidthConstraints) {
+  ASSERT_OK_AND_ASSIGN(
+      GeneratedCc generated,
+      GenerateCc(ParseProtoOrDie<p4::config::v1::P4Info>(kP4Info), kOptions));
+  EXPECT_THAT(generated.source,
+              AllOf(HasSubstr("TableSatisfiesConstraint1("),
+                    HasSubstr("uint64_t key_1_mask = uint64_t{0u};"),
+                    HasSubstr("TableSatisfiesConstraint2("),
+                    HasSubstr("absl::uint128 key_1_value = 0;"),
+                    HasSubstr("ActionSatisfiesConstraint10("),
+                    HasSubstr("uint64_t param_1 = 0;")));
+}
+
+TEST(CcGeneratorTest, LeavesArbitraryPrecisionToInterpreter) {
+  ASSERT_OK_AND_ASSIGN(
+      GeneratedCc generated,
+      GenerateCc(ParseProtoOrDie<p4::config::v1::P4Info>(kP4Info), kOptions));
+  EXPECT_THAT(generated.source,
+              AllOf(Not(HasSubstr("TableSatisfiesConstraint3(")),
+                    Not(HasSubstr("TableSatisfiesConstraint4(")),
+                    HasSubstr("case 4:  // unconstrained_table")));
+}
+
+TEST(CcGeneratorTest, IsDeterministic) {
+  const auto p4info = ParseProtoOrDie<p4::config::v1::P4Info>(kP4Info);
+  ASSERT_OK_AND_ASSIGN(GeneratedCc first, GenerateCc(p4info, kOptions));
+  ASSERT_OK_AND_ASSIGN(GeneratedCc second, GenerateCc(p4info, kOptions));
+  EXPECT_EQ(first.header, second.header);
+  EXPECT_EQ(first.source, second.source);
+}
+
+TEST(CcGeneratorTest, RejectsInvalidConstraints) {
+  const auto p4info = ParseProtoOrDie<p4::config::v1::P4Info>(R"pb(
+    tables {
+      preamble {
+        id: 1
+        name: "table"
+        annotations: "@entry_restriction(\"unknown_key == 1\")"
+      }
+    }
+  )pb");
+  EXPECT_THAT(GenerateCc(p4info, kOptions),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(CcGeneratorTest, RejectsMissingNamespace) {
+  EXPECT_THAT(
+      GenerateCc(ParseProtoOrDie<p4::config::v1::P4Info>(kP4Info),
+                 {.header_path = "constraints.h"}),
+      StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace p4_constraints
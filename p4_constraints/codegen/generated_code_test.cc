@@ -0,0 +1,237 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+// Tests the code generated by the `p4_constraints_cc_library` rule for
+// testdata/example.p4info.pb.txt against the interpreter.
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <stdint.h>
+
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "gutil/status_matchers.h"
+#include "gutil/testing.h"
+#include "p4/v1/p4runtime.pb.h"
+#include "p4_constraints/backend/constraint_info.h"
+#include "p4_constraints/backend/interpreter.h"
+#include "p4_constraints/codegen/example_constraints.h"
+
+namespace p4_constraints {
+namespace {
+
+using ::gutil::IsOkAndHolds;
+using ::gutil::ParseProtoOrDie;
+using ::testing::HasSubstr;
+using ::testing::IsEmpty;
+
+// Returns the minimal big-endian bytestring of `value`, followed by
+// `extra_bytes` zero-bytes, if any, to exceed 64 bits.
+std::string Bytes(uint64_t value, int extra_bytes = 0) {
+  std::string bytes;
+  for (; value != 0; value >>= 8) bytes.insert(bytes.begin(), value & 0xff);
+  if (bytes.empty()) bytes.push_back('\0');
+  return bytes + std::string(extra_bytes, '\0');
+}
+
+p4::v1::TableEntry ExactEntry(uint64_t a, uint64_t b) {
+  p4::v1::TableEntry entry;
+  entry.set_table_id(1);
+  p4::v1::FieldMatch* match = entry.add_match();
+  match->set_field_id(1);
+  match->mutable_exact()->set_value(Bytes(a));
+  match = entry.add_match();
+  match->set_field_id(2);
+  match->mutable_exact()->set_value(Bytes(b));
+  return entry;
+}
+
+p4::v1::Action Action(uint32_t action_id,
+                      std::vector<std::pair<uint32_t, std::string>> params) {
+  p4::v1::Action action;
+  action.set_action_id(action_id);
+  for (auto& [param_id, value] : params) {
+    p4::v1::Action_Param* param = action.add_params();
+    param->set_param_id(param_id);
+    param->set_value(value);
+  }
+  return action;
+}
+
+// Returns entries of all tables of the example, including malformed entries
+// and entries with values that exceed the width of their keys.
+std::vector<p4::v1::TableEntry> TestEntries() {
+  std::vector<p4::v1::TableEntry> entries;
+
+  // exact_table.
+  for (uint64_t a : {0, 1, 2}) {
+    for (uint64_t b : {0, 999, 1000, 0xffff, 0x10000}) {
+      entries.push_back(ExactEntry(a, b));
+    }
+  }
+  p4::v1::TableEntry entry = ExactEntry(1, 1);
+  entry.mutable_match(1)->mutable_exact()->set_value(Bytes(1, 8));
+  entries.push_back(entry);
+  entry = ExactEntry(1, 1);
+  entry.mutable_match()->RemoveLast();
+  entries.push_back(entry);
+  entry = ExactEntry(1, 1);
+  entry.mutable_match(1)->set_field_id(1);
+  entries.push_back(entry);
+  entry = ExactEntry(1, 1);
+  entry.mutable_match(1)->set_field_id(9);
+  entries.push_back(entry);
+  entry = ExactEntry(1, 1);
+  entry.mutable_match(1)->mutable_ternary()->set_value(Bytes(1));
+  entries.push_back(entry);
+  entry = ExactEntry(1, 1);
+  p4::v1::FieldMatch* unused = entry.add_match();
+  unused->set_field_id(3);
+  unused->mutable_ternary()->set_value(Bytes(7, 20));
+  unused->mutable_ternary()->set_mask(Bytes(7, 20));
+  entries.push_back(entry);
+
+  // mixed_table.
+  for (uint64_t mask : {0x0ull, 0xffull, 0xffffffffull}) {
+    for (std::optional<uint64_t> o :
+         std::vector<std::optional<uint64_t>>{std::nullopt, 5, 6}) {
+      for (int prefix_length : {-1, 24, 25}) {
+        for (int32_t priority : {-1, 5, 20}) {
+          p4::v1::TableEntry mixed;
+          mixed.set_table_id(2);
+          mixed.set_priority(priority);
+          p4::v1::FieldMatch* match = mixed.add_match();
+          match->set_field_id(1);
+          match->mutable_ternary()->set_value(Bytes(0));
+          match->mutable_ternary()->set_mask(Bytes(mask));
+          if (o.has_value()) {
+            match = mixed.add_match();
+            match->set_field_id(2);
+            match->mutable_optional()->set_value(Bytes(*o));
+          }
+          if (prefix_length >= 0) {
+            match = mixed.add_match();
+            match->set_field_id(3);
+            match->mutable_lpm()->set_value(Bytes(0));
+            match->mutable_lpm()->set_prefix_len(prefix_length);
+          }
+          match = mixed.add_match();
+          match->set_field_id(4);
+          match->mutable_range()->set_low(Bytes(priority == 5 ? 2 : 1));
+          match->mutable_range()->set_high(Bytes(2));
+          entries.push_back(mixed);
+        }
+      }
+    }
+  }
+
+  // wide_table.
+  for (uint64_t value : {1, 2}) {
+    for (int extra_bytes : {0, 8, 9}) {
+      for (uint64_t mask : {0, 1}) {
+        p4::v1::TableEntry wide;
+        wide.set_table_id(3);
+        p4::v1::FieldMatch* match = wide.add_match();
+        match->set_field_id(1);
+        match->mutable_ternary()->set_value(Bytes(value, extra_bytes));
+        match->mutable_ternary()->set_mask(Bytes(mask));
+        entries.push_back(wide);
+      }
+    }
+  }
+
+  // arbitrary_precision_table.
+  for (uint64_t k : {1, 2}) {
+    p4::v1::TableEntry huge;
+    huge.set_table_id(5);
+    p4::v1::FieldMatch* match = huge.add_match();
+    match->set_field_id(1);
+    match->mutable_exact()->set_value(Bytes(k));
+    entries.push_back(huge);
+  }
+
+  // Unknown table.
+  entry = ExactEntry(1, 1);
+  entry.set_table_id(99);
+  entries.push_back(entry);
+
+  // Actions, on entries of a table without and of a table with constraints.
+  std::vector<p4::v1::Action> actions = {
+      Action(10, {{1, Bytes(0)}, {2, Bytes(1)}}),
+      Action(10, {{1, Bytes(1)}}),
+      Action(10, {{1, Bytes(255)}, {2, Bytes(1, 20)}}),
+      Action(10, {{1, Bytes(256)}}),
+      Action(10, {{1, Bytes(1, 8)}}),
+      Action(10, {{2, Bytes(1)}}),
+      Action(10, {{1, Bytes(1)}, {1, Bytes(1)}}),
+      Action(10, {{1, Bytes(1)}, {3, Bytes(1)}}),
+      Action(11, {}),
+      Action(12, {{1, Bytes(1)}}),
+      Action(12, {{1, Bytes(2)}}),
+      Action(99, {}),
+  };
+  for (const p4::v1::TableEntry& base :
+       {ParseProtoOrDie<p4::v1::TableEntry>(
+            R"pb(table_id: 4
+                 match {
+                   field_id: 1
+                   exact { value: "\001" }
+                 })pb"),
+        ExactEntry(1, 1), ExactEntry(0, 1)}) {
+    for (const p4::v1::Action& action : actions) {
+      entry = base;
+      *entry.mutable_action()->mutable_action() = action;
+      entries.push_back(entry);
+    }
+    for (int i = 0; i + 1 < actions.size(); ++i) {
+      entry = base;
+      for (int j = i; j <= i + 1; ++j) {
+        *entry.mutable_action()
+             ->mutable_action_profile_action_set()
+             ->add_action_profile_actions()
+             ->mutable_action() = actions[j];
+      }
+      entries.push_back(entry);
+    }
+    entry = base;
+    entry.mutable_action()->set_action_profile_member_id(1);
+    entries.push_back(entry);
+  }
+  return entries;
+}
+
+TEST(GeneratedCodeTest, AgreesWithInterpreter) {
+  const ConstraintInfo& constraint_info = example::GetConstraintInfo();
+  for (const p4::v1::TableEntry& entry : TestEntries()) {
+    SCOPED_TRACE(entry.DebugString());
+    absl::StatusOr<std::string> expected =
+        ReasonEntryViolatesConstraint(entry, constraint_info);
+    absl::StatusOr<std::string> actual =
+        example::ReasonEntryViolatesConstraint(entry);
+    EXPECT_EQ(actual.status(), expected.status());
+    if (expected.ok() && actual.ok()) EXPECT_EQ(*actual, *expected);
+  }
+}
+
+TEST(GeneratedCodeTest, AcceptsSatisfyingEntries) {
+  p4::v1::TableEntry entry = ExactEntry(1, 0xffff);
+  *entry.mutable_action()->mutable_action() = Action(10, {{1, Bytes(7)}});
+  EXPECT_THAT(example::ReasonEntryViolatesConstraint(entry),
+              IsOkAndHolds(IsEmpty()));
+}
+
+TEST(GeneratedCodeTest, ExplainsViolations) {
+  EXPECT_THAT(example::ReasonEntryViolatesConstraint(ExactEntry(0, 1)),
+              IsOkAndHolds(HasSubstr("a != 0")));
+  p4::v1::TableEntry entry = ExactEntry(1, 1);
+  *entry.mutable_action()->mutable_action() = Action(10, {{1, Bytes(0)}});
+  EXPECT_THAT(example::ReasonEntryViolatesConstraint(entry),
+              IsOkAndHolds(HasSubstr("port != 0")));
+}
+
+}  // namespace
+}  // namespace p4_constraints
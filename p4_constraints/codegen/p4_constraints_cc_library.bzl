@@ -0,0 +1,93 @@
+# SPDX-FileCopyrightText: 2026 The P4-Constraints Authors
+#
+# SPDX-License-Identifier: Apache-2.0
+
+"""Bazel rule compiling the constraints of a P4 program to C++ ahead of time.
+
+Usage:
+```build
+    load(
+        "@p4_constraints//p4_constraints/codegen:p4_constraints_cc_library.bzl",
+        "p4_constraints_cc_library",
+    )
+
+    p4_constraints_cc_library(
+        name = "main_constraints",
+        p4info = "main.p4info.pb.txt",  # p4info.proto in text format
+        cc_namespace = "main::constraints",
+    )
+```
+This yields a `cc_library` with header `main_constraints.h` declaring
+```cpp
+    namespace main::constraints {
+    absl::StatusOr<std::string> ReasonEntryViolatesConstraint(
+        const p4::v1::TableEntry& entry);
+    const p4_constraints::ConstraintInfo& GetConstraintInfo();
+    }
+```
+See p4_constraints/codegen/cc_generator.h for details.
+"""
+
+load("@rules_cc//cc:cc_library.bzl", "cc_library")
+
+def p4_constraints_cc_library(
+        name,
+        p4info,
+        cc_namespace,
+        testonly = False,
+        visibility = None):
+    """Generates a C++ library checking the constraints in `p4info`.
+
+    Args:
+      name: Name of the cc_library. The generated files are `<name>.h` and
+        `<name>.cc`.
+      p4info: P4Info file in p4info.proto text format, e.g. generated by the
+        `p4_library` rule of p4c.
+      cc_namespace: C++ namespace of the generated code.
+      testonly: Whether the library is only used by tests.
+      visibility: Visibility of the cc_library.
+    """
+    generator = Label("//p4_constraints/cli:cc_generator")
+    header = name + ".h"
+    source = name + ".cc"
+    package = native.package_name()
+    header_path = package + "/" + header if package else header
+    native.genrule(
+        name = name + "_generate",
+        testonly = testonly,
+        srcs = [p4info],
+        outs = [header, source],
+        tools = [generator],
+        cmd = " ".join([
+            "$(execpath {generator})",
+            "--p4info=$(execpath {p4info})",
+            "--cc_namespace={cc_namespace}",
+            "--header_path={header_path}",
+            "--out_header=$(execpath {header})",
+            "--out_source=$(execpath {source})",
+        ]).format(
+            generator = generator,
+            p4info = p4info,
+            cc_namespace = cc_namespace,
+            header_path = header_path,
+            header = header,
+            source = source,
+        ),
+    )
+    cc_library(
+        name = name,
+        testonly = testonly,
+        visibility = visibility,
+        srcs = [source],
+        hdrs = [header],
+        deps = [
+            Label("//p4_constraints/backend:constraint_info"),
+            Label("//p4_constraints/backend:interpreter"),
+            Label("//p4_constraints/codegen:runtime"),
+            Label("@abseil-cpp//absl/log:check"),
+            Label("@abseil-cpp//absl/numeric:int128"),
+            Label("@abseil-cpp//absl/status:statusor"),
+            Label("@p4runtime//proto/p4/config/v1:p4info_cc_proto"),
+            Label("@p4runtime//proto/p4/v1:p4runtime_cc_proto"),
+        ],
+    )
@@ -0,0 +1,36 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+// Support routines for the code emitted by the C++ generator (see
+// cc_generator.h). Not intended for use by hand-written code.
+
+#ifndef P4_CONSTRAINTS_CODEGEN_RUNTIME_H_
+#define P4_CONSTRAINTS_CODEGEN_RUNTIME_H_
+
+#include <stdint.h>
+
+#include "absl/numeric/int128.h"
+#include "absl/strings/string_view.h"
+
+namespace p4_constraints {
+namespace codegen_runtime {
+
+// Parses the big-endian P4Runtime bytestring `bytes` into `value`, allowing for
+// leading zero-bytes like `ParseP4RTInteger` does. Returns false if the value
+// does not fit into `Value`, in which case the generated code leaves the entry
+// to the interpreter.
+template <typename Value>
+bool ParseUnsigned(absl::string_view bytes, Value& value) {
+  while (!bytes.empty() && bytes.front() == '\0') bytes.remove_prefix(1);
+  if (bytes.size() > sizeof(Value)) return false;
+  value = 0;
+  for (char byte : bytes) {
+    value = (value << 8) | Value(static_cast<uint8_t>(byte));
+  }
+  return true;
+}
+
+}  // namespace codegen_runtime
+}  // namespace p4_constraints
+
+#endif  // P4_CONSTRAINTS_CODEGEN_RUNTIME_H_
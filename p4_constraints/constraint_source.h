@@ -16,16 +16,70 @@
 #ifndef THIRD_PARTY_P4LANG_P4_CONSTRAINTS_P4_CONSTRAINTS_CONSTRAINT_SOURCE_H_
 #define THIRD_PARTY_P4LANG_P4_CONSTRAINTS_P4_CONSTRAINTS_CONSTRAINT_SOURCE_H_
 
+#include <stddef.h>
+
+#include <memory>
+#include <ostream>
 #include <string>
+#include <utility>
 
+#include "absl/strings/string_view.h"
 #include "p4_constraints/ast.pb.h"
 
 namespace p4_constraints {
 
+class QuoteIndex;  // See quote.h.
+
+// The text of a constraint. Immutable, and shared by copies, so that an index
+// of the text (see quote.h) can tell in constant time whether it still indexes
+// a given `ConstraintString`: it does iff they share the same buffer.
+class ConstraintString {
+ public:
+  ConstraintString() : ConstraintString(std::string()) {}
+  ConstraintString(std::string text)  // NOLINT: Implicit by design.
+      : text_(std::make_shared<const std::string>(std::move(text))) {}
+  ConstraintString(absl::string_view text)  // NOLINT: Implicit by design.
+      : ConstraintString(std::string(text)) {}
+  ConstraintString(const char* text)  // NOLINT: Implicit by design.
+      : ConstraintString(std::string(text)) {}
+
+  const std::string& str() const { return *text_; }
+  operator absl::string_view() const { return *text_; }  // NOLINT
+  const char* data() const { return text_->data(); }
+  size_t size() const { return text_->size(); }
+  bool empty() const { return text_->empty(); }
+
+  // Returns true iff `other` shares the buffer of this string, i.e. is a copy
+  // of it. Constant time.
+  bool SharesBufferWith(const ConstraintString& other) const {
+    return text_ == other.text_;
+  }
+
+  friend bool operator==(const ConstraintString& left,
+                         const ConstraintString& right) {
+    return left.str() == right.str();
+  }
+  friend bool operator!=(const ConstraintString& left,
+                         const ConstraintString& right) {
+    return !(left == right);
+  }
+  friend std::ostream& operator<<(std::ostream& out,
+                                  const ConstraintString& text) {
+    return out << text.str();
+  }
+
+ private:
+  // Never null.
+  std::shared_ptr<const std::string> text_;
+};
+
 // Convenient struct of source information for quoting.
 struct ConstraintSource {
-  std::string constraint_string;
+  ConstraintString constraint_string;
   ast::SourceLocation constraint_location;
+  // Speeds up quoting `constraint_string`, if not null and built for it or a
+  // copy of it; see `IndexConstraintSource`.
+  std::shared_ptr<const QuoteIndex> quote_index;
 };
 
 }  // namespace p4_constraints
@@ -32,7 +32,9 @@
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
+#include "google/protobuf/arena.h"
 #include "gutil/status.h"
+#include "p4_constraints/ast.h"
 #include "p4_constraints/ast.pb.h"
 #include "p4_constraints/big_int.h"
 #include "p4_constraints/frontend/constraint_kind.h"
@@ -220,11 +222,12 @@ absl::StatusOr<std::string> MacStringToByteString(
 
 // -- Auxiliary base constructors ----------------------------------------------
 
-ast::Expression LocatedExpression(const ast::SourceLocation& start_location,
-                                  const ast::SourceLocation& end_location) {
-  ast::Expression ast;
-  *ast.mutable_start_location() = start_location;
-  *ast.mutable_end_location() = end_location;
+ast::ExpressionPtr LocatedExpression(const ast::SourceLocation& start_location,
+                                     const ast::SourceLocation& end_location,
+                                     google::protobuf::Arena* arena) {
+  ast::ExpressionPtr ast = ast::NewExpression(arena);
+  *ast->mutable_start_location() = start_location;
+  *ast->mutable_end_location() = end_location;
   return ast;
 }
 
@@ -232,78 +235,84 @@ ast::Expression LocatedExpression(const ast::SourceLocation& start_location,
 
 // -- Public AST constructors --------------------------------------------------
 
-absl::StatusOr<ast::Expression> MakeBooleanConstant(const Token& boolean) {
+absl::StatusOr<ast::ExpressionPtr> MakeBooleanConstant(
+    const Token& boolean, google::protobuf::Arena* arena) {
   RET_CHECK(boolean.kind == Token::TRUE || boolean.kind == Token::FALSE)
       << "expected boolean, got " << boolean.kind;
-  ast::Expression ast =
-      LocatedExpression(boolean.start_location, boolean.end_location);
-  ast.set_boolean_constant(boolean.kind == Token::TRUE);
+  ast::ExpressionPtr ast = LocatedExpression(boolean.StartLocation(),
+                                             boolean.EndLocation(), arena);
+  ast->set_boolean_constant(boolean.kind == Token::TRUE);
   return ast;
 }
 
-absl::StatusOr<ast::Expression> MakeIntegerConstant(const Token& numeral) {
+absl::StatusOr<ast::ExpressionPtr> MakeIntegerConstant(
+    const Token& numeral, google::protobuf::Arena* arena) {
   ASSIGN_OR_RETURN(std::string numeral_str, ConvertNumeral(numeral));
-  ast::Expression ast =
-      LocatedExpression(numeral.start_location, numeral.end_location);
-  ast.set_integer_constant(numeral_str);
+  ast::ExpressionPtr ast = LocatedExpression(numeral.StartLocation(),
+                                             numeral.EndLocation(), arena);
+  ast->set_integer_constant(numeral_str);
   return ast;
 }
 
-absl::StatusOr<ast::Expression> MakeNetworkAddressIntegerConstant(
+absl::StatusOr<ast::ExpressionPtr> MakeNetworkAddressIntegerConstant(
     const absl::string_view& address_type,
     const absl::string_view& address_string,
     const ast::SourceLocation& start_location,
-    const ast::SourceLocation& end_location) {
+    const ast::SourceLocation& end_location, google::protobuf::Arena* arena) {
   std::string numeral_str;
   if (address_type == "ipv4") {
     ASSIGN_OR_RETURN(std::string ipv4_bits,
                      Ipv4StringToByteString(address_string));
     ASSIGN_OR_RETURN(numeral_str,
                      ConvertNumeral(Token(Token::BINARY, ipv4_bits,
-                                          start_location, end_location)));
+                                          /*start=*/{}, /*end=*/{})));
   } else if (address_type == "ipv6") {
     ASSIGN_OR_RETURN(std::string ipv6_bytes,
                      Ipv6StringToByteString(address_string));
     ASSIGN_OR_RETURN(numeral_str,
                      ConvertNumeral(Token(Token::BINARY, ipv6_bytes,
-                                          start_location, end_location)));
+                                          /*start=*/{}, /*end=*/{})));
   } else if (address_type == "mac") {
     ASSIGN_OR_RETURN(std::string mac_bytes,
                      MacStringToByteString(address_string));
     ASSIGN_OR_RETURN(numeral_str,
                      ConvertNumeral(Token(Token::BINARY, mac_bytes,
-                                          start_location, end_location)));
+                                          /*start=*/{}, /*end=*/{})));
   } else {
     return absl::InvalidArgumentError("Invalid network identifier");
   }
-  ast::Expression ast = LocatedExpression(start_location, end_location);
-  ast.set_integer_constant(numeral_str);
+  ast::ExpressionPtr ast =
+      LocatedExpression(start_location, end_location, arena);
+  ast->set_integer_constant(numeral_str);
   return ast;
 }
 
-absl::StatusOr<ast::Expression> MakeBooleanNegation(const Token& bang_token,
-                                                    ast::Expression operand) {
+absl::StatusOr<ast::ExpressionPtr> MakeBooleanNegation(
+    const Token& bang_token, ast::ExpressionPtr operand) {
   RET_CHECK_EQ(bang_token.kind, Token::BANG);
-  ast::Expression ast =
-      LocatedExpression(bang_token.start_location, operand.end_location());
-  *ast.mutable_boolean_negation() = std::move(operand);
+  ast::ExpressionPtr ast =
+      LocatedExpression(bang_token.StartLocation(), operand->end_location(),
+                        operand->GetArena());
+  ast->set_allocated_boolean_negation(operand.release());
   return ast;
 }
 
-absl::StatusOr<ast::Expression> MakeArithmeticNegation(
-    const Token& minus_token, ast::Expression operand) {
+absl::StatusOr<ast::ExpressionPtr> MakeArithmeticNegation(
+    const Token& minus_token, ast::ExpressionPtr operand) {
   RET_CHECK_EQ(minus_token.kind, Token::MINUS);
-  ast::Expression ast =
-      LocatedExpression(minus_token.start_location, operand.end_location());
-  *ast.mutable_arithmetic_negation() = std::move(operand);
+  ast::ExpressionPtr ast =
+      LocatedExpression(minus_token.StartLocation(), operand->end_location(),
+                        operand->GetArena());
+  ast->set_allocated_arithmetic_negation(operand.release());
   return ast;
 }
 
-absl::StatusOr<ast::Expression> MakeVariable(absl::Span<const Token> tokens,
-                                             ConstraintKind constraint_kind) {
+absl::StatusOr<ast::ExpressionPtr> MakeVariable(
+    absl::Span<const Token> tokens, ConstraintKind constraint_kind,
+    google::protobuf::Arena* arena) {
   RET_CHECK_GT(tokens.size(), 0);
-  ast::Expression ast = LocatedExpression(tokens.front().start_location,
-                                          tokens.back().end_location);
+  ast::ExpressionPtr ast = LocatedExpression(
+      tokens.front().StartLocation(), tokens.back().EndLocation(), arena);
   std::stringstream key_or_param{};
   for (int i = 0; i < tokens.size(); i++) {
     const Token& id = tokens[i];
@@ -321,11 +330,11 @@ absl::StatusOr<ast::Expression> MakeVariable(absl::Span<const Token> tokens,
   }
   switch (constraint_kind) {
     case ConstraintKind::kTableConstraint: {
-      ast.set_key(key_or_param.str());
+      ast->set_key(key_or_param.str());
       return ast;
     }
     case ConstraintKind::kActionConstraint: {
-      ast.set_action_parameter(key_or_param.str());
+      ast->set_action_parameter(key_or_param.str());
       return ast;
     }
   }
@@ -334,36 +343,38 @@ absl::StatusOr<ast::Expression> MakeVariable(absl::Span<const Token> tokens,
          << static_cast<int>(constraint_kind);
 }
 
-absl::StatusOr<ast::Expression> MakeAttributeAccess(
-    const Token& double_colon, const Token& attribute_name) {
-  ast::Expression ast = LocatedExpression(double_colon.start_location,
-                                          attribute_name.end_location);
-  ast.mutable_attribute_access()->set_attribute_name(attribute_name.text);
+absl::StatusOr<ast::ExpressionPtr> MakeAttributeAccess(
+    const Token& double_colon, const Token& attribute_name,
+    google::protobuf::Arena* arena) {
+  ast::ExpressionPtr ast = LocatedExpression(
+      double_colon.StartLocation(), attribute_name.EndLocation(), arena);
+  ast->mutable_attribute_access()->set_attribute_name(
+      std::string(attribute_name.text));
   return ast;
 }
 
-absl::StatusOr<ast::Expression> MakeBinaryExpression(const Token& binop_token,
-                                                     ast::Expression left,
-                                                     ast::Expression right) {
-  ast::Expression ast =
-      LocatedExpression(left.start_location(), right.end_location());
-  ast::BinaryExpression* binexpr = ast.mutable_binary_expression();
+absl::StatusOr<ast::ExpressionPtr> MakeBinaryExpression(
+    const Token& binop_token, ast::ExpressionPtr left,
+    ast::ExpressionPtr right) {
+  ast::ExpressionPtr ast = LocatedExpression(
+      left->start_location(), right->end_location(), left->GetArena());
+  ast::BinaryExpression* binexpr = ast->mutable_binary_expression();
 
   ASSIGN_OR_RETURN(ast::BinaryOperator binop,
                    ConvertBinaryOperator(binop_token.kind));
   binexpr->set_binop(binop);
-  *binexpr->mutable_left() = std::move(left);
-  *binexpr->mutable_right() = std::move(right);
+  binexpr->set_allocated_left(left.release());
+  binexpr->set_allocated_right(right.release());
   return ast;
 }
 
-absl::StatusOr<ast::Expression> MakeFieldAccess(ast::Expression expr,
-                                                const Token& field) {
+absl::StatusOr<ast::ExpressionPtr> MakeFieldAccess(ast::ExpressionPtr expr,
+                                                   const Token& field) {
   RET_CHECK_EQ(field.kind, Token::ID);
-  ast::Expression ast =
-      LocatedExpression(expr.start_location(), field.end_location);
-  *ast.mutable_field_access()->mutable_expr() = std::move(expr);
-  ast.mutable_field_access()->set_field(field.text);
+  ast::ExpressionPtr ast = LocatedExpression(
+      expr->start_location(), field.EndLocation(), expr->GetArena());
+  ast->mutable_field_access()->set_allocated_expr(expr.release());
+  ast->mutable_field_access()->set_field(std::string(field.text));
   return ast;
 }
 
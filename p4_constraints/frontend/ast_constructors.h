@@ -24,6 +24,8 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
+#include "google/protobuf/arena.h"
+#include "p4_constraints/ast.h"
 #include "p4_constraints/ast.pb.h"
 #include "p4_constraints/frontend/constraint_kind.h"
 #include "p4_constraints/frontend/token.h"
@@ -31,12 +33,18 @@
 namespace p4_constraints {
 namespace ast {
 
+// ASTs are allocated on the given `arena`, or on the heap if it is null. ASTs
+// with subexpressions are allocated alongside their subexpressions, which are
+// moved into them without copying (see `ast::ExpressionPtr`).
+
 // Returns an AST given a TRUE or FALSE token, or an error Status otherwise.
-absl::StatusOr<ast::Expression> MakeBooleanConstant(const Token& boolean);
+absl::StatusOr<ast::ExpressionPtr> MakeBooleanConstant(
+    const Token& boolean, google::protobuf::Arena* arena);
 
 // Returns an AST given a BINARY/OCTARY/DECIMAL/HEXADEC token, or an error
 // Status otherwise.
-absl::StatusOr<ast::Expression> MakeIntegerConstant(const Token& numeral);
+absl::StatusOr<ast::ExpressionPtr> MakeIntegerConstant(
+    const Token& numeral, google::protobuf::Arena* arena);
 
 // Returns an AST `a` such that `a.integer_constant() == net(address)`. Valid
 // values for address_type (`net`) are "ipv4", "ipv6", or "mac". Returns error
@@ -44,42 +52,45 @@ absl::StatusOr<ast::Expression> MakeIntegerConstant(const Token& numeral);
 // or MAC address string. The start_location of the AST is the ID token's start
 // location and the end location of the AST is the RPAR token's end location as
 // the Tokens (ID, LPAR, STRING, RPAR) are expressed as an integer constant.
-absl::StatusOr<ast::Expression> MakeNetworkAddressIntegerConstant(
+absl::StatusOr<ast::ExpressionPtr> MakeNetworkAddressIntegerConstant(
     const absl::string_view& address_type,
     const absl::string_view& address_string,
     const ast::SourceLocation& start_location,
-    const ast::SourceLocation& end_location);
+    const ast::SourceLocation& end_location, google::protobuf::Arena* arena);
 
 // Returns an AST for table entry attribute access (such as ::priority).
-absl::StatusOr<ast::Expression> MakeAttributeAccess(
-    const Token& double_colon, const Token& attribute_name);
+absl::StatusOr<ast::ExpressionPtr> MakeAttributeAccess(
+    const Token& double_colon, const Token& attribute_name,
+    google::protobuf::Arena* arena);
 
 // Returns an AST `a` such that `a.param() == "id1id2...idn"` (if parsing action
 // parameters) and `a.key() == "id1.id2...idn"` (if parsing keys) given ID
 // tokens `{t1, ..., tn}` such that `idi == ti.text`, or an error Status
 // otherwise.
-absl::StatusOr<ast::Expression> MakeVariable(absl::Span<const Token> tokens,
-                                             ConstraintKind constraint_kind);
+absl::StatusOr<ast::ExpressionPtr> MakeVariable(
+    absl::Span<const Token> tokens, ConstraintKind constraint_kind,
+    google::protobuf::Arena* arena);
 
 // Returns an AST (with the given operand) when given a BANG ('!') token,
 // or an error Status otherwise.
-absl::StatusOr<ast::Expression> MakeBooleanNegation(const Token& bang_token,
-                                                    ast::Expression operand);
+absl::StatusOr<ast::ExpressionPtr> MakeBooleanNegation(
+    const Token& bang_token, ast::ExpressionPtr operand);
 
 // Returns an AST (with the given operand) when given a MINUS ('-') token,
 // or an error Status otherwise.
-absl::StatusOr<ast::Expression> MakeArithmeticNegation(const Token& minus_token,
-                                                       ast::Expression operand);
+absl::StatusOr<ast::ExpressionPtr> MakeArithmeticNegation(
+    const Token& minus_token, ast::ExpressionPtr operand);
 
 // Returns an AST (with the given operands) when given  a AND, OR, or IMPLIES
-// token, or an error Status otherwise.
-absl::StatusOr<ast::Expression> MakeBinaryExpression(const Token& binop_token,
-                                                     ast::Expression left,
-                                                     ast::Expression right);
+// token, or an error Status otherwise. The operands must live on the same
+// arena.
+absl::StatusOr<ast::ExpressionPtr> MakeBinaryExpression(
+    const Token& binop_token, ast::ExpressionPtr left,
+    ast::ExpressionPtr right);
 
 // Returns an AST when given an ID token `field`, or an error Status otherwise.
-absl::StatusOr<ast::Expression> MakeFieldAccess(ast::Expression expr,
-                                                const Token& field);
+absl::StatusOr<ast::ExpressionPtr> MakeFieldAccess(ast::ExpressionPtr expr,
+                                                   const Token& field);
 
 }  // namespace ast
 }  // namespace p4_constraints
@@ -15,197 +15,323 @@
 
 #include "p4_constraints/frontend/lexer.h"
 
-#include <map>
-#include <optional>
-#include <string>
-#include <utility>
+#include <stddef.h>
+
 #include <vector>
 
-#include "absl/log/check.h"
-#include "absl/log/log.h"
+#include "absl/strings/match.h"
 #include "absl/strings/string_view.h"
-#include "p4_constraints/ast.h"
 #include "p4_constraints/ast.pb.h"
 #include "p4_constraints/constraint_source.h"
 #include "p4_constraints/frontend/token.h"
-#include "re2/re2.h"
 
 namespace p4_constraints {
 
 namespace {
 
+bool IsContinuationByte(unsigned char c) { return (c & 0xC0) == 0x80; }
+
+// Returns the number of bytes of the UTF-8 encoded character at the beginning
+// of `input`, or 0 if `input` does not begin with one. Matches RE2, which the
+// lexer used historically and which is deliberately lenient for negated
+// character classes: it accepts any lead byte in [C2-F4] followed by the right
+// number of continuation bytes, including some overlong encodings and code
+// points past U+10FFFF.
+size_t Utf8CharLength(absl::string_view input) {
+  const unsigned char c = input[0];
+  size_t length;
+  if (c < 0x80) {
+    return 1;
+  } else if (c >= 0xC2 && c <= 0xDF) {
+    length = 2;
+  } else if (c >= 0xE0 && c <= 0xEF) {
+    length = 3;
+  } else if (c >= 0xF0 && c <= 0xF4) {
+    length = 4;
+  } else {
+    return 0;
+  }
+  if (input.size() < length) return 0;
+  for (size_t i = 1; i < length; ++i) {
+    if (!IsContinuationByte(input[i])) return 0;
+  }
+  return length;
+}
+
+// Returns the length of the longest prefix of `input` consisting of valid UTF-8
+// encoded characters other than the ASCII characters in `excluded`.
+size_t SpanUtf8Excluding(absl::string_view input, absl::string_view excluded) {
+  size_t length = 0;
+  while (length < input.size()) {
+    const char c = input[length];
+    if (excluded.find(c) != absl::string_view::npos) break;
+    const size_t char_length = Utf8CharLength(input.substr(length));
+    if (char_length == 0) break;
+    length += char_length;
+  }
+  return length;
+}
+
+// Returns the length of the longest prefix of `input` whose characters all
+// satisfy `predicate`.
+template <class Predicate>
+size_t Span(absl::string_view input, Predicate predicate) {
+  size_t length = 0;
+  while (length < input.size() && predicate(input[length])) ++length;
+  return length;
+}
+
+bool IsBinaryDigit(char c) { return c == '0' || c == '1'; }
+bool IsOctalDigit(char c) { return c >= '0' && c <= '7'; }
+bool IsDecimalDigit(char c) { return c >= '0' && c <= '9'; }
+bool IsHexDigit(char c) {
+  return IsDecimalDigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+bool IsIdStart(char c) {
+  return c == '_' || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+bool IsIdChar(char c) { return IsIdStart(c) || IsDecimalDigit(c); }
+
+// Returns the length of the newline at the beginning of `input`, or 0 if
+// `input` does not begin with a newline ("\r\n", "\r", or "\n").
+size_t NewlineLength(absl::string_view input) {
+  if (input.empty()) return 0;
+  if (input[0] == '\n') return 1;
+  if (input[0] != '\r') return 0;
+  return input.size() > 1 && input[1] == '\n' ? 2 : 1;
+}
+
+// The position of the lexer within the input.
+struct Cursor {
+  size_t offset;
+  int line;
+  int column;
+};
+
 // Consumes characters from the input until the string "*/" appears or the input
-// is exhausted, updating the given SourceLocation accordingly.
-void SwallowMultiLineComment(absl::string_view* input,
-                             ast::SourceLocation* location) {
-  static const LazyRE2 kCommentRegexp{
-      // Important: the ordering matters, since the first matching case applies!
-      "(\\*/)"                // End of comment ('*/').
-      "|([^\\n\\r\\*]+|\\*)"  // Comment fragment; safe to accept '*' since '*/'
-                              // (first case) did not match.
-      "|((?:\\r\\n?)|\\n)"    // Newline.
-  };
-  absl::string_view end_of_comment = "";
-  absl::string_view comment = "";
-  absl::string_view newline = "";
-  while (RE2::Consume(input, *kCommentRegexp, &end_of_comment, &comment,
-                      &newline)) {
-    if (!end_of_comment.empty()) {
-      location->set_column(location->column() + end_of_comment.size());
-      return;
-    } else if (!comment.empty()) {
-      location->set_column(location->column() + comment.size());
-    } else if (!newline.empty()) {
-      location->set_line(location->line() + 1);
-      location->set_column(0);
+// is exhausted, updating the given cursor accordingly. Stops early, before the
+// first byte that is not valid UTF-8, which the caller then rejects.
+void SwallowMultiLineComment(absl::string_view input, Cursor& cursor) {
+  while (cursor.offset < input.size()) {
+    const absl::string_view rest = input.substr(cursor.offset);
+    if (const size_t newline = NewlineLength(rest); newline > 0) {
+      cursor.offset += newline;
+      cursor.line += 1;
+      cursor.column = 0;
+    } else if (rest[0] == '*') {
+      const size_t length = rest.size() > 1 && rest[1] == '/' ? 2 : 1;
+      cursor.offset += length;
+      cursor.column += length;
+      if (length == 2) return;
     } else {
-      LOG(ERROR) << "impossible: no capture group matched in string: " << input;
+      const size_t length = SpanUtf8Excluding(rest, "\r\n*");
+      if (length == 0) return;
+      cursor.offset += length;
+      cursor.column += length;
     }
   }
-  DCHECK(input->empty());
   // TODO(smolkaj): We tolerate unterminated comments that run until the end of
   // the input. It would be cleaner to report a lex error but this would
   // require a redesign since the lexer is currently pure, i.e. not in the
   // StatusOr monad. Not worth the effort at the moment.
 }
 
-// Specifies what constitutes a token.
-// Important: the ordering matters, since the first matching case applies!
-const LazyRE2 kTokenPattern{
-    // clang-format off
-    "(?P<whitespace>[ \\t]+)"
-    "|(?P<newline>(?:\\r\\n?)|\\n)"
-    "|(?P<comment>//[^\\r\\n]*)"
-    "|(?P<begin_multiline_comment>/\\*)"
-    // Keywords.
-    "|(?P<keyword>"
-      "true|false|&&"
-      "|\\|\\|"
-      "|->"
-      "|::"
-      "|==|!=|>=|<="
-      "|[!()><.;\\-]"
-    ")"
-    // IDs.
-    "|(?P<id>[_a-zA-Z][_a-zA-Z0-9]*)"
-    // Numerals.
-    "|(?:0[bB])" "(?P<binary>[0-1]+)"
-    "|(?:0[oO])" "(?P<octary>[0-7]+)"
-    "|(?:0[xX])" "(?P<hexadec>[0-9a-fA-F]+)"
-    "|(?:0[dD])?" "(?P<decimal>[0-9]+)"
-    // Strings.
-    "|(?P<string>'([^']*)')"
-    // clang-format on
-};
-
-// Access capture group in kTokenPattern by name.
-absl::string_view CaptureByName(
-    const std::string& group_name,
-    const std::vector<absl::string_view>& captures) {
-  auto iter = kTokenPattern->NamedCapturingGroups().find(group_name);
-  if (iter != kTokenPattern->NamedCapturingGroups().end()) {
-    return captures[iter->second];
-  } else {
-    LOG(ERROR) << "non-existent capture group: " << group_name;
-    return "";
-  }
-}
-
 }  // namespace
 
 std::vector<Token> Tokenize(const ConstraintSource& constraint) {
   // Output.
   std::vector<Token> tokens;
-  // Input
-  absl::string_view input = constraint.constraint_string;
+  // Input.
+  const absl::string_view input = constraint.constraint_string;
   // Location tracking.
-  ast::SourceLocation start_location = constraint.constraint_location;
-  ast::SourceLocation current_location = start_location;
-
-  // +1 because there is an implicit capturing group at index 0 corresponding to
-  // the entire regexp.
-  const int capture_count = kTokenPattern->NumberOfCapturingGroups() + 1;
-
-  // We will have RE2 store the strings matched by each capturing group here.
-  std::vector<absl::string_view> captures(capture_count);
-
-  while (kTokenPattern->Match(input, 0, input.size(), RE2::Anchor::ANCHOR_START,
-                              captures.data(), capture_count)) {
-    // The next token starts at the current location.
-    DCHECK_EQ(start_location, current_location) << "loop invariant violated";
-
-    // Consume matched input (aka "lexeme").
-    std::string lexeme = std::string(captures[0]);
-    input.remove_prefix(lexeme.length());
+  Cursor cursor{
+      .offset = 0,
+      .line = constraint.constraint_location.line(),
+      .column = constraint.constraint_location.column(),
+  };
+  auto position_at = [&](int column) {
+    return Token::Position{.line = cursor.line, .column = column};
+  };
+  const ast::SourceLocation* const origin = &constraint.constraint_location;
 
-    // Advance location.
-    current_location.set_column(current_location.column() + lexeme.length());
+  while (cursor.offset < input.size()) {
+    const absl::string_view rest = input.substr(cursor.offset);
+    const char c = rest[0];
+    const char next = rest.size() > 1 ? rest[1] : '\0';
 
-    // Which kind of token did we find?
-    Token::Kind kind;
-    if (!CaptureByName("whitespace", captures).empty() ||
-        !CaptureByName("comment", captures).empty()) {
-      start_location = current_location;
+    // Whitespace, newlines, and comments.
+    if (c == ' ' || c == '\t') {
+      const size_t length =
+          Span(rest, [](char ch) { return ch == ' ' || ch == '\t'; });
+      cursor.offset += length;
+      cursor.column += length;
       continue;
-    } else if (!CaptureByName("newline", captures).empty()) {
-      current_location.set_line(current_location.line() + 1);
-      current_location.set_column(0);
-      start_location = current_location;
+    }
+    if (const size_t newline = NewlineLength(rest); newline > 0) {
+      cursor.offset += newline;
+      cursor.line += 1;
+      cursor.column = 0;
       continue;
-    } else if (!CaptureByName("begin_multiline_comment", captures).empty()) {
-      SwallowMultiLineComment(&input, &current_location);
-      start_location = current_location;
+    }
+    if (c == '/' && next == '/') {
+      const size_t length = 2 + SpanUtf8Excluding(rest.substr(2), "\r\n");
+      cursor.offset += length;
+      cursor.column += length;
       continue;
-    } else if (!CaptureByName("keyword", captures).empty()) {
-      kind = Token::KeywordToKind(lexeme).value_or(Token::UNEXPECTED_CHAR);
-      if (kind == Token::UNEXPECTED_CHAR)
-        LOG(ERROR)
-            << "keyword " << lexeme
-            << " recognized by lexer, but unknown to Token::KeywordToKind";
-    } else if (!CaptureByName("id", captures).empty()) {
-      kind = Token::ID;
-      // For numerals, update lexeme to exclude base prefix (e.g., "0b")
-    } else if (!CaptureByName("binary", captures).empty()) {
-      // Update lexeme to exclude base prefix.
-      lexeme = std::string(CaptureByName("binary", captures));
-      kind = Token::BINARY;
-    } else if (!CaptureByName("octary", captures).empty()) {
-      // Update lexeme to exclude base prefix.
-      lexeme = std::string(CaptureByName("octary", captures));
-      kind = Token::OCTARY;
-    } else if (!CaptureByName("decimal", captures).empty()) {
-      // Update lexeme to exclude base prefix.
-      lexeme = std::string(CaptureByName("decimal", captures));
-      kind = Token::DECIMAL;
-    } else if (!CaptureByName("hexadec", captures).empty()) {
-      // Update lexeme to exclude base prefix.
-      lexeme = std::string(CaptureByName("hexadec", captures));
-      kind = Token::HEXADEC;
-    } else if (!CaptureByName("string", captures).empty()) {
-      lexeme = std::string(CaptureByName("string", captures));
-      lexeme = lexeme.substr(1, lexeme.size() - 2);
-      kind = Token::STRING;
-    } else {
-      LOG(ERROR) << "impossible: no capture group matched in string: "
-                 << lexeme;
-      kind = Token::UNEXPECTED_CHAR;
     }
-    tokens.push_back(Token(kind, lexeme, start_location, current_location));
-    // Advance start location.
-    start_location = current_location;
+    if (c == '/' && next == '*') {
+      cursor.offset += 2;
+      cursor.column += 2;
+      SwallowMultiLineComment(input, cursor);
+      continue;
+    }
+
+    // Tokens. The lexeme comprises the first `length` characters of `rest`;
+    // the token's text excludes the first `prefix` and last `suffix` of them
+    // (i.e., numeral prefixes and quotes).
+    Token::Kind kind = Token::UNEXPECTED_CHAR;
+    size_t length = 1;
+    size_t prefix = 0;
+    size_t suffix = 0;
+    switch (c) {
+      case '!':
+        if (next == '=') {
+          kind = Token::NE;
+          length = 2;
+        } else {
+          kind = Token::BANG;
+        }
+        break;
+      case '&':
+        if (next == '&') {
+          kind = Token::AND;
+          length = 2;
+        }
+        break;
+      case '|':
+        if (next == '|') {
+          kind = Token::OR;
+          length = 2;
+        }
+        break;
+      case '-':
+        if (next == '>') {
+          kind = Token::IMPLIES;
+          length = 2;
+        } else {
+          kind = Token::MINUS;
+        }
+        break;
+      case ':':
+        if (next == ':') {
+          kind = Token::DOUBLE_COLON;
+          length = 2;
+        }
+        break;
+      case '=':
+        if (next == '=') {
+          kind = Token::EQ;
+          length = 2;
+        }
+        break;
+      case '>':
+        if (next == '=') {
+          kind = Token::GE;
+          length = 2;
+        } else {
+          kind = Token::GT;
+        }
+        break;
+      case '<':
+        if (next == '=') {
+          kind = Token::LE;
+          length = 2;
+        } else {
+          kind = Token::LT;
+        }
+        break;
+      case '(':
+        kind = Token::LPAR;
+        break;
+      case ')':
+        kind = Token::RPAR;
+        break;
+      case '.':
+        kind = Token::DOT;
+        break;
+      case ';':
+        kind = Token::SEMICOLON;
+        break;
+      case '\'': {
+        // Unterminated strings are unexpected characters.
+        const size_t content = SpanUtf8Excluding(rest.substr(1), "'");
+        if (content + 1 < rest.size() && rest[content + 1] == '\'') {
+          kind = Token::STRING;
+          length = content + 2;
+          prefix = suffix = 1;
+        }
+        break;
+      }
+      default:
+        // Keywords take precedence over IDs, even if they are a proper prefix
+        // of the ID: "trueish" is lexed as TRUE, ID("ish").
+        if (absl::StartsWith(rest, "true")) {
+          kind = Token::TRUE;
+          length = 4;
+        } else if (absl::StartsWith(rest, "false")) {
+          kind = Token::FALSE;
+          length = 5;
+        } else if (IsIdStart(c)) {
+          kind = Token::ID;
+          length = Span(rest, IsIdChar);
+        } else if (IsDecimalDigit(c)) {
+          // A base prefix that is not followed by a digit of its base is not a
+          // prefix: "0b2" is lexed as DECIMAL("0"), ID("b2").
+          const absl::string_view digits = absl::ClippedSubstr(rest, 2);
+          size_t num_digits = 0;
+          kind = Token::DECIMAL;
+          if (c == '0' && (next == 'b' || next == 'B')) {
+            kind = Token::BINARY;
+            num_digits = Span(digits, IsBinaryDigit);
+          } else if (c == '0' && (next == 'o' || next == 'O')) {
+            kind = Token::OCTARY;
+            num_digits = Span(digits, IsOctalDigit);
+          } else if (c == '0' && (next == 'x' || next == 'X')) {
+            kind = Token::HEXADEC;
+            num_digits = Span(digits, IsHexDigit);
+          } else if (c == '0' && (next == 'd' || next == 'D')) {
+            num_digits = Span(digits, IsDecimalDigit);
+          }
+          if (num_digits > 0) {
+            length = 2 + num_digits;
+            prefix = 2;
+          } else {
+            kind = Token::DECIMAL;
+            length = Span(rest, IsDecimalDigit);
+          }
+        }
+        break;
+    }
+    if (kind == Token::UNEXPECTED_CHAR) break;
+
+    const int start_column = cursor.column;
+    cursor.offset += length;
+    cursor.column += length;
+    tokens.push_back(Token(kind, rest.substr(prefix, length - prefix - suffix),
+                           position_at(start_column),
+                           position_at(cursor.column), origin));
   }
 
-  // No match - input does no longer begin with a token.
-  if (input.empty()) {
-    tokens.push_back(
-        Token(Token::END_OF_INPUT, "", start_location, current_location));
+  if (cursor.offset == input.size()) {
+    tokens.push_back(Token(Token::END_OF_INPUT, input.substr(cursor.offset),
+                           position_at(cursor.column),
+                           position_at(cursor.column), origin));
   } else {
     // Advance location by one column to make the location interval non-empty.
-    current_location.set_column(current_location.column() + 1);
-    // TODO(smolkaj): We could do a better job reporting the precise location of
-    // the first unexpected character here, see "Known limitation" in lexer.h.
-    tokens.push_back(Token(Token::UNEXPECTED_CHAR, {input[0]}, start_location,
-                           current_location));
+    tokens.push_back(Token(Token::UNEXPECTED_CHAR,
+                           input.substr(cursor.offset, 1),
+                           position_at(cursor.column),
+                           position_at(cursor.column + 1), origin));
   }
 
   return tokens;
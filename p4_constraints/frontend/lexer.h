@@ -29,10 +29,10 @@
 // pointing at '|', as indicated above. It would be better to point at '&',
 // since replacing '&' with '|' makes the input lexable.
 //
-// This is due to a limitation of RE2 (see yaqs/6274189471383552), which cannot
-// compute the prefix-closure of a given regexp for us currently. This could be
-// easily fixed by hard-coding the prefix closure by hand, or better, submit a
-// pull request to RE2 -- but currently this seems not worth the effort.
+// This behavior is inherited from the original RE2-based lexer (see
+// regexp_lexer.h), which the hand-written lexer reproduces exactly, token by
+// token and location by location. It could now be fixed easily, but would
+// change the error messages users see.
 
 #ifndef P4_CONSTRAINTS_FRONTEND_LEXER_H_
 #define P4_CONSTRAINTS_FRONTEND_LEXER_H_
@@ -49,6 +49,9 @@ namespace p4_constraints {
 // function is total; syntax errors are signaled by emitting an UNEXPECTED_CHAR
 // token. The final token in the returned token sequence is guaranteed to be an
 // END_OF_INPUT or UNEXPECTED_CHAR token.
+//
+// The returned tokens point into `constraint` (see `Token`), which must outlive
+// them.
 std::vector<Token> Tokenize(const ConstraintSource& constraint);
 
 }  // namespace p4_constraints
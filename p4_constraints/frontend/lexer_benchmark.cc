@@ -0,0 +1,68 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+// Compares the hand-written lexer against the original RE2-based lexer on
+// SAI-style ACL table constraints of increasing size.
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "p4_constraints/ast.pb.h"
+#include "p4_constraints/constraint_source.h"
+#include "p4_constraints/frontend/lexer.h"
+#include "p4_constraints/frontend/regexp_lexer.h"
+#include "p4_constraints/frontend/token.h"
+
+namespace p4_constraints {
+namespace {
+
+// Modeled after the ACL tables of SAI P4.
+constexpr char kAclConstraint[] = R"(
+  // Only allow IP field matches for IP packets.
+  dst_ip::mask != 0 -> is_ipv4 == 1;
+  ttl::mask != 0 -> (is_ip == 1 || is_ipv4 == 1 || is_ipv6 == 1);
+  /* Only allow l4_dst_port matches for TCP/UDP packets. */
+  l4_dst_port::mask != 0 -> (ip_protocol::mask == 0xff &&
+                             (ip_protocol::value == 6 ||
+                              ip_protocol::value == 0d17));
+  dst_mac::mask == 0 || dst_mac == mac('00:11:22:33:44:55');
+  ::priority > 0 && ::priority <= 0x7fffffff;
+)";
+
+// Returns a constraint consisting of `copies` copies of `kAclConstraint`.
+ConstraintSource MakeConstraint(int copies) {
+  std::string constraint;
+  for (int i = 0; i < copies; ++i) absl::StrAppend(&constraint, kAclConstraint);
+  ConstraintSource source{.constraint_string = std::move(constraint)};
+  source.constraint_location.set_table_name("acl_table");
+  return source;
+}
+
+void BM_Tokenize(benchmark::State& state) {
+  const ConstraintSource source = MakeConstraint(state.range(0));
+  for (auto _ : state) {
+    std::vector<Token> tokens = Tokenize(source);
+    benchmark::DoNotOptimize(tokens);
+  }
+  state.SetBytesProcessed(state.iterations() *
+                          source.constraint_string.size());
+}
+BENCHMARK(BM_Tokenize)->Arg(1)->Arg(100);
+
+void BM_TokenizeWithRegexp(benchmark::State& state) {
+  const ConstraintSource source = MakeConstraint(state.range(0));
+  for (auto _ : state) {
+    std::vector<Token> tokens = TokenizeWithRegexp(source);
+    benchmark::DoNotOptimize(tokens);
+  }
+  state.SetBytesProcessed(state.iterations() *
+                          source.constraint_string.size());
+}
+BENCHMARK(BM_TokenizeWithRegexp)->Arg(1)->Arg(100);
+
+}  // namespace
+}  // namespace p4_constraints
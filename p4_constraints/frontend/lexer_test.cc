@@ -18,6 +18,8 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <iterator>
+#include <random>
 #include <sstream>
 #include <string>
 #include <utility>
@@ -25,6 +27,7 @@
 
 #include "p4_constraints/ast.pb.h"
 #include "p4_constraints/constraint_source.h"
+#include "p4_constraints/frontend/regexp_lexer.h"
 #include "p4_constraints/frontend/token.h"
 
 namespace p4_constraints {
@@ -301,10 +304,12 @@ TEST(LexerTest, CommentsAreLexedCorrectly) {
 }
 
 TEST(LexerTest, TokenizeAnEmptyString) {
-  std::vector<Token> empty_str_tokens = Tokenize({
+  // Tokens point into their source, so it must outlive them.
+  const ConstraintSource source{
       .constraint_string = "''",
       .constraint_location = ast::SourceLocation(),
-  });
+  };
+  std::vector<Token> empty_str_tokens = Tokenize(source);
   EXPECT_THAT(GetTokenKinds(empty_str_tokens),
               ElementsAre(Token::STRING, Token::END_OF_INPUT));
   EXPECT_THAT(empty_str_tokens[0].text, "");
@@ -320,10 +325,11 @@ TEST(LexerTest, TokenizeAnEmptyStringWithADoubleQuoteInMiddle) {
 }
 
 TEST(LexerTest, TokenizeString) {
-  auto str_tokens = Tokenize({
+  const ConstraintSource source{
       .constraint_string = "'192.168.2.1'",
       .constraint_location = ast::SourceLocation(),
-  });
+  };
+  auto str_tokens = Tokenize(source);
   EXPECT_THAT(GetTokenKinds(str_tokens),
               testing::ElementsAre(Token::STRING, Token::END_OF_INPUT));
   EXPECT_THAT(str_tokens[0].text, "192.168.2.1");
@@ -369,4 +375,100 @@ TEST(LexerTest, TokenizeIPv4ReverseMixedQuoteString) {
       testing::ElementsAre(Token::ID, Token::LPAR, Token::UNEXPECTED_CHAR));
 }
 
+// Differential tests against the original RE2-based lexer, which the lexer must
+// reproduce exactly.
+
+// Expects that `Tokenize` and `TokenizeWithRegexp` agree on `input`.
+void ExpectSameTokensAsRegexpLexer(const std::string& input) {
+  ast::SourceLocation location;
+  location.set_file_path("file.p4");
+  location.set_line(7);
+  location.set_column(3);
+  const ConstraintSource source{
+      .constraint_string = input,
+      .constraint_location = location,
+  };
+  const std::vector<Token> expected = TokenizeWithRegexp(source);
+  const std::vector<Token> actual = Tokenize(source);
+  ASSERT_EQ(actual.size(), expected.size()) << "input: '" << input << "'";
+  for (int i = 0; i < expected.size(); ++i) {
+    SCOPED_TRACE(testing::Message()
+                 << "token " << i << " of input '" << input << "'");
+    EXPECT_EQ(actual[i].kind, expected[i].kind);
+    EXPECT_EQ(actual[i].text, expected[i].text);
+    EXPECT_EQ(actual[i].StartLocation().DebugString(),
+              expected[i].StartLocation().DebugString());
+    EXPECT_EQ(actual[i].EndLocation().DebugString(),
+              expected[i].EndLocation().DebugString());
+    // The text must be a slice of the source.
+    EXPECT_GE(actual[i].text.data(), source.constraint_string.data());
+    EXPECT_LE(actual[i].text.data() + actual[i].text.size(),
+              source.constraint_string.data() +
+                  source.constraint_string.size());
+  }
+}
+
+TEST(LexerTest, AgreesWithRegexpLexerOnEdgeCases) {
+  const std::string tests[] = {
+      "",
+      " \t ",
+      "trueish falsey true_ false0",
+      "a::mask != 0 -> b == 1; ::priority > 0",
+      "!!=!===>>=<<=--->&&&|||:::",
+      "0b 0b2 0b012 0B1 0o 0o8 0O17 0x 0xg 0XfF 0d 0df 0D09 00 0d0d0",
+      "x\ry\r\nz\n\rw\n\n",
+      "// comment\ntrue // trailing\r\nfalse //",
+      "/* multi\r\n * line */ true /**/ false /*** / ***/ x",
+      "/* unterminated\n comment",
+      "'' 'string' 'with \n newline' 'unterminated",
+      "ipv4('192.168.2.1') ipv6('::1') mac('00:11:22:33:44:55')",
+      "// \xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80\ntrue",
+      "/* \xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80 */ true",
+      "'\xc3\xa9\xe2\x82\xac' x",
+      "\xc3\xa9",
+      "// \xc0\x80 \xc1\xbf overlong",
+      "// \xe0\x80\x80 \xf0\x80\x80\x80 overlong",
+      "// \xed\xa0\x80 surrogate",
+      "// \xf4\x90\x80\x80 out of range",
+      "// \xf5\x80\x80\x80 \x80 invalid",
+      "// \xe2\x82 truncated",
+      "'\xff'",
+      "@ true",
+      "true |& false",
+      "x /",
+      std::string("a\0b", 3),
+  };
+  for (const std::string& input : tests) {
+    ExpectSameTokensAsRegexpLexer(input);
+  }
+}
+
+TEST(LexerTest, AgreesWithRegexpLexerOnRandomInputs) {
+  // Fragments that exercise every rule of the lexer and their interactions.
+  const std::string kFragments[] = {
+      "true", "false", "tru", "t", "f", "_", "x", "id_0", "0", "1", "7",
+      "9", "a", "F", "g", "0b", "0B", "0o", "0O", "0x", "0X", "0d", "0D",
+      "!", "=", "&", "|", "-", ">", "<", ":", ".", ";", "(", ")", "'",
+      "/", "*", "//", "/*", "*/", " ", "\t", "\r", "\n", "\r\n",
+      "\xc3\xa9", "\xe2\x82\xac", "\xf0\x9f\x98\x80", "@", "\"",
+  };
+  // Invalid UTF-8 is only generated outside of multiline comments, which the
+  // RE2-based lexer does not support.
+  const std::string kInvalidUtf8[] = {"\xff", "\xc3", "\xc0\x80"};
+  std::mt19937 rng(/*seed=*/0);
+  std::uniform_int_distribution<int> num_fragments(0, 20);
+  std::uniform_int_distribution<int> fragment(0, std::size(kFragments) - 1);
+  std::uniform_int_distribution<int> invalid(0, std::size(kInvalidUtf8) - 1);
+  for (int i = 0; i < 10000; ++i) {
+    std::string input;
+    for (int n = num_fragments(rng); n > 0; --n) {
+      input += kFragments[fragment(rng)];
+    }
+    ExpectSameTokensAsRegexpLexer(input);
+    if (input.find("/*") == std::string::npos) {
+      ExpectSameTokensAsRegexpLexer(input + kInvalidUtf8[invalid(rng)]);
+    }
+  }
+}
+
 }  // namespace p4_constraints
@@ -24,7 +24,9 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "google/protobuf/arena.h"
 #include "gutil/status.h"
+#include "p4_constraints/ast.h"
 #include "p4_constraints/ast.pb.h"
 #include "p4_constraints/constraint_source.h"
 #include "p4_constraints/frontend/ast_constructors.h"
@@ -38,6 +40,7 @@ namespace p4_constraints {
 namespace {
 
 using ::p4_constraints::ast::Expression;
+using ::p4_constraints::ast::ExpressionPtr;
 using ::p4_constraints::ast::SourceLocation;
 
 // -- Infinite token stream ----------------------------------------------------
@@ -65,9 +68,9 @@ class TokenStream {
 Token TokenStream::Peek() const {
   if (index_ < tokens_.size()) return tokens_[index_];
   // If we have exhausted all proper tokens, emit END_OF_INPUT token.
-  ast::SourceLocation eof_loc =
-      tokens_.empty() ? ast::SourceLocation() : tokens_.back().end_location;
-  return Token(Token::END_OF_INPUT, "", eof_loc, eof_loc);
+  if (tokens_.empty()) return Token(Token::END_OF_INPUT, "", {}, {});
+  const Token& last = tokens_.back();
+  return Token(Token::END_OF_INPUT, "", last.end, last.end, last.origin);
 }
 
 Token TokenStream::Next() {
@@ -152,7 +155,7 @@ gutil::StatusBuilder ParseError(const ConstraintSource& source,
 }
 
 gutil::StatusBuilder ParseError(Token token, const ConstraintSource& source) {
-  return ParseError(source, token.start_location, token.end_location);
+  return ParseError(source, token.StartLocation(), token.EndLocation());
 }
 
 // Returns an error status indicating that the given token came as a surprise,
@@ -234,23 +237,25 @@ absl::StatusOr<Token> ExpectTokenKind(Token::Kind kind, TokenStream* tokens) {
 //     | ('==' | '!=' | '>' | '>=' | '<' | '<=') constraint
 //
 // extension is then right-recursive and can be implemented using a while loop.
-absl::StatusOr<Expression> ParseConstraintAbove(ConstraintKind constraint_kind,
-                                                TokenStream* tokens,
-                                                int context_precedence) {
+//
+// The AST is allocated on `arena`, or on the heap if `arena` is null.
+absl::StatusOr<ExpressionPtr> ParseConstraintAbove(
+    ConstraintKind constraint_kind, TokenStream* tokens,
+    int context_precedence, google::protobuf::Arena* arena) {
   // Try to parse an 'initial' AST.
-  Expression ast;
+  ExpressionPtr ast;
   const Token token = tokens->Next();
   switch (token.kind) {
     case Token::TRUE:
     case Token::FALSE: {
-      ASSIGN_OR_RETURN(ast, ast::MakeBooleanConstant(token));
+      ASSIGN_OR_RETURN(ast, ast::MakeBooleanConstant(token, arena));
       break;
     }
     case Token::BINARY:
     case Token::OCTARY:
     case Token::DECIMAL:
     case Token::HEXADEC: {
-      ASSIGN_OR_RETURN(ast, ast::MakeIntegerConstant(token));
+      ASSIGN_OR_RETURN(ast, ast::MakeIntegerConstant(token, arena));
       break;
     }
     case Token::ID: {
@@ -263,8 +268,8 @@ absl::StatusOr<Expression> ParseConstraintAbove(ConstraintKind constraint_kind,
                          ExpectTokenKind(Token::RPAR, tokens));
         ASSIGN_OR_RETURN(
             ast, ast::MakeNetworkAddressIntegerConstant(
-                     token.text, string_token.text, token.start_location,
-                     rpar_token.end_location));
+                     token.text, string_token.text, token.StartLocation(),
+                     rpar_token.EndLocation(), arena));
       } else {
         // Parse variable: ID (DOT ID)*
         std::vector<Token> id_tokens = {token};
@@ -273,30 +278,35 @@ absl::StatusOr<Expression> ParseConstraintAbove(ConstraintKind constraint_kind,
           ASSIGN_OR_RETURN(Token token, ExpectTokenKind(Token::ID, tokens));
           id_tokens.push_back(token);
         }
-        ASSIGN_OR_RETURN(ast, ast::MakeVariable(id_tokens, constraint_kind));
+        ASSIGN_OR_RETURN(
+            ast, ast::MakeVariable(id_tokens, constraint_kind, arena));
       }
       break;
     }
     case Token::DOUBLE_COLON: {
       ASSIGN_OR_RETURN(const Token attribute_name,
                        ExpectTokenKind(Token::ID, tokens));
-      ASSIGN_OR_RETURN(ast, ast::MakeAttributeAccess(token, attribute_name));
+      ASSIGN_OR_RETURN(
+          ast, ast::MakeAttributeAccess(token, attribute_name, arena));
       break;
     }
     case Token::BANG: {
-      ASSIGN_OR_RETURN(ast, ParseConstraintAbove(constraint_kind, tokens,
-                                                 TokenPrecedence(token.kind)));
+      ASSIGN_OR_RETURN(
+          ast, ParseConstraintAbove(constraint_kind, tokens,
+                                    TokenPrecedence(token.kind), arena));
       ASSIGN_OR_RETURN(ast, ast::MakeBooleanNegation(token, std::move(ast)));
       break;
     }
     case Token::MINUS: {
-      ASSIGN_OR_RETURN(ast, ParseConstraintAbove(constraint_kind, tokens,
-                                                 TokenPrecedence(token.kind)));
+      ASSIGN_OR_RETURN(
+          ast, ParseConstraintAbove(constraint_kind, tokens,
+                                    TokenPrecedence(token.kind), arena));
       ASSIGN_OR_RETURN(ast, ast::MakeArithmeticNegation(token, std::move(ast)));
       break;
     }
     case Token::LPAR: {
-      ASSIGN_OR_RETURN(ast, ParseConstraintAbove(constraint_kind, tokens, 0));
+      ASSIGN_OR_RETURN(
+          ast, ParseConstraintAbove(constraint_kind, tokens, 0, arena));
       RETURN_IF_ERROR(ExpectTokenKind(Token::RPAR, tokens).status());
       break;
     }
@@ -367,9 +377,10 @@ absl::StatusOr<Expression> ParseConstraintAbove(ConstraintKind constraint_kind,
       ASSIGN_OR_RETURN(ast, ast::MakeFieldAccess(std::move(ast), field));
     } else {
       // token.kind is one of &&, ;, ||, ->, ==, !=, >, >=, <, <=.
-      ASSIGN_OR_RETURN(Expression another_ast,
-                       ParseConstraintAbove(constraint_kind, tokens,
-                                            TokenPrecedence(token.kind)));
+      ASSIGN_OR_RETURN(
+          ExpressionPtr another_ast,
+          ParseConstraintAbove(constraint_kind, tokens,
+                               TokenPrecedence(token.kind), arena));
       ASSIGN_OR_RETURN(ast, ast::MakeBinaryExpression(token, std::move(ast),
                                                       std::move(another_ast)));
     }
@@ -382,24 +393,43 @@ absl::StatusOr<Expression> ParseConstraintAbove(ConstraintKind constraint_kind,
 // given `source`. The behavior of this function is undefined if this assumption
 // is violated. Due to this tricky contract, we don't expose this function
 // publicly.
-absl::StatusOr<Expression> internal_parser::ParseConstraint(
+absl::StatusOr<ExpressionPtr> internal_parser::ParseConstraint(
     ConstraintKind constraint_kind, const std::vector<Token>& tokens,
-    const ConstraintSource& source) {
+    const ConstraintSource& source, google::protobuf::Arena* arena) {
   TokenStream token_stream(tokens, source);
-  ASSIGN_OR_RETURN(Expression ast,
-                   ParseConstraintAbove(constraint_kind, &token_stream, 0));
+  ASSIGN_OR_RETURN(
+      ExpressionPtr ast,
+      ParseConstraintAbove(constraint_kind, &token_stream, 0, arena));
   RETURN_IF_ERROR(ExpectTokenKind(Token::END_OF_INPUT, &token_stream).status());
   return ast;
 }
 
+absl::StatusOr<Expression> internal_parser::ParseConstraint(
+    ConstraintKind constraint_kind, const std::vector<Token>& tokens,
+    const ConstraintSource& source) {
+  ASSIGN_OR_RETURN(ExpressionPtr ast,
+                   ParseConstraint(constraint_kind, tokens, source,
+                                   /*arena=*/nullptr));
+  return std::move(*ast);
+}
+
 // -- Public interface ---------------------------------------------------------
 
 // Public-facing version of `internal_parser::ParseConstraint` that provides a
 // fool-proof & more-convenient API that combines lexing and parsing.
+absl::StatusOr<ExpressionPtr> ParseConstraint(ConstraintKind constraint_kind,
+                                              const ConstraintSource& source,
+                                              google::protobuf::Arena* arena) {
+  const std::vector<Token> tokens = Tokenize(source);
+  return internal_parser::ParseConstraint(constraint_kind, tokens, source,
+                                          arena);
+}
+
 absl::StatusOr<Expression> ParseConstraint(ConstraintKind constraint_kind,
                                            const ConstraintSource& source) {
-  const std::vector<Token> tokens = Tokenize(source);
-  return internal_parser::ParseConstraint(constraint_kind, tokens, source);
+  ASSIGN_OR_RETURN(ExpressionPtr ast,
+                   ParseConstraint(constraint_kind, source, /*arena=*/nullptr));
+  return std::move(*ast);
 }
 
 }  // namespace p4_constraints
@@ -21,6 +21,8 @@
 #include <vector>
 
 #include "absl/status/statusor.h"
+#include "google/protobuf/arena.h"
+#include "p4_constraints/ast.h"
 #include "p4_constraints/ast.pb.h"
 #include "p4_constraints/constraint_source.h"
 #include "p4_constraints/frontend/constraint_kind.h"
@@ -33,6 +35,13 @@ namespace p4_constraints {
 absl::StatusOr<ast::Expression> ParseConstraint(ConstraintKind constraint_kind,
                                                 const ConstraintSource& source);
 
+// Like the function above, but allocates the AST on `arena` (or on the heap if
+// `arena` is null), so that it can be rewritten in place by later passes
+// without being copied.
+absl::StatusOr<ast::ExpressionPtr> ParseConstraint(
+    ConstraintKind constraint_kind, const ConstraintSource& source,
+    google::protobuf::Arena* arena);
+
 // -- END OF PUBLIC INTERFACE --------------------------------------------------
 
 // Exposed for testing only.
@@ -44,6 +53,11 @@ absl::StatusOr<ast::Expression> ParseConstraint(
     ConstraintKind constraint_kind, const std::vector<Token>& tokens,
     const ConstraintSource& source);
 
+// Like the function above, but allocates the AST on `arena`.
+absl::StatusOr<ast::ExpressionPtr> ParseConstraint(
+    ConstraintKind constraint_kind, const std::vector<Token>& tokens,
+    const ConstraintSource& source, google::protobuf::Arena* arena);
+
 }  // namespace internal_parser
 
 }  // namespace p4_constraints
@@ -0,0 +1,73 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+// Measures lexing and parsing SAI-style ACL table constraints of increasing
+// size.
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <utility>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "google/protobuf/arena.h"
+#include "p4_constraints/ast.h"
+#include "p4_constraints/ast.pb.h"
+#include "p4_constraints/constraint_source.h"
+#include "p4_constraints/frontend/constraint_kind.h"
+#include "p4_constraints/frontend/parser.h"
+
+namespace p4_constraints {
+namespace {
+
+// Modeled after the ACL tables of SAI P4.
+constexpr char kAclConstraint[] = R"(
+  // Only allow IP field matches for IP packets.
+  dst_ip::mask != 0 -> is_ipv4 == 1;
+  ttl::mask != 0 -> (is_ip == 1 || is_ipv4 == 1 || is_ipv6 == 1);
+  /* Only allow l4_dst_port matches for TCP/UDP packets. */
+  l4_dst_port::mask != 0 -> (ip_protocol::mask == 0xff &&
+                             (ip_protocol::value == 6 ||
+                              ip_protocol::value == 0d17));
+  dst_mac::mask == 0 || dst_mac == mac('00:11:22:33:44:55');
+  ::priority > 0 && ::priority <= 0x7fffffff;
+)";
+
+void BM_ParseConstraint(benchmark::State& state) {
+  std::string constraint;
+  for (int i = 0; i < state.range(0); ++i) {
+    absl::StrAppend(&constraint, kAclConstraint);
+  }
+  ConstraintSource source{.constraint_string = std::move(constraint)};
+  source.constraint_location.set_table_name("acl_table");
+  for (auto _ : state) {
+    absl::StatusOr<ast::Expression> constraint =
+        ParseConstraint(ConstraintKind::kTableConstraint, source);
+    benchmark::DoNotOptimize(constraint);
+  }
+  state.SetBytesProcessed(state.iterations() *
+                          source.constraint_string.size());
+}
+BENCHMARK(BM_ParseConstraint)->Arg(1)->Arg(100);
+
+void BM_ParseConstraintOnArena(benchmark::State& state) {
+  std::string constraint;
+  for (int i = 0; i < state.range(0); ++i) {
+    absl::StrAppend(&constraint, kAclConstraint);
+  }
+  ConstraintSource source{.constraint_string = std::move(constraint)};
+  source.constraint_location.set_table_name("acl_table");
+  for (auto _ : state) {
+    google::protobuf::Arena arena;
+    absl::StatusOr<ast::ExpressionPtr> constraint =
+        ParseConstraint(ConstraintKind::kTableConstraint, source, &arena);
+    benchmark::DoNotOptimize(constraint);
+  }
+  state.SetBytesProcessed(state.iterations() *
+                          source.constraint_string.size());
+}
+BENCHMARK(BM_ParseConstraintOnArena)->Arg(1)->Arg(100);
+
+}  // namespace
+}  // namespace p4_constraints
@@ -24,6 +24,7 @@
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
 #include "gutil/proto_matchers.h"
 #include "gutil/status_matchers.h"
 #include "p4_constraints/ast.pb.h"
@@ -38,38 +39,32 @@ using ::gutil::IsOkAndHolds;
 using ::gutil::Partially;
 using ::gutil::StatusIs;
 
-Token Binary(std::string text) {
-  return Token(Token::BINARY, text, ast::SourceLocation(),
-               ast::SourceLocation());
+Token Binary(absl::string_view text) {
+  return Token(Token::BINARY, text, /*start=*/{}, /*end=*/{});
 }
 
-Token Octary(std::string text) {
-  return Token(Token::Kind::OCTARY, text, ast::SourceLocation(),
-               ast::SourceLocation());
+Token Octary(absl::string_view text) {
+  return Token(Token::Kind::OCTARY, text, /*start=*/{}, /*end=*/{});
 }
 
-Token Decimal(std::string text) {
-  return Token(Token::Kind::DECIMAL, text, ast::SourceLocation(),
-               ast::SourceLocation());
+Token Decimal(absl::string_view text) {
+  return Token(Token::Kind::DECIMAL, text, /*start=*/{}, /*end=*/{});
 }
 
-Token Hexadec(std::string text) {
-  return Token(Token::Kind::HEXADEC, text, ast::SourceLocation(),
-               ast::SourceLocation());
+Token Hexadec(absl::string_view text) {
+  return Token(Token::Kind::HEXADEC, text, /*start=*/{}, /*end=*/{});
 }
 
-Token String(std::string text) {
-  return Token(Token::Kind::STRING, text, ast::SourceLocation(),
-               ast::SourceLocation());
+Token String(absl::string_view text) {
+  return Token(Token::Kind::STRING, text, /*start=*/{}, /*end=*/{});
 }
 
-Token Id(std::string text) {
-  return Token(Token::Kind::ID, text, ast::SourceLocation(),
-               ast::SourceLocation());
+Token Id(absl::string_view text) {
+  return Token(Token::Kind::ID, text, /*start=*/{}, /*end=*/{});
 }
 
 Token DummyToken(Token::Kind kind) {
-  return Token(kind, "", ast::SourceLocation(), ast::SourceLocation());
+  return Token(kind, "", /*start=*/{}, /*end=*/{});
 }
 
 struct ParserTest : public ::testing::Test {
@@ -0,0 +1,23 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+// The original RE2-based lexer, which the hand-written lexer in lexer.h
+// replaces. Kept as the reference for differential tests and benchmarks of the
+// latter; not meant for use outside of tests.
+
+#ifndef P4_CONSTRAINTS_FRONTEND_REGEXP_LEXER_H_
+#define P4_CONSTRAINTS_FRONTEND_REGEXP_LEXER_H_
+
+#include <vector>
+
+#include "p4_constraints/constraint_source.h"
+#include "p4_constraints/frontend/token.h"
+
+namespace p4_constraints {
+
+// Same as `Tokenize` in lexer.h, but matches tokens using RE2.
+std::vector<Token> TokenizeWithRegexp(const ConstraintSource& constraint);
+
+}  // namespace p4_constraints
+
+#endif  // P4_CONSTRAINTS_FRONTEND_REGEXP_LEXER_H_
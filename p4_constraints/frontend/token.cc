@@ -22,6 +22,7 @@
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/types/optional.h"
+#include "p4_constraints/ast.pb.h"
 
 namespace p4_constraints {
 
@@ -57,6 +58,27 @@ const Token::Kind Token::kAllKinds[26] = {
     // clang-format on
 };
 
+namespace {
+
+ast::SourceLocation MaterializeLocation(const ast::SourceLocation* origin,
+                                        Token::Position position) {
+  ast::SourceLocation location;
+  if (origin != nullptr) location = *origin;
+  location.set_line(position.line);
+  location.set_column(position.column);
+  return location;
+}
+
+}  // namespace
+
+ast::SourceLocation Token::StartLocation() const {
+  return MaterializeLocation(origin, start);
+}
+
+ast::SourceLocation Token::EndLocation() const {
+  return MaterializeLocation(origin, end);
+}
+
 std::string Token::KindToKeyword(Token::Kind token_kind) {
   switch (token_kind) {
     case Token::TRUE:
@@ -23,6 +23,7 @@
 #include <iosfwd>
 #include <string>
 
+#include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
 #include "p4_constraints/ast.pb.h"
 
@@ -64,23 +65,38 @@ struct Token {
   // All token kinds. Keep in sync with enum Kind.
   static const Kind kAllKinds[26];
 
-  Token(const Kind kind, const std::string text,
-        const ast::SourceLocation start_location,
-        const ast::SourceLocation end_location) noexcept
-      : kind{kind},
-        text{text},
-        start_location{start_location},
-        end_location{end_location} {};
+  // A 0-based line and column, as in `ast::SourceLocation`.
+  struct Position {
+    int line = 0;
+    int column = 0;
+  };
+
+  Token(const Kind kind, const absl::string_view text, const Position start,
+        const Position end,
+        const ast::SourceLocation* const origin = nullptr) noexcept
+      : kind{kind}, text{text}, start{start}, end{end}, origin{origin} {};
 
   const Kind kind;
 
-  // Text read by lexer when generating this token.
-  const std::string text;
+  // Text read by lexer when generating this token. Points into the constraint
+  // string the token was lexed from, which must outlive the token.
+  const absl::string_view text;
 
   // The source location of the text read to generate this token is the
-  // half-open, 0-based interval [start_location, end_location).
-  const ast::SourceLocation start_location;
-  const ast::SourceLocation end_location;
+  // half-open, 0-based interval [start, end).
+  const Position start;
+  const Position end;
+
+  // The `constraint_location` of the `ConstraintSource` the token was lexed
+  // from, which must outlive the token, or nullptr. Provides the file path or
+  // table/action name of `StartLocation()` and `EndLocation()`.
+  const ast::SourceLocation* const origin;
+
+  // Returns `start`/`end` as an `ast::SourceLocation`. Tokens are lightweight
+  // views; these materialize the protos only when an AST node or an error
+  // message needs them.
+  ast::SourceLocation StartLocation() const;
+  ast::SourceLocation EndLocation() const;
 
   // Mappings from token kinds to keywords and vice versa. For tokens
   // corresponding to several string such as BINARY, the corresponding keyword
@@ -15,13 +15,23 @@
 
 #include "p4_constraints/quote.h"
 
+#include <stddef.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
 #include <sstream>
 #include <string>
+#include <tuple>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/log/log.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "gutil/proto.h"
 #include "gutil/status.h"
 #include "p4_constraints/ast.h"
@@ -87,69 +97,73 @@ absl::StatusOr<std::string> Explain(const ast::SourceLocation& start,
          << "Invalid source case: " << start.DebugString();
 }
 
+// Returns the offsets of the lines of `constraint_string`, like `std::getline`
+// splits it: a trailing newline does not start another line.
+std::vector<int> LineOffsets(absl::string_view constraint_string) {
+  std::vector<int> line_offsets;
+  for (size_t offset = 0; offset < constraint_string.size();) {
+    line_offsets.push_back(offset);
+    const size_t newline = constraint_string.find('\n', offset);
+    if (newline == absl::string_view::npos) break;
+    offset = newline + 1;
+  }
+  return line_offsets;
+}
+
+// Returns the line starting at `offset` in `constraint_string`, without its
+// newline.
+absl::string_view LineAt(absl::string_view constraint_string, int offset) {
+  absl::string_view line = constraint_string.substr(offset);
+  return line.substr(0, line.find('\n'));
+}
+
 // Returns a string that quotes and marks the given source location interval,
 // e.g.:
 //
 //  | hdr.ethernet.eth_type == 0x08 ->
 // 8|   1+2 == true
 //  |   ^^^^^^^^^^^
+// `line_offsets` are the `LineOffsets` of the constraint.
 // TODO(b/243082448): Add multiline quoting. Not urgent as current uses only
 // quote single lines.
 absl::StatusOr<std::string> Quote(const ConstraintSource& constraint,
+                                  absl::Span<const int> line_offsets,
                                   const ast::SourceLocation& start,
                                   const ast::SourceLocation& end) {
   if (gutil::ProtoEqual(start, end)) return "";
 
-  std::stringstream constraint_string(constraint.constraint_string);
-
   // Index of the line we want to quote.
   const int kKeyLine = start.line();
   // Start and end are located relative to a source file/table. Offset is the
   // relative location of constraint to that same source.
   const int kOffset = constraint.constraint_location.line();
-  // Number of lines to show before the key line, for context.
-  const int kBefore = (start.line() == kOffset) ? 0 : 1;
-
-  // Discard unneeded lines before the lines we're interested in.
-  int i = kOffset;
-  for (std::string line; i < kKeyLine - kBefore; i++) {
-    if (!std::getline(constraint_string, line)) {
-      return gutil::InvalidArgumentErrorBuilder() << absl::StrFormat(
-                 "Interval [`start`, `end`] to quote must lie within given "
-                 "`constraint`, but `start.line()` = %d while the final line "
-                 "of `constraint` is %d",
-                 kKeyLine, i - 1);
-    }
+  // Index of the key line within the constraint; a key line before the
+  // constraint quotes its first line.
+  const int key_index = std::max(kKeyLine - kOffset, 0);
+  if (key_index >= line_offsets.size()) {
+    return gutil::InvalidArgumentErrorBuilder() << absl::StrFormat(
+               "Interval [`start`, `end`] to quote must lie within given "
+               "`constraint`, but `start.line()` = %d while the final line "
+               "of `constraint` is %d",
+               kKeyLine, kOffset + static_cast<int>(line_offsets.size()) - 1);
   }
 
   const std::string key_line_margin = std::to_string(kKeyLine + 1);
   const std::string context_line_margin(key_line_margin.size(), ' ');
   const std::string separator = " | ";
-  std::stringstream output;
+  std::string output;
 
-  // Output lines before key line for context.
-  for (std::string line; i < kKeyLine; i++) {
-    if (std::getline(constraint_string, line)) {
-      output << context_line_margin << separator << line << "\n";
-    } else {
-      return gutil::InvalidArgumentErrorBuilder() << absl::StrFormat(
-                 "Interval [`start`, `end`] to quote must lie within given "
-                 "`constraint`, but `start.line()` = %d while the final line "
-                 "of `constraint` is %d",
-                 kKeyLine, i - 1);
-    }
+  // Output the line before key line for context, if it is in the constraint.
+  if (key_index > 0) {
+    absl::StrAppend(
+        &output, context_line_margin, separator,
+        LineAt(constraint.constraint_string, line_offsets[key_index - 1]),
+        "\n");
   }
   // Output key line.
-  std::string line;
-  if (std::getline(constraint_string, line)) {
-    output << key_line_margin << separator << line << "\n";
-  } else {
-    return gutil::InvalidArgumentErrorBuilder() << absl::StrFormat(
-               "Interval [`start`, `end`] to quote must lie within given "
-               "`constraint`, but `start.line()` = %d while the final line "
-               "of `constraint` is %d",
-               kKeyLine, i - 1);
-  }
+  const absl::string_view line =
+      LineAt(constraint.constraint_string, line_offsets[key_index]);
+  absl::StrAppend(&output, key_line_margin, separator, line, "\n");
 
   // Mark key columns using '^'.
   const std::string margin = absl::StrCat(context_line_margin, separator,
@@ -158,11 +172,161 @@ absl::StatusOr<std::string> Quote(const ConstraintSource& constraint,
                               ? (end.column() - start.column())
                               : (line.size() - margin.size());
   const std::string marker(marker_size, '^');
-  output << margin << marker << "\n";
-  return output.str();
+  absl::StrAppend(&output, margin, marker, "\n");
+  return output;
 }
+
+// Returns the name of the table, action, or file of `location`.
+absl::string_view SourceName(const ast::SourceLocation& location) {
+  switch (location.source_case()) {
+    case ast::SourceLocation::kTableName:
+      return location.table_name();
+    case ast::SourceLocation::kFilePath:
+      return location.file_path();
+    case ast::SourceLocation::kActionName:
+      return location.action_name();
+    case ast::SourceLocation::SOURCE_NOT_SET:
+      break;
+  }
+  return "";
+}
+
+// Key of a quote in a `QuoteIndex`: the source of the constraint (its kind and
+// name) and the location of the constraint in it, followed by the lines and
+// columns of the quoted interval. The name points into `constraint_location`.
+using QuoteKey = std::tuple<int, absl::string_view, int, int, int, int, int,
+                            int>;
+
+QuoteKey MakeQuoteKey(const ast::SourceLocation& constraint_location,
+                      const ast::SourceLocation& from,
+                      const ast::SourceLocation& to) {
+  return {constraint_location.source_case(),
+          SourceName(constraint_location),
+          constraint_location.line(),
+          constraint_location.column(),
+          from.line(),
+          from.column(),
+          to.line(),
+          to.column()};
+}
+
+// Assigns slots to the intervals of `expr` and its subexpressions, which are
+// located in the constraint at `constraint_location`.
+void AddQuoteSlots(const ast::Expression& expr,
+                   const ast::SourceLocation& constraint_location,
+                   absl::flat_hash_map<QuoteKey, int>& slot_by_key) {
+  const int slot = slot_by_key.size();
+  slot_by_key.try_emplace(MakeQuoteKey(constraint_location,
+                                       expr.start_location(),
+                                       expr.end_location()),
+                          slot);
+  switch (expr.expression_case()) {
+    case ast::Expression::kBooleanNegation:
+      AddQuoteSlots(expr.boolean_negation(), constraint_location, slot_by_key);
+      break;
+    case ast::Expression::kArithmeticNegation:
+      AddQuoteSlots(expr.arithmetic_negation(), constraint_location,
+                    slot_by_key);
+      break;
+    case ast::Expression::kTypeCast:
+      AddQuoteSlots(expr.type_cast(), constraint_location, slot_by_key);
+      break;
+    case ast::Expression::kBinaryExpression:
+      AddQuoteSlots(expr.binary_expression().left(), constraint_location,
+                    slot_by_key);
+      AddQuoteSlots(expr.binary_expression().right(), constraint_location,
+                    slot_by_key);
+      break;
+    case ast::Expression::kFieldAccess:
+      AddQuoteSlots(expr.field_access().expr(), constraint_location,
+                    slot_by_key);
+      break;
+    default:
+      break;
+  }
+}
+
 }  // namespace
 
+class QuoteIndex {
+ public:
+  QuoteIndex(const ConstraintSource& source, const ast::Expression* constraint)
+      : indexed_string_(source.constraint_string),
+        constraint_location_(source.constraint_location),
+        line_offsets_(LineOffsets(source.constraint_string)),
+        slot_by_key_(MakeSlots(constraint_location_, constraint)),
+        quotes_(slot_by_key_.size()) {}
+
+  QuoteIndex(const QuoteIndex&) = delete;
+  QuoteIndex& operator=(const QuoteIndex&) = delete;
+
+  ~QuoteIndex() {
+    for (std::atomic<const std::string*>& quote : quotes_) delete quote.load();
+  }
+
+  // Returns true iff `constraint_string` is the string this indexes, or a copy
+  // of it. Constant time.
+  bool Indexes(const ConstraintString& constraint_string) const {
+    return constraint_string.SharesBufferWith(indexed_string_);
+  }
+
+  absl::Span<const int> line_offsets() const { return line_offsets_; }
+
+  // Returns the quote of the interval of `key`, or null if it has not been
+  // rendered yet. Does not lock.
+  const std::string* FindQuote(const QuoteKey& key) const {
+    auto it = slot_by_key_.find(key);
+    if (it == slot_by_key_.end()) return nullptr;
+    return quotes_[it->second].load(std::memory_order_acquire);
+  }
+
+  // Caches `quote` as the quote of the interval of `key`, unless it is not the
+  // interval of a subexpression of the indexed constraint, or another thread
+  // got there first.
+  void InsertQuote(const QuoteKey& key, const std::string& quote) const {
+    auto it = slot_by_key_.find(key);
+    if (it == slot_by_key_.end()) return;
+    auto cached = std::make_unique<const std::string>(quote);
+    const std::string* expected = nullptr;
+    if (quotes_[it->second].compare_exchange_strong(
+            expected, cached.get(), std::memory_order_acq_rel)) {
+      cached.release();
+    }
+  }
+
+ private:
+  static absl::flat_hash_map<QuoteKey, int> MakeSlots(
+      const ast::SourceLocation& constraint_location,
+      const ast::Expression* constraint) {
+    absl::flat_hash_map<QuoteKey, int> slot_by_key;
+    if (constraint != nullptr) {
+      AddQuoteSlots(*constraint, constraint_location, slot_by_key);
+    }
+    return slot_by_key;
+  }
+
+  // The indexed string. Shares its buffer rather than copying it, and keeps it
+  // alive, so that no other string can take its place.
+  const ConstraintString indexed_string_;
+  // The keys in `slot_by_key_` point into it.
+  const ast::SourceLocation constraint_location_;
+  const std::vector<int> line_offsets_;
+  // The slots in `quotes_` of the intervals of the subexpressions of the
+  // indexed constraint. Fixed at construction, so reading it needs no lock.
+  const absl::flat_hash_map<QuoteKey, int> slot_by_key_;
+  // The rendered quotes, owned, or null until first rendered.
+  mutable std::vector<std::atomic<const std::string*>> quotes_;
+};
+
+void IndexConstraintSource(ConstraintSource& source) {
+  source.quote_index = std::make_shared<const QuoteIndex>(source, nullptr);
+}
+
+void IndexConstraintSource(ConstraintSource& source,
+                           const ast::Expression& constraint) {
+  source.quote_index = std::make_shared<const QuoteIndex>(source, &constraint);
+}
+
 std::string GetSourceName(const ast::SourceLocation& source) {
   switch (source.source_case()) {
     case ast::SourceLocation::kTableName:
@@ -190,9 +354,23 @@ absl::StatusOr<std::string> QuoteSubConstraint(
                GetSourceName(constraint.constraint_location),
                GetSourceName(from), GetSourceName(to));
   }
+  const QuoteIndex* index = constraint.quote_index.get();
+  if (index == nullptr || !index->Indexes(constraint.constraint_string)) {
+    ASSIGN_OR_RETURN(std::string explanation, Explain(from, to));
+    ASSIGN_OR_RETURN(
+        std::string quote,
+        Quote(constraint, LineOffsets(constraint.constraint_string), from, to));
+    return absl::StrCat(explanation, quote);
+  }
+  const QuoteKey key =
+      MakeQuoteKey(constraint.constraint_location, from, to);
+  if (const std::string* quote = index->FindQuote(key)) return *quote;
   ASSIGN_OR_RETURN(std::string explanation, Explain(from, to));
-  ASSIGN_OR_RETURN(std::string quote, Quote(constraint, from, to));
-  return absl::StrCat(explanation, quote);
+  ASSIGN_OR_RETURN(std::string quote,
+                   Quote(constraint, index->line_offsets(), from, to));
+  std::string result = absl::StrCat(explanation, quote);
+  index->InsertQuote(key, result);
+  return result;
 }
 
 }  // namespace p4_constraints
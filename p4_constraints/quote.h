@@ -31,10 +31,32 @@ namespace p4_constraints {
 // Returns a string that quotes a sub-constraint within `constraint` and
 // describes its source location, delimited by `from` and `to`. If delimiters
 // fall out of range or args are malformed, returns an invalid argument error.
+//
+// Without a `quote_index`, finding the quoted lines takes a scan of the whole
+// constraint, on every call.
 absl::StatusOr<std::string> QuoteSubConstraint(
     const ConstraintSource& constraint, const ast::SourceLocation& from,
     const ast::SourceLocation& to);
 
+// An index of the lines of a constraint, and a cache of the quotes of its
+// subexpressions (whose number is bounded by the size of the constraint) by
+// source and interval. Immutable but for the cache, which is filled in
+// without locking. Thread-safe.
+class QuoteIndex;
+
+// Attaches a `QuoteIndex` of `source` to `source`, so that each quote costs
+// time proportional to the quoted lines rather than the whole constraint.
+//
+// The index is shared by copies of `source`, and tied to the buffer of
+// `source.constraint_string`, which is immutable: sources that are assigned
+// another string quote without it, until they are indexed again.
+void IndexConstraintSource(ConstraintSource& source);
+
+// Same as above, but additionally caches the quotes of the subexpressions of
+// `constraint`, parsed from `source`, so that each is only rendered once.
+void IndexConstraintSource(ConstraintSource& source,
+                           const ast::Expression& constraint);
+
 }  // namespace p4_constraints
 
 #endif  // P4_CONSTRAINTS_QUOTE_H_
@@ -0,0 +1,180 @@
+// Copyright 2026 The P4-Constraints Authors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "p4_constraints/quote.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_replace.h"
+#include "gutil/status_matchers.h"
+#include "p4_constraints/ast.pb.h"
+#include "p4_constraints/constraint_source.h"
+
+namespace p4_constraints {
+namespace {
+
+using ::gutil::IsOkAndHolds;
+using ::gutil::StatusIs;
+using ::testing::HasSubstr;
+
+ast::SourceLocation Location(int line, int column) {
+  ast::SourceLocation location;
+  location.set_table_name("t");
+  location.set_line(line);
+  location.set_column(column);
+  return location;
+}
+
+// A constraint at line 10 of table t, quoted at lines 10 to 13.
+ConstraintSource MakeSource() {
+  return ConstraintSource{
+      .constraint_string = "a == 1 &&\nb == 2 &&\n\nc == 3\n",
+      .constraint_location = Location(10, 0),
+  };
+}
+
+TEST(QuoteSubConstraintTest, QuotesKeyLineWithContext) {
+  EXPECT_THAT(
+      QuoteSubConstraint(MakeSource(), Location(11, 0), Location(11, 6)),
+      IsOkAndHolds("In @entry_restriction of table 't'; at offset line "
+                   "12, columns 1 to 6:\n"
+                   "   | a == 1 &&\n"
+                   "12 | b == 2 &&\n"
+                   "   | ^^^^^^\n"));
+  EXPECT_THAT(
+      QuoteSubConstraint(MakeSource(), Location(10, 5), Location(10, 6)),
+      IsOkAndHolds("In @entry_restriction of table 't'; at offset line "
+                   "11, column 6:\n"
+                   "11 | a == 1 &&\n"
+                   "   |      ^\n"));
+}
+
+TEST(QuoteSubConstraintTest, RejectsLinesPastTheConstraint) {
+  EXPECT_THAT(
+      QuoteSubConstraint(MakeSource(), Location(14, 0), Location(14, 1)),
+      StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(QuoteSubConstraintTest, IndexedSourcesQuoteTheSame) {
+  ConstraintSource indexed = MakeSource();
+  IndexConstraintSource(indexed);
+  for (int line = 9; line < 15; ++line) {
+    for (int column = 0; column < 3; ++column) {
+      SCOPED_TRACE(absl::StrCat(line, ":", column));
+      const ast::SourceLocation from = Location(line, column);
+      const ast::SourceLocation to = Location(line, column + 2);
+      absl::StatusOr<std::string> expected =
+          QuoteSubConstraint(MakeSource(), from, to);
+      // Twice, to exercise the cache.
+      for (int round = 0; round < 2; ++round) {
+        absl::StatusOr<std::string> actual =
+            QuoteSubConstraint(indexed, from, to);
+        ASSERT_EQ(actual.status(), expected.status());
+        if (expected.ok()) EXPECT_EQ(*actual, *expected);
+      }
+    }
+  }
+}
+
+// `a == 1`, the first atom of the constraint of `MakeSource`.
+ast::Expression MakeFirstAtom() {
+  ast::Expression atom;
+  *atom.mutable_start_location() = Location(10, 0);
+  *atom.mutable_end_location() = Location(10, 6);
+  ast::BinaryExpression& equality = *atom.mutable_binary_expression();
+  equality.set_binop(ast::EQ);
+  *equality.mutable_left()->mutable_start_location() = Location(10, 0);
+  *equality.mutable_left()->mutable_end_location() = Location(10, 1);
+  equality.mutable_left()->set_key("a");
+  *equality.mutable_right()->mutable_start_location() = Location(10, 5);
+  *equality.mutable_right()->mutable_end_location() = Location(10, 6);
+  equality.mutable_right()->set_integer_constant("1");
+  return atom;
+}
+
+TEST(QuoteSubConstraintTest, SubexpressionQuotesAreCached) {
+  const ast::Expression atom = MakeFirstAtom();
+  ConstraintSource indexed = MakeSource();
+  IndexConstraintSource(indexed, atom);
+  for (const ast::Expression* expr :
+       {&atom, &atom.binary_expression().left(),
+        &atom.binary_expression().right()}) {
+    SCOPED_TRACE(expr->DebugString());
+    ASSERT_OK_AND_ASSIGN(std::string expected,
+                         QuoteSubConstraint(MakeSource(),
+                                            expr->start_location(),
+                                            expr->end_location()));
+    // Twice, to exercise the cache.
+    for (int round = 0; round < 2; ++round) {
+      EXPECT_THAT(QuoteSubConstraint(indexed, expr->start_location(),
+                                     expr->end_location()),
+                  IsOkAndHolds(expected));
+    }
+  }
+}
+
+TEST(QuoteSubConstraintTest, CachedQuotesAreKeyedBySource) {
+  const ast::Expression atom = MakeFirstAtom();
+  ConstraintSource source = MakeSource();
+  IndexConstraintSource(source, atom);
+  ASSERT_THAT(QuoteSubConstraint(source, atom.start_location(),
+                                 atom.end_location()),
+              IsOkAndHolds(HasSubstr("table 't'")));
+  // Same string, different table.
+  source.constraint_location.set_table_name("u");
+  ast::SourceLocation from = atom.start_location();
+  ast::SourceLocation to = atom.end_location();
+  from.set_table_name("u");
+  to.set_table_name("u");
+  EXPECT_THAT(QuoteSubConstraint(source, from, to),
+              IsOkAndHolds(HasSubstr("table 'u'")));
+}
+
+TEST(QuoteSubConstraintTest, StaleIndexIsIgnored) {
+  ConstraintSource source = MakeSource();
+  IndexConstraintSource(source);
+  source.constraint_string = "x == 1";
+  EXPECT_THAT(QuoteSubConstraint(source, Location(10, 0), Location(10, 1)),
+              IsOkAndHolds("In @entry_restriction of table 't'; at offset line "
+                           "11, column 1:\n"
+                           "11 | x == 1\n"
+                           "   | ^\n"));
+}
+
+TEST(QuoteSubConstraintTest, CachedQuotesOfReplacedStringAreIgnored) {
+  const ast::Expression atom = MakeFirstAtom();
+  ConstraintSource source = MakeSource();
+  IndexConstraintSource(source, atom);
+  const ast::Expression& key = atom.binary_expression().left();
+  // Fills the cache.
+  ASSERT_THAT(
+      QuoteSubConstraint(source, key.start_location(), key.end_location()),
+      IsOkAndHolds(HasSubstr("11 | a == 1 &&\n")));
+  // Same size and lines, different text.
+  source.constraint_string =
+      absl::StrReplaceAll(source.constraint_string, {{"a == 1", "x == 7"}});
+  EXPECT_THAT(
+      QuoteSubConstraint(source, key.start_location(), key.end_location()),
+      IsOkAndHolds(HasSubstr("11 | x == 7 &&\n")));
+}
+
+TEST(QuoteSubConstraintTest, IndexIsSharedByCopiesOfTheSource) {
+  const ast::Expression atom = MakeFirstAtom();
+  ConstraintSource source = MakeSource();
+  IndexConstraintSource(source, atom);
+  const ConstraintSource copy = source;
+  ASSERT_TRUE(
+      copy.constraint_string.SharesBufferWith(source.constraint_string));
+  EXPECT_THAT(QuoteSubConstraint(copy, atom.start_location(),
+                                 atom.end_location()),
+              IsOkAndHolds(HasSubstr("11 | a == 1 &&\n")));
+}
+
+}  // namespace
+}  // namespace p4_constraints